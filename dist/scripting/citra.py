@@ -3,13 +3,20 @@ import random
 import enum
 import socket
 
-CURRENT_REQUEST_VERSION = 1
-MAX_REQUEST_DATA_SIZE = 32
-MAX_PACKET_SIZE = 48
+CURRENT_REQUEST_VERSION = 2
+MAX_REQUEST_DATA_SIZE = 4096
+MAX_PACKET_SIZE = 4112
 
 class RequestType(enum.IntEnum):
     ReadMemory = 1,
-    WriteMemory = 2
+    WriteMemory = 2,
+    ReadHLEStats = 3,
+    ReadPerfStats = 4,
+    ReadMemoryBatch = 5,
+    WriteMemoryBatch = 6,
+    AddWatch = 7,
+    RemoveWatch = 8,
+    WatchNotification = 9
 
 CITRA_PORT = 45987
 
@@ -17,6 +24,7 @@ class Citra:
     def __init__(self, address="127.0.0.1", port=CITRA_PORT):
         self.socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
         self.address = address
+        self.notifications = []
 
     def is_connected(self):
         return self.socket is not None
@@ -90,6 +98,111 @@ class Citra:
                 return False
         return True
 
+    def _send_request(self, request_type, request_data):
+        request, request_id = self._generate_header(request_type, len(request_data))
+        self.socket.sendto(request + request_data, (self.address, CITRA_PORT))
+        while True:
+            raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+            # Watch notifications may arrive while waiting for a reply
+            if struct.unpack("I", raw_reply[8:12])[0] == RequestType.WatchNotification:
+                self.notifications.append(raw_reply)
+                continue
+            return self._read_and_validate_header(raw_reply, request_id, request_type)
+
+    def read_memory_batch(self, ranges):
+        """
+        Reads several (address, size) ranges with a single request
+        >>> c.read_memory_batch([(0x100000, 2), (0x100002, 2)])
+        [b'\\x07\\x00', b'\\x00\\xeb']
+        """
+        request_data = struct.pack("I", len(ranges))
+        for address, size in ranges:
+            request_data += struct.pack("II", address, size)
+        reply_data = self._send_request(RequestType.ReadMemoryBatch, request_data)
+        if reply_data is None or len(reply_data) != sum(size for _, size in ranges):
+            return None
+
+        result = []
+        for _, size in ranges:
+            result.append(reply_data[:size])
+            reply_data = reply_data[size:]
+        return result
+
+    def write_memory_batch(self, writes):
+        """
+        Writes several (address, contents) pairs with a single request
+        >>> c.write_memory_batch([(0x100000, b"\\x07\\x00\\x00\\xeb")])
+        True
+        """
+        request_data = struct.pack("I", len(writes))
+        for address, contents in writes:
+            request_data += struct.pack("II", address, len(contents)) + contents
+        return self._send_request(RequestType.WriteMemoryBatch, request_data) is not None
+
+    def add_watch(self, address, size):
+        """
+        Watches a memory range, returning the id of the watch, or None if the range is not mapped.
+        A notification is sent at the end of every frame in which the contents changed, and once
+        when the watch is added.
+        """
+        reply_data = self._send_request(RequestType.AddWatch, struct.pack("II", address, size))
+        if not reply_data:
+            return None
+        return struct.unpack("I", reply_data)[0]
+
+    def remove_watch(self, watch_id):
+        return self._send_request(RequestType.RemoveWatch, struct.pack("I", watch_id)) is not None
+
+    def wait_for_notification(self, timeout=None):
+        """
+        Returns (watch id, frame number, contents) of the next watch notification
+        """
+        if self.notifications:
+            raw_reply = self.notifications.pop(0)
+        else:
+            self.socket.settimeout(timeout)
+            try:
+                raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+            except socket.timeout:
+                return None
+            finally:
+                self.socket.settimeout(None)
+        _, watch_id, reply_type, _ = struct.unpack("IIII", raw_reply[:4*4])
+        if reply_type != RequestType.WatchNotification:
+            return None
+        frame = struct.unpack("I", raw_reply[4*4:4*5])[0]
+        return (watch_id, frame, raw_reply[4*5:])
+
+    def _read_report(self, request_type):
+        result = bytes()
+        while True:
+            request_data = struct.pack("II", len(result), MAX_REQUEST_DATA_SIZE)
+            request, request_id = self._generate_header(request_type, len(request_data))
+            request += request_data
+            self.socket.sendto(request, (self.address, CITRA_PORT))
+
+            raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+            reply_data = self._read_and_validate_header(raw_reply, request_id, request_type)
+
+            if reply_data is None:
+                return None
+            result += reply_data
+            if len(reply_data) < MAX_REQUEST_DATA_SIZE:
+                return result.decode()
+
+    def read_hle_stats(self):
+        """
+        Returns the SVC and IPC command statistics as CSV text. Statistics are only recorded
+        after the first call, unless Citra was started with --hle-stats.
+        """
+        return self._read_report(RequestType.ReadHLEStats)
+
+    def read_perf_stats(self):
+        """
+        Returns the latest performance statistics and frame time breakdown as CSV text
+        """
+        return self._read_report(RequestType.ReadPerfStats)
+
 if "__main__" == __name__:
     import doctest
     doctest.testmod(extraglobs={'c': Citra()})
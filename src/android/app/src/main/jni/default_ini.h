@@ -114,6 +114,10 @@ shaders_accurate_mul =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Whether to process GPU command lists on a separate thread. Only used by the software renderer.
+# 0 (default): Off, 1: On
+use_async_gpu =
+
 # Forces VSync on the display thread. Usually doesn't impact performance, but on some drivers it can
 # so only turn this off if you notice a speed difference.
 # 0: Off, 1 (default): On
@@ -318,6 +322,10 @@ camera_inner_flip =
 # Examples: *:Debug Kernel.SVC:Trace Service.*:Critical
 log_filter = *:Info
 
+# Writes the log as a compact binary file (citra_log.bin) instead of text, which is cheaper to write.
+# Expand it to text with citra --expand-log. 0 (default): Off, 1: On
+binary_log =
+
 [Debugging]
 # Record frame time data, can be found in the log directory. Boolean value
 record_frame_times =
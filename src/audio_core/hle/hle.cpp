@@ -28,6 +28,7 @@
 #include "common/common_types.h"
 #include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/tracing.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 
@@ -457,6 +458,8 @@ bool DspHle::Impl::Tick() {
 }
 
 void DspHle::Impl::AudioTickCallback(s64 cycles_late) {
+    CITRA_TRACE_SCOPE("DSP", "AudioTick");
+    Core::PerfStats::ScopedComponent component{Core::PerfStats::Component::Audio};
     if (Tick()) {
         // TODO(merry): Signal all the other interrupts as appropriate.
         if (auto service = dsp_dsp.lock()) {
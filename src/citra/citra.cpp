@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <regex>
@@ -19,12 +20,14 @@
 #include "common/detached_tasks.h"
 #include "common/file_util.h"
 #include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
 #include "common/logging/filter.h"
 #include "common/logging/log.h"
 #include "common/scm_rev.h"
 #include "common/scope_exit.h"
 #include "common/settings.h"
 #include "common/string_util.h"
+#include "common/tracing.h"
 #include "core/core.h"
 #include "core/dumping/backend.h"
 #include "core/dumping/ffmpeg_backend.h"
@@ -69,7 +72,16 @@ static void PrintHelp(const char* argv0) {
                  "-r, --movie-record=[file]  Record a movie (game inputs) to the given file\n"
                  "-a, --movie-record-author=AUTHOR Sets the author of the movie to be recorded\n"
                  "-p, --movie-play=[file]    Playback the movie (game inputs) from the given file\n"
+                 "-k, --movie-keyframes=NUMBER Embeds a savestate every NUMBER frames in the\n"
+                 "                     recorded movie, for seeking during playback\n"
                  "-d, --dump-video=[file]    Dumps audio and video to the given video file\n"
+                 "-l, --expand-log=FILE Prints a binary log file as text and exits\n"
+                 "-t, --trace=FILE     Records a trace and writes it to FILE in the Chrome trace\n"
+                 "                     format when emulation ends\n"
+                 "-s, --hle-stats=FILE Writes SVC and IPC command statistics to FILE as CSV when\n"
+                 "                     emulation ends\n"
+                 "-c, --perf-stats=FILE Writes performance statistics and the frame time\n"
+                 "                     breakdown to FILE as CSV every second\n"
                  "-f, --fullscreen     Start in fullscreen mode\n"
                  "-h, --help           Display this help and exit\n"
                  "-v, --version        Output version information and exit\n";
@@ -187,7 +199,11 @@ int main(int argc, char** argv) {
     std::string movie_record;
     std::string movie_record_author;
     std::string movie_play;
+    u64 movie_keyframe_interval = 0;
     std::string dump_video;
+    std::string trace_file;
+    std::string hle_stats_file;
+    std::string perf_stats_file;
 
     char* endarg;
 #ifdef _WIN32
@@ -215,7 +231,12 @@ int main(int argc, char** argv) {
         {"movie-record", required_argument, 0, 'r'},
         {"movie-record-author", required_argument, 0, 'a'},
         {"movie-play", required_argument, 0, 'p'},
+        {"movie-keyframes", required_argument, 0, 'k'},
         {"dump-video", required_argument, 0, 'd'},
+        {"expand-log", required_argument, 0, 'l'},
+        {"trace", required_argument, 0, 't'},
+        {"hle-stats", required_argument, 0, 's'},
+        {"perf-stats", required_argument, 0, 'c'},
         {"fullscreen", no_argument, 0, 'f'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
@@ -223,7 +244,7 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:i:m:r:p:fhv", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "g:i:m:r:p:k:l:t:s:c:fhv", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'g':
@@ -289,9 +310,39 @@ int main(int argc, char** argv) {
             case 'p':
                 movie_play = optarg;
                 break;
+            case 'k':
+                errno = 0;
+                movie_keyframe_interval = strtoull(optarg, &endarg, 0);
+                if (endarg == optarg)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror("--movie-keyframes");
+                    exit(1);
+                }
+                break;
             case 'd':
                 dump_video = optarg;
                 break;
+            case 'l': {
+                std::string data;
+                if (FileUtil::ReadFileToString(false, optarg, data) == 0) {
+                    std::cout << "Failed to read log file " << optarg << "\n";
+                    return -1;
+                }
+                std::cout << Common::Log::ExpandBinaryLog(
+                    {reinterpret_cast<const u8*>(data.data()), data.size()});
+                return 0;
+            }
+            case 't':
+                trace_file = optarg;
+                Common::Tracing::SetEnabled(true);
+                break;
+            case 's':
+                hle_stats_file = optarg;
+                break;
+            case 'c':
+                perf_stats_file = optarg;
+                break;
             case 'f':
                 fullscreen = true;
                 LOG_INFO(Frontend, "Starting in fullscreen mode...");
@@ -333,6 +384,10 @@ int main(int argc, char** argv) {
     auto& system = Core::System::GetInstance();
     auto& movie = Core::Movie::GetInstance();
 
+    if (!hle_stats_file.empty()) {
+        system.hle_stats.SetEnabled(true);
+    }
+
     if (!movie_record.empty()) {
         movie.PrepareForRecording();
     }
@@ -432,6 +487,7 @@ int main(int argc, char** argv) {
         movie.StartPlayback(movie_play);
     }
     if (!movie_record.empty()) {
+        movie.SetKeyframeInterval(movie_keyframe_interval);
         movie.StartRecording(movie_record, movie_record_author);
     }
     if (!dump_video.empty() && DynamicLibrary::FFmpeg::LoadFFmpeg()) {
@@ -457,6 +513,16 @@ int main(int argc, char** argv) {
                       total);
         });
 
+    std::unique_ptr<FileUtil::IOFile> perf_stats_csv;
+    if (!perf_stats_file.empty()) {
+        perf_stats_csv = std::make_unique<FileUtil::IOFile>(perf_stats_file, "w");
+        perf_stats_csv->WriteString(Core::PerfStats::GetCsvHeader() + '\n');
+    }
+    // This is the only place the stats are collected, even without a CSV file, so that each sample
+    // covers a whole interval. The window title and the RPC server read the last sample.
+    constexpr auto perf_stats_interval = std::chrono::seconds{1};
+    auto perf_stats_time = std::chrono::steady_clock::now();
+
     const auto secondary_is_open = [&secondary_window] {
         // if the secondary window isn't created, it shouldn't affect the main loop
         return secondary_window ? secondary_window->IsOpen() : true;
@@ -464,6 +530,15 @@ int main(int argc, char** argv) {
     while (emu_window->IsOpen() && secondary_is_open()) {
         const auto result = system.RunLoop();
 
+        const auto now = std::chrono::steady_clock::now();
+        if (now - perf_stats_time >= perf_stats_interval) {
+            perf_stats_time = now;
+            const auto perf_results = system.GetAndResetPerfStats();
+            if (perf_stats_csv) {
+                perf_stats_csv->WriteString(Core::PerfStats::FormatCsvRow(perf_results) + '\n');
+            }
+        }
+
         switch (result) {
         case Core::System::ResultStatus::ShutdownRequested:
             emu_window->RequestClose();
@@ -482,6 +557,18 @@ int main(int argc, char** argv) {
     main_render_thread.join();
     secondary_render_thread.join();
 
+    if (!trace_file.empty()) {
+        Common::Tracing::SetEnabled(false);
+        Common::Tracing::ExportChromeTrace(trace_file);
+    }
+    if (!hle_stats_file.empty()) {
+        const std::string report = system.hle_stats.GetReport();
+        FileUtil::IOFile file{hle_stats_file, "w"};
+        if (!file.IsOpen() || file.WriteString(report) != report.size()) {
+            LOG_ERROR(Frontend, "Failed to write HLE statistics to {}", hle_stats_file);
+        }
+    }
+
     movie.Shutdown();
 
     auto video_dumper = system.GetVideoDumper();
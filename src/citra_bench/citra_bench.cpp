@@ -0,0 +1,636 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+
+// This needs to be included before getopt.h because the latter #defines symbols used by it
+#include "common/microprofile.h"
+
+#include "common/detached_tasks.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/backend.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/scope_exit.h"
+#include "common/settings.h"
+#include "common/string_util.h"
+#include "core/core.h"
+#include "core/frontend/applets/default_applets.h"
+#include "core/frontend/emu_window.h"
+#include "core/movie.h"
+#include "core/perf_stats.h"
+#include "core/tracer/player.h"
+#include "video_core/command_processor.h"
+#include "video_core/renderer_software/renderer_software.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include <shellapi.h>
+#endif
+
+namespace {
+
+class DummyContext : public Frontend::GraphicsContext {};
+
+/// Window without a display. The software renderer only needs it for the framebuffer layout.
+class EmuWindow_Headless : public Frontend::EmuWindow {
+public:
+    EmuWindow_Headless() {
+        UpdateCurrentFramebufferLayout(Core::kScreenTopWidth,
+                                       Core::kScreenTopHeight + Core::kScreenBottomHeight);
+    }
+
+    void PollEvents() override {}
+
+    std::unique_ptr<GraphicsContext> CreateSharedContext() const override {
+        return std::make_unique<DummyContext>();
+    }
+};
+
+struct FrameHashes {
+    u64 top;
+    u64 bottom;
+};
+
+void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] <filename>\n"
+                 "-m, --movie=FILE     Plays back the inputs of the given movie file\n"
+                 "-s, --seek=FRAME     Seeks the movie to FRAME before running the warmup frames,\n"
+                 "                     starting from its last keyframe before FRAME\n"
+                 "-r, --replay=FILE    Replays a CiTrace GPU trace instead of running a title,\n"
+                 "                     looping it as often as needed\n"
+                 "-n, --frames=NUMBER  Number of frames to measure (default 600)\n"
+                 "-w, --warmup=NUMBER  Number of frames to run before measuring (default 60)\n"
+                 "-o, --output=FILE    Writes the results to FILE as JSON instead of stdout\n"
+                 "-x, --hash-frames    Includes a hash of both screens of every measured frame\n"
+                 "-h, --help           Display this help and exit\n"
+                 "-v, --version        Output version information and exit\n";
+}
+
+void PrintVersion() {
+    std::cout << "Citra " << Common::g_scm_branch << " " << Common::g_scm_desc << std::endl;
+}
+
+bool ParseCount(const char* arg, u32& count) {
+    char* end;
+    errno = 0;
+    const unsigned long value = std::strtoul(arg, &end, 0);
+    if (end == arg || *end != '\0' || errno != 0) {
+        return false;
+    }
+    count = static_cast<u32>(value);
+    return true;
+}
+
+std::string EscapeJson(const std::string& str) {
+    return Common::ReplaceAll(Common::ReplaceAll(str, "\\", "\\\\"), "\"", "\\\"");
+}
+
+FrameHashes HashScreens(const VideoCore::RendererBase& renderer) {
+    const auto& sw_renderer = static_cast<const SwRenderer::RendererSoftware&>(renderer);
+    const auto hash_screen = [&](VideoCore::ScreenId id) {
+        const auto& pixels = sw_renderer.Screen(id).pixels;
+        return Common::ComputeHash64(pixels.data(), pixels.size());
+    };
+    return {hash_screen(VideoCore::ScreenId::TopLeft), hash_screen(VideoCore::ScreenId::Bottom)};
+}
+
+/// Returns the value below which the given fraction of the sorted values lie
+double GetPercentile(const std::vector<double>& sorted, double fraction) {
+    const std::size_t index = static_cast<std::size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+/// Measures the host time of every frame after the warmup frames
+class FrameMeasurement {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FrameMeasurement(Core::System& system_, u32 warmup_frames_, u32 frames_, bool hash_frames_)
+        : system{system_}, warmup_frames{warmup_frames_}, frames{frames_},
+          hash_frames{hash_frames_} {
+        frame_times.reserve(frames);
+        if (hash_frames) {
+            hashes.reserve(frames);
+        }
+        if (warmup_frames == 0) {
+            Start();
+        }
+    }
+
+    /// Must be called whenever an emulated frame has been presented
+    void OnFrameEnd() {
+        ++frames_ended;
+        const auto now = Clock::now();
+        if (frames_ended == warmup_frames) {
+            Start();
+            return;
+        }
+        if (!IsMeasuring()) {
+            return;
+        }
+        frame_times.push_back(std::chrono::duration<double>(now - frame_start_time).count());
+        if (hash_frames) {
+            hashes.push_back(HashScreens(system.Renderer()));
+        }
+        frame_start_time = now;
+    }
+
+    /// Returns true while the current frame is measured
+    bool IsMeasuring() const {
+        return frames_ended >= warmup_frames && !IsDone();
+    }
+
+    /// Returns true once all frames have been measured
+    bool IsDone() const {
+        return frame_times.size() >= frames;
+    }
+
+    u32 GetExpectedFrames() const {
+        return frames;
+    }
+
+    const std::vector<double>& GetFrameTimes() const {
+        return frame_times;
+    }
+
+    const std::vector<FrameHashes>& GetHashes() const {
+        return hashes;
+    }
+
+    double GetTotalTime() const {
+        return std::chrono::duration<double>(frame_start_time - start_time).count();
+    }
+
+private:
+    void Start() {
+        // Discard the statistics of the warmup frames
+        static_cast<void>(system.GetAndResetPerfStats());
+        start_time = frame_start_time = Clock::now();
+    }
+
+    Core::System& system;
+    const u32 warmup_frames;
+    const u32 frames;
+    const bool hash_frames;
+    u32 frames_ended = 0;
+    Clock::time_point start_time;
+    Clock::time_point frame_start_time;
+    std::vector<double> frame_times;
+    std::vector<FrameHashes> hashes;
+};
+
+/**
+ * Host time of the draws of a trace, by their position in the trace. Each draw is replayed once
+ * per loop over the trace.
+ */
+class DrawStatistics {
+public:
+    explicit DrawStatistics(std::size_t trace_frames) : frames(trace_frames) {}
+
+    void BeginFrame(std::size_t frame) {
+        current_frame = frame;
+        draw_index = 0;
+    }
+
+    void Record(const Pica::CommandProcessor::DrawInfo& info) {
+        auto& draws = frames[current_frame];
+        if (draw_index == draws.size()) {
+            draws.push_back({info.num_vertices, info.is_indexed, info.is_immediate});
+        }
+        Draw& draw = draws[draw_index++];
+        const double time = std::chrono::duration<double>(info.time).count();
+        ++draw.count;
+        draw.total_time += time;
+        draw.max_time = std::max(draw.max_time, time);
+        draw.accelerated_count += info.is_accelerated ? 1 : 0;
+        ++total_count;
+        total_time += time;
+    }
+
+    /// Formats the draw totals and the most expensive draws as JSON fields
+    std::string FormatJson(std::size_t measured_frames, std::size_t max_draws) const {
+        struct Row {
+            std::size_t frame;
+            std::size_t index;
+            const Draw* draw;
+        };
+        std::vector<Row> rows;
+        for (std::size_t frame = 0; frame < frames.size(); ++frame) {
+            for (std::size_t index = 0; index < frames[frame].size(); ++index) {
+                if (frames[frame][index].count != 0) {
+                    rows.push_back({frame, index, &frames[frame][index]});
+                }
+            }
+        }
+        const auto mean_time = [](const Draw& draw) { return draw.total_time / draw.count; };
+        const std::size_t num_rows = std::min(rows.size(), max_draws);
+        std::partial_sort(rows.begin(), rows.begin() + num_rows, rows.end(),
+                          [&](const Row& a, const Row& b) {
+                              return mean_time(*a.draw) > mean_time(*b.draw);
+                          });
+
+        const double frame_count = static_cast<double>(std::max<std::size_t>(measured_frames, 1));
+        std::string json =
+            fmt::format(",\n  \"draws\": {{\"per_frame\": {:.1f}, \"ms_per_frame\": {:.3f}}}",
+                        total_count / frame_count, total_time * 1000.0 / frame_count);
+        json += ",\n  \"top_draws\": [";
+        for (std::size_t i = 0; i < num_rows; ++i) {
+            const Draw& draw = *rows[i].draw;
+            json += fmt::format(
+                "{}\n    {{\"frame\": {}, \"index\": {}, \"vertices\": {}, \"indexed\": {}, "
+                "\"immediate\": {}, \"accelerated\": {}, \"mean_us\": {:.2f}, \"max_us\": {:.2f}}}",
+                i == 0 ? "" : ",", rows[i].frame, rows[i].index, draw.num_vertices, draw.is_indexed,
+                draw.is_immediate, draw.accelerated_count == draw.count,
+                mean_time(draw) * 1e6, draw.max_time * 1e6);
+        }
+        json += "\n  ]";
+        return json;
+    }
+
+private:
+    struct Draw {
+        u32 num_vertices;
+        bool is_indexed;
+        bool is_immediate;
+        u32 count = 0;
+        u32 accelerated_count = 0;
+        double total_time = 0.0;
+        double max_time = 0.0;
+    };
+
+    std::vector<std::vector<Draw>> frames;
+    std::size_t current_frame = 0;
+    std::size_t draw_index = 0;
+    u64 total_count = 0;
+    double total_time = 0.0;
+};
+
+/**
+ * Formats the results as JSON.
+ * @param source_field JSON field naming what was run
+ * @param extra_fields Additional JSON fields, each starting with a comma
+ */
+std::string FormatResults(const std::string& source_field, const FrameMeasurement& measurement,
+                          const Core::PerfStats::Results& perf_results,
+                          const std::string& extra_fields) {
+    const auto& frame_times = measurement.GetFrameTimes();
+    const auto& hashes = measurement.GetHashes();
+    const double total_time = measurement.GetTotalTime();
+    std::vector<double> sorted = frame_times;
+    std::sort(sorted.begin(), sorted.end());
+    const double frame_count = static_cast<double>(frame_times.size());
+    const double mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / frame_count;
+    const auto to_ms = [](double seconds) { return seconds * 1000.0; };
+
+    std::string json = "{\n";
+    json += fmt::format("  \"version\": \"{} {}\",\n", Common::g_scm_branch, Common::g_scm_desc);
+    json += fmt::format("  {},\n", source_field);
+    json += fmt::format("  \"frames\": {},\n", frame_times.size());
+    json += fmt::format("  \"total_s\": {:.4f},\n", total_time);
+    json += fmt::format("  \"fps\": {{\"mean\": {:.2f}, \"low_10\": {:.2f}, \"low_1\": {:.2f}, "
+                        "\"low_0_1\": {:.2f}}},\n",
+                        frame_count / total_time, 1.0 / GetPercentile(sorted, 0.9),
+                        1.0 / GetPercentile(sorted, 0.99), 1.0 / GetPercentile(sorted, 0.999));
+    json += fmt::format("  \"frame_time_ms\": {{\"mean\": {:.3f}, \"min\": {:.3f}, "
+                        "\"p50\": {:.3f}, \"p90\": {:.3f}, \"p99\": {:.3f}, \"max\": {:.3f}}},\n",
+                        to_ms(mean), to_ms(sorted.front()), to_ms(GetPercentile(sorted, 0.5)),
+                        to_ms(GetPercentile(sorted, 0.9)), to_ms(GetPercentile(sorted, 0.99)),
+                        to_ms(sorted.back()));
+    json += fmt::format("  \"emulation_speed\": {:.4f},\n", perf_results.emulation_speed);
+
+    json += "  \"component_ms_per_frame\": {";
+    for (std::size_t i = 0; i < Core::PerfStats::NumComponents; ++i) {
+        json += fmt::format(
+            "{}\"{}\": {:.3f}", i == 0 ? "" : ", ",
+            Core::PerfStats::GetComponentName(static_cast<Core::PerfStats::Component>(i)),
+            to_ms(perf_results.component_times[i]));
+    }
+    json += "}";
+    json += extra_fields;
+
+    if (!hashes.empty()) {
+        json += ",\n  \"frame_hashes\": [";
+        for (std::size_t i = 0; i < hashes.size(); ++i) {
+            json += fmt::format("{}\n    [\"{:016x}\", \"{:016x}\"]", i == 0 ? "" : ",",
+                                hashes[i].top, hashes[i].bottom);
+        }
+        json += "\n  ]";
+    }
+    json += "\n}\n";
+    return json;
+}
+
+/// Boots a title and measures its frames. Returns false if the title failed to load.
+bool RunTitle(Core::System& system, Frontend::EmuWindow& emu_window, const std::string& filepath,
+              const std::string& movie_play, u32 seek_frame, FrameMeasurement& measurement) {
+    auto& movie = Core::Movie::GetInstance();
+    const Core::System::ResultStatus load_result{system.Load(emu_window, filepath)};
+
+    switch (load_result) {
+    case Core::System::ResultStatus::ErrorGetLoader:
+        LOG_CRITICAL(Frontend, "Failed to obtain loader for {}!", filepath);
+        return false;
+    case Core::System::ResultStatus::ErrorLoader:
+        LOG_CRITICAL(Frontend, "Failed to load ROM!");
+        return false;
+    case Core::System::ResultStatus::ErrorLoader_ErrorEncrypted:
+        LOG_CRITICAL(Frontend, "The game that you are trying to load must be decrypted before "
+                               "being used with Citra.");
+        return false;
+    case Core::System::ResultStatus::ErrorLoader_ErrorInvalidFormat:
+        LOG_CRITICAL(Frontend, "Error while loading ROM: The ROM format is not supported.");
+        return false;
+    case Core::System::ResultStatus::ErrorNotInitialized:
+        LOG_CRITICAL(Frontend, "CPUCore not initialized");
+        return false;
+    case Core::System::ResultStatus::ErrorSystemMode:
+        LOG_CRITICAL(Frontend, "Failed to determine system mode!");
+        return false;
+    case Core::System::ResultStatus::Success:
+        break; // Expected case
+    default:
+        LOG_ERROR(Frontend, "Error while loading ROM: {}", system.GetStatusDetails());
+        break;
+    }
+
+    if (!movie_play.empty()) {
+        const auto metadata = movie.GetMovieMetadata(movie_play);
+        LOG_INFO(Movie, "Input count: {}", metadata.input_count);
+        movie.StartPlayback(movie_play);
+    }
+
+    if (seek_frame != 0) {
+        if (!movie.SeekToFrame(seek_frame)) {
+            LOG_CRITICAL(Frontend, "Failed to seek to frame {}", seek_frame);
+            return false;
+        }
+        while (movie.IsSeeking()) {
+            const auto result = system.RunLoop();
+            if (result != Core::System::ResultStatus::Success) {
+                LOG_CRITICAL(Frontend, "Error while seeking: {}", system.GetStatusDetails());
+                return false;
+            }
+        }
+    }
+
+    s32 current_frame = system.Renderer().GetCurrentFrame();
+    while (!measurement.IsDone()) {
+        const auto result = system.RunLoop();
+        if (result == Core::System::ResultStatus::ShutdownRequested) {
+            break;
+        }
+        if (result != Core::System::ResultStatus::Success) {
+            LOG_ERROR(Frontend, "Error in main run loop: {}: {}", result,
+                      system.GetStatusDetails());
+            break;
+        }
+
+        for (const s32 frame = system.Renderer().GetCurrentFrame(); current_frame < frame;
+             ++current_frame) {
+            measurement.OnFrameEnd();
+        }
+    }
+    return true;
+}
+
+/**
+ * Replays a CiTrace file in a loop and measures its frames, without running any guest code.
+ * Returns false if the trace could not be read.
+ */
+bool ReplayTrace(Core::System& system, Frontend::EmuWindow& emu_window,
+                 const std::string& trace_file, FrameMeasurement& measurement,
+                 std::string& extra_fields) {
+    if (system.InitWithoutApplication(emu_window) != Core::System::ResultStatus::Success) {
+        return false;
+    }
+    CiTrace::Player player{system.Memory()};
+    if (!player.Load(trace_file) || player.GetFrameCount() == 0) {
+        LOG_CRITICAL(Frontend, "Failed to load trace {}", trace_file);
+        return false;
+    }
+
+    DrawStatistics draw_statistics{player.GetFrameCount()};
+    Pica::CommandProcessor::SetDrawObserver([&](const Pica::CommandProcessor::DrawInfo& info) {
+        // Skip the draws of the warmup frames
+        if (measurement.IsMeasuring()) {
+            draw_statistics.Record(info);
+        }
+    });
+
+    for (std::size_t frame = 0; !measurement.IsDone(); ++frame) {
+        const std::size_t trace_frame = frame % player.GetFrameCount();
+        if (trace_frame == 0) {
+            // Start every loop from the same state, so that each loop renders the same frames
+            player.ApplyInitialState();
+        }
+        draw_statistics.BeginFrame(trace_frame);
+        player.ReplayFrame(trace_frame);
+        system.Renderer().SwapBuffers();
+        measurement.OnFrameEnd();
+    }
+    Pica::CommandProcessor::SetDrawObserver({});
+
+    constexpr std::size_t MaxReportedDraws = 20;
+    extra_fields = draw_statistics.FormatJson(measurement.GetFrameTimes().size(),
+                                              MaxReportedDraws);
+    return true;
+}
+
+} // Anonymous namespace
+
+/// Application entry point
+int main(int argc, char** argv) {
+    Common::Log::Initialize();
+    // Keep stdout free for the results
+    Common::Log::SetColorConsoleBackendEnabled(true);
+    Common::Log::Start();
+    Common::DetachedTasks detached_tasks;
+    int option_index = 0;
+    std::string filepath;
+    std::string movie_play;
+    u32 seek_frame = 0;
+    std::string trace_file;
+    std::string output_file;
+    u32 frames = 600;
+    u32 warmup_frames = 60;
+    bool hash_frames = false;
+
+#ifdef _WIN32
+    int argc_w;
+    auto argv_w = CommandLineToArgvW(GetCommandLineW(), &argc_w);
+
+    if (argv_w == nullptr) {
+        LOG_CRITICAL(Frontend, "Failed to get command line arguments");
+        return -1;
+    }
+#endif
+
+    static struct option long_options[] = {
+        {"movie", required_argument, 0, 'm'},
+        {"seek", required_argument, 0, 's'},
+        {"replay", required_argument, 0, 'r'},
+        {"frames", required_argument, 0, 'n'},
+        {"warmup", required_argument, 0, 'w'},
+        {"output", required_argument, 0, 'o'},
+        {"hash-frames", no_argument, 0, 'x'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+
+    while (optind < argc) {
+        int arg = getopt_long(argc, argv, "m:s:r:n:w:o:xhv", long_options, &option_index);
+        if (arg != -1) {
+            switch (static_cast<char>(arg)) {
+            case 'm':
+                movie_play = optarg;
+                break;
+            case 's':
+                if (!ParseCount(optarg, seek_frame)) {
+                    std::cerr << "Invalid seek frame " << optarg << "\n";
+                    return -1;
+                }
+                break;
+            case 'r':
+                trace_file = optarg;
+                break;
+            case 'n':
+                if (!ParseCount(optarg, frames) || frames == 0) {
+                    std::cerr << "Invalid frame count " << optarg << "\n";
+                    return -1;
+                }
+                break;
+            case 'w':
+                if (!ParseCount(optarg, warmup_frames)) {
+                    std::cerr << "Invalid warmup frame count " << optarg << "\n";
+                    return -1;
+                }
+                break;
+            case 'o':
+                output_file = optarg;
+                break;
+            case 'x':
+                hash_frames = true;
+                break;
+            case 'h':
+                PrintHelp(argv[0]);
+                return 0;
+            case 'v':
+                PrintVersion();
+                return 0;
+            }
+        } else {
+#ifdef _WIN32
+            filepath = Common::UTF16ToUTF8(argv_w[optind]);
+#else
+            filepath = argv[optind];
+#endif
+            optind++;
+        }
+    }
+
+#ifdef _WIN32
+    LocalFree(argv_w);
+#endif
+
+    MicroProfileOnThreadCreate("EmuThread");
+    SCOPE_EXIT({ MicroProfileShutdown(); });
+
+    if (filepath.empty() && trace_file.empty()) {
+        LOG_CRITICAL(Frontend, "Failed to load ROM: No ROM specified");
+        return -1;
+    }
+
+    auto& system = Core::System::GetInstance();
+    auto& movie = Core::Movie::GetInstance();
+
+    // Run unthrottled with the software renderer and no audio output, so that the results only
+    // depend on the host CPU. A fixed clock keeps runs without a movie deterministic, a movie
+    // replaces it with the clock it was recorded with. Trace replay applies memory loads between
+    // command lists, so it needs the command lists processed synchronously.
+    Settings::values.graphics_api = Settings::GraphicsAPI::Software;
+    Settings::values.frame_limit = 0;
+    Settings::values.output_type = AudioCore::SinkType::Null;
+    Settings::values.enable_audio_stretching = false;
+    Settings::values.init_clock = Settings::InitClock::FixedTime;
+    Settings::values.use_gdbstub = false;
+    if (!trace_file.empty()) {
+        Settings::values.use_async_gpu = false;
+    }
+    if (!movie_play.empty()) {
+        movie.PrepareForPlayback(movie_play);
+    }
+    system.ApplySettings();
+
+    // Register frontend applets
+    Frontend::RegisterDefaultApplets();
+
+    EmuWindow_Headless emu_window;
+
+    LOG_INFO(Frontend, "Citra Version: {} | {}-{}", Common::g_build_fullname, Common::g_scm_branch,
+             Common::g_scm_desc);
+    Settings::LogSettings();
+
+    FrameMeasurement measurement{system, warmup_frames, frames, hash_frames};
+    std::string source_field;
+    std::string extra_fields;
+    bool loaded;
+    if (trace_file.empty()) {
+        source_field = fmt::format("\"title\": \"{}\"", EscapeJson(filepath));
+        loaded = RunTitle(system, emu_window, filepath, movie_play, seek_frame, measurement);
+    } else {
+        source_field = fmt::format("\"trace\": \"{}\"", EscapeJson(trace_file));
+        loaded = ReplayTrace(system, emu_window, trace_file, measurement, extra_fields);
+    }
+
+    int exit_code = 0;
+    if (!loaded) {
+        exit_code = -1;
+    } else if (measurement.GetFrameTimes().empty()) {
+        LOG_CRITICAL(Frontend, "Emulation stopped before any frame was measured");
+        exit_code = -1;
+    } else {
+        if (!measurement.IsDone()) {
+            LOG_WARNING(Frontend, "Emulation stopped after {} of {} measured frames",
+                        measurement.GetFrameTimes().size(), measurement.GetExpectedFrames());
+        }
+        const std::string results = FormatResults(source_field, measurement,
+                                                  system.GetAndResetPerfStats(), extra_fields);
+        if (output_file.empty()) {
+            std::cout << results;
+        } else {
+            FileUtil::IOFile file{output_file, "w"};
+            if (!file.IsOpen() || file.WriteString(results) != results.size()) {
+                LOG_CRITICAL(Frontend, "Failed to write results to {}", output_file);
+                exit_code = -1;
+            }
+        }
+    }
+
+    movie.Shutdown();
+    if (system.IsPoweredOn()) {
+        system.Shutdown();
+    }
+
+    detached_tasks.WaitForAllTasks();
+    return exit_code;
+}
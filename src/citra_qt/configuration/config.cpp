@@ -482,6 +482,7 @@ void Config::ReadDebuggingValues() {
         qt_config->value(QStringLiteral("record_frame_times"), false).toBool();
     ReadBasicSetting(Settings::values.use_gdbstub);
     ReadBasicSetting(Settings::values.gdbstub_port);
+    ReadBasicSetting(Settings::values.enable_rpc_shared_memory);
     ReadBasicSetting(Settings::values.renderer_debug);
 
     qt_config->beginGroup(QStringLiteral("LLE"));
@@ -527,6 +528,7 @@ void Config::ReadMiscellaneousValues() {
     qt_config->beginGroup(QStringLiteral("Miscellaneous"));
 
     ReadBasicSetting(Settings::values.log_filter);
+    ReadBasicSetting(Settings::values.binary_log);
 
     qt_config->endGroup();
 }
@@ -642,6 +644,7 @@ void Config::ReadRendererValues() {
 
     if (global) {
         ReadBasicSetting(Settings::values.use_shader_jit);
+        ReadBasicSetting(Settings::values.use_async_gpu);
     }
 
     qt_config->endGroup();
@@ -989,6 +992,7 @@ void Config::SaveDebuggingValues() {
     qt_config->setValue(QStringLiteral("record_frame_times"), Settings::values.record_frame_times);
     WriteBasicSetting(Settings::values.use_gdbstub);
     WriteBasicSetting(Settings::values.gdbstub_port);
+    WriteBasicSetting(Settings::values.enable_rpc_shared_memory);
     WriteBasicSetting(Settings::values.renderer_debug);
 
     qt_config->beginGroup(QStringLiteral("LLE"));
@@ -1034,6 +1038,7 @@ void Config::SaveMiscellaneousValues() {
     qt_config->beginGroup(QStringLiteral("Miscellaneous"));
 
     WriteBasicSetting(Settings::values.log_filter);
+    WriteBasicSetting(Settings::values.binary_log);
 
     qt_config->endGroup();
 }
@@ -1118,6 +1123,8 @@ void Config::SaveRendererValues() {
     if (global) {
         WriteSetting(QStringLiteral("use_shader_jit"), Settings::values.use_shader_jit.GetValue(),
                      true);
+        WriteSetting(QStringLiteral("use_async_gpu"), Settings::values.use_async_gpu.GetValue(),
+                     false);
     }
 
     qt_config->endGroup();
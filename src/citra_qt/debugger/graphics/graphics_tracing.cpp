@@ -69,7 +69,7 @@ void GraphicsTracingWidget::StartRecording() {
     // TODO: Drop this explicit conversion once we store float24 values bit-correctly internally.
     std::array<u32, 4 * 16> default_attributes;
     for (unsigned i = 0; i < 16; ++i) {
-        for (unsigned comp = 0; comp < 3; ++comp) {
+        for (unsigned comp = 0; comp < 4; ++comp) {
             default_attributes[4 * i + comp] = nihstro::to_float24(
                 Pica::g_state.input_default_attributes.attr[i][comp].ToFloat32());
         }
@@ -77,7 +77,7 @@ void GraphicsTracingWidget::StartRecording() {
 
     std::array<u32, 4 * 96> vs_float_uniforms;
     for (unsigned i = 0; i < 96; ++i)
-        for (unsigned comp = 0; comp < 3; ++comp)
+        for (unsigned comp = 0; comp < 4; ++comp)
             vs_float_uniforms[4 * i + comp] =
                 nihstro::to_float24(Pica::g_state.vs.uniforms.f[i][comp].ToFloat32());
 
@@ -51,6 +51,7 @@
 #include <cstring>
 #include <dirent.h>
 #include <pwd.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -1184,6 +1185,94 @@ bool IOFile::Resize(u64 size) {
     return m_good;
 }
 
+MappedFile::MappedFile() = default;
+
+MappedFile::MappedFile(const IOFile& file) {
+    Map(file);
+}
+
+MappedFile::~MappedFile() {
+    Unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    Swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    Swap(other);
+    return *this;
+}
+
+void MappedFile::Swap(MappedFile& other) noexcept {
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+    std::swap(m_writable, other.m_writable);
+#ifdef _WIN32
+    std::swap(m_mapping, other.m_mapping);
+#endif
+}
+
+bool MappedFile::Map(const IOFile& file, bool writable) {
+    Unmap();
+
+    const int fd = file.GetFd();
+    const u64 size = file.GetSize();
+    if (fd == -1 || size == 0 || size > std::numeric_limits<std::size_t>::max()) {
+        return false;
+    }
+
+#ifdef _WIN32
+    const HANDLE file_handle = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    m_mapping = CreateFileMappingW(file_handle, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                   0, 0, nullptr);
+    if (m_mapping == nullptr) {
+        LOG_ERROR(Common_Filesystem, "CreateFileMapping failed: {}", GetLastErrorMsg());
+        return false;
+    }
+    void* data = MapViewOfFile(m_mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr) {
+        LOG_ERROR(Common_Filesystem, "MapViewOfFile failed: {}", GetLastErrorMsg());
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+        return false;
+    }
+#else
+    const int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* data = mmap(nullptr, static_cast<std::size_t>(size), protection, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        LOG_ERROR(Common_Filesystem, "mmap failed: {}", GetLastErrorMsg());
+        return false;
+    }
+#endif
+
+    m_data = static_cast<u8*>(data);
+    m_size = static_cast<std::size_t>(size);
+    m_writable = writable;
+    return true;
+}
+
+void MappedFile::Unmap() {
+    if (m_data == nullptr) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    m_mapping = nullptr;
+#else
+    munmap(m_data, m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_writable = false;
+}
+
 template <typename T>
 using boost_iostreams = boost::iostreams::stream<T>;
 
@@ -4,12 +4,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cstdio>
 #include <functional>
 #include <ios>
 #include <limits>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <type_traits>
@@ -332,6 +334,10 @@ public:
         return nullptr != m_file;
     }
 
+    [[nodiscard]] const std::string& GetFilename() const {
+        return filename;
+    }
+
     // m_good is set to false when a read, write or other function fails
     [[nodiscard]] bool IsGood() const {
         return m_good;
@@ -393,6 +399,65 @@ private:
     friend class boost::serialization::access;
 };
 
+/**
+ * A read-only memory mapping of a whole file opened through IOFile. Reading through the mapping
+ * avoids the seek and read calls of IOFile, and the pages are shared with every other process
+ * mapping the same file.
+ */
+class MappedFile : public NonCopyable {
+public:
+    MappedFile();
+    explicit MappedFile(const IOFile& file);
+
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    void Swap(MappedFile& other) noexcept;
+
+    /**
+     * Maps the whole file. The mapping stays valid after the file itself is closed.
+     * A writable mapping is shared with other processes mapping the same file, and needs the
+     * file to be opened for writing.
+     */
+    bool Map(const IOFile& file, bool writable = false);
+    void Unmap();
+
+    [[nodiscard]] bool IsMapped() const {
+        return m_data != nullptr;
+    }
+
+    [[nodiscard]] const u8* Data() const {
+        return m_data;
+    }
+
+    /// Returns the mapped data if the mapping is writable, nullptr otherwise
+    [[nodiscard]] u8* WritableData() const {
+        return m_writable ? m_data : nullptr;
+    }
+
+    [[nodiscard]] std::size_t Size() const {
+        return m_size;
+    }
+
+    /// Returns a view of at most length bytes at offset, clamped to the end of the mapping.
+    [[nodiscard]] std::span<const u8> GetSpan(u64 offset, std::size_t length) const {
+        if (offset >= m_size) {
+            return {};
+        }
+        return {m_data + offset, std::min<std::size_t>(length, m_size - offset)};
+    }
+
+private:
+    u8* m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_writable = false;
+#ifdef _WIN32
+    void* m_mapping = nullptr;
+#endif
+};
+
 template <std::ios_base::openmode o, typename T>
 void OpenFStream(T& fstream, const std::string& filename);
 } // namespace FileUtil
@@ -26,6 +26,7 @@
 #include "common/file_util.h"
 #include "common/literals.h"
 #include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
 #include "common/logging/log.h"
 #include "common/logging/log_entry.h"
 #include "common/logging/text_formatter.h"
@@ -79,6 +80,10 @@ public:
         enabled = enabled_;
     }
 
+    bool IsEnabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
 private:
     std::atomic_bool enabled{false};
 };
@@ -105,7 +110,7 @@ public:
     ~FileBackend() override = default;
 
     void Write(const Entry& entry) override {
-        if (!enabled) {
+        if (!enabled || suspended.load(std::memory_order_relaxed)) {
             return;
         }
 
@@ -131,12 +136,89 @@ public:
 
     void EnableForStacktrace() override {
         enabled = true;
+        suspended = false;
         bytes_written = 0;
     }
 
+    /// Stops writing entries while the binary log is written instead
+    void SetSuspended(bool suspended_) {
+        suspended = suspended_;
+    }
+
+    bool IsSuspended() const {
+        return suspended.load(std::memory_order_relaxed);
+    }
+
 private:
     std::unique_ptr<FileUtil::IOFile> file;
     bool enabled = true;
+    std::atomic_bool suspended{false};
+    std::size_t bytes_written = 0;
+};
+
+/**
+ * Backend that writes the compact binary log, which is expanded to text afterwards. Messages whose
+ * formatting was deferred are written as their raw arguments without being formatted.
+ */
+class BinaryFileBackend final : public Backend {
+public:
+    explicit BinaryFileBackend(std::string filename_) : filename{std::move(filename_)} {}
+
+    ~BinaryFileBackend() override = default;
+
+    void Write(const Entry& entry) override {
+        if (!enabled.load(std::memory_order_acquire) || write_limit_exceeded) {
+            return;
+        }
+
+        buffer.clear();
+        encoder.Encode(entry, buffer);
+        bytes_written += file->WriteBytes(buffer.data(), buffer.size());
+
+        using namespace Common::Literals;
+        // Prevent logs from exceeding a set maximum size in the event that log entries are spammed.
+        write_limit_exceeded = bytes_written > 100_MiB;
+        if (entry.log_level >= Level::Error || write_limit_exceeded) {
+            file->Flush();
+        }
+    }
+
+    void Flush() override {
+        if (file) {
+            file->Flush();
+        }
+    }
+
+    void EnableForStacktrace() override {
+        if (file) {
+            enabled = true;
+            write_limit_exceeded = false;
+        }
+    }
+
+    /// Enables writing the binary log. The file is created the first time it is enabled.
+    void SetEnabled(bool enabled_) {
+        if (enabled_ && !file) {
+            auto old_filename = filename;
+            old_filename += ".old";
+            static_cast<void>(FileUtil::Delete(old_filename));
+            static_cast<void>(FileUtil::Rename(filename, old_filename));
+
+            file = std::make_unique<FileUtil::IOFile>(filename, "wb", _SH_DENYWR);
+            std::vector<u8> header;
+            encoder.EncodeHeader(header);
+            file->WriteBytes(header.data(), header.size());
+        }
+        enabled.store(enabled_, std::memory_order_release);
+    }
+
+private:
+    std::string filename;
+    std::unique_ptr<FileUtil::IOFile> file;
+    BinaryLogEncoder encoder;
+    std::vector<u8> buffer;
+    std::atomic_bool enabled{false};
+    bool write_limit_exceeded = false;
     std::size_t bytes_written = 0;
 };
 
@@ -214,6 +296,7 @@ public:
         filter.ParseFilterString(Settings::values.log_filter.GetValue());
         instance = std::unique_ptr<Impl, decltype(&Deleter)>(
             new Impl(fmt::format("{}{}", log_dir, log_file), filter), Deleter);
+        instance->SetBinaryLogEnabled(Settings::values.binary_log.GetValue());
         initialization_in_progress_suppress_logging = false;
     }
 
@@ -235,18 +318,36 @@ public:
         color_console_backend.SetEnabled(enabled);
     }
 
+    void SetBinaryLogEnabled(bool enabled) {
+        binary_file_backend.SetEnabled(enabled);
+        file_backend.SetSuspended(enabled);
+    }
+
     void PushEntry(Class log_class, Level log_level, const char* filename, unsigned int line_num,
-                   const char* function, std::string message) {
+                   const char* function, const char* format, const fmt::format_args& args) {
+        if (!filter.CheckMessage(log_class, log_level)) {
+            return;
+        }
+        message_queue.EmplaceWait(CreateEntry(log_class, log_level, filename, line_num, function,
+                                              fmt::vformat(format, args)));
+    }
+
+    void PushDeferredEntry(Class log_class, Level log_level, const char* filename,
+                           unsigned int line_num, const char* function, const char* format,
+                           const DeferredArgs& args) {
         if (!filter.CheckMessage(log_class, log_level)) {
             return;
         }
-        message_queue.EmplaceWait(
-            CreateEntry(log_class, log_level, filename, line_num, function, std::move(message)));
+        Entry entry = CreateEntry(log_class, log_level, filename, line_num, function, {});
+        entry.format = format;
+        entry.args = args;
+        message_queue.EmplaceWait(std::move(entry));
     }
 
 private:
     Impl(const std::string& file_backend_filename, const Filter& filter_)
-        : filter{filter_}, file_backend{file_backend_filename} {
+        : filter{filter_}, file_backend{file_backend_filename},
+          binary_file_backend{GetBinaryLogFilename(file_backend_filename)} {
 #ifdef CITRA_LINUX_GCC_BACKTRACE
         int waker_pipefd[2];
         int done_printing_pipefd[2];
@@ -314,6 +415,7 @@ private:
             Common::SetCurrentThreadName("citra:Log");
             Entry entry;
             const auto write_logs = [this, &entry]() {
+                FormatDeferredMessage(entry);
                 ForEachBackend([&entry](Backend& backend) { backend.Write(entry); });
             };
             while (!stop_token.stop_requested()) {
@@ -348,10 +450,36 @@ private:
         };
     }
 
+    /// Formats the message of a deferred entry, unless only the binary log is written
+    void FormatDeferredMessage(Entry& entry) const {
+        if (!entry.args.IsCaptured()) {
+            return;
+        }
+#if !defined(_WIN32) && !defined(ANDROID)
+        if (!color_console_backend.IsEnabled() && file_backend.IsSuspended()) {
+            return;
+        }
+#endif
+        try {
+            entry.message = entry.args.Format(entry.format);
+        } catch (const fmt::format_error& e) {
+            entry.message = fmt::format("<invalid format string \"{}\": {}>", entry.format,
+                                        e.what());
+        }
+    }
+
+    static std::string GetBinaryLogFilename(std::string_view text_filename) {
+        if (text_filename.ends_with(".txt")) {
+            text_filename.remove_suffix(4);
+        }
+        return fmt::format("{}.bin", text_filename);
+    }
+
     void ForEachBackend(auto lambda) {
         lambda(static_cast<Backend&>(debugger_backend));
         lambda(static_cast<Backend&>(color_console_backend));
         lambda(static_cast<Backend&>(file_backend));
+        lambda(static_cast<Backend&>(binary_file_backend));
 #ifdef ANDROID
         lambda(static_cast<Backend&>(lc_backend));
 #endif
@@ -397,6 +525,7 @@ private:
     DebuggerBackend debugger_backend{};
     ColorConsoleBackend color_console_backend{};
     FileBackend file_backend;
+    BinaryFileBackend binary_file_backend;
 #ifdef ANDROID
     LogcatBackend lc_backend{};
 #endif
@@ -434,12 +563,25 @@ void SetColorConsoleBackendEnabled(bool enabled) {
     Impl::Instance().SetColorConsoleBackendEnabled(enabled);
 }
 
+void SetBinaryLogEnabled(bool enabled) {
+    Impl::Instance().SetBinaryLogEnabled(enabled);
+}
+
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args) {
     if (!initialization_in_progress_suppress_logging) {
-        Impl::Instance().PushEntry(log_class, log_level, filename, line_num, function,
-                                   fmt::vformat(format, args));
+        Impl::Instance().PushEntry(log_class, log_level, filename, line_num, function, format,
+                                   args);
+    }
+}
+
+void DeferredLogMessageImpl(Class log_class, Level log_level, const char* filename,
+                            unsigned int line_num, const char* function, const char* format,
+                            const DeferredArgs& args) {
+    if (!initialization_in_progress_suppress_logging) {
+        Impl::Instance().PushDeferredEntry(log_class, log_level, filename, line_num, function,
+                                           format, args);
     }
 }
 } // namespace Common::Log
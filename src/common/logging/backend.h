@@ -24,4 +24,7 @@ void DisableLoggingInTests();
 void SetGlobalFilter(const Filter& filter);
 
 void SetColorConsoleBackendEnabled(bool enabled);
+
+/// Writes the log to a binary file instead of the text file, see binary_log.h
+void SetBinaryLogEnabled(bool enabled);
 } // namespace Common::Log
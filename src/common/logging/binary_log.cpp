@@ -0,0 +1,237 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <optional>
+#include <fmt/args.h>
+#include <fmt/format.h>
+#include "common/logging/binary_log.h"
+#include "common/logging/log_entry.h"
+#include "common/logging/text_formatter.h"
+
+namespace Common::Log {
+
+namespace {
+
+constexpr std::array<u8, 4> BinaryLogMagic{'C', 'L', 'O', 'G'};
+constexpr u32 BinaryLogVersion = 1;
+
+enum class RecordType : u8 {
+    String = 0, ///< Defines a string that entries refer to by id
+    Entry = 1,  ///< A log entry
+};
+
+template <typename T>
+void Append(std::vector<u8>& out, const T& value) {
+    const auto* bytes = reinterpret_cast<const u8*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+/// Reads values from a binary log, failing once the data runs out.
+class Reader {
+public:
+    explicit Reader(std::span<const u8> data_) : data{data_} {}
+
+    template <typename T>
+    std::optional<T> Read() {
+        if (data.size() - offset < sizeof(T)) {
+            return std::nullopt;
+        }
+        T value;
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    std::optional<std::string> ReadString(std::size_t size) {
+        if (data.size() - offset < size) {
+            return std::nullopt;
+        }
+        std::string value(reinterpret_cast<const char*>(data.data() + offset), size);
+        offset += size;
+        return value;
+    }
+
+    bool AtEnd() const {
+        return offset == data.size();
+    }
+
+private:
+    std::span<const u8> data;
+    std::size_t offset = 0;
+};
+
+/// Reads a tagged argument into the argument store. Returns false on truncated data.
+bool ReadArg(Reader& reader, fmt::dynamic_format_arg_store<fmt::format_context>& args) {
+    const auto type = reader.Read<BinaryArgType>();
+    if (!type) {
+        return false;
+    }
+    if (*type == BinaryArgType::String) {
+        const auto size = reader.Read<u32>();
+        const auto value = size ? reader.ReadString(*size) : std::nullopt;
+        if (!value) {
+            return false;
+        }
+        args.push_back(*value);
+        return true;
+    }
+
+    const auto bits = reader.Read<u64>();
+    if (!bits) {
+        return false;
+    }
+    switch (*type) {
+    case BinaryArgType::Signed:
+        args.push_back(static_cast<s64>(*bits));
+        break;
+    case BinaryArgType::Unsigned:
+        args.push_back(*bits);
+        break;
+    case BinaryArgType::Float: {
+        const u32 float_bits = static_cast<u32>(*bits);
+        float value;
+        std::memcpy(&value, &float_bits, sizeof(value));
+        args.push_back(value);
+        break;
+    }
+    case BinaryArgType::Double: {
+        double value;
+        std::memcpy(&value, &*bits, sizeof(value));
+        args.push_back(value);
+        break;
+    }
+    case BinaryArgType::Bool:
+        args.push_back(*bits != 0);
+        break;
+    case BinaryArgType::Char:
+        args.push_back(static_cast<char>(*bits));
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+} // Anonymous namespace
+
+void BinaryLogEncoder::EncodeHeader(std::vector<u8>& out) {
+    out.insert(out.end(), BinaryLogMagic.begin(), BinaryLogMagic.end());
+    Append(out, BinaryLogVersion);
+}
+
+void BinaryLogEncoder::Encode(const Entry& entry, std::vector<u8>& out) {
+    // Messages formatted by the caller are stored as the only argument of a "{}" format
+    const bool deferred = entry.args.IsCaptured();
+    const u32 file_id = GetStringId(entry.filename, out);
+    const u32 function_id = GetStringId(entry.function, out);
+    const u32 format_id = GetStringId(deferred ? entry.format : "{}", out);
+
+    out.push_back(static_cast<u8>(RecordType::Entry));
+    Append(out, static_cast<s64>(entry.timestamp.count()));
+    Append(out, entry.log_class);
+    Append(out, entry.log_level);
+    Append(out, entry.line_num);
+    Append(out, file_id);
+    Append(out, function_id);
+    Append(out, format_id);
+    if (deferred) {
+        entry.args.Serialize(out);
+    } else {
+        out.push_back(1);
+        AppendBinaryArg(out, std::string_view{entry.message});
+    }
+}
+
+u32 BinaryLogEncoder::GetStringId(const char* str, std::vector<u8>& out) {
+    if (str == nullptr) {
+        str = "";
+    }
+    // Strings are identified by address, which is stable since they are all literals
+    const auto [it, inserted] = string_ids.try_emplace(str, static_cast<u32>(string_ids.size()));
+    if (inserted) {
+        const u32 size = static_cast<u32>(std::strlen(str));
+        out.push_back(static_cast<u8>(RecordType::String));
+        Append(out, it->second);
+        Append(out, size);
+        out.insert(out.end(), str, str + size);
+    }
+    return it->second;
+}
+
+std::string ExpandBinaryLog(std::span<const u8> data) {
+    Reader reader{data};
+    std::string text;
+
+    const auto magic = reader.Read<std::array<u8, 4>>();
+    const auto version = reader.Read<u32>();
+    if (!magic || *magic != BinaryLogMagic || !version || *version != BinaryLogVersion) {
+        return text;
+    }
+
+    std::vector<std::string> strings;
+    const auto get_string = [&strings](u32 id) -> const char* {
+        return id < strings.size() ? strings[id].c_str() : "?";
+    };
+
+    while (!reader.AtEnd()) {
+        const auto type = reader.Read<RecordType>();
+        if (type == RecordType::String) {
+            const auto id = reader.Read<u32>();
+            const auto size = reader.Read<u32>();
+            const auto value = size ? reader.ReadString(*size) : std::nullopt;
+            if (!id || !value) {
+                break;
+            }
+            strings.resize(std::max<std::size_t>(strings.size(), *id + 1));
+            strings[*id] = *value;
+            continue;
+        }
+        if (type != RecordType::Entry) {
+            break;
+        }
+
+        const auto timestamp = reader.Read<s64>();
+        const auto log_class = reader.Read<Class>();
+        const auto log_level = reader.Read<Level>();
+        const auto line_num = reader.Read<u32>();
+        const auto file_id = reader.Read<u32>();
+        const auto function_id = reader.Read<u32>();
+        const auto format_id = reader.Read<u32>();
+        const auto num_args = reader.Read<u8>();
+        if (!timestamp || !log_class || !log_level || !line_num || !file_id || !function_id ||
+            !format_id || !num_args) {
+            break;
+        }
+
+        fmt::dynamic_format_arg_store<fmt::format_context> args;
+        bool complete = true;
+        for (u8 i = 0; i < *num_args && complete; ++i) {
+            complete = ReadArg(reader, args);
+        }
+        if (!complete) {
+            break;
+        }
+
+        Entry entry{
+            .timestamp = std::chrono::microseconds{*timestamp},
+            .log_class = *log_class,
+            .log_level = *log_level,
+            .filename = get_string(*file_id),
+            .line_num = *line_num,
+            .function = get_string(*function_id),
+        };
+        try {
+            entry.message = fmt::vformat(get_string(*format_id), args);
+        } catch (const fmt::format_error& e) {
+            entry.message = fmt::format("<invalid format string: {}>", e.what());
+        }
+        text.append(FormatLogMessage(entry)).append(1, '\n');
+    }
+    return text;
+}
+
+} // namespace Common::Log
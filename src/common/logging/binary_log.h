@@ -0,0 +1,44 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Common::Log {
+
+struct Entry;
+
+/**
+ * Encodes log entries into the compact binary log format. Deferred messages are stored as their
+ * format string and raw arguments, so writing them doesn't require formatting the message.
+ *
+ * The format is a header followed by records. File names, function names and format strings are
+ * written once as string records and afterwards referred to by their id.
+ */
+class BinaryLogEncoder {
+public:
+    /// Appends the header that starts a binary log
+    void EncodeHeader(std::vector<u8>& out);
+
+    /// Appends the records of an entry, including any string it refers to for the first time
+    void Encode(const Entry& entry, std::vector<u8>& out);
+
+private:
+    u32 GetStringId(const char* str, std::vector<u8>& out);
+
+    std::unordered_map<const char*, u32> string_ids;
+};
+
+/**
+ * Expands a binary log into text, with one line per entry formatted like the text log. A
+ * truncated last record, as left by a crash, is ignored.
+ */
+std::string ExpandBinaryLog(std::span<const u8> data);
+
+} // namespace Common::Log
@@ -0,0 +1,187 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fmt/format.h>
+#include "common/common_types.h"
+#include "common/logging/formatter.h"
+
+namespace Common::Log {
+
+/// Type tag of an argument in the binary log format
+enum class BinaryArgType : u8 {
+    Signed,
+    Unsigned,
+    Float,
+    Double,
+    Bool,
+    Char,
+    String,
+};
+
+/// Appends a tagged string argument to a binary log record.
+inline void AppendBinaryArg(std::vector<u8>& out, std::string_view value) {
+    const u32 size = static_cast<u32>(value.size());
+    out.push_back(static_cast<u8>(BinaryArgType::String));
+    out.insert(out.end(), reinterpret_cast<const u8*>(&size),
+               reinterpret_cast<const u8*>(&size) + sizeof(size));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+/// Appends a tagged argument to a binary log record. Enums are stored as their underlying value.
+template <typename T>
+void AppendBinaryArg(std::vector<u8>& out, const T& value) {
+    if constexpr (std::is_enum_v<T>) {
+        AppendBinaryArg(out, static_cast<std::underlying_type_t<T>>(value));
+    } else {
+        BinaryArgType type{};
+        u64 bits = 0;
+        if constexpr (std::is_same_v<T, bool>) {
+            type = BinaryArgType::Bool;
+            bits = value ? 1 : 0;
+        } else if constexpr (std::is_same_v<T, char>) {
+            type = BinaryArgType::Char;
+            bits = static_cast<u8>(value);
+        } else if constexpr (std::is_same_v<T, float>) {
+            type = BinaryArgType::Float;
+            u32 float_bits;
+            std::memcpy(&float_bits, &value, sizeof(float_bits));
+            bits = float_bits;
+        } else if constexpr (std::is_floating_point_v<T>) {
+            type = BinaryArgType::Double;
+            const double double_value = static_cast<double>(value);
+            std::memcpy(&bits, &double_value, sizeof(bits));
+        } else if constexpr (std::is_signed_v<T>) {
+            type = BinaryArgType::Signed;
+            bits = static_cast<u64>(static_cast<s64>(value));
+        } else {
+            type = BinaryArgType::Unsigned;
+            bits = static_cast<u64>(value);
+        }
+        out.push_back(static_cast<u8>(type));
+        out.insert(out.end(), reinterpret_cast<const u8*>(&bits),
+                   reinterpret_cast<const u8*>(&bits) + sizeof(bits));
+    }
+}
+
+/// Arguments of this type are copied into the log entry and formatted on the logging thread.
+template <typename T>
+constexpr bool IsDeferrableArg = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+
+namespace Detail {
+
+template <std::size_t N>
+struct ArgLayout {
+    std::array<std::size_t, N> offsets{};
+    std::size_t size = 0;
+};
+
+/// Offsets of each argument in the deferred argument buffer, following their alignment
+template <typename... Args>
+constexpr ArgLayout<sizeof...(Args)> MakeArgLayout() {
+    ArgLayout<sizeof...(Args)> layout;
+    [[maybe_unused]] std::size_t i = 0;
+    ((layout.size = (layout.size + alignof(Args) - 1) / alignof(Args) * alignof(Args),
+      layout.offsets[i++] = layout.size, layout.size += sizeof(Args)),
+     ...);
+    return layout;
+}
+
+/// Checks the argument types before their layout, which needs them to be complete types
+template <std::size_t Capacity, typename... Args>
+constexpr bool CanCaptureArgs() {
+    if constexpr ((IsDeferrableArg<Args> && ...)) {
+        return ((alignof(Args) <= 8) && ...) && MakeArgLayout<Args...>().size <= Capacity;
+    } else {
+        return false;
+    }
+}
+
+} // namespace Detail
+
+/**
+ * Arguments of a log message copied by value into a fixed size buffer, so that the message can be
+ * formatted on the logging thread instead of the thread that logged it. Only arithmetic and enum
+ * arguments are captured this way, since anything else may refer to memory that is gone by the
+ * time the message is formatted.
+ */
+class DeferredArgs {
+public:
+    static constexpr std::size_t Capacity = 64;
+
+    /// Whether a message with these argument types can be deferred
+    template <typename... Args>
+    static constexpr bool CanCapture = Detail::CanCaptureArgs<Capacity, Args...>();
+
+    /// Copies the arguments into the buffer
+    template <typename... Args>
+    void Capture(const Args&... args) {
+        static_assert(CanCapture<Args...>);
+        static constexpr Ops ops{&FormatArgs<Args...>, &SerializeArgs<Args...>};
+        [[maybe_unused]] constexpr auto layout = Detail::MakeArgLayout<Args...>();
+        [[maybe_unused]] std::size_t i = 0;
+        ((std::memcpy(storage.data() + layout.offsets[i++], &args, sizeof(Args))), ...);
+        this->ops = &ops;
+    }
+
+    /// Returns true if arguments have been captured
+    bool IsCaptured() const {
+        return ops != nullptr;
+    }
+
+    /// Formats the captured arguments with the given format string
+    std::string Format(const char* format) const {
+        return ops->format(format, storage.data());
+    }
+
+    /// Appends the argument count and the tagged arguments to a binary log record
+    void Serialize(std::vector<u8>& out) const {
+        ops->serialize(storage.data(), out);
+    }
+
+private:
+    struct Ops {
+        std::string (*format)(const char* format, const u8* storage);
+        void (*serialize)(const u8* storage, std::vector<u8>& out);
+    };
+
+    template <typename T>
+    static T Load(const u8* storage, std::size_t offset) {
+        T value;
+        std::memcpy(&value, storage + offset, sizeof(T));
+        return value;
+    }
+
+    template <typename... Args>
+    static std::string FormatArgs(const char* format, const u8* storage) {
+        [[maybe_unused]] constexpr auto layout = Detail::MakeArgLayout<Args...>();
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+            std::tuple<Args...> values{Load<Args>(storage, layout.offsets[I])...};
+            return fmt::vformat(format, fmt::make_format_args(std::get<I>(values)...));
+        }(std::index_sequence_for<Args...>{});
+    }
+
+    template <typename... Args>
+    static void SerializeArgs(const u8* storage, std::vector<u8>& out) {
+        [[maybe_unused]] constexpr auto layout = Detail::MakeArgLayout<Args...>();
+        out.push_back(static_cast<u8>(sizeof...(Args)));
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (AppendBinaryArg(out, Load<Args>(storage, layout.offsets[I])), ...);
+        }(std::index_sequence_for<Args...>{});
+    }
+
+    const Ops* ops = nullptr;
+    alignas(8) std::array<u8, Capacity> storage;
+};
+
+} // namespace Common::Log
@@ -8,6 +8,7 @@
 #include <array>
 #include <string_view>
 
+#include "common/logging/deferred_args.h"
 #include "common/logging/formatter.h"
 #include "common/logging/types.h"
 
@@ -27,11 +28,27 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args);
 
+/// Logs a message to the global logger, leaving the formatting to the logging thread
+void DeferredLogMessageImpl(Class log_class, Level log_level, const char* filename,
+                            unsigned int line_num, const char* function, const char* format,
+                            const DeferredArgs& args);
+
+/**
+ * Logs a message to the global logger. When all arguments can be copied by value, formatting the
+ * message is left to the logging thread, so the format string must be a string literal.
+ */
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, const char* format, const Args&... args) {
-    FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
-                      fmt::make_format_args(args...));
+    if constexpr (DeferredArgs::CanCapture<Args...>) {
+        DeferredArgs deferred_args;
+        deferred_args.Capture(args...);
+        DeferredLogMessageImpl(log_class, log_level, filename, line_num, function, format,
+                               deferred_args);
+    } else {
+        FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
+                          fmt::make_format_args(args...));
+    }
 }
 
 } // namespace Common::Log
@@ -5,7 +5,9 @@
 #pragma once
 
 #include <chrono>
+#include <string>
 
+#include "common/logging/deferred_args.h"
 #include "common/logging/types.h"
 
 namespace Common::Log {
@@ -20,7 +22,10 @@ struct Entry {
     Level log_level{};
     const char* filename = nullptr;
     u32 line_num = 0;
-    std::string function;
+    const char* function = nullptr;
+    /// Format string of a message whose arguments are formatted on the logging thread
+    const char* format = nullptr;
+    DeferredArgs args;
     std::string message;
 };
 
@@ -21,5 +21,11 @@ typedef void* HANDLE;
 #endif
 
 #include <microprofile.h>
+#include "common/tracing.h"
 
 #define MP_RGB(r, g, b) ((r) << 16 | (g) << 8 | (b) << 0)
+
+/// Profiles a scope with both MicroProfile and the tracer of common/tracing.h
+#define CITRA_PROFILE_SCOPE(var, category, name)                                                   \
+    MICROPROFILE_SCOPE(var);                                                                       \
+    CITRA_TRACE_SCOPE(category, name)
@@ -0,0 +1,240 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/tracing.h"
+
+namespace Common::Tracing {
+
+namespace Detail {
+std::atomic_bool enabled{false};
+}
+
+namespace {
+
+/// Number of events kept per thread, the oldest events are overwritten first
+constexpr std::size_t RingSize = 1 << 16;
+
+struct Event {
+    s64 timestamp; ///< Nanoseconds since the tracer was first used
+    const char* category;
+    const char* name;
+    u64 value;
+    EventType type;
+};
+
+struct ThreadBuffer {
+    u32 thread_id{};
+    std::string name; ///< Protected by the registry mutex
+    std::atomic<u64> write_index{0};
+    std::array<Event, RingSize> events{};
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+thread_local ThreadBuffer* current_buffer = nullptr;
+thread_local std::string current_thread_name;
+
+/// Returns the buffer of the calling thread, creating it the first time the thread records
+ThreadBuffer& GetThreadBuffer() {
+    if (!current_buffer) [[unlikely]] {
+        auto& registry = GetRegistry();
+        std::scoped_lock lock{registry.mutex};
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->thread_id = static_cast<u32>(registry.buffers.size() + 1);
+        buffer->name = current_thread_name.empty()
+                           ? fmt::format("Thread {}", buffer->thread_id)
+                           : current_thread_name;
+        current_buffer = registry.buffers.emplace_back(std::move(buffer)).get();
+    }
+    return *current_buffer;
+}
+
+/// Copies the events of a buffer while its thread may still be recording
+std::vector<Event> Snapshot(const ThreadBuffer& buffer) {
+    const u64 end = buffer.write_index.load(std::memory_order_acquire);
+    const u64 begin = end > RingSize ? end - RingSize : 0;
+    std::vector<Event> events;
+    events.reserve(end - begin);
+    for (u64 i = begin; i < end; ++i) {
+        events.push_back(buffer.events[i % RingSize]);
+    }
+
+    // Drop the events the thread may have overwritten while they were being copied
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const u64 new_end = buffer.write_index.load(std::memory_order_relaxed);
+    const u64 first_valid = new_end + 1 > RingSize ? new_end + 1 - RingSize : 0;
+    if (first_valid > begin) {
+        const u64 dropped = std::min<u64>(first_valid - begin, events.size());
+        events.erase(events.begin(), events.begin() + static_cast<std::ptrdiff_t>(dropped));
+    }
+    return events;
+}
+
+std::string EscapeJson(std::string_view str) {
+    std::string escaped;
+    escaped.reserve(str.size());
+    for (const char c : str) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += fmt::format("\\u{:04x}", c);
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+class ChromeTraceWriter {
+public:
+    void AppendThreadName(u32 thread_id, std::string_view name) {
+        Append(fmt::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},)"
+                           R"("args":{{"name":"{}"}}}})",
+                           thread_id, EscapeJson(name)));
+    }
+
+    void AppendEvent(u32 thread_id, const Event& event) {
+        const char* phase = "";
+        std::string extra;
+        switch (event.type) {
+        case EventType::Begin:
+            phase = "B";
+            break;
+        case EventType::End:
+            phase = "E";
+            break;
+        case EventType::Counter:
+            phase = "C";
+            extra = fmt::format(R"(,"args":{{"value":{}}})", event.value);
+            break;
+        case EventType::FlowBegin:
+            phase = "s";
+            extra = fmt::format(R"(,"id":{})", event.value);
+            break;
+        case EventType::FlowStep:
+            phase = "t";
+            extra = fmt::format(R"(,"id":{})", event.value);
+            break;
+        case EventType::FlowEnd:
+            phase = "f";
+            extra = fmt::format(R"(,"id":{},"bp":"e")", event.value);
+            break;
+        }
+        Append(fmt::format(R"({{"name":"{}","cat":"{}","ph":"{}","ts":{}.{:03},"pid":1,)"
+                           R"("tid":{}{}}})",
+                           EscapeJson(event.name), EscapeJson(event.category), phase,
+                           event.timestamp / 1000, event.timestamp % 1000, thread_id, extra));
+    }
+
+    std::string Finish() {
+        json += "\n]}\n";
+        return std::move(json);
+    }
+
+private:
+    void Append(std::string_view event) {
+        if (!first) {
+            json += ",\n";
+        }
+        first = false;
+        json += event;
+    }
+
+    std::string json = R"({"displayTimeUnit":"ns","traceEvents":[)"
+                       "\n";
+    bool first = true;
+};
+
+} // Anonymous namespace
+
+void SetEnabled(bool enabled) {
+    // Start the clock before the first event is recorded
+    static_cast<void>(GetRegistry());
+    Detail::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void SetThreadName(const char* name) {
+    current_thread_name = name;
+    if (current_buffer) {
+        auto& registry = GetRegistry();
+        std::scoped_lock lock{registry.mutex};
+        current_buffer->name = current_thread_name;
+    }
+}
+
+void RecordEvent(EventType type, const char* category, const char* name, u64 value) {
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+    using std::chrono::steady_clock;
+
+    ThreadBuffer& buffer = GetThreadBuffer();
+    const s64 timestamp =
+        duration_cast<nanoseconds>(steady_clock::now() - GetRegistry().origin).count();
+    const u64 index = buffer.write_index.load(std::memory_order_relaxed);
+    buffer.events[index % RingSize] = {timestamp, category, name, value, type};
+    buffer.write_index.store(index + 1, std::memory_order_release);
+}
+
+bool ExportChromeTrace(const std::string& path) {
+    auto& registry = GetRegistry();
+    ChromeTraceWriter writer;
+    {
+        std::scoped_lock lock{registry.mutex};
+        for (const auto& buffer : registry.buffers) {
+            writer.AppendThreadName(buffer->thread_id, buffer->name);
+
+            const auto events = Snapshot(*buffer);
+            // Scopes that started before the oldest kept event have no begin event, and scopes
+            // still running have no end event yet. Drop the former and close the latter.
+            std::vector<const Event*> open_scopes;
+            for (const Event& event : events) {
+                if (event.type == EventType::End) {
+                    if (open_scopes.empty()) {
+                        continue;
+                    }
+                    open_scopes.pop_back();
+                } else if (event.type == EventType::Begin) {
+                    open_scopes.push_back(&event);
+                }
+                writer.AppendEvent(buffer->thread_id, event);
+            }
+            while (!open_scopes.empty()) {
+                Event end = *open_scopes.back();
+                end.type = EventType::End;
+                end.timestamp = events.back().timestamp;
+                writer.AppendEvent(buffer->thread_id, end);
+                open_scopes.pop_back();
+            }
+        }
+    }
+
+    const std::string json = writer.Finish();
+    FileUtil::IOFile file{path, "w"};
+    if (!file.IsOpen() || file.WriteString(json) != json.size()) {
+        LOG_ERROR(Common, "Failed to write trace to {}", path);
+        return false;
+    }
+    LOG_INFO(Common, "Wrote trace to {}", path);
+    return true;
+}
+
+} // namespace Common::Tracing
@@ -0,0 +1,101 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+
+/**
+ * A lightweight tracer that records scopes, counters and flow events into a ring buffer per thread
+ * and exports them in the Chrome trace event format, which chrome://tracing and Perfetto open.
+ *
+ * Recording is lock-free: each thread only writes its own buffer. While tracing is disabled, every
+ * trace point costs a single relaxed atomic load. Category and event names must be string literals
+ * (or otherwise outlive the tracer), since only their addresses are recorded.
+ */
+namespace Common::Tracing {
+
+enum class EventType : u8 {
+    Begin,     ///< Start of a scope
+    End,       ///< End of the most recently started scope
+    Counter,   ///< Sample of a counter value
+    FlowBegin, ///< Start of a flow between scopes, identified by its id
+    FlowStep,  ///< Intermediate step of a flow
+    FlowEnd,   ///< End of a flow
+};
+
+namespace Detail {
+extern std::atomic_bool enabled;
+}
+
+/// Returns true if events are being recorded
+inline bool IsEnabled() {
+    return Detail::enabled.load(std::memory_order_relaxed);
+}
+
+/// Starts or stops recording events. Events recorded so far are kept.
+void SetEnabled(bool enabled);
+
+/// Sets the name the calling thread is shown with in exported traces
+void SetThreadName(const char* name);
+
+/**
+ * Records an event on the calling thread.
+ * @param value Counter value for counters, id for flow events, unused otherwise
+ */
+void RecordEvent(EventType type, const char* category, const char* name, u64 value = 0);
+
+/**
+ * Writes the events that are still in the ring buffers to a Chrome trace JSON file.
+ * @returns true on success
+ */
+bool ExportChromeTrace(const std::string& path);
+
+/// Records a scope for the lifetime of the object
+class ScopedEvent {
+public:
+    ScopedEvent(const char* category_, const char* name_) {
+        if (IsEnabled()) {
+            category = category_;
+            name = name_;
+            RecordEvent(EventType::Begin, category, name);
+        }
+    }
+
+    ~ScopedEvent() {
+        if (category) {
+            RecordEvent(EventType::End, category, name);
+        }
+    }
+
+    ScopedEvent(const ScopedEvent&) = delete;
+    ScopedEvent& operator=(const ScopedEvent&) = delete;
+
+private:
+    const char* category = nullptr;
+    const char* name = nullptr;
+};
+
+} // namespace Common::Tracing
+
+#define CITRA_TRACE_SCOPE(category, name)                                                          \
+    ::Common::Tracing::ScopedEvent CONCAT2(trace_scope_, __LINE__) {                               \
+        category, name                                                                             \
+    }
+
+#define CITRA_TRACE_EVENT(type, category, name, value)                                             \
+    do {                                                                                           \
+        if (::Common::Tracing::IsEnabled()) {                                                      \
+            ::Common::Tracing::RecordEvent(::Common::Tracing::EventType::type, category, name,     \
+                                           static_cast<u64>(value));                               \
+        }                                                                                          \
+    } while (0)
+
+#define CITRA_TRACE_COUNTER(category, name, value) CITRA_TRACE_EVENT(Counter, category, name, value)
+#define CITRA_TRACE_FLOW_BEGIN(category, name, id) CITRA_TRACE_EVENT(FlowBegin, category, name, id)
+#define CITRA_TRACE_FLOW_STEP(category, name, id) CITRA_TRACE_EVENT(FlowStep, category, name, id)
+#define CITRA_TRACE_FLOW_END(category, name, id) CITRA_TRACE_EVENT(FlowEnd, category, name, id)
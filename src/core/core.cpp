@@ -13,6 +13,7 @@
 #include "common/arch.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
+#include "common/tracing.h"
 #include "core/arm/arm_interface.h"
 #include "core/arm/exclusive_monitor.h"
 #include "core/hle/service/cam/cam.h"
@@ -75,6 +76,7 @@ Core::Timing& Global() {
 System::~System() = default;
 
 System::ResultStatus System::RunLoop(bool tight_loop) {
+    CITRA_TRACE_SCOPE("Core", "RunLoop");
     status = ResultStatus::Success;
     if (!IsPoweredOn()) {
         return ResultStatus::ErrorNotInitialized;
@@ -146,6 +148,18 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
         break;
     }
 
+    // Movie keyframes are savestates too, so they are taken and loaded here as well
+    try {
+        if (Movie::GetInstance().ProcessKeyframes(*this)) {
+            frame_limiter.WaitOnce();
+            return ResultStatus::Success;
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR(Core, "Error loading movie keyframe: {}", e.what());
+        status_details = e.what();
+        return ResultStatus::ErrorSavestate;
+    }
+
     // All cores should have executed the same amount of ticks. If this is not the case an event was
     // scheduled with a cycles_into_future smaller then the current downcount.
     // So we have to get those cores to the same global time first
@@ -184,6 +198,7 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
             current_core_to_execute->GetTimer().Idle();
             PrepareReschedule();
         } else {
+            PerfStats::ScopedComponent component{PerfStats::Component::CpuJit};
             if (tight_loop) {
                 current_core_to_execute->Run();
             } else {
@@ -216,6 +231,7 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
                 cpu_core->GetTimer().Idle();
                 PrepareReschedule();
             } else {
+                PerfStats::ScopedComponent component{PerfStats::Component::CpuJit};
                 if (tight_loop) {
                     cpu_core->Run();
                 } else {
@@ -320,6 +336,7 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
     }
     cheat_engine = std::make_unique<Cheats::CheatEngine>(title_id, *this);
     perf_stats = std::make_unique<PerfStats>(title_id);
+    hle_stats.Reset();
 
     if (Settings::values.custom_textures) {
         custom_tex_manager->FindCustomTextures();
@@ -350,6 +367,10 @@ PerfStats::Results System::GetAndResetPerfStats() {
                                   : PerfStats::Results{};
 }
 
+PerfStats::Results System::GetLastPerfStats() const {
+    return perf_stats ? perf_stats->GetLastStats() : PerfStats::Results{};
+}
+
 void System::Reschedule() {
     if (!reschedule_pending) {
         return;
@@ -362,6 +383,27 @@ void System::Reschedule() {
     }
 }
 
+System::ResultStatus System::InitWithoutApplication(Frontend::EmuWindow& emu_window) {
+    // Use the default memory layout of an Old 3DS, since no application asks for another one
+    const ResultStatus init_result{Init(emu_window, nullptr, 0, 0, 2)};
+    if (init_result != ResultStatus::Success) {
+        LOG_CRITICAL(Core, "Failed to initialize system (Error {})!",
+                     static_cast<u32>(init_result));
+        System::Shutdown();
+        return init_result;
+    }
+
+    perf_stats = std::make_unique<PerfStats>(0);
+    hle_stats.Reset();
+    status = ResultStatus::Success;
+    m_emu_window = &emu_window;
+    m_secondary_window = nullptr;
+
+    [[maybe_unused]] const PerfStats::Results result = GetAndResetPerfStats();
+    perf_stats->BeginSystemFrame();
+    return status;
+}
+
 System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
                                   Frontend::EmuWindow* secondary_window, u32 system_mode,
                                   u8 n3ds_mode, u32 num_cores) {
@@ -496,6 +538,10 @@ const Cheats::CheatEngine& System::CheatEngine() const {
     return *cheat_engine;
 }
 
+RPC::RPCServer& System::RPCServer() {
+    return *rpc_server;
+}
+
 void System::RegisterVideoDumper(std::shared_ptr<VideoDumper::Backend> dumper) {
     video_dumper = std::move(dumper);
 }
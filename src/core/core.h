@@ -7,11 +7,14 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <span>
 #include <string>
+#include <vector>
 #include <boost/serialization/version.hpp>
 #include "common/common_types.h"
 #include "core/frontend/applets/mii_selector.h"
 #include "core/frontend/applets/swkbd.h"
+#include "core/hle_stats.h"
 #include "core/loader/loader.h"
 #include "core/memory.h"
 #include "core/perf_stats.h"
@@ -146,6 +149,14 @@ public:
     [[nodiscard]] ResultStatus Load(Frontend::EmuWindow& emu_window, const std::string& filepath,
                                     Frontend::EmuWindow* secondary_window = {});
 
+    /**
+     * Initializes the emulated hardware without loading an application, for tools that drive the
+     * GPU directly, like the CiTrace player. The CPU must not be run afterwards.
+     * @param emu_window Reference to the host-system window used for video output.
+     * @returns ResultStatus code, indicating if the operation succeeded.
+     */
+    [[nodiscard]] ResultStatus InitWithoutApplication(Frontend::EmuWindow& emu_window);
+
     /**
      * Indicates if the emulated system is powered on (all subsystems initialized and able to run an
      * application).
@@ -168,6 +179,9 @@ public:
 
     [[nodiscard]] PerfStats::Results GetAndResetPerfStats();
 
+    /// Returns the results of the last GetAndResetPerfStats call, without resetting the stats
+    [[nodiscard]] PerfStats::Results GetLastPerfStats() const;
+
     /**
      * Gets a reference to the emulated CPU.
      * @returns A reference to the emulated CPU.
@@ -252,6 +266,9 @@ public:
     /// Gets a const reference to the cheat engine
     [[nodiscard]] const Cheats::CheatEngine& CheatEngine() const;
 
+    /// Gets a reference to the RPC server
+    [[nodiscard]] RPC::RPCServer& RPCServer();
+
     /// Gets a reference to the custom texture cache system
     [[nodiscard]] VideoCore::CustomTexManager& CustomTexManager();
 
@@ -268,6 +285,7 @@ public:
 
     std::unique_ptr<PerfStats> perf_stats;
     FrameLimiter frame_limiter;
+    HLEStats hle_stats;
 
     void SetStatus(ResultStatus new_status, const char* details = nullptr) {
         status = new_status;
@@ -321,6 +339,12 @@ public:
 
     void LoadState(u32 slot);
 
+    /// Serializes the emulated state into a compressed buffer, as stored in savestate files
+    [[nodiscard]] std::vector<u8> SaveStateBuffer() const;
+
+    /// Restores the emulated state from a buffer created by SaveStateBuffer
+    void LoadStateBuffer(std::span<const u8> buffer);
+
     /// Self delete ncch
     bool SetSelfDelete(const std::string& file) {
         if (m_filepath == file) {
@@ -4,6 +4,9 @@
 
 #include <algorithm>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include "common/archives.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
@@ -16,11 +19,59 @@ SERIALIZE_EXPORT_IMPL(FileSys::DiskDirectory)
 
 namespace FileSys {
 
+DiskFile::~DiskFile() {
+    if (!state) {
+        return;
+    }
+    std::scoped_lock lock{state->mutex};
+    if (state->write_buffer_owner == this) {
+        FlushWriteBuffer();
+    }
+}
+
+void DiskFile::AcquireSharedState() {
+    static std::mutex shared_states_mutex;
+    static std::unordered_map<std::string, std::weak_ptr<SharedState>> shared_states;
+
+    std::scoped_lock lock{shared_states_mutex};
+    state = shared_states[file->GetFilename()].lock();
+    if (!state) {
+        std::erase_if(shared_states, [](const auto& pair) { return pair.second.expired(); });
+        state = std::make_shared<SharedState>();
+        shared_states[file->GetFilename()] = state;
+    }
+}
+
+bool DiskFile::FlushWriteBuffer() const {
+    if (state->write_buffer.empty())
+        return true;
+
+    const DiskFile* owner = state->write_buffer_owner;
+    owner->file->Seek(state->write_buffer_offset, SEEK_SET);
+    const bool success = owner->file->WriteBytes(state->write_buffer.data(),
+                                                 state->write_buffer.size()) ==
+                         state->write_buffer.size();
+    if (owner != this) {
+        // Make the data visible to the host file of this file
+        owner->file->Flush();
+    }
+    if (!success) {
+        LOG_ERROR(Service_FS, "Failed to write back {} bytes at offset 0x{:x}",
+                  state->write_buffer.size(), state->write_buffer_offset);
+        owner->write_failed = true;
+    }
+    state->write_buffer.clear();
+    state->write_buffer_owner = nullptr;
+    return success;
+}
+
 ResultVal<std::size_t> DiskFile::Read(const u64 offset, const std::size_t length,
                                       u8* buffer) const {
     if (!mode.read_flag)
         return ERROR_INVALID_OPEN_FLAGS;
 
+    std::scoped_lock lock{state->mutex};
+    FlushWriteBuffer();
     file->Seek(offset, SEEK_SET);
     return file->ReadBytes(buffer, length);
 }
@@ -30,25 +81,81 @@ ResultVal<std::size_t> DiskFile::Write(const u64 offset, const std::size_t lengt
     if (!mode.write_flag)
         return ERROR_INVALID_OPEN_FLAGS;
 
-    file->Seek(offset, SEEK_SET);
-    std::size_t written = file->WriteBytes(buffer, length);
-    if (flush)
+    std::scoped_lock lock{state->mutex};
+    if (write_failed) {
+        write_failed = false;
+        return ERROR_INSUFFICIENT_SPACE;
+    }
+
+    // Only merge writes of this file that overlap or directly follow the buffered data.
+    const u64 buffer_end = state->write_buffer_offset + state->write_buffer.size();
+    if (!state->write_buffer.empty() &&
+        (state->write_buffer_owner != this || offset < state->write_buffer_offset ||
+         offset > buffer_end)) {
+        FlushWriteBuffer();
+    }
+    if (state->write_buffer.empty()) {
+        state->write_buffer_offset = offset;
+    }
+
+    // Growing the file allocates host storage, which can fail, so the guest has to see the result
+    if (offset + length > file->GetSize() ||
+        offset + length - state->write_buffer_offset > MaxWriteBufferSize) {
+        if (!FlushWriteBuffer()) {
+            write_failed = false;
+            return ERROR_INSUFFICIENT_SPACE;
+        }
+        file->Seek(offset, SEEK_SET);
+        std::size_t written = file->WriteBytes(buffer, length);
+        if (flush)
+            file->Flush();
+        return written;
+    }
+
+    const std::size_t buffer_offset =
+        static_cast<std::size_t>(offset - state->write_buffer_offset);
+    if (buffer_offset + length > state->write_buffer.size()) {
+        state->write_buffer.resize(buffer_offset + length);
+    }
+    std::copy_n(buffer, length, state->write_buffer.begin() + buffer_offset);
+    state->write_buffer_owner = this;
+
+    if (flush) {
+        if (!FlushWriteBuffer()) {
+            write_failed = false;
+            return ERROR_INSUFFICIENT_SPACE;
+        }
         file->Flush();
-    return written;
+    }
+    return length;
 }
 
 u64 DiskFile::GetSize() const {
+    // Buffered writes never grow the file
+    std::scoped_lock lock{state->mutex};
     return file->GetSize();
 }
 
 bool DiskFile::SetSize(const u64 size) const {
+    std::scoped_lock lock{state->mutex};
+    FlushWriteBuffer();
     file->Resize(size);
     file->Flush();
     return true;
 }
 
 bool DiskFile::Close() const {
-    return file->Close();
+    std::scoped_lock lock{state->mutex};
+    FlushWriteBuffer();
+    const bool success = !write_failed;
+    write_failed = false;
+    return file->Close() && success;
+}
+
+void DiskFile::Flush() const {
+    std::scoped_lock lock{state->mutex};
+    FlushWriteBuffer();
+    file->Flush();
 }
 
 DiskDirectory::DiskDirectory(const std::string& path) {
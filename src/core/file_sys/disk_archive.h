@@ -6,6 +6,7 @@
 
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <boost/serialization/base_object.hpp>
@@ -20,6 +21,18 @@
 
 namespace FileSys {
 
+/**
+ * A file on the host disk. Writes within the current size of the host file are buffered while
+ * they are adjacent or overlapping, and written back to the host file when a write can't be
+ * merged, or on flush, resize, read, close and destruction. Save-heavy titles tend to issue many
+ * tiny sequential writes. Writes that grow the file, which may fail for lack of space, are written
+ * through, and a failed write back is reported by the next write or close of the file that
+ * buffered it.
+ *
+ * All the files opened on the same host path share the write buffer, so that each sees the
+ * writes of the others. Guest reads run on the FS I/O thread while other requests may use the
+ * same file, so all accesses to the host files and the write buffer of a path are serialized.
+ */
 class DiskFile : public FileBackend {
 public:
     DiskFile(FileUtil::IOFile&& file_, const Mode& mode_,
@@ -27,8 +40,11 @@ public:
         : file(new FileUtil::IOFile(std::move(file_))) {
         delay_generator = std::move(delay_generator_);
         mode.hex = mode_.hex;
+        AcquireSharedState();
     }
 
+    ~DiskFile() override;
+
     ResultVal<std::size_t> Read(u64 offset, std::size_t length, u8* buffer) const override;
     ResultVal<std::size_t> Write(u64 offset, std::size_t length, bool flush,
                                  const u8* buffer) override;
@@ -36,22 +52,50 @@ public:
     bool SetSize(u64 size) const override;
     bool Close() const override;
 
-    void Flush() const override {
-        file->Flush();
-    }
+    void Flush() const override;
 
 protected:
     Mode mode;
     std::unique_ptr<FileUtil::IOFile> file;
 
 private:
+    static constexpr std::size_t MaxWriteBufferSize = 0x10000;
+
+    /// State of a host path, shared by the files opened on it.
+    struct SharedState {
+        std::mutex mutex; ///< Guards the host files of the path and the write buffer
+        std::vector<u8> write_buffer;
+        u64 write_buffer_offset{};
+        const DiskFile* write_buffer_owner{}; ///< File whose host file the buffer is written to
+    };
+
+    /// Looks up the shared state of the host path, creating it for the first file opened on it.
+    void AcquireSharedState();
+
+    /**
+     * Writes the buffered data, if any, through the host file of the file that buffered it. A
+     * failure is recorded for that file to report. Must be called with the shared mutex held.
+     * @returns false if writing the data failed
+     */
+    bool FlushWriteBuffer() const;
+
+    std::shared_ptr<SharedState> state;
+    mutable bool write_failed = false; ///< A buffered write failed and was not reported yet
+
     DiskFile() = default;
 
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
+        if (Archive::is_saving::value) {
+            std::scoped_lock lock{state->mutex};
+            FlushWriteBuffer();
+        }
         ar& boost::serialization::base_object<FileBackend>(*this);
         ar& mode.hex;
         ar& file;
+        if (Archive::is_loading::value) {
+            AcquireSharedState();
+        }
     }
     friend class boost::serialization::access;
 };
@@ -4,6 +4,8 @@
 
 #include <algorithm>
 #include <cstring>
+#include <optional>
+#include <utility>
 #include "common/alignment.h"
 #include "common/archives.h"
 #include "common/assert.h"
@@ -64,6 +66,7 @@ LayeredFS::LayeredFS(std::shared_ptr<RomFSReader> romfs_, std::string patch_path
 }
 
 void LayeredFS::Load() {
+    replace_file_cache.clear();
     romfs->ReadFile(0, sizeof(header), reinterpret_cast<u8*>(&header));
 
     ASSERT_MSG(header.header_length == sizeof(header), "Header size is incorrect");
@@ -80,7 +83,17 @@ void LayeredFS::Load() {
     RebuildMetadata();
 }
 
-LayeredFS::~LayeredFS() = default;
+LayeredFS::~LayeredFS() {
+    if (statistics.replace_reads == 0 && statistics.patch_reads == 0) {
+        return;
+    }
+    LOG_INFO(Service_FS,
+             "LayeredFS reads: {} base ({} coalesced), {} replaced ({} handle hits, {} misses), "
+             "{} patched",
+             statistics.base_reads, statistics.base_reads_coalesced, statistics.replace_reads,
+             statistics.replace_handle_hits, statistics.replace_handle_misses,
+             statistics.patch_reads);
+}
 
 u32 LayeredFS::LoadDirectory(Directory& current, u32 offset) {
     DirectoryMetadata metadata;
@@ -487,9 +500,35 @@ std::size_t LayeredFS::GetSize() const {
     return metadata.size() + current_data_offset;
 }
 
+FileUtil::IOFile* LayeredFS::GetReplaceFile(const File& file) {
+    const auto it = std::find_if(replace_file_cache.begin(), replace_file_cache.end(),
+                                 [&file](const auto& entry) { return entry.file == &file; });
+    if (it != replace_file_cache.end()) {
+        statistics.replace_handle_hits++;
+        replace_file_cache.splice(replace_file_cache.begin(), replace_file_cache, it);
+        auto& handle = replace_file_cache.front().handle;
+        handle.Clear(); // A previous short read may have left the error flag set
+        return &handle;
+    }
+
+    statistics.replace_handle_misses++;
+    FileUtil::IOFile handle(file.relocation.replace_file_path, "rb");
+    if (!handle) {
+        return nullptr;
+    }
+
+    if (replace_file_cache.size() >= MaxOpenReplaceFiles) {
+        replace_file_cache.pop_back();
+    }
+    replace_file_cache.push_front({&file, std::move(handle)});
+    return &replace_file_cache.front().handle;
+}
+
 std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
     ASSERT_MSG(offset + length <= GetSize(), "Out of bound");
 
+    std::scoped_lock lock{mutex};
+
     std::size_t read_size = 0;
     if (offset < metadata.size()) {
         // First read the metadata
@@ -501,6 +540,29 @@ std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buff
         offset -= metadata.size();
     }
 
+    // Unmodified files are usually laid out in the same order as in the base RomFS, so reads
+    // spanning several of them are merged into a single read from the base RomFS. The alignment
+    // padding between them is zeroed once the merged read has been issued.
+    struct PendingBaseRead {
+        u64 romfs_offset;
+        std::size_t buffer_offset;
+        std::size_t length;
+    };
+    std::optional<PendingBaseRead> pending_read;
+    std::vector<std::pair<std::size_t, std::size_t>> pending_padding; // buffer offset, length
+
+    const auto flush_pending_read = [&] {
+        if (pending_read) {
+            romfs->ReadFile(pending_read->romfs_offset, pending_read->length,
+                            buffer + pending_read->buffer_offset);
+            pending_read.reset();
+        }
+        for (const auto& [padding_offset, padding_length] : pending_padding) {
+            std::memset(buffer + padding_offset, 0, padding_length);
+        }
+        pending_padding.clear();
+    };
+
     // Read files
     auto current = (--data_offset_map.upper_bound(offset));
     while (read_size < length) {
@@ -519,31 +581,57 @@ std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buff
         // Read the file in different ways depending on relocation type
         auto& relocation = current->second->relocation;
         if (relocation.type == 0) { // none
-            romfs->ReadFile(relocation.original_offset + relative_offset, to_read,
-                            buffer + read_size);
+            const u64 romfs_offset = relocation.original_offset + relative_offset;
+            if (pending_read && pending_read->buffer_offset + pending_read->length == read_size &&
+                pending_read->romfs_offset + pending_read->length == romfs_offset) {
+                pending_read->length += to_read;
+                statistics.base_reads_coalesced++;
+            } else {
+                flush_pending_read();
+                pending_read = PendingBaseRead{romfs_offset, read_size, to_read};
+            }
+            statistics.base_reads++;
         } else if (relocation.type == 1) { // replace
-            FileUtil::IOFile replace_file(relocation.replace_file_path, "rb");
+            flush_pending_read();
+            statistics.replace_reads++;
+            auto* replace_file = GetReplaceFile(*current->second);
             if (replace_file) {
-                replace_file.Seek(relative_offset, SEEK_SET);
-                replace_file.ReadBytes(buffer + read_size, to_read);
+                replace_file->Seek(relative_offset, SEEK_SET);
+                replace_file->ReadBytes(buffer + read_size, to_read);
             } else {
                 LOG_ERROR(Service_FS, "Could not open replacement file for {}",
                           current->second->path);
             }
         } else if (relocation.type == 2) { // patch
+            flush_pending_read();
+            statistics.patch_reads++;
             std::memcpy(buffer + read_size, relocation.patched_file.data() + relative_offset,
                         to_read);
         } else {
             UNREACHABLE();
         }
 
-        std::memset(buffer + read_size + to_read, 0, alignment);
+        if (alignment != 0) {
+            // Extend the merged read over the padding if the next file directly follows in the
+            // base RomFS, so that it can still be merged.
+            const auto next = std::next(current);
+            if (pending_read && read_size + to_read + alignment < length &&
+                next != data_offset_map.end() && next->second->relocation.type == 0 &&
+                next->second->relocation.original_offset ==
+                    pending_read->romfs_offset + pending_read->length + alignment) {
+                pending_read->length += alignment;
+                pending_padding.emplace_back(read_size + to_read, alignment);
+            } else {
+                std::memset(buffer + read_size + to_read, 0, alignment);
+            }
+        }
 
         read_size += to_read + alignment;
         offset += to_read + alignment;
         current++;
     }
 
+    flush_pending_read();
     return read_size;
 }
 
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -14,6 +16,7 @@
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/string.hpp>
 #include "common/common_types.h"
+#include "common/file_util.h"
 #include "common/swap.h"
 #include "core/file_sys/romfs_reader.h"
 
@@ -44,6 +47,16 @@ static_assert(sizeof(RomFSHeader) == 0x28, "Size of RomFSHeader is not correct")
  */
 class LayeredFS : public RomFSReader {
 public:
+    /// Read counters for this title, used to judge how much of the RomFS is being replaced.
+    struct Statistics {
+        u64 base_reads{};            ///< Reads served from the underlying RomFS
+        u64 base_reads_coalesced{};  ///< Base reads merged into a preceding read
+        u64 replace_reads{};         ///< Reads served from replacement files
+        u64 replace_handle_hits{};   ///< Replacement reads that reused an open handle
+        u64 replace_handle_misses{}; ///< Replacement reads that had to open the file
+        u64 patch_reads{};           ///< Reads served from patched files
+    };
+
     explicit LayeredFS(std::shared_ptr<RomFSReader> romfs, std::string patch_path,
                        std::string patch_ext_path, bool load_relocations = true);
     ~LayeredFS() override;
@@ -53,6 +66,11 @@ public:
 
     bool DumpRomFS(const std::string& target_path);
 
+    Statistics GetStatistics() const {
+        std::scoped_lock lock{mutex};
+        return statistics;
+    }
+
 private:
     struct File;
     struct Directory {
@@ -100,6 +118,10 @@ private:
 
     void Load();
 
+    // Returns an open handle to the replacement file of `file`, or nullptr if it can't be opened.
+    // Handles are kept open in a small LRU cache, as titles tend to issue many small reads.
+    FileUtil::IOFile* GetReplaceFile(const File& file);
+
     std::shared_ptr<RomFSReader> romfs;
     std::string patch_path;
     std::string patch_ext_path;
@@ -128,6 +150,16 @@ private:
     std::vector<u8> file_metadata_table; // rebuilt file metadata table
     u64 current_data_offset{};           // current assigned data offset
 
+    struct ReplaceFileHandle {
+        const File* file;
+        FileUtil::IOFile handle;
+    };
+    static constexpr std::size_t MaxOpenReplaceFiles = 16;
+    std::list<ReplaceFileHandle> replace_file_cache; // most recently used first
+
+    mutable std::mutex mutex; ///< Guards the replacement file handles and the statistics
+    Statistics statistics{};
+
     LayeredFS();
 
     template <class Archive>
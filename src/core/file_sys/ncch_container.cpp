@@ -440,6 +440,12 @@ Loader::ResultStatus NCCHContainer::Load() {
     if (!(has_exefs || has_romfs || is_tainted))
         return Loader::ResultStatus::Error;
 
+    // Sections are read from one mapping of the ExeFS file, which is kept for the lifetime of the
+    // container, like the RomFS reader does
+    if (exefs_file.IsOpen()) {
+        exefs_mapping.Map(exefs_file);
+    }
+
     is_loaded = true;
     return Loader::ResultStatus::Success;
 }
@@ -523,7 +529,21 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
 
             s64 section_offset =
                 (section.offset + exefs_offset + sizeof(ExeFs_Header) + ncch_offset);
-            exefs_file.Seek(section_offset, SEEK_SET);
+
+            // Read straight from the mapping of the file where possible. The data is then only
+            // copied once, while decrypting, or not at all for unencrypted compressed code.
+            std::vector<u8> read_buffer;
+            std::span<const u8> section_data;
+            if (exefs_mapping.IsMapped()) {
+                section_data = exefs_mapping.GetSpan(section_offset, section.size);
+            } else {
+                read_buffer.resize(section.size);
+                exefs_file.Seek(section_offset, SEEK_SET);
+                read_buffer.resize(exefs_file.ReadBytes(read_buffer.data(), read_buffer.size()));
+                section_data = read_buffer;
+            }
+            if (section_data.size() != section.size)
+                return Loader::ResultStatus::Error;
 
             std::array<u8, 16> key;
             if (strcmp(section.name, "icon") == 0 || strcmp(section.name, "banner") == 0) {
@@ -537,28 +557,27 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
             dec.Seek(section.offset + sizeof(ExeFs_Header));
 
             if (strcmp(section.name, ".code") == 0 && is_compressed) {
-                // Section is compressed, read compressed .code section...
-                std::vector<u8> temp_buffer(section.size);
-                if (exefs_file.ReadBytes(temp_buffer.data(), temp_buffer.size()) !=
-                    temp_buffer.size())
-                    return Loader::ResultStatus::Error;
-
+                // Section is compressed, decrypt compressed .code section if needed...
+                std::vector<u8> temp_buffer;
+                std::span<const u8> compressed_data = section_data;
                 if (is_encrypted) {
-                    dec.ProcessData(&temp_buffer[0], &temp_buffer[0], section.size);
+                    temp_buffer.resize(section.size);
+                    dec.ProcessData(temp_buffer.data(), section_data.data(), section.size);
+                    compressed_data = temp_buffer;
                 }
 
                 // Decompress .code section...
-                buffer.resize(LZSS_GetDecompressedSize(temp_buffer));
-                if (!LZSS_Decompress(temp_buffer, buffer)) {
+                buffer.resize(LZSS_GetDecompressedSize(compressed_data));
+                if (!LZSS_Decompress(compressed_data, buffer)) {
                     return Loader::ResultStatus::ErrorInvalidFormat;
                 }
             } else {
                 // Section is uncompressed...
                 buffer.resize(section.size);
-                if (exefs_file.ReadBytes(buffer.data(), section.size) != section.size)
-                    return Loader::ResultStatus::Error;
                 if (is_encrypted) {
-                    dec.ProcessData(buffer.data(), buffer.data(), section.size);
+                    dec.ProcessData(buffer.data(), section_data.data(), section.size);
+                } else {
+                    std::memcpy(buffer.data(), section_data.data(), section.size);
                 }
             }
 
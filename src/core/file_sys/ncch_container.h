@@ -358,6 +358,7 @@ private:
     std::string filepath;
     FileUtil::IOFile file;
     FileUtil::IOFile exefs_file;
+    FileUtil::MappedFile exefs_mapping; ///< Mapping of exefs_file, if it could be mapped
 };
 
 } // namespace FileSys
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cstring>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
 #include "common/archives.h"
@@ -8,17 +9,103 @@ SERIALIZE_EXPORT_IMPL(FileSys::DirectRomFSReader)
 
 namespace FileSys {
 
-std::size_t DirectRomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
+std::size_t DirectRomFSReader::ReadDirect(std::size_t offset, std::size_t length, u8* buffer) {
     if (length == 0)
         return 0; // Crypto++ does not like zero size buffer
-    file.Seek(file_offset + offset, SEEK_SET);
     std::size_t read_length = std::min(length, static_cast<std::size_t>(data_size) - offset);
-    read_length = file.ReadBytes(buffer, read_length);
+    const u8* source = buffer;
+    if (mapping.IsMapped()) {
+        const auto data = mapping.GetSpan(file_offset + offset, read_length);
+        source = data.data();
+        read_length = data.size();
+        if (read_length == 0)
+            return 0;
+        if (!is_encrypted) {
+            std::memcpy(buffer, source, read_length);
+        }
+    } else {
+        file.Seek(file_offset + offset, SEEK_SET);
+        read_length = file.ReadBytes(buffer, read_length);
+    }
     if (is_encrypted) {
         CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
         d.Seek(crypto_offset + offset);
-        d.ProcessData(buffer, buffer, read_length);
+        d.ProcessData(buffer, source, read_length);
+    }
+    return read_length;
+}
+
+DirectRomFSReader::CacheBlock& DirectRomFSReader::AllocateBlock(u64 index) {
+    CacheBlock* block;
+    if (cache.size() < CacheMaxBlocks) {
+        block = &cache.emplace_back();
+    } else {
+        block = &*std::min_element(cache.begin(), cache.end(), [](const auto& a, const auto& b) {
+            return a.last_used < b.last_used;
+        });
+    }
+    block->index = index;
+    block->last_used = ++cache_tick;
+    return *block;
+}
+
+const DirectRomFSReader::CacheBlock& DirectRomFSReader::GetBlock(u64 index, bool read_ahead) {
+    const auto it = std::find_if(cache.begin(), cache.end(),
+                                 [index](const auto& block) { return block.index == index; });
+    if (it != cache.end()) {
+        it->last_used = ++cache_tick;
+        return *it;
+    }
+
+    const u64 num_blocks = (data_size + CacheBlockSize - 1) / CacheBlockSize;
+    const bool load_next =
+        read_ahead && index + 1 < num_blocks &&
+        std::none_of(cache.begin(), cache.end(),
+                     [index](const auto& block) { return block.index == index + 1; });
+
+    // Read both blocks with a single host read and decryption pass.
+    std::vector<u8> data((load_next ? 2 : 1) * CacheBlockSize);
+    data.resize(ReadDirect(index * CacheBlockSize, data.size(), data.data()));
+
+    if (load_next && data.size() > CacheBlockSize) {
+        auto& next = AllocateBlock(index + 1);
+        next.data.assign(data.begin() + CacheBlockSize, data.end());
+        data.resize(CacheBlockSize);
+    }
+
+    auto& block = AllocateBlock(index);
+    block.data = std::move(data);
+    return block;
+}
+
+std::size_t DirectRomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
+    if (offset >= data_size)
+        return 0;
+    length = std::min(length, static_cast<std::size_t>(data_size) - offset);
+
+    std::scoped_lock lock{mutex};
+
+    // Large reads gain nothing from the cache and would only evict useful blocks. Unencrypted
+    // mapped data is already as cheap to read as the cache.
+    if (length >= CacheBlockSize || (mapping.IsMapped() && !is_encrypted)) {
+        last_read_end = offset + length;
+        return ReadDirect(offset, length, buffer);
+    }
+
+    const bool sequential = offset == last_read_end;
+    std::size_t read_length = 0;
+    while (read_length < length) {
+        const u64 position = offset + read_length;
+        const auto& block = GetBlock(position / CacheBlockSize, sequential);
+        const std::size_t block_offset = position % CacheBlockSize;
+        if (block_offset >= block.data.size())
+            break; // The host file is shorter than expected
+        const std::size_t to_copy =
+            std::min(length - read_length, block.data.size() - block_offset);
+        std::memcpy(buffer + read_length, block.data.data() + block_offset, to_copy);
+        read_length += to_copy;
     }
+    last_read_end = offset + read_length;
     return read_length;
 }
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <array>
+#include <mutex>
+#include <vector>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
@@ -10,7 +12,8 @@
 namespace FileSys {
 
 /**
- * Interface for reading RomFS data.
+ * Interface for reading RomFS data. A reader is shared by all the files opened from its RomFS, so
+ * ReadFile may be called from several threads.
  */
 class RomFSReader {
 public:
@@ -27,18 +30,24 @@ private:
 
 /**
  * A RomFS reader that directly reads the RomFS file.
+ *
+ * Small reads are served from a cache of aligned, already decrypted blocks, so that titles issuing
+ * many small reads to the same region don't hit the host file and the decryption each time.
+ * Sequential access additionally reads the following block ahead.
+ * When the host file can be memory-mapped, data is read from the mapping instead, and unencrypted
+ * reads skip the cache altogether.
  */
 class DirectRomFSReader : public RomFSReader {
 public:
     DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
-        : is_encrypted(false), file(std::move(file)), file_offset(file_offset),
-          data_size(data_size) {}
+        : is_encrypted(false), file(std::move(file)), mapping(this->file),
+          file_offset(file_offset), data_size(data_size) {}
 
     DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
                       const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
                       std::size_t crypto_offset)
-        : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
-          crypto_offset(crypto_offset), data_size(data_size) {}
+        : is_encrypted(true), file(std::move(file)), mapping(this->file), key(key), ctr(ctr),
+          file_offset(file_offset), crypto_offset(crypto_offset), data_size(data_size) {}
 
     ~DirectRomFSReader() override = default;
 
@@ -49,14 +58,38 @@ public:
     std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer) override;
 
 private:
+    static constexpr std::size_t CacheBlockSize = 0x10000;
+    static constexpr std::size_t CacheMaxBlocks = 16;
+
+    struct CacheBlock {
+        u64 index;
+        u64 last_used;
+        std::vector<u8> data; // May be shorter than CacheBlockSize for the last block
+    };
+
+    /// Reads and decrypts data into buffer, bypassing the cache.
+    std::size_t ReadDirect(std::size_t offset, std::size_t length, u8* buffer);
+
+    /// Returns the cached block with the given index, loading it (and maybe its successor).
+    const CacheBlock& GetBlock(u64 index, bool read_ahead);
+
+    /// Returns a cache slot to load a new block into, evicting the least recently used one.
+    CacheBlock& AllocateBlock(u64 index);
+
     bool is_encrypted;
     FileUtil::IOFile file;
+    FileUtil::MappedFile mapping;
     std::array<u8, 16> key;
     std::array<u8, 16> ctr;
     u64 file_offset;
     u64 crypto_offset;
     u64 data_size;
 
+    std::mutex mutex; ///< Guards the file position and the cache
+    std::vector<CacheBlock> cache;
+    u64 cache_tick{};
+    u64 last_read_end{};
+
     DirectRomFSReader() = default;
 
     template <class Archive>
@@ -69,6 +102,9 @@ private:
         ar& file_offset;
         ar& crypto_offset;
         ar& data_size;
+        if (Archive::is_loading::value) {
+            mapping.Map(file);
+        }
     }
     friend class boost::serialization::access;
 };
@@ -8,6 +8,7 @@
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/scm_rev.h"
+#include "common/tracing.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -2321,6 +2322,7 @@ MICROPROFILE_DEFINE(Kernel_SVC, "Kernel", "SVC", MP_RGB(70, 200, 70));
 
 void SVC::CallSVC(u32 immediate) {
     MICROPROFILE_SCOPE(Kernel_SVC);
+    Core::PerfStats::ScopedComponent component{Core::PerfStats::Component::Hle};
 
     // Lock the global kernel mutex when we enter the kernel HLE.
     std::lock_guard lock{HLE::g_hle_lock};
@@ -2331,8 +2333,16 @@ void SVC::CallSVC(u32 immediate) {
     const FunctionDef* info = GetSVCInfo(immediate);
     LOG_TRACE(Kernel_SVC, "calling {}", info->name);
     if (info) {
+        CITRA_TRACE_SCOPE("SVC", info->name);
         if (info->func) {
+            const bool record_stats = system.hle_stats.IsEnabled();
+            const auto start =
+                record_stats ? Core::HLEStats::Clock::now() : Core::HLEStats::Clock::time_point{};
             (this->*(info->func))();
+            if (record_stats) {
+                system.hle_stats.RecordSVC(immediate, info->name,
+                                           Core::HLEStats::Clock::now() - start);
+            }
         } else {
             LOG_ERROR(Kernel_SVC, "unimplemented SVC function {}(..)", info->name);
         }
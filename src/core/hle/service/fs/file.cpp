@@ -5,6 +5,7 @@
 #include <boost/serialization/unique_ptr.hpp>
 #include "common/archives.h"
 #include "common/logging/log.h"
+#include "common/thread_worker.h"
 #include "core/core.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/file_backend.h"
@@ -17,11 +18,75 @@
 
 SERIALIZE_EXPORT_IMPL(Service::FS::File)
 SERIALIZE_EXPORT_IMPL(Service::FS::FileSessionSlot)
+SERIALIZE_EXPORT_IMPL(Service::FS::File::ThreadCallback)
 
 namespace Service::FS {
 
+namespace {
+/**
+ * Host thread servicing guest file reads, so that slow host storage doesn't stall emulation.
+ * There is only one, which keeps reads in submission order. The emulation thread may access the
+ * same backends meanwhile, through other files or services, so the backends and the RomFS readers
+ * they share guard their state themselves.
+ */
+Common::ThreadWorker& GetIOWorker() {
+    static Common::ThreadWorker worker(1, "FS I/O");
+    return worker;
+}
+} // Anonymous namespace
+
+class File::ThreadCallback : public Kernel::HLERequestContext::WakeupCallback {
+public:
+    ThreadCallback(std::shared_future<AsyncReadResult> future_, u32 buffer_id_)
+        : future(std::move(future_)), buffer_id(buffer_id_) {}
+
+    void WakeUp(std::shared_ptr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
+                Kernel::ThreadWakeupReason reason) override {
+        // The emulated delay has passed, but the host read might still be in progress.
+        const AsyncReadResult& result = GetResult();
+        auto& buffer = ctx.GetMappedBuffer(buffer_id);
+
+        IPC::RequestBuilder rb(ctx, 0x0802, 2, 2);
+        if (result.code.IsError()) {
+            rb.Push(result.code);
+            rb.Push<u32>(0);
+        } else {
+            buffer.Write(result.data.data(), 0, result.data.size());
+            rb.Push(RESULT_SUCCESS);
+            rb.Push<u32>(static_cast<u32>(result.data.size()));
+        }
+        rb.PushMappedBuffer(buffer);
+    }
+
+private:
+    ThreadCallback() = default;
+
+    const AsyncReadResult& GetResult() {
+        if (future.valid()) {
+            result = future.get();
+            future = {};
+        }
+        return result;
+    }
+
+    std::shared_future<AsyncReadResult> future;
+    AsyncReadResult result;
+    u32 buffer_id;
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        // Savestates can't hold the host read, so wait for it and store its result instead.
+        GetResult();
+        ar& boost::serialization::base_object<Kernel::HLERequestContext::WakeupCallback>(*this);
+        ar& result;
+        ar& buffer_id;
+    }
+    friend class boost::serialization::access;
+};
+
 template <class Archive>
 void File::serialize(Archive& ar, const unsigned int) {
+    WaitForPendingRead();
     ar& boost::serialization::base_object<Kernel::SessionRequestHandler>(*this);
     ar& path;
     ar& backend;
@@ -53,6 +118,13 @@ File::File(Kernel::KernelSystem& kernel)
     RegisterHandlers(functions);
 }
 
+void File::WaitForPendingRead() {
+    if (pending_read.valid()) {
+        pending_read.wait();
+        pending_read = {};
+    }
+}
+
 void File::Read(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x0802, 3, 2);
     u64 offset = rp.Pop<u64>();
@@ -60,6 +132,8 @@ void File::Read(Kernel::HLERequestContext& ctx) {
     auto& buffer = rp.PopMappedBuffer();
     LOG_TRACE(Service_FS, "Read {}: offset=0x{:x} length=0x{:08X}", GetName(), offset, length);
 
+    WaitForPendingRead();
+
     const FileSessionSlot* file = GetSessionData(ctx.Session());
 
     if (file->subfile && length > file->size) {
@@ -76,22 +150,28 @@ void File::Read(Kernel::HLERequestContext& ctx) {
                   offset, length, backend->GetSize());
     }
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
-
-    std::vector<u8> data(length);
-    ResultVal<std::size_t> read = backend->Read(offset, data.size(), data.data());
-    if (read.Failed()) {
-        rb.Push(read.Code());
-        rb.Push<u32>(0);
-    } else {
-        buffer.Write(data.data(), 0, *read);
-        rb.Push(RESULT_SUCCESS);
-        rb.Push<u32>(static_cast<u32>(*read));
-    }
-    rb.PushMappedBuffer(buffer);
+    // Issue the host read to the I/O thread and let the guest thread sleep through the emulated
+    // delay meanwhile. The response is written once both are done, so guest timing doesn't depend
+    // on how fast the host storage is.
+    auto promise = std::make_shared<std::promise<AsyncReadResult>>();
+    pending_read = promise->get_future().share();
+    GetIOWorker().QueueWork([self = shared_from_this(), backend = backend.get(), promise, offset,
+                             length] {
+        AsyncReadResult result;
+        result.data.resize(length);
+        ResultVal<std::size_t> read = backend->Read(offset, length, result.data.data());
+        if (read.Failed()) {
+            result.code = read.Code();
+            result.data.clear();
+        } else {
+            result.data.resize(*read);
+        }
+        promise->set_value(std::move(result));
+    });
 
     std::chrono::nanoseconds read_timeout_ns{backend->GetReadDelayNs(length)};
-    ctx.SleepClientThread("file::read", read_timeout_ns, nullptr);
+    ctx.SleepClientThread("file::read", read_timeout_ns,
+                          std::make_shared<ThreadCallback>(pending_read, buffer.GetId()));
 }
 
 void File::Write(Kernel::HLERequestContext& ctx) {
@@ -103,6 +183,8 @@ void File::Write(Kernel::HLERequestContext& ctx) {
     LOG_TRACE(Service_FS, "Write {}: offset=0x{:x} length={}, flush=0x{:x}", GetName(), offset,
               length, flush);
 
+    WaitForPendingRead();
+
     IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
 
     FileSessionSlot* file = GetSessionData(ctx.Session());
@@ -135,6 +217,8 @@ void File::Write(Kernel::HLERequestContext& ctx) {
 void File::GetSize(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x0804, 0, 0);
 
+    WaitForPendingRead();
+
     const FileSessionSlot* file = GetSessionData(ctx.Session());
 
     IPC::RequestBuilder rb = rp.MakeBuilder(3, 0);
@@ -146,6 +230,8 @@ void File::SetSize(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x0805, 2, 0);
     u64 size = rp.Pop<u64>();
 
+    WaitForPendingRead();
+
     FileSessionSlot* file = GetSessionData(ctx.Session());
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
@@ -164,6 +250,8 @@ void File::SetSize(Kernel::HLERequestContext& ctx) {
 void File::Close(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x0808, 0, 0);
 
+    WaitForPendingRead();
+
     // TODO(Subv): Only close the backend if this client is the only one left.
     if (connected_sessions.size() > 1)
         LOG_WARNING(Service_FS, "Closing File backend but {} clients still connected",
@@ -177,6 +265,8 @@ void File::Close(Kernel::HLERequestContext& ctx) {
 void File::Flush(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x0809, 0, 0);
 
+    WaitForPendingRead();
+
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
 
     const FileSessionSlot* file = GetSessionData(ctx.Session());
@@ -215,6 +305,8 @@ void File::OpenLinkFile(Kernel::HLERequestContext& ctx) {
     using Kernel::ClientSession;
     using Kernel::ServerSession;
     IPC::RequestParser rp(ctx, 0x080C, 0, 0);
+    WaitForPendingRead();
+
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
     auto [server, client] = kernel.CreateSessionPair(GetName());
     ClientConnected(server);
@@ -236,6 +328,8 @@ void File::OpenSubFile(Kernel::HLERequestContext& ctx) {
     s64 offset = rp.PopRaw<s64>();
     s64 size = rp.PopRaw<s64>();
 
+    WaitForPendingRead();
+
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
 
     const FileSessionSlot* original_file = GetSessionData(ctx.Session());
@@ -276,6 +370,8 @@ void File::OpenSubFile(Kernel::HLERequestContext& ctx) {
 }
 
 std::shared_ptr<Kernel::ClientSession> File::Connect() {
+    WaitForPendingRead();
+
     auto [server, client] = kernel.CreateSessionPair(GetName());
     ClientConnected(server);
 
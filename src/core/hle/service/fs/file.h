@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
+#include <vector>
 #include <boost/serialization/base_object.hpp>
 #include "core/file_sys/archive_backend.h"
 #include "core/global.h"
@@ -43,6 +45,8 @@ public:
          const FileSys::Path& path);
     ~File() = default;
 
+    class ThreadCallback;
+
     std::string GetName() const {
         return "Path: " + path.DebugStr();
     }
@@ -62,6 +66,23 @@ public:
     std::size_t GetSessionFileSize(std::shared_ptr<Kernel::ServerSession> session);
 
 private:
+    /// Result of a read performed on the host I/O thread.
+    struct AsyncReadResult {
+        ResultCode code = RESULT_SUCCESS;
+        std::vector<u8> data;
+
+    private:
+        template <class Archive>
+        void serialize(Archive& ar, const unsigned int) {
+            ar& code.raw;
+            ar& data;
+        }
+        friend class boost::serialization::access;
+    };
+
+    /// Waits for the read in flight on the host I/O thread, if any, to finish.
+    void WaitForPendingRead();
+
     void Read(Kernel::HLERequestContext& ctx);
     void Write(Kernel::HLERequestContext& ctx);
     void GetSize(Kernel::HLERequestContext& ctx);
@@ -75,6 +96,10 @@ private:
 
     Kernel::KernelSystem& kernel;
 
+    /// Read currently being serviced by the host I/O thread. Other requests on this file wait for
+    /// it, as file backends are not thread-safe.
+    std::shared_future<AsyncReadResult> pending_read;
+
     File(Kernel::KernelSystem& kernel);
     File();
 
@@ -87,3 +112,4 @@ private:
 
 BOOST_CLASS_EXPORT_KEY(Service::FS::FileSessionSlot)
 BOOST_CLASS_EXPORT_KEY(Service::FS::File)
+BOOST_CLASS_EXPORT_KEY(Service::FS::File::ThreadCallback)
@@ -6,6 +6,7 @@
 #include <fmt/format.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/tracing.h"
 #include "core/core.h"
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/client_port.h"
@@ -181,7 +182,16 @@ void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context)
 
     LOG_TRACE(Service, "{}",
               MakeFunctionString(info->name, GetServiceName(), context.CommandBuffer()));
+    CITRA_TRACE_SCOPE("IPC", info->name);
+    auto& hle_stats = Core::System::GetInstance().hle_stats;
+    const bool record_stats = hle_stats.IsEnabled();
+    const auto start =
+        record_stats ? Core::HLEStats::Clock::now() : Core::HLEStats::Clock::time_point{};
     handler_invoker(this, info->handler_callback, context);
+    if (record_stats) {
+        hle_stats.RecordIPC(this, service_name, header_code, info->name,
+                            Core::HLEStats::Clock::now() - start);
+    }
 }
 
 std::string ServiceFrameworkBase::GetFunctionName(u32 header) const {
@@ -0,0 +1,127 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+#include <fmt/format.h>
+#include "core/hle_stats.h"
+
+namespace Core {
+
+std::size_t HLEStats::Histogram::GetBucket(u64 value_ns) {
+    if (value_ns < LinearBuckets) {
+        return static_cast<std::size_t>(value_ns);
+    }
+    const std::size_t exponent = 63 - std::countl_zero(value_ns);
+    const std::size_t sub_bucket =
+        static_cast<std::size_t>(value_ns >> (exponent - SubBucketBits)) &
+        ((1 << SubBucketBits) - 1);
+    return LinearBuckets + ((exponent - SubBucketBits - 1) << SubBucketBits) + sub_bucket;
+}
+
+u64 HLEStats::Histogram::GetBucketLowerBound(std::size_t bucket) {
+    if (bucket < LinearBuckets) {
+        return bucket;
+    }
+    const std::size_t exponent = ((bucket - LinearBuckets) >> SubBucketBits) + SubBucketBits + 1;
+    const u64 sub_bucket = (bucket - LinearBuckets) & ((1 << SubBucketBits) - 1);
+    return ((1ULL << SubBucketBits) | sub_bucket) << (exponent - SubBucketBits);
+}
+
+void HLEStats::Histogram::Record(u64 value_ns) {
+    ++buckets[GetBucket(value_ns)];
+    ++count;
+    total_ns += value_ns;
+    max_ns = std::max(max_ns, value_ns);
+}
+
+u64 HLEStats::Histogram::GetPercentile(double fraction) const {
+    const u64 target = static_cast<u64>(fraction * static_cast<double>(count));
+    u64 seen = 0;
+    for (std::size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+        seen += buckets[bucket];
+        if (seen > target) {
+            return GetBucketLowerBound(bucket);
+        }
+    }
+    return max_ns;
+}
+
+void HLEStats::RecordSVC(u32 svc_number, const char* name, Clock::duration time) {
+    const u64 time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+    std::scoped_lock lock{mutex};
+    auto [it, inserted] = svc_entries.try_emplace(svc_number);
+    if (inserted) {
+        it->second.name = name;
+    }
+    it->second.histogram.Record(time_ns);
+}
+
+void HLEStats::RecordIPC(const void* service, const std::string& service_name, u32 header,
+                         const char* name, Clock::duration time) {
+    const u64 time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+    std::scoped_lock lock{mutex};
+    auto [it, inserted] = ipc_entries.try_emplace({service, header >> 16});
+    if (inserted) {
+        it->second.name = fmt::format("{}::{}", service_name, name);
+    }
+    it->second.histogram.Record(time_ns);
+}
+
+void HLEStats::EndFrame() {
+    if (!IsEnabled()) {
+        return;
+    }
+    std::scoped_lock lock{mutex};
+    ++frames;
+}
+
+void HLEStats::Reset() {
+    std::scoped_lock lock{mutex};
+    svc_entries.clear();
+    ipc_entries.clear();
+    frames = 0;
+}
+
+std::string HLEStats::GetReport() const {
+    struct Row {
+        const char* kind;
+        u32 id;
+        const Entry* entry;
+    };
+
+    std::scoped_lock lock{mutex};
+    std::vector<Row> rows;
+    rows.reserve(svc_entries.size() + ipc_entries.size());
+    for (const auto& [svc_number, entry] : svc_entries) {
+        rows.push_back({"svc", svc_number, &entry});
+    }
+    for (const auto& [key, entry] : ipc_entries) {
+        rows.push_back({"ipc", key.second, &entry});
+    }
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+        return a.entry->histogram.total_ns > b.entry->histogram.total_ns;
+    });
+
+    const auto to_us = [](u64 ns) { return static_cast<double>(ns) / 1000.0; };
+    const double frame_count = static_cast<double>(std::max<u64>(frames, 1));
+    std::string report = fmt::format("# frames={}\n", frames);
+    report += "kind,id,name,calls,calls_per_frame,total_us,us_per_frame,mean_us,p50_us,p90_us,"
+              "p99_us,max_us\n";
+    for (const Row& row : rows) {
+        const Histogram& histogram = row.entry->histogram;
+        report += fmt::format(
+            "{},0x{:X},{},{},{:.2f},{:.1f},{:.2f},{:.2f},{:.2f},{:.2f},{:.2f},{:.2f}\n", row.kind,
+            row.id, row.entry->name, histogram.count,
+            static_cast<double>(histogram.count) / frame_count, to_us(histogram.total_ns),
+            to_us(histogram.total_ns) / frame_count,
+            to_us(histogram.total_ns) / static_cast<double>(histogram.count),
+            to_us(histogram.GetPercentile(0.5)), to_us(histogram.GetPercentile(0.9)),
+            to_us(histogram.GetPercentile(0.99)), to_us(histogram.max_ns));
+    }
+    return report;
+}
+
+} // namespace Core
@@ -0,0 +1,105 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include "common/common_types.h"
+
+namespace Core {
+
+/**
+ * Counts calls to each SVC and HLE IPC command and records how much host time they take, to find
+ * which HLE services a title spends its time in. Recording is off until SetEnabled is called,
+ * callers check IsEnabled before timing a call. All public functions of this class are
+ * thread-safe.
+ */
+class HLEStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Latency histogram with logarithmic buckets, each split linearly into 8 sub-buckets, so that
+     * every recorded value is within 12.5% of its bucket's lower bound.
+     */
+    class Histogram {
+    public:
+        void Record(u64 value_ns);
+
+        /// Returns the lower bound of the bucket that contains the given fraction of values
+        u64 GetPercentile(double fraction) const;
+
+        /// Returns the index of the bucket the value is counted in
+        static std::size_t GetBucket(u64 value_ns);
+
+        /// Returns the smallest value counted in the bucket
+        static u64 GetBucketLowerBound(std::size_t bucket);
+
+        static constexpr std::size_t SubBucketBits = 3;
+        static constexpr std::size_t LinearBuckets = 2 << SubBucketBits;
+        static constexpr std::size_t NumBuckets =
+            LinearBuckets + (64 - SubBucketBits - 1) * (1 << SubBucketBits);
+
+        u64 count = 0;
+        u64 total_ns = 0;
+        u64 max_ns = 0;
+
+    private:
+        std::array<u32, NumBuckets> buckets{};
+    };
+
+    /// Starts or stops recording. Statistics recorded so far are kept.
+    void SetEnabled(bool enabled_) {
+        enabled.store(enabled_, std::memory_order_relaxed);
+    }
+
+    /// Returns true if calls should be timed and recorded
+    bool IsEnabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /// Records a call to an SVC
+    void RecordSVC(u32 svc_number, const char* name, Clock::duration time);
+
+    /**
+     * Records a call to an HLE IPC command.
+     * @param service Identifies the service, usually the service object itself
+     * @param service_name Name of the service, only read the first time the command is recorded
+     * @param header Command header, whose upper 16 bits are the command ID
+     */
+    void RecordIPC(const void* service, const std::string& service_name, u32 header,
+                   const char* name, Clock::duration time);
+
+    /// Marks the end of an emulated frame, for the per frame averages
+    void EndFrame();
+
+    /// Clears all statistics
+    void Reset();
+
+    /**
+     * Returns the statistics as CSV, with one line per SVC and IPC command sorted by the total
+     * time spent in them. Times are in microseconds.
+     */
+    std::string GetReport() const;
+
+private:
+    struct Entry {
+        std::string name;
+        Histogram histogram;
+    };
+
+    std::atomic_bool enabled{false};
+    mutable std::mutex mutex;
+    std::map<u32, Entry> svc_entries;
+    std::map<std::pair<const void*, u32>, Entry> ipc_entries;
+    u64 frames = 0;
+};
+
+} // namespace Core
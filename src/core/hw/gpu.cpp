@@ -2,14 +2,21 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <numeric>
+#include <span>
+#include <thread>
 #include <type_traits>
+#include <vector>
 #include "common/alignment.h"
+#include "common/arch.h"
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/thread_worker.h"
 #include "common/vector_math.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -20,11 +27,18 @@
 #include "core/tracer/recorder.h"
 #include "video_core/command_processor.h"
 #include "video_core/debug_utils/debug_utils.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
 #include "video_core/utils.h"
 #include "video_core/video_core.h"
 
+#if CITRA_ARCH(x86_64)
+#include <emmintrin.h>
+#elif CITRA_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
 namespace GPU {
 
 Regs g_regs;
@@ -44,35 +58,83 @@ inline void Read(T& var, const u32 raw_addr) {
         return;
     }
 
+    if (VideoCore::g_gpu_thread) {
+        VideoCore::g_gpu_thread->Synchronize();
+    }
+
     var = g_regs[addr / 4];
 }
 
-static Common::Vec4<u8> DecodePixel(Regs::PixelFormat input_format, const u8* src_pixel) {
-    switch (input_format) {
-    case Regs::PixelFormat::RGBA8:
+template <Regs::PixelFormat format>
+static Common::Vec4<u8> DecodePixel(const u8* src_pixel) {
+    if constexpr (format == Regs::PixelFormat::RGBA8) {
         return Common::Color::DecodeRGBA8(src_pixel);
-
-    case Regs::PixelFormat::RGB8:
+    } else if constexpr (format == Regs::PixelFormat::RGB8) {
         return Common::Color::DecodeRGB8(src_pixel);
-
-    case Regs::PixelFormat::RGB565:
+    } else if constexpr (format == Regs::PixelFormat::RGB565) {
         return Common::Color::DecodeRGB565(src_pixel);
-
-    case Regs::PixelFormat::RGB5A1:
+    } else if constexpr (format == Regs::PixelFormat::RGB5A1) {
         return Common::Color::DecodeRGB5A1(src_pixel);
-
-    case Regs::PixelFormat::RGBA4:
+    } else {
         return Common::Color::DecodeRGBA4(src_pixel);
+    }
+}
+
+template <Regs::PixelFormat format>
+static void EncodePixel(const Common::Vec4<u8>& color, u8* dst_pixel) {
+    if constexpr (format == Regs::PixelFormat::RGBA8) {
+        Common::Color::EncodeRGBA8(color, dst_pixel);
+    } else if constexpr (format == Regs::PixelFormat::RGB8) {
+        Common::Color::EncodeRGB8(color, dst_pixel);
+    } else if constexpr (format == Regs::PixelFormat::RGB565) {
+        Common::Color::EncodeRGB565(color, dst_pixel);
+    } else if constexpr (format == Regs::PixelFormat::RGB5A1) {
+        Common::Color::EncodeRGB5A1(color, dst_pixel);
+    } else {
+        Common::Color::EncodeRGBA4(color, dst_pixel);
+    }
+}
 
+static bool IsValidTransferFormat(Regs::PixelFormat format) {
+    switch (format) {
+    case Regs::PixelFormat::RGBA8:
+    case Regs::PixelFormat::RGB8:
+    case Regs::PixelFormat::RGB565:
+    case Regs::PixelFormat::RGB5A1:
+    case Regs::PixelFormat::RGBA4:
+        return true;
     default:
-        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}", input_format);
-        return {0, 0, 0, 0};
+        return false;
     }
 }
 
 MICROPROFILE_DEFINE(GPU_DisplayTransfer, "GPU", "DisplayTransfer", MP_RGB(100, 100, 255));
 MICROPROFILE_DEFINE(GPU_CmdlistProcessing, "GPU", "Cmdlist Processing", MP_RGB(100, 255, 100));
 
+/**
+ * Fills size bytes at dest with repeated copies of pattern, where size is a multiple of the
+ * pattern size. Instead of storing the pattern value by value, the filled part is copied over
+ * the rest in blocks of doubling size.
+ */
+static void FillPattern(u8* dest, std::size_t size, std::span<const u8> pattern) {
+    if (size == 0) {
+        return;
+    }
+
+    if (std::all_of(pattern.begin(), pattern.end(), [&](u8 byte) { return byte == pattern[0]; })) {
+        std::memset(dest, pattern[0], size);
+        return;
+    }
+
+    std::memcpy(dest, pattern.data(), pattern.size());
+    std::size_t filled = pattern.size();
+    while (filled < size) {
+        const std::size_t chunk = std::min(filled, size - filled);
+        std::memcpy(dest + filled, dest, chunk);
+        filled += chunk;
+    }
+}
+
 static void MemoryFill(const Regs::MemoryFillConfig& config) {
     const PAddr start_addr = config.GetStartAddress();
     const PAddr end_addr = config.GetEndAddress();
@@ -105,27 +167,276 @@ static void MemoryFill(const Regs::MemoryFillConfig& config) {
 
     if (config.fill_24bit) {
         // fill with 24-bit values
-        for (u8* ptr = start; ptr < end; ptr += 3) {
-            ptr[0] = config.value_24bit_r;
-            ptr[1] = config.value_24bit_g;
-            ptr[2] = config.value_24bit_b;
-        }
+        const std::array<u8, 3> value = {static_cast<u8>(config.value_24bit_r),
+                                         static_cast<u8>(config.value_24bit_g),
+                                         static_cast<u8>(config.value_24bit_b)};
+        // The last value may be cut off by the end of the range
+        FillPattern(start, Common::AlignUp<std::size_t>(end - start, 3), value);
     } else if (config.fill_32bit) {
         // fill with 32-bit values
-        if (end > start) {
-            u32 value = config.value_32bit;
-            std::size_t len = (end - start) / sizeof(u32);
-            for (std::size_t i = 0; i < len; ++i)
-                std::memcpy(&start[i * sizeof(u32)], &value, sizeof(u32));
-        }
+        const u32 value = config.value_32bit;
+        FillPattern(start, Common::AlignDown<std::size_t>(end - start, sizeof(u32)),
+                    {reinterpret_cast<const u8*>(&value), sizeof(value)});
     } else {
         // fill with 16-bit values
-        u16 value_16bit = config.value_16bit.Value();
-        for (u8* ptr = start; ptr < end; ptr += sizeof(u16))
-            std::memcpy(ptr, &value_16bit, sizeof(u16));
+        const u16 value = config.value_16bit.Value();
+        FillPattern(start, Common::AlignUp<std::size_t>(end - start, sizeof(u16)),
+                    {reinterpret_cast<const u8*>(&value), sizeof(value)});
+    }
+}
+
+/**
+ * Converts a row of RGBA8 pixels to RGB8 by dropping the alpha byte of each pixel.
+ * @returns the number of pixels converted, the rest is left to the caller
+ */
+static u32 ConvertRowRGBA8ToRGB8(const u8* src, u8* dst, u32 width) {
+    u32 x = 0;
+#if CITRA_ARCH(x86_64)
+    const __m128i low_pixel_mask = _mm_set1_epi64x(0xFFFFFF);
+    const __m128i high_pixel_mask = _mm_set1_epi64x(0xFFFFFF000000);
+    // Each 8 byte store writes two bytes past the pixels it converts, which are overwritten by
+    // the next store or the caller. The last pixel is always left to the caller.
+    for (; x + 5 <= width; x += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+        // A, B, G, R -> B, G, R, 0
+        pixels = _mm_srli_epi32(pixels, 8);
+        // Pack the two pixels of each 64 bit half into its low 6 bytes
+        pixels = _mm_or_si128(_mm_and_si128(pixels, low_pixel_mask),
+                              _mm_and_si128(_mm_srli_epi64(pixels, 8), high_pixel_mask));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 3), pixels);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 3 + 6), _mm_srli_si128(pixels, 8));
+    }
+#elif CITRA_ARCH(arm64)
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16x4_t abgr = vld4q_u8(src + x * 4);
+        uint8x16x3_t bgr;
+        bgr.val[0] = abgr.val[1];
+        bgr.val[1] = abgr.val[2];
+        bgr.val[2] = abgr.val[3];
+        vst3q_u8(dst + x * 3, bgr);
+    }
+#endif
+    return x;
+}
+
+/**
+ * Converts a row of RGB8 pixels to RGBA8 with an opaque alpha.
+ * @returns the number of pixels converted, the rest is left to the caller
+ */
+static u32 ConvertRowRGB8ToRGBA8(const u8* src, u8* dst, u32 width) {
+    u32 x = 0;
+#if CITRA_ARCH(x86_64)
+    const __m128i low_pixel_mask = _mm_set1_epi64x(0xFFFFFF);
+    const __m128i high_pixel_mask = _mm_set1_epi64x(0xFFFFFF00000000);
+    const __m128i alpha = _mm_set1_epi32(0xFF);
+    // Each 16 byte load reads four bytes past the pixels it converts, so the last two pixels are
+    // always left to the caller
+    for (; x + 6 <= width; x += 4) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 3));
+        // Pixels 0 and 1 in the low 64 bit half, pixels 2 and 3 in the high one
+        const __m128i pairs = _mm_unpacklo_epi64(bytes, _mm_srli_si128(bytes, 6));
+        // Move the second pixel of each half to the upper 32 bits
+        const __m128i pixels =
+            _mm_or_si128(_mm_and_si128(pairs, low_pixel_mask),
+                         _mm_and_si128(_mm_slli_epi64(pairs, 8), high_pixel_mask));
+        // B, G, R, 0 -> A, B, G, R
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4),
+                         _mm_or_si128(_mm_slli_epi32(pixels, 8), alpha));
+    }
+#elif CITRA_ARCH(arm64)
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16x3_t bgr = vld3q_u8(src + x * 3);
+        uint8x16x4_t abgr;
+        abgr.val[0] = vdupq_n_u8(0xFF);
+        abgr.val[1] = bgr.val[0];
+        abgr.val[2] = bgr.val[1];
+        abgr.val[3] = bgr.val[2];
+        vst4q_u8(dst + x * 4, abgr);
+    }
+#endif
+    return x;
+}
+
+/// Converts a row of linearly stored pixels
+template <Regs::PixelFormat input_format, Regs::PixelFormat output_format>
+static void ConvertRow(const u8* src, u8* dst, u32 width) {
+    constexpr u32 src_bytes_per_pixel = Regs::BytesPerPixel(input_format);
+    constexpr u32 dst_bytes_per_pixel = Regs::BytesPerPixel(output_format);
+
+    u32 x = 0;
+    if constexpr (input_format == output_format) {
+        // Decoding and encoding a pixel in the same format is lossless
+        std::memcpy(dst, src, width * dst_bytes_per_pixel);
+        return;
+    } else if constexpr (input_format == Regs::PixelFormat::RGBA8 &&
+                         output_format == Regs::PixelFormat::RGB8) {
+        x = ConvertRowRGBA8ToRGB8(src, dst, width);
+    } else if constexpr (input_format == Regs::PixelFormat::RGB8 &&
+                         output_format == Regs::PixelFormat::RGBA8) {
+        x = ConvertRowRGB8ToRGBA8(src, dst, width);
+    }
+    for (; x < width; ++x) {
+        EncodePixel<output_format>(DecodePixel<input_format>(src + x * src_bytes_per_pixel),
+                                   dst + x * dst_bytes_per_pixel);
+    }
+}
+
+/// Offsets in pixels of the horizontally adjacent pixel pairs of a row within an 8x8 tile
+constexpr std::array<u32, 4> TilePairOffsets = {0, 4, 16, 20};
+
+/**
+ * Copies width pixels of row y of a tiled image to a linear row, or back when ToTiled is set.
+ * Within a tile, the pixels of a row are stored in pairs, which are copied together.
+ */
+template <bool ToTiled>
+static void CopyTiledRow(std::conditional_t<ToTiled, u8*, const u8*> tiled,
+                         std::conditional_t<ToTiled, const u8*, u8*> linear, u32 y,
+                         u32 image_width, u32 width, u32 bytes_per_pixel) {
+    const u32 row_offset = (y & ~7) * image_width * bytes_per_pixel;
+    for (u32 x = 0; x < width; x += 8) {
+        const u32 tile_offset = row_offset + VideoCore::GetMortonOffset(x, y, bytes_per_pixel);
+        for (u32 pair = 0; pair < TilePairOffsets.size() && x + 2 * pair < width; ++pair) {
+            const u32 size = std::min(2u, width - x - 2 * pair) * bytes_per_pixel;
+            const u32 pair_offset = tile_offset + TilePairOffsets[pair] * bytes_per_pixel;
+            const u32 linear_offset = (x + 2 * pair) * bytes_per_pixel;
+            if constexpr (ToTiled) {
+                std::memcpy(tiled + pair_offset, linear + linear_offset, size);
+            } else {
+                std::memcpy(linear + linear_offset, tiled + pair_offset, size);
+            }
+        }
+    }
+}
+
+/**
+ * Converts the output rows [y_begin, y_end) of a display transfer. The pixel formats are template
+ * parameters so that the inner loop doesn't have to dispatch on them for every pixel.
+ */
+template <Regs::PixelFormat input_format, Regs::PixelFormat output_format>
+static void TransferRows(const Regs::DisplayTransferConfig& config, const u8* src_pointer,
+                         u8* dst_pointer, u32 y_begin, u32 y_end) {
+    constexpr u32 src_bytes_per_pixel = Regs::BytesPerPixel(input_format);
+    constexpr u32 dst_bytes_per_pixel = Regs::BytesPerPixel(output_format);
+
+    const u32 horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    const u32 vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+    const u32 output_width = config.output_width >> horizontal_scale;
+    const u32 output_height = config.output_height >> vertical_scale;
+    const u32 input_width = config.input_width;
+    const bool src_tiled = config.input_linear == 0;
+    const bool dst_tiled = (config.input_linear != 0) != (config.dont_swizzle != 0);
+
+    if (config.scaling == config.NoScale) {
+        // Tiled rows are gathered into linear order first, so that whole rows are converted by
+        // the row kernels
+        std::vector<u8> src_row(src_tiled ? output_width * src_bytes_per_pixel : 0);
+        std::vector<u8> dst_row(dst_tiled ? output_width * dst_bytes_per_pixel : 0);
+        for (u32 y = y_begin; y < y_end; ++y) {
+            // Flip the y value of the output data
+            const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+
+            const u8* src = src_pointer + y * input_width * src_bytes_per_pixel;
+            if (src_tiled) {
+                CopyTiledRow<false>(src_pointer, src_row.data(), y, input_width, output_width,
+                                    src_bytes_per_pixel);
+                src = src_row.data();
+            }
+            u8* dst = dst_tiled ? dst_row.data()
+                                : dst_pointer + output_y * output_width * dst_bytes_per_pixel;
+            ConvertRow<input_format, output_format>(src, dst, output_width);
+            if (dst_tiled) {
+                CopyTiledRow<true>(dst_pointer, dst_row.data(), output_y, output_width,
+                                   output_width, dst_bytes_per_pixel);
+            }
+        }
+        return;
+    }
+
+    // Tiled images store 8 rows of pixels in each row of tiles
+    const auto tiled_offset = [](u32 x, u32 y, u32 width, u32 bytes_per_pixel) {
+        return VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
+               (y & ~7) * width * bytes_per_pixel;
+    };
+
+    // Downscaling is only implemented for tiled input
+    for (u32 y = y_begin; y < y_end; ++y) {
+        // Calculate the row of the input image based on the current output row and the scale
+        const u32 input_y = y << vertical_scale;
+
+        // Flip the y value of the output data, we do this after calculating the position in the
+        // input image to account for the scaling options.
+        const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+        const u32 dst_row_offset = output_y * output_width * dst_bytes_per_pixel;
+
+        for (u32 x = 0; x < output_width; ++x) {
+            const u32 input_x = x << horizontal_scale;
+            const u8* src_pixel =
+                src_pointer + tiled_offset(input_x, input_y, input_width, src_bytes_per_pixel);
+            u8* dst_pixel =
+                dst_pointer + (dst_tiled ? tiled_offset(x, output_y, output_width,
+                                                        dst_bytes_per_pixel)
+                                         : dst_row_offset + x * dst_bytes_per_pixel);
+
+            // Downscaled modes average 2x1 or 2x2 blocks, which are stored consecutively in
+            // tiled images
+            Common::Vec4<u8> src_color = DecodePixel<input_format>(src_pixel);
+            if (config.scaling == config.ScaleX) {
+                const auto pixel = DecodePixel<input_format>(src_pixel + src_bytes_per_pixel);
+                src_color = ((src_color + pixel) / 2).template Cast<u8>();
+            } else {
+                const auto pixel1 = DecodePixel<input_format>(src_pixel + 1 * src_bytes_per_pixel);
+                const auto pixel2 = DecodePixel<input_format>(src_pixel + 2 * src_bytes_per_pixel);
+                const auto pixel3 = DecodePixel<input_format>(src_pixel + 3 * src_bytes_per_pixel);
+                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).template Cast<u8>();
+            }
+
+            EncodePixel<output_format>(src_color, dst_pixel);
+        }
+    }
+}
+
+using TransferRowsFunc = void (*)(const Regs::DisplayTransferConfig&, const u8*, u8*, u32, u32);
+
+template <Regs::PixelFormat input_format>
+static TransferRowsFunc GetTransferRowsFunc(Regs::PixelFormat output_format) {
+    switch (output_format) {
+    case Regs::PixelFormat::RGBA8:
+        return &TransferRows<input_format, Regs::PixelFormat::RGBA8>;
+    case Regs::PixelFormat::RGB8:
+        return &TransferRows<input_format, Regs::PixelFormat::RGB8>;
+    case Regs::PixelFormat::RGB565:
+        return &TransferRows<input_format, Regs::PixelFormat::RGB565>;
+    case Regs::PixelFormat::RGB5A1:
+        return &TransferRows<input_format, Regs::PixelFormat::RGB5A1>;
+    default:
+        return &TransferRows<input_format, Regs::PixelFormat::RGBA4>;
+    }
+}
+
+static TransferRowsFunc GetTransferRowsFunc(const Regs::DisplayTransferConfig& config) {
+    switch (config.input_format) {
+    case Regs::PixelFormat::RGBA8:
+        return GetTransferRowsFunc<Regs::PixelFormat::RGBA8>(config.output_format);
+    case Regs::PixelFormat::RGB8:
+        return GetTransferRowsFunc<Regs::PixelFormat::RGB8>(config.output_format);
+    case Regs::PixelFormat::RGB565:
+        return GetTransferRowsFunc<Regs::PixelFormat::RGB565>(config.output_format);
+    case Regs::PixelFormat::RGB5A1:
+        return GetTransferRowsFunc<Regs::PixelFormat::RGB5A1>(config.output_format);
+    default:
+        return GetTransferRowsFunc<Regs::PixelFormat::RGBA4>(config.output_format);
     }
 }
 
+/// Minimum number of output pixels converted by one worker task
+constexpr u32 TransferTaskPixels = 0x10000;
+
+static Common::ThreadWorker& GetTransferWorkers() {
+    static Common::ThreadWorker workers(
+        std::max<std::size_t>(std::thread::hardware_concurrency(), 2) - 1, "DisplayTransfer");
+    return workers;
+}
+
 static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
     const PAddr src_addr = config.GetPhysicalInputAddress();
     const PAddr dst_addr = config.GetPhysicalOutputAddress();
@@ -193,113 +504,35 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
     Memory::RasterizerFlushRegion(config.GetPhysicalInputAddress(), input_size);
     Memory::RasterizerInvalidateRegion(config.GetPhysicalOutputAddress(), output_size);
 
-    for (u32 y = 0; y < output_height; ++y) {
-        for (u32 x = 0; x < output_width; ++x) {
-            Common::Vec4<u8> src_color;
-
-            // Calculate the [x,y] position of the input image
-            // based on the current output position and the scale
-            u32 input_x = x << horizontal_scale;
-            u32 input_y = y << vertical_scale;
-
-            u32 output_y;
-            if (config.flip_vertically) {
-                // Flip the y value of the output data,
-                // we do this after calculating the [x,y] position of the input image
-                // to account for the scaling options.
-                output_y = output_height - y - 1;
-            } else {
-                output_y = y;
-            }
-
-            u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
-            u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
-            u32 src_offset;
-            u32 dst_offset;
-
-            if (config.input_linear) {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as linear and the output as tiled
-                    u32 coarse_y = output_y & ~7;
-                    u32 stride = output_width * dst_bytes_per_pixel;
-
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 coarse_y * stride;
-                } else {
-                    // Both input and output are linear
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                }
-            } else {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as tiled and the output as linear
-                    u32 coarse_y = input_y & ~7;
-                    u32 stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 coarse_y * stride;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                } else {
-                    // Both input and output are tiled
-                    u32 out_coarse_y = output_y & ~7;
-                    u32 out_stride = output_width * dst_bytes_per_pixel;
-
-                    u32 in_coarse_y = input_y & ~7;
-                    u32 in_stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 in_coarse_y * in_stride;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 out_coarse_y * out_stride;
-                }
-            }
-
-            const u8* src_pixel = src_pointer + src_offset;
-            src_color = DecodePixel(config.input_format, src_pixel);
-            if (config.scaling == config.ScaleX) {
-                Common::Vec4<u8> pixel =
-                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
-                src_color = ((src_color + pixel) / 2).Cast<u8>();
-            } else if (config.scaling == config.ScaleXY) {
-                Common::Vec4<u8> pixel1 =
-                    DecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
-                Common::Vec4<u8> pixel2 =
-                    DecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
-                Common::Vec4<u8> pixel3 =
-                    DecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
-                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
-            }
-
-            u8* dst_pixel = dst_pointer + dst_offset;
-            switch (config.output_format) {
-            case Regs::PixelFormat::RGBA8:
-                Common::Color::EncodeRGBA8(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB8:
-                Common::Color::EncodeRGB8(src_color, dst_pixel);
-                break;
+    if (!IsValidTransferFormat(config.input_format)) {
+        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}",
+                  static_cast<u32>(config.input_format.Value()));
+        return;
+    }
 
-            case Regs::PixelFormat::RGB565:
-                Common::Color::EncodeRGB565(src_color, dst_pixel);
-                break;
+    if (!IsValidTransferFormat(config.output_format)) {
+        LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}",
+                  static_cast<u32>(config.output_format.Value()));
+        return;
+    }
 
-            case Regs::PixelFormat::RGB5A1:
-                Common::Color::EncodeRGB5A1(src_color, dst_pixel);
-                break;
+    const TransferRowsFunc convert_rows = GetTransferRowsFunc(config);
 
-            case Regs::PixelFormat::RGBA4:
-                Common::Color::EncodeRGBA4(src_color, dst_pixel);
-                break;
+    // Rows are independent of each other, so large transfers are split across worker threads
+    const u32 rows_per_task = std::max<u32>(8, TransferTaskPixels / output_width);
+    if (rows_per_task >= output_height) {
+        convert_rows(config, src_pointer, dst_pointer, 0, output_height);
+        return;
+    }
 
-            default:
-                LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}",
-                          static_cast<u32>(config.output_format.Value()));
-                break;
-            }
-        }
+    auto& workers = GetTransferWorkers();
+    for (u32 y = 0; y < output_height; y += rows_per_task) {
+        const u32 y_end = std::min(y + rows_per_task, output_height);
+        workers.QueueWork([&config, convert_rows, src_pointer, dst_pointer, y, y_end] {
+            convert_rows(config, src_pointer, dst_pointer, y, y_end);
+        });
     }
+    workers.WaitForRequests();
 }
 
 static void TextureCopy(const Regs::DisplayTransferConfig& config) {
@@ -395,6 +628,15 @@ inline void Write(u32 addr, const T data) {
         return;
     }
 
+    // The command list registers are only read on the emulation thread, so further command lists
+    // can be queued without waiting for the GPU thread.
+    const bool is_command_processor_reg =
+        index >= GPU_REG_INDEX(command_processor_config.size) &&
+        index <= GPU_REG_INDEX(command_processor_config.trigger);
+    if (VideoCore::g_gpu_thread && !is_command_processor_reg) {
+        VideoCore::g_gpu_thread->Synchronize();
+    }
+
     g_regs[index] = static_cast<u32>(data);
 
     switch (index) {
@@ -468,9 +710,14 @@ inline void Write(u32 addr, const T data) {
     case GPU_REG_INDEX(command_processor_config.trigger): {
         const auto& config = g_regs.command_processor_config;
         if (config.trigger & 1) {
-            MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
-
-            Pica::CommandProcessor::ProcessCommandList(config.GetPhysicalAddress(), config.size);
+            if (VideoCore::g_gpu_thread) {
+                VideoCore::g_gpu_thread->SubmitCommandList(config.GetPhysicalAddress(),
+                                                           config.size);
+            } else {
+                MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
+                Pica::CommandProcessor::ProcessCommandList(config.GetPhysicalAddress(),
+                                                           config.size);
+            }
 
             g_regs.command_processor_config.trigger = 0;
         }
@@ -504,6 +751,9 @@ template void Write<u8>(u32 addr, const u8 data);
 
 /// Update hardware
 static void VBlankCallback(std::uintptr_t user_data, s64 cycles_late) {
+    if (VideoCore::g_gpu_thread) {
+        VideoCore::g_gpu_thread->Synchronize();
+    }
     VideoCore::g_renderer->SwapBuffers();
 
     // Signal to GSP that GPU interrupt has occurred
@@ -58,7 +58,7 @@ struct Regs {
     /**
      * Returns the number of bytes per pixel.
      */
-    static int BytesPerPixel(PixelFormat format) {
+    static constexpr int BytesPerPixel(PixelFormat format) {
         switch (format) {
         case PixelFormat::RGBA8:
             return 4;
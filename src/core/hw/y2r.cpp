@@ -5,16 +5,26 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
-#include <memory>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "common/arch.h"
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "common/vector_math.h"
 #include "core/core.h"
 #include "core/hle/service/y2r_u.h"
 #include "core/hw/y2r.h"
 #include "core/memory.h"
 
+#if CITRA_ARCH(x86_64)
+#include <emmintrin.h>
+#elif CITRA_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
 namespace HW::Y2R {
 
 using namespace Service::Y2R;
@@ -23,59 +33,196 @@ static const std::size_t MAX_TILES = 1024 / 8;
 static const std::size_t TILE_SIZE = 8 * 8;
 using ImageTile = std::array<u32, TILE_SIZE>;
 
-/// Converts a image strip from the source YUV format into individual 8x8 RGB32 tiles.
-static void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u8* input_U,
-                            const u8* input_V, ImageTile output[], unsigned int width,
-                            unsigned int height, const CoefficientSet& coefficients) {
+/// Size in bytes of the buffer used as CDMA source/target for one strip of the given width
+static std::size_t StripBufferSize(std::size_t line_width) {
+    return line_width * 8 * 4;
+}
+
+/**
+ * Converts one line of YUV samples to RGB32. All sources are expanded to one sample per pixel
+ * beforehand, so the line can be converted eight pixels at a time with host SIMD instructions.
+ */
+static void ConvertLineToRGB(const s16* Y, const s16* U, const s16* V, u32* output,
+                             unsigned int width, const CoefficientSet& coefficients) {
+    const s32 c0 = coefficients[0];
+    const s32 c1 = coefficients[1];
+    const s32 c2 = coefficients[2];
+    const s32 c3 = coefficients[3];
+    const s32 c4 = coefficients[4];
+    // This conversion process is bit-exact with hardware, as far as could be tested.
+    const s32 rounding_offset = 0x18;
+    const s32 r_offset = coefficients[5] + rounding_offset;
+    const s32 g_offset = coefficients[6] + rounding_offset;
+    const s32 b_offset = coefficients[7] + rounding_offset;
+
+    unsigned int x = 0;
+
+#if CITRA_ARCH(x86_64)
+    // Each 32-bit lane holds a pair of 16-bit coefficients for _mm_madd_epi16. The samples are
+    // negated instead of the coefficients in the green channel, since samples can't overflow.
+    const auto coefficient_pair = [](s32 a, s32 b) {
+        return _mm_set1_epi32(static_cast<s32>(static_cast<u16>(a) |
+                                               (static_cast<u32>(static_cast<u16>(b)) << 16)));
+    };
+    const __m128i coef_YV_r = coefficient_pair(c0, c1);
+    const __m128i coef_YV_g = coefficient_pair(c0, c2);
+    const __m128i coef_U_g = coefficient_pair(c3, 0);
+    const __m128i coef_YU_b = coefficient_pair(c0, c4);
+    const __m128i offset_r = _mm_set1_epi32(r_offset);
+    const __m128i offset_g = _mm_set1_epi32(g_offset);
+    const __m128i offset_b = _mm_set1_epi32(b_offset);
+    const __m128i zero = _mm_setzero_si128();
+
+    const auto finish = [](__m128i value, __m128i offset) {
+        return _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(value, 3), offset), 5);
+    };
+
+    for (; x + 8 <= width; x += 8) {
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Y + x));
+        const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(U + x));
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(V + x));
+        const __m128i neg_u = _mm_sub_epi16(zero, u);
+        const __m128i neg_v = _mm_sub_epi16(zero, v);
+
+        const __m128i r_lo = finish(_mm_madd_epi16(_mm_unpacklo_epi16(y, v), coef_YV_r), offset_r);
+        const __m128i r_hi = finish(_mm_madd_epi16(_mm_unpackhi_epi16(y, v), coef_YV_r), offset_r);
+        const __m128i g_lo =
+            finish(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(y, neg_v), coef_YV_g),
+                                 _mm_madd_epi16(_mm_unpacklo_epi16(neg_u, zero), coef_U_g)),
+                   offset_g);
+        const __m128i g_hi =
+            finish(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(y, neg_v), coef_YV_g),
+                                 _mm_madd_epi16(_mm_unpackhi_epi16(neg_u, zero), coef_U_g)),
+                   offset_g);
+        const __m128i b_lo = finish(_mm_madd_epi16(_mm_unpacklo_epi16(y, u), coef_YU_b), offset_b);
+        const __m128i b_hi = finish(_mm_madd_epi16(_mm_unpackhi_epi16(y, u), coef_YU_b), offset_b);
+
+        // Saturating packs clamp the channels to [0, 255]
+        const __m128i r = _mm_packus_epi16(_mm_packs_epi32(r_lo, r_hi), zero);
+        const __m128i g = _mm_packus_epi16(_mm_packs_epi32(g_lo, g_hi), zero);
+        const __m128i b = _mm_packus_epi16(_mm_packs_epi32(b_lo, b_hi), zero);
+
+        const __m128i b_shifted = _mm_unpacklo_epi8(zero, b);
+        const __m128i gr = _mm_unpacklo_epi8(g, r);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + x),
+                         _mm_unpacklo_epi16(b_shifted, gr));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + x + 4),
+                         _mm_unpackhi_epi16(b_shifted, gr));
+    }
+#elif CITRA_ARCH(arm64)
+    const int32x4_t offset_r = vdupq_n_s32(r_offset);
+    const int32x4_t offset_g = vdupq_n_s32(g_offset);
+    const int32x4_t offset_b = vdupq_n_s32(b_offset);
+
+    const auto finish = [](int32x4_t value, int32x4_t offset) {
+        return vshrq_n_s32(vaddq_s32(vshrq_n_s32(value, 3), offset), 5);
+    };
+    // Saturating narrows clamp the channels to [0, 255]
+    const auto narrow = [](int32x4_t lo, int32x4_t hi) {
+        return vqmovn_u16(vcombine_u16(vqmovun_s32(lo), vqmovun_s32(hi)));
+    };
+    const auto convert = [&](int16x4_t y, int16x4_t u, int16x4_t v, int32x4_t& r, int32x4_t& g,
+                             int32x4_t& b) {
+        const int32x4_t cY = vmull_n_s16(y, static_cast<s16>(c0));
+        r = finish(vmlal_n_s16(cY, v, static_cast<s16>(c1)), offset_r);
+        g = finish(vmlsl_n_s16(vmlsl_n_s16(cY, v, static_cast<s16>(c2)), u, static_cast<s16>(c3)),
+                   offset_g);
+        b = finish(vmlal_n_s16(cY, u, static_cast<s16>(c4)), offset_b);
+    };
+
+    for (; x + 8 <= width; x += 8) {
+        const int16x8_t y = vld1q_s16(Y + x);
+        const int16x8_t u = vld1q_s16(U + x);
+        const int16x8_t v = vld1q_s16(V + x);
+
+        int32x4_t r_lo, g_lo, b_lo, r_hi, g_hi, b_hi;
+        convert(vget_low_s16(y), vget_low_s16(u), vget_low_s16(v), r_lo, g_lo, b_lo);
+        convert(vget_high_s16(y), vget_high_s16(u), vget_high_s16(v), r_hi, g_hi, b_hi);
+
+        uint8x8x4_t pixels;
+        pixels.val[0] = vdup_n_u8(0);
+        pixels.val[1] = narrow(b_lo, b_hi);
+        pixels.val[2] = narrow(g_lo, g_hi);
+        pixels.val[3] = narrow(r_lo, r_hi);
+        vst4_u8(reinterpret_cast<u8*>(output + x), pixels);
+    }
+#endif
+
+    for (; x < width; ++x) {
+        const s32 cY = c0 * Y[x];
+
+        const s32 r = ((cY + c1 * V[x]) >> 3) + r_offset;
+        const s32 g = ((cY - c2 * V[x] - c3 * U[x]) >> 3) + g_offset;
+        const s32 b = ((cY + c4 * U[x]) >> 3) + b_offset;
+
+        output[x] = (static_cast<u32>(std::clamp(r >> 5, 0, 0xFF)) << 24) |
+                    (static_cast<u32>(std::clamp(g >> 5, 0, 0xFF)) << 16) |
+                    (static_cast<u32>(std::clamp(b >> 5, 0, 0xFF)) << 8);
+    }
+}
+
+/**
+ * Converts a image strip from the source YUV format into individual 8x8 RGB32 tiles. 16-bit input
+ * formats have already been narrowed to 8-bit by ReceiveData, so they share the code of the
+ * matching 8-bit format.
+ */
+template <InputFormat input_format>
+static void ConvertYUVToRGB(const u8* input_Y, const u8* input_U, const u8* input_V,
+                            ImageTile output[], unsigned int width, unsigned int height,
+                            const CoefficientSet& coefficients) {
+    std::array<s16, MAX_TILES * 8> Y;
+    std::array<s16, MAX_TILES * 8> U;
+    std::array<s16, MAX_TILES * 8> V;
+    std::array<u32, MAX_TILES * 8> line;
 
     for (unsigned int y = 0; y < height; ++y) {
-        for (unsigned int x = 0; x < width; ++x) {
-            s32 Y = 0;
-            s32 U = 0;
-            s32 V = 0;
-            switch (input_format) {
-            case InputFormat::YUV422_Indiv8:
-            case InputFormat::YUV422_Indiv16:
-                Y = input_Y[y * width + x];
-                U = input_U[(y * width + x) / 2];
-                V = input_V[(y * width + x) / 2];
-                break;
-            case InputFormat::YUV420_Indiv8:
-            case InputFormat::YUV420_Indiv16:
-                Y = input_Y[y * width + x];
-                U = input_U[((y / 2) * width + x) / 2];
-                V = input_V[((y / 2) * width + x) / 2];
-                break;
-            case InputFormat::YUYV422_Interleaved:
-                Y = input_Y[(y * width + x) * 2];
-                U = input_Y[(y * width + (x / 2) * 2) * 2 + 1];
-                V = input_Y[(y * width + (x / 2) * 2) * 2 + 3];
-                break;
+        if constexpr (input_format == InputFormat::YUYV422_Interleaved) {
+            const u8* src = input_Y + y * width * 2;
+            for (unsigned int x = 0; x < width; x += 2) {
+                Y[x] = src[x * 2];
+                Y[x + 1] = src[x * 2 + 2];
+                U[x] = U[x + 1] = src[x * 2 + 1];
+                V[x] = V[x + 1] = src[x * 2 + 3];
+            }
+        } else {
+            // Chroma is shared by two horizontally adjacent pixels, and by two lines in 4:2:0
+            const unsigned int chroma_line =
+                input_format == InputFormat::YUV420_Indiv8 ? y / 2 : y;
+            const u8* src_Y = input_Y + y * width;
+            const u8* src_U = input_U + chroma_line * width / 2;
+            const u8* src_V = input_V + chroma_line * width / 2;
+            for (unsigned int x = 0; x < width; ++x) {
+                Y[x] = src_Y[x];
+                U[x] = src_U[x / 2];
+                V[x] = src_V[x / 2];
             }
+        }
+
+        ConvertLineToRGB(Y.data(), U.data(), V.data(), line.data(), width, coefficients);
 
-            // This conversion process is bit-exact with hardware, as far as could be tested.
-            auto& c = coefficients;
-            s32 cY = c[0] * Y;
-
-            s32 r = cY + c[1] * V;
-            s32 g = cY - c[2] * V - c[3] * U;
-            s32 b = cY + c[4] * U;
-
-            const s32 rounding_offset = 0x18;
-            r = (r >> 3) + c[5] + rounding_offset;
-            g = (g >> 3) + c[6] + rounding_offset;
-            b = (b >> 3) + c[7] + rounding_offset;
-
-            unsigned int tile = x / 8;
-            unsigned int tile_x = x % 8;
-            u32* out = &output[tile][y * 8 + tile_x];
-            *out = ((u32)std::clamp(r >> 5, 0, 0xFF) << 24) |
-                   ((u32)std::clamp(g >> 5, 0, 0xFF) << 16) |
-                   ((u32)std::clamp(b >> 5, 0, 0xFF) << 8);
+        for (unsigned int tile = 0; tile < width / 8; ++tile) {
+            std::memcpy(&output[tile][y * 8], &line[tile * 8], 8 * sizeof(u32));
         }
     }
 }
 
+using ConvertYUVToRGBFunc = void (*)(const u8*, const u8*, const u8*, ImageTile[], unsigned int,
+                                     unsigned int, const CoefficientSet&);
+
+static ConvertYUVToRGBFunc GetConvertYUVToRGBFunc(InputFormat input_format) {
+    switch (input_format) {
+    case InputFormat::YUV422_Indiv8:
+    case InputFormat::YUV422_Indiv16:
+        return ConvertYUVToRGB<InputFormat::YUV422_Indiv8>;
+    case InputFormat::YUV420_Indiv8:
+    case InputFormat::YUV420_Indiv16:
+        return ConvertYUVToRGB<InputFormat::YUV420_Indiv8>;
+    case InputFormat::YUYV422_Interleaved:
+        return ConvertYUVToRGB<InputFormat::YUYV422_Interleaved>;
+    }
+    UNREACHABLE();
+}
+
 /// Simulates an incoming CDMA transfer. The N parameter is used to automatically convert 16-bit
 /// formats to 8-bit.
 template <std::size_t N>
@@ -87,8 +234,12 @@ static void ReceiveData(Memory::MemorySystem& memory, u8* output, ConversionBuff
     ASSERT(amount_of_data % output_unit == 0);
 
     while (amount_of_data > 0) {
-        for (std::size_t i = 0; i < output_unit; ++i) {
-            output[i] = input[i * N];
+        if constexpr (N == 1) {
+            std::memcpy(output, input, output_unit);
+        } else {
+            for (std::size_t i = 0; i < output_unit; ++i) {
+                output[i] = input[i * N];
+            }
         }
 
         output += output_unit;
@@ -100,47 +251,107 @@ static void ReceiveData(Memory::MemorySystem& memory, u8* output, ConversionBuff
     }
 }
 
+/// Receives the input data of one strip of `row_data_size` pixels into `data_buffer`.
+static void ReceiveStrip(Memory::MemorySystem& memory, ConversionConfiguration& cvt,
+                         u8* data_buffer, std::size_t row_data_size) {
+    u8* input_Y = data_buffer;
+    u8* input_U = input_Y + 8 * cvt.input_line_width;
+    u8* input_V = input_U + 8 * cvt.input_line_width / 2;
+
+    switch (cvt.input_format) {
+    case InputFormat::YUV422_Indiv8:
+        ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 2);
+        ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 2);
+        break;
+    case InputFormat::YUV420_Indiv8:
+        ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 4);
+        ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 4);
+        break;
+    case InputFormat::YUV422_Indiv16:
+        ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 2);
+        ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 2);
+        break;
+    case InputFormat::YUV420_Indiv16:
+        ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 4);
+        ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 4);
+        break;
+    case InputFormat::YUYV422_Interleaved:
+        ReceiveData<1>(memory, input_Y, cvt.src_YUYV, row_data_size * 2);
+        break;
+    }
+}
+
+constexpr std::size_t BytesPerOutputPixel(OutputFormat output_format) {
+    switch (output_format) {
+    case OutputFormat::RGBA8:
+        return 4;
+    case OutputFormat::RGB8:
+        return 3;
+    case OutputFormat::RGB5A1:
+    case OutputFormat::RGB565:
+        return 2;
+    }
+    return 0;
+}
+
 /// Convert intermediate RGB32 format to the final output format while simulating an outgoing CDMA
 /// transfer.
+template <OutputFormat output_format>
 static void SendData(Memory::MemorySystem& memory, const u32* input, ConversionBuffer& buf,
-                     int amount_of_data, OutputFormat output_format, u8 alpha) {
+                     int amount_of_data, u8 alpha) {
+
+    constexpr std::size_t bytes_per_pixel = BytesPerOutputPixel(output_format);
+    // A transfer unit always ends with a whole pixel, even if that writes past its end.
+    const std::size_t unit_pixels = (buf.transfer_unit + bytes_per_pixel - 1) / bytes_per_pixel;
 
     u8* output = memory.GetPointer(buf.address);
 
     while (amount_of_data > 0) {
-        u8* unit_end = output + buf.transfer_unit;
-        while (output < unit_end) {
-            u32 color = *input++;
-            Common::Vec4<u8> col_vec{(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8), alpha};
-
-            switch (output_format) {
-            case OutputFormat::RGBA8:
-                Common::Color::EncodeRGBA8(col_vec, output);
-                output += 4;
-                break;
-            case OutputFormat::RGB8:
-                Common::Color::EncodeRGB8(col_vec, output);
-                output += 3;
-                break;
-            case OutputFormat::RGB5A1:
-                Common::Color::EncodeRGB5A1(col_vec, output);
-                output += 2;
-                break;
-            case OutputFormat::RGB565:
-                Common::Color::EncodeRGB565(col_vec, output);
-                output += 2;
-                break;
+        for (std::size_t i = 0; i < unit_pixels; ++i) {
+            const u32 color = input[i];
+            const Common::Vec4<u8> col_vec{(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8),
+                                           alpha};
+            u8* pixel = output + i * bytes_per_pixel;
+
+            if constexpr (output_format == OutputFormat::RGBA8) {
+                Common::Color::EncodeRGBA8(col_vec, pixel);
+            } else if constexpr (output_format == OutputFormat::RGB8) {
+                Common::Color::EncodeRGB8(col_vec, pixel);
+            } else if constexpr (output_format == OutputFormat::RGB5A1) {
+                Common::Color::EncodeRGB5A1(col_vec, pixel);
+            } else {
+                Common::Color::EncodeRGB565(col_vec, pixel);
             }
-
-            amount_of_data -= 1;
         }
 
-        output += buf.gap;
+        input += unit_pixels;
+        output += unit_pixels * bytes_per_pixel + buf.gap;
+        amount_of_data -= static_cast<int>(unit_pixels);
         buf.address += buf.transfer_unit + buf.gap;
         buf.image_size -= buf.transfer_unit;
     }
 }
 
+using SendDataFunc = void (*)(Memory::MemorySystem&, const u32*, ConversionBuffer&, int, u8);
+
+static SendDataFunc GetSendDataFunc(OutputFormat output_format) {
+    switch (output_format) {
+    case OutputFormat::RGBA8:
+        return SendData<OutputFormat::RGBA8>;
+    case OutputFormat::RGB8:
+        return SendData<OutputFormat::RGB8>;
+    case OutputFormat::RGB5A1:
+        return SendData<OutputFormat::RGB5A1>;
+    case OutputFormat::RGB565:
+        return SendData<OutputFormat::RGB565>;
+    }
+    UNREACHABLE();
+}
+
 static const u8 linear_lut[TILE_SIZE] = {
     // clang-format off
      0,  1,  2,  3,  4,  5,  6,  7,
@@ -202,14 +413,161 @@ static void RotateTile270(const ImageTile& input, ImageTile& output, int height,
     }
 }
 
-static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, int line_stride) {
+/// For each pixel of a rotated and remapped output tile, the index of its source pixel
+using TileGather = std::array<u8, TILE_SIZE>;
+
+/**
+ * Builds the gather table equivalent to rotating a tile and remapping it through `tile_remap`. The
+ * table only depends on the conversion settings, so it is built once per conversion instead of
+ * rotating every tile through the remap LUT.
+ */
+static TileGather MakeTileGather(Rotation rotation, const u8* tile_remap, int height) {
+    ImageTile identity;
+    for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+        identity[i] = static_cast<u32>(i);
+    }
+
+    ImageTile rotated{};
+    switch (rotation) {
+    case Rotation::None:
+        RotateTile0(identity, rotated, height, tile_remap);
+        break;
+    case Rotation::Clockwise_90:
+        RotateTile90(identity, rotated, height, tile_remap);
+        break;
+    case Rotation::Clockwise_180:
+        RotateTile180(identity, rotated, height, tile_remap);
+        break;
+    case Rotation::Clockwise_270:
+        RotateTile270(identity, rotated, height, tile_remap);
+        break;
+    }
+
+    TileGather gather;
+    for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+        gather[i] = static_cast<u8>(rotated[i]);
+    }
+    return gather;
+}
+
+static void WriteTileToOutput(u32* output, const ImageTile& tile, const TileGather& gather,
+                              int height, int line_stride) {
     for (int y = 0; y < height; ++y) {
         for (int x = 0; x < 8; ++x) {
-            output[y * line_stride + x] = tile[y * 8 + x];
+            output[y * line_stride + x] = tile[gather[y * 8 + x]];
         }
     }
 }
 
+/// Converts one received strip in `data_buffer` and replaces it with the RGB32 output data.
+static void ConvertStrip(const ConversionConfiguration& cvt, ConvertYUVToRGBFunc convert,
+                         const TileGather& gather, u8* data_buffer, ImageTile tiles[],
+                         unsigned int row_height) {
+    const std::size_t num_tiles = cvt.input_line_width / 8;
+
+    const u8* input_Y = data_buffer;
+    const u8* input_U = input_Y + 8 * cvt.input_line_width;
+    const u8* input_V = input_U + 8 * cvt.input_line_width / 2;
+    convert(input_Y, input_U, input_V, tiles, cvt.input_line_width, row_height,
+            cvt.coefficients);
+
+    u32* output_buffer = reinterpret_cast<u32*>(data_buffer);
+
+    for (std::size_t i = 0; i < num_tiles; ++i) {
+        int image_strip_width = 0;
+        int output_stride = 0;
+        std::size_t tile_index = i;
+
+        switch (cvt.rotation) {
+        case Rotation::None:
+        case Rotation::Clockwise_180:
+            image_strip_width = cvt.input_line_width;
+            output_stride = 8;
+            break;
+        case Rotation::Clockwise_90:
+        case Rotation::Clockwise_270:
+            image_strip_width = 8;
+            output_stride = 8 * row_height;
+            break;
+        }
+
+        // For 180 and 270 degree rotations we also invert the order of tiles in the strip, since
+        // the rotates are done individually on each tile.
+        if (cvt.rotation == Rotation::Clockwise_180 || cvt.rotation == Rotation::Clockwise_270) {
+            tile_index = num_tiles - i - 1;
+        }
+
+        switch (cvt.block_alignment) {
+        case BlockAlignment::Linear:
+            WriteTileToOutput(output_buffer, tiles[tile_index], gather, row_height,
+                              image_strip_width);
+            output_buffer += output_stride;
+            break;
+        case BlockAlignment::Block8x8:
+            WriteTileToOutput(output_buffer, tiles[tile_index], gather, 8, 8);
+            output_buffer += TILE_SIZE;
+            break;
+        }
+    }
+}
+
+/// Scratch memory kept between conversions, so that they don't allocate on every call.
+struct ConversionScratch {
+    /// Buffers used as CDMA source/target, one per strip in flight.
+    std::vector<u8> data_buffers;
+    /// Intermediate storage for decoded 8x8 image tiles, one row of tiles per task.
+    std::vector<ImageTile> tiles;
+};
+
+static ConversionScratch& GetScratch() {
+    static ConversionScratch scratch;
+    return scratch;
+}
+
+/// Minimum number of pixels converted by one worker task
+constexpr std::size_t ConversionTaskPixels = 0x8000;
+
+static Common::ThreadWorker& GetConversionWorkers() {
+    static Common::ThreadWorker workers(
+        std::max<std::size_t>(std::thread::hardware_concurrency(), 2) - 1, "Y2R");
+    return workers;
+}
+
+/// Host memory range touched by the CDMA transfers of a conversion.
+struct HostRange {
+    const u8* begin;
+    const u8* end;
+
+    bool Overlaps(const HostRange& other) const {
+        return begin < other.end && other.begin < end;
+    }
+};
+
+/// Returns the range between the given starting address of a buffer and its current address.
+static HostRange GetTransferredRange(Memory::MemorySystem& memory, VAddr start,
+                                     const ConversionBuffer& buf) {
+    const u8* begin = memory.GetPointer(start);
+    return {begin, begin + (buf.address - start)};
+}
+
+/// Returns an upper bound of the host memory written when sending out the whole image.
+static HostRange GetOutputRange(Memory::MemorySystem& memory, const ConversionConfiguration& cvt) {
+    const std::size_t bytes_per_pixel = BytesPerOutputPixel(cvt.output_format);
+    // SendData always writes whole pixels, even if the last one goes past a transfer unit.
+    const std::size_t pixels_per_unit =
+        (cvt.dst.transfer_unit + bytes_per_pixel - 1) / bytes_per_pixel;
+    const std::size_t unit_stride = pixels_per_unit * bytes_per_pixel + cvt.dst.gap;
+
+    std::size_t size = 0;
+    for (unsigned int y = 0; y < cvt.input_lines; y += 8) {
+        const std::size_t row_data_size = std::min(cvt.input_lines - y, 8u) * cvt.input_line_width;
+        size += (row_data_size + pixels_per_unit - 1) / pixels_per_unit * unit_stride;
+    }
+
+    const u8* begin = memory.GetPointer(cvt.dst.address);
+    return {begin, begin + size};
+}
+
 /**
  * Performs a Y2R colorspace conversion.
  *
@@ -246,7 +604,12 @@ static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, in
  * In this implementation, to avoid the combinatorial explosion of parameter combinations, common
  * intermediate formats are used and where possible tables or parameters are used instead of
  * diverging code paths to keep the amount of branches in check. Some steps are also merged to
- * increase efficiency.
+ * increase efficiency. The input and output formats are template parameters of the conversion and
+ * transfer loops, which are selected once per conversion.
+ *
+ * Since strips are converted independently, large images receive all strips first, convert them
+ * on worker threads and then send them out in order. This gives the same result as processing
+ * strip by strip as long as the output doesn't overlap the input, which is checked beforehand.
  *
  * Output for all valid settings combinations matches hardware, however output in some edge-cases
  * differs:
@@ -267,11 +630,9 @@ void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration& cv
     std::size_t num_tiles = cvt.input_line_width / 8;
     ASSERT(num_tiles <= MAX_TILES);
 
-    // Buffer used as a CDMA source/target.
-    std::unique_ptr<u8[]> data_buffer(new u8[cvt.input_line_width * 8 * 4]);
-    // Intermediate storage for decoded 8x8 image tiles. Always stored as RGB32.
-    std::unique_ptr<ImageTile[]> tiles(new ImageTile[num_tiles]);
-    ImageTile tmp_tile;
+    if (cvt.input_lines == 0) {
+        return;
+    }
 
     // LUT used to remap writes to a tile. Used to allow linear or swizzled output without
     // requiring two different code paths.
@@ -285,96 +646,110 @@ void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration& cv
         break;
     }
 
-    for (unsigned int y = 0; y < cvt.input_lines; y += 8) {
-        unsigned int row_height = std::min(cvt.input_lines - y, 8u);
-
-        // Total size in pixels of incoming data required for this strip.
-        const std::size_t row_data_size = row_height * cvt.input_line_width;
-
-        u8* input_Y = data_buffer.get();
-        u8* input_U = input_Y + 8 * cvt.input_line_width;
-        u8* input_V = input_U + 8 * cvt.input_line_width / 2;
+    const std::size_t num_strips = (cvt.input_lines + 7) / 8;
+    const unsigned int last_row_height = cvt.input_lines - static_cast<u32>(num_strips - 1) * 8;
+    const TileGather gather = MakeTileGather(cvt.rotation, tile_remap, 8);
+    const TileGather last_gather = MakeTileGather(cvt.rotation, tile_remap, last_row_height);
+
+    const ConvertYUVToRGBFunc convert = GetConvertYUVToRGBFunc(cvt.input_format);
+    const SendDataFunc send = GetSendDataFunc(cvt.output_format);
+    const std::size_t strip_size = StripBufferSize(cvt.input_line_width);
+    const u8 alpha = static_cast<u8>(cvt.alpha);
+
+    auto& scratch = GetScratch();
+
+    const auto row_height = [&](std::size_t strip) {
+        return strip == num_strips - 1 ? last_row_height : 8u;
+    };
+    const auto row_data_size = [&](std::size_t strip) {
+        return row_height(strip) * cvt.input_line_width;
+    };
+
+    const std::size_t strips_per_task =
+        std::max<std::size_t>(1, ConversionTaskPixels / (8 * cvt.input_line_width));
+    const bool parallel = num_strips > strips_per_task && cvt.dst.transfer_unit != 0;
+
+    if (parallel) {
+        const ConversionConfiguration initial_cvt = cvt;
+        // A short last strip leaves part of its buffer untouched, where the sequential path has
+        // the output of the previous strip. It is received again and converted once that is done.
+        const bool short_last_strip = last_row_height != 8;
+        ConversionConfiguration last_strip_cvt = cvt;
+
+        scratch.data_buffers.resize(num_strips * strip_size);
+        for (std::size_t strip = 0; strip < num_strips; ++strip) {
+            if (strip == num_strips - 1) {
+                last_strip_cvt = cvt;
+            }
+            ReceiveStrip(memory, cvt, &scratch.data_buffers[strip * strip_size],
+                         row_data_size(strip));
+        }
 
-        switch (cvt.input_format) {
-        case InputFormat::YUV422_Indiv8:
-            ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 2);
-            ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 2);
-            break;
-        case InputFormat::YUV420_Indiv8:
-            ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 4);
-            ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 4);
-            break;
-        case InputFormat::YUV422_Indiv16:
-            ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 2);
-            ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 2);
-            break;
-        case InputFormat::YUV420_Indiv16:
-            ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 4);
-            ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 4);
-            break;
-        case InputFormat::YUYV422_Interleaved:
-            input_U = nullptr;
-            input_V = nullptr;
-            ReceiveData<1>(memory, input_Y, cvt.src_YUYV, row_data_size * 2);
-            break;
+        // Sending the output of a strip must not change the input of a later one
+        const HostRange output = GetOutputRange(memory, initial_cvt);
+        bool overlaps = output.begin == nullptr;
+        if (cvt.input_format == InputFormat::YUYV422_Interleaved) {
+            overlaps |= output.Overlaps(
+                GetTransferredRange(memory, initial_cvt.src_YUYV.address, cvt.src_YUYV));
+        } else {
+            overlaps |=
+                output.Overlaps(GetTransferredRange(memory, initial_cvt.src_Y.address, cvt.src_Y));
+            overlaps |=
+                output.Overlaps(GetTransferredRange(memory, initial_cvt.src_U.address, cvt.src_U));
+            overlaps |=
+                output.Overlaps(GetTransferredRange(memory, initial_cvt.src_V.address, cvt.src_V));
         }
 
-        // Note(yuriks): If additional optimization is required, input_format can be moved to a
-        // template parameter, so that its dispatch can be moved to outside the inner loop.
-        ConvertYUVToRGB(cvt.input_format, input_Y, input_U, input_V, tiles.get(),
-                        cvt.input_line_width, row_height, cvt.coefficients);
-
-        u32* output_buffer = reinterpret_cast<u32*>(data_buffer.get());
-
-        for (std::size_t i = 0; i < num_tiles; ++i) {
-            int image_strip_width = 0;
-            int output_stride = 0;
-
-            switch (cvt.rotation) {
-            case Rotation::None:
-                RotateTile0(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_90:
-                RotateTile90(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
-            case Rotation::Clockwise_180:
-                // For 180 and 270 degree rotations we also invert the order of tiles in the strip,
-                // since the rotates are done individually on each tile.
-                RotateTile180(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_270:
-                RotateTile270(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
+        if (!overlaps) {
+            const std::size_t full_strips = short_last_strip ? num_strips - 1 : num_strips;
+            const std::size_t num_tasks = (full_strips + strips_per_task - 1) / strips_per_task;
+            scratch.tiles.resize(num_tasks * num_tiles);
+
+            auto& workers = GetConversionWorkers();
+            for (std::size_t task = 0; task < num_tasks; ++task) {
+                workers.QueueWork([&, task] {
+                    const std::size_t begin = task * strips_per_task;
+                    const std::size_t end = std::min(begin + strips_per_task, full_strips);
+                    for (std::size_t strip = begin; strip < end; ++strip) {
+                        ConvertStrip(cvt, convert, gather,
+                                     &scratch.data_buffers[strip * strip_size],
+                                     &scratch.tiles[task * num_tiles], 8);
+                    }
+                });
+            }
+            workers.WaitForRequests();
+
+            if (short_last_strip) {
+                u8* data_buffer = &scratch.data_buffers[full_strips * strip_size];
+                std::memcpy(data_buffer, data_buffer - strip_size, strip_size);
+                cvt = last_strip_cvt;
+                ReceiveStrip(memory, cvt, data_buffer, row_data_size(full_strips));
+                ConvertStrip(cvt, convert, last_gather, data_buffer, scratch.tiles.data(),
+                             last_row_height);
             }
 
-            switch (cvt.block_alignment) {
-            case BlockAlignment::Linear:
-                WriteTileToOutput(output_buffer, tmp_tile, row_height, image_strip_width);
-                output_buffer += output_stride;
-                break;
-            case BlockAlignment::Block8x8:
-                WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
-                output_buffer += TILE_SIZE;
-                break;
+            for (std::size_t strip = 0; strip < num_strips; ++strip) {
+                send(memory,
+                     reinterpret_cast<const u32*>(&scratch.data_buffers[strip * strip_size]),
+                     cvt.dst, static_cast<int>(row_data_size(strip)), alpha);
             }
+            return;
         }
 
-        // Note(yuriks): If additional optimization is required, output_format can be moved to a
-        // template parameter, so that its dispatch can be moved to outside the inner loop.
-        SendData(memory, reinterpret_cast<u32*>(data_buffer.get()), cvt.dst, (int)row_data_size,
-                 cvt.output_format, (u8)cvt.alpha);
+        // Fall back to converting strip by strip from the start
+        cvt = initial_cvt;
+    }
+
+    scratch.data_buffers.resize(std::max(scratch.data_buffers.size(), strip_size));
+    scratch.tiles.resize(std::max(scratch.tiles.size(), num_tiles));
+    u8* data_buffer = scratch.data_buffers.data();
+
+    for (std::size_t strip = 0; strip < num_strips; ++strip) {
+        ReceiveStrip(memory, cvt, data_buffer, row_data_size(strip));
+        ConvertStrip(cvt, convert, strip == num_strips - 1 ? last_gather : gather, data_buffer,
+                     scratch.tiles.data(), row_height(strip));
+        send(memory, reinterpret_cast<const u32*>(data_buffer), cvt.dst,
+             static_cast<int>(row_data_size(strip)), alpha);
     }
 }
 } // namespace HW::Y2R
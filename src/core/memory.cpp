@@ -23,6 +23,7 @@
 #include "core/hle/service/plgldr/plgldr.h"
 #include "core/hw/hw.h"
 #include "core/memory.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
@@ -768,11 +769,21 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
     }
 }
 
+namespace {
+/// Waits for queued command lists, so that the CPU does not access memory the GPU is writing
+void SynchronizeGPUThread() {
+    if (VideoCore::g_gpu_thread) {
+        VideoCore::g_gpu_thread->Synchronize();
+    }
+}
+} // Anonymous namespace
+
 void RasterizerFlushRegion(PAddr start, u32 size) {
     if (VideoCore::g_renderer == nullptr) {
         return;
     }
 
+    SynchronizeGPUThread();
     VideoCore::g_renderer->Rasterizer()->FlushRegion(start, size);
 }
 
@@ -781,6 +792,7 @@ void RasterizerInvalidateRegion(PAddr start, u32 size) {
         return;
     }
 
+    SynchronizeGPUThread();
     VideoCore::g_renderer->Rasterizer()->InvalidateRegion(start, size);
 }
 
@@ -791,6 +803,7 @@ void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size) {
         return;
     }
 
+    SynchronizeGPUThread();
     VideoCore::g_renderer->Rasterizer()->FlushAndInvalidateRegion(start, size);
 }
 
@@ -801,6 +814,9 @@ void RasterizerClearAll(bool flush) {
         return;
     }
 
+    // Drain queued command lists so that their results and interrupts are not lost when the
+    // rasterizer state is dropped, e.g. while taking a savestate.
+    SynchronizeGPUThread();
     VideoCore::g_renderer->Rasterizer()->ClearAll(flush);
 }
 
@@ -811,6 +827,7 @@ void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
         return;
     }
 
+    SynchronizeGPUThread();
     VAddr end = start + size;
 
     auto CheckRegion = [&](VAddr region_start, VAddr region_end, PAddr paddr_region_start) {
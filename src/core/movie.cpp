@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -16,6 +17,7 @@
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/scm_rev.h"
+#include "common/settings.h"
 #include "common/string_util.h"
 #include "common/swap.h"
 #include "common/timer.h"
@@ -124,12 +126,77 @@ struct CTMHeader {
     std::array<char, 32> author; /// Author of the movie
     u32_le rerecord_count;       /// Number of rerecords when making the movie
     u64_le input_count;          /// Number of inputs (button and pad states) when making the movie
+    u32_le version;              /// Format version, 0 in movies of the first version
+    u64_le input_size;           /// Size of the inputs following the header, from version 2
+    u64_le keyframe_offset;      /// Location of the keyframe index, from version 2
+    u32_le keyframe_count;       /// Number of entries in the keyframe index
 
-    std::array<u8, 164> reserved; /// Make heading 256 bytes so it has consistent size
+    std::array<u8, 140> reserved; /// Make heading 256 bytes so it has consistent size
 };
 static_assert(sizeof(CTMHeader) == 256, "CTMHeader should be 256 bytes");
+
+/// Entry of the keyframe index, which follows the inputs and the keyframe savestates
+struct CTMKeyframe {
+    u64_le input_count; /// Number of pad inputs before the keyframe was taken
+    u64_le offset;      /// Location of the compressed savestate in the file
+    u64_le size;        /// Size of the compressed savestate
+};
+static_assert(sizeof(CTMKeyframe) == 24, "CTMKeyframe should be 24 bytes");
 #pragma pack(pop)
 
+/// Version 2 stores keyframes after the inputs, so their size is in the header
+constexpr u32 movie_version = 2;
+
+/// Size of the inputs. Movies of the first version end with them.
+static u64 GetInputSize(const CTMHeader& header, u64 file_size) {
+    if (header.version < 2) {
+        return file_size - sizeof(CTMHeader);
+    }
+    return std::min<u64>(header.input_size, file_size - sizeof(CTMHeader));
+}
+
+/// Converts frames, as counted by GetCurrentInputIndex, to pad inputs
+static u64 FramesToInputs(u64 frames) {
+    return static_cast<u64>(std::nearbyint(frames * 234.0 / GPU::SCREEN_REFRESH_RATE));
+}
+
+/**
+ * Reads the keyframe index of a movie, which movies of the first version don't have.
+ * @returns nothing if the index or a keyframe is outside the file, or the index is not sorted by
+ * input count
+ */
+static std::optional<std::vector<CTMKeyframe>> ReadKeyframeIndex(FileUtil::IOFile& file,
+                                                                  const CTMHeader& header,
+                                                                  u64 file_size) {
+    std::vector<CTMKeyframe> keyframe_index;
+    if (header.version < 2 || header.keyframe_count == 0) {
+        return keyframe_index;
+    }
+
+    const u64 index_offset = header.keyframe_offset;
+    if (index_offset > file_size ||
+        header.keyframe_count > (file_size - index_offset) / sizeof(CTMKeyframe)) {
+        return std::nullopt;
+    }
+    keyframe_index.resize(header.keyframe_count);
+    if (!file.Seek(index_offset, SEEK_SET) ||
+        file.ReadArray(keyframe_index.data(), keyframe_index.size()) != keyframe_index.size()) {
+        return std::nullopt;
+    }
+
+    u64 last_input_count = 0;
+    for (const auto& entry : keyframe_index) {
+        const u64 offset = entry.offset;
+        const u64 size = entry.size;
+        const u64 input_count = entry.input_count;
+        if (offset > file_size || size > file_size - offset || input_count < last_input_count) {
+            return std::nullopt;
+        }
+        last_input_count = input_count;
+    }
+    return keyframe_index;
+}
+
 static u64 GetInputCount(std::span<const u8> input) {
     u64 input_count = 0;
     for (std::size_t pos = 0; pos < input.size(); pos += sizeof(ControllerState)) {
@@ -213,6 +280,11 @@ void Movie::serialize(Archive& ar, const unsigned int file_version) {
         } else {
             play_mode = PlayMode::Recording;
             rerecord_count++;
+
+            // Keyframes after this state belong to the inputs that are recorded again
+            std::erase_if(keyframes, [this](const Keyframe& keyframe) {
+                return keyframe.input_count > current_input;
+            });
         }
     }
 }
@@ -371,6 +443,9 @@ void Movie::Record(const ControllerState& controller_state) {
 void Movie::Record(const Service::HID::PadState& pad_state, const s16& circle_pad_x,
                    const s16& circle_pad_y) {
     current_input++;
+    if (keyframe_interval != 0 && current_input % keyframe_interval == 0) {
+        keyframe_pending = true;
+    }
 
     ControllerState s{};
     s.type = ControllerStateType::PadAndCircle;
@@ -481,8 +556,36 @@ Movie::ValidationResult Movie::ValidateInput(std::span<const u8> input, u64 expe
                                                   : ValidationResult::InputCountDismatch;
 }
 
+std::vector<u8> Movie::ReadKeyframe(const Keyframe& keyframe) const {
+    if (!keyframe.state.empty()) {
+        return keyframe.state;
+    }
+
+    FileUtil::IOFile file(record_movie_file, "rb");
+    std::vector<u8> state(keyframe.size);
+    if (!file.Seek(keyframe.offset, SEEK_SET) ||
+        file.ReadBytes(state.data(), state.size()) != state.size()) {
+        throw std::runtime_error("Could not read keyframe from " + record_movie_file);
+    }
+    return state;
+}
+
 void Movie::SaveMovie() {
     LOG_INFO(Movie, "Saving recorded movie to '{}'", record_movie_file);
+
+    // Keyframes of a movie that is recorded again are still in the file that is overwritten
+    for (auto& keyframe : keyframes) {
+        if (!keyframe.state.empty()) {
+            continue;
+        }
+        try {
+            keyframe.state = ReadKeyframe(keyframe);
+        } catch (const std::exception& e) {
+            LOG_ERROR(Movie, "{}", e.what());
+        }
+    }
+    std::erase_if(keyframes, [](const Keyframe& keyframe) { return keyframe.state.empty(); });
+
     FileUtil::IOFile save_record(record_movie_file, "wb");
 
     if (!save_record.IsGood()) {
@@ -501,6 +604,19 @@ void Movie::SaveMovie() {
 
     header.rerecord_count = rerecord_count;
     header.input_count = GetInputCount(recorded_input);
+    header.version = movie_version;
+    header.input_size = recorded_input.size();
+
+    std::vector<CTMKeyframe> keyframe_index;
+    u64 offset = sizeof(CTMHeader) + recorded_input.size();
+    for (auto& keyframe : keyframes) {
+        keyframe.offset = offset;
+        keyframe.size = keyframe.state.size();
+        keyframe_index.push_back({keyframe.input_count, keyframe.offset, keyframe.size});
+        offset += keyframe.size;
+    }
+    header.keyframe_offset = offset;
+    header.keyframe_count = static_cast<u32>(keyframe_index.size());
 
     std::string rev_bytes;
     CryptoPP::StringSource(Common::g_scm_rev, true,
@@ -509,9 +625,20 @@ void Movie::SaveMovie() {
 
     save_record.WriteBytes(&header, sizeof(CTMHeader));
     save_record.WriteBytes(recorded_input.data(), recorded_input.size());
+    for (const auto& keyframe : keyframes) {
+        save_record.WriteBytes(keyframe.state.data(), keyframe.state.size());
+    }
+    save_record.WriteArray(keyframe_index.data(), keyframe_index.size());
 
     if (!save_record.IsGood()) {
         LOG_ERROR(Movie, "Error saving movie");
+        return;
+    }
+
+    // The keyframes are read back from the file when needed
+    for (auto& keyframe : keyframes) {
+        keyframe.state.clear();
+        keyframe.state.shrink_to_fit();
     }
 }
 
@@ -538,9 +665,18 @@ void Movie::StartPlayback(const std::string& movie_file) {
             rerecord_count = header.rerecord_count;
             total_input = header.input_count;
 
-            recorded_input.resize(size - sizeof(CTMHeader));
+            recorded_input.resize(GetInputSize(header, size));
             save_record.ReadArray(recorded_input.data(), recorded_input.size());
 
+            keyframes.clear();
+            if (const auto keyframe_index = ReadKeyframeIndex(save_record, header, size)) {
+                for (const auto& entry : *keyframe_index) {
+                    keyframes.push_back({entry.input_count, entry.offset, entry.size, {}});
+                }
+            } else {
+                LOG_ERROR(Movie, "Movie has an invalid keyframe index, seeking back is disabled");
+            }
+
             current_byte = 0;
             current_input = 0;
             id = header.id;
@@ -558,6 +694,7 @@ void Movie::StartRecording(const std::string& movie_file, const std::string& aut
     record_movie_file = movie_file;
     record_movie_author = author;
     rerecord_count = 1;
+    keyframes.clear();
 
     // Generate a random ID
     CryptoPP::AutoSeededRandomPool rng;
@@ -574,6 +711,112 @@ void Movie::SetReadOnly(bool read_only_) {
     read_only = read_only_;
 }
 
+bool Movie::IsReadOnly() const {
+    return read_only;
+}
+
+void Movie::SetKeyframeInterval(u64 interval) {
+    keyframe_interval = FramesToInputs(interval);
+}
+
+bool Movie::SeekToFrame(u64 frame) {
+    if (play_mode != PlayMode::Playing && play_mode != PlayMode::MovieFinished) {
+        LOG_ERROR(Movie, "Unable to seek, no movie is being played");
+        return false;
+    }
+
+    const u64 target = FramesToInputs(frame);
+    if (total_input != 0 && target > total_input) {
+        LOG_ERROR(Movie, "Unable to seek to frame {}, the movie ends at frame {}", frame,
+                  GetTotalInputCount());
+        return false;
+    }
+
+    // A keyframe taken at the last input is a savestate of the finished movie, which can't be
+    // loaded while playing it back
+    const auto end = std::lower_bound(
+        keyframes.begin(), keyframes.end(), total_input,
+        [](const Keyframe& keyframe, u64 input) { return keyframe.input_count < input; });
+
+    // Use the last keyframe before the target, unless playing on from here is shorter
+    const auto next = std::upper_bound(
+        keyframes.begin(), end, target,
+        [](u64 input, const Keyframe& keyframe) { return input < keyframe.input_count; });
+    const bool can_play_on = play_mode == PlayMode::Playing && current_input <= target;
+    if (next != keyframes.begin() &&
+        (!can_play_on || std::prev(next)->input_count > current_input)) {
+        seek_keyframe = static_cast<std::size_t>(std::distance(keyframes.begin(), next) - 1);
+    } else if (can_play_on) {
+        seek_keyframe.reset();
+    } else {
+        LOG_ERROR(Movie, "Unable to seek back to frame {}, there is no keyframe before it",
+                  frame);
+        return false;
+    }
+
+    LOG_INFO(Movie, "Seeking to frame {}", frame);
+    seek_request = target;
+    return true;
+}
+
+bool Movie::IsSeeking() const {
+    return seek_request.has_value() || seek_target.has_value();
+}
+
+bool Movie::ProcessKeyframes(System& system) {
+    return ProcessKeyframes(
+        [&system] { return system.SaveStateBuffer(); },
+        [&system](std::span<const u8> state) { system.LoadStateBuffer(state); });
+}
+
+bool Movie::ProcessKeyframes(const std::function<std::vector<u8>()>& save_state,
+                             const std::function<void(std::span<const u8>)>& load_state) {
+    if (keyframe_pending) {
+        keyframe_pending = false;
+        try {
+            keyframes.push_back({current_input, 0, 0, save_state()});
+        } catch (const std::exception& e) {
+            LOG_ERROR(Movie, "Failed to take keyframe: {}", e.what());
+        }
+    }
+
+    if (!seek_request) {
+        return false;
+    }
+    if (!seek_target) {
+        // Run as fast as possible until the target, without touching the frame limit setting
+        Core::System::GetInstance().frame_limiter.SetUnlimited(true);
+    }
+    seek_target = std::exchange(seek_request, std::nullopt);
+
+    bool loaded = false;
+    if (seek_keyframe) {
+        const Keyframe& keyframe = keyframes[*std::exchange(seek_keyframe, std::nullopt)];
+        // In R/W mode, loading a state would start recording from it
+        const bool was_read_only = std::exchange(read_only, true);
+        try {
+            load_state(ReadKeyframe(keyframe));
+        } catch (...) {
+            read_only = was_read_only;
+            FinishSeek();
+            throw;
+        }
+        read_only = was_read_only;
+        loaded = true;
+    }
+
+    if (play_mode != PlayMode::Playing || current_input >= *seek_target) {
+        FinishSeek();
+    }
+    return loaded;
+}
+
+void Movie::FinishSeek() {
+    LOG_INFO(Movie, "Seek finished at frame {}", GetCurrentInputIndex());
+    Core::System::GetInstance().frame_limiter.SetUnlimited(false);
+    seek_target.reset();
+}
+
 static boost::optional<CTMHeader> ReadHeader(const std::string& movie_file) {
     FileUtil::IOFile save_record(movie_file, "rb");
     const u64 size = save_record.GetSize();
@@ -631,6 +874,11 @@ Movie::ValidationResult Movie::ValidateMovie(const std::string& movie_file) cons
         return ValidationResult::Invalid;
     }
 
+    if (!ReadKeyframeIndex(save_record, header, size)) {
+        LOG_ERROR(Movie, "Movie has an invalid keyframe index");
+        return ValidationResult::Invalid;
+    }
+
     auto result = ValidateHeader(header);
     if (result != ValidationResult::OK) {
         return result;
@@ -640,7 +888,8 @@ Movie::ValidationResult Movie::ValidateMovie(const std::string& movie_file) cons
         return ValidationResult::OK;
     }
 
-    std::vector<u8> input(size - sizeof(header));
+    std::vector<u8> input(GetInputSize(header, size));
+    save_record.Seek(sizeof(CTMHeader), SEEK_SET);
     save_record.ReadArray(input.data(), input.size());
     return ValidateInput(input, header.input_count);
 }
@@ -661,6 +910,13 @@ void Movie::Shutdown() {
     if (play_mode == PlayMode::Recording) {
         SaveMovie();
     }
+    if (seek_target) {
+        FinishSeek();
+    }
+    seek_request.reset();
+    seek_keyframe.reset();
+    keyframes.clear();
+    keyframe_pending = false;
 
     play_mode = PlayMode::None;
     recorded_input.resize(0);
@@ -677,6 +933,9 @@ void Movie::Handle(Targs&... Fargs) {
         ASSERT(current_byte + sizeof(ControllerState) <= recorded_input.size());
         Play(Fargs...);
         CheckInputEnd();
+        if (seek_target && (play_mode != PlayMode::Playing || current_input >= *seek_target)) {
+            FinishSeek();
+        }
     } else if (play_mode == PlayMode::Recording) {
         Record(Fargs...);
     }
@@ -5,7 +5,9 @@
 #pragma once
 
 #include <functional>
+#include <optional>
 #include <span>
+#include <vector>
 #include <boost/serialization/vector.hpp>
 #include "common/common_types.h"
 
@@ -23,6 +25,7 @@ union PadState;
 } // namespace Service
 
 namespace Core {
+class System;
 struct CTMHeader;
 struct ControllerState;
 
@@ -59,6 +62,41 @@ public:
      */
     void SetReadOnly(bool read_only);
 
+    bool IsReadOnly() const;
+
+    /**
+     * Sets how often a keyframe, a savestate embedded in the movie, is taken while recording.
+     * Keyframes allow SeekToFrame to skip most of the movie. 0 disables keyframes, the default.
+     * @param interval Number of frames between keyframes
+     */
+    void SetKeyframeInterval(u64 interval);
+
+    /**
+     * Seeks the movie being played to the given frame. The last keyframe before the frame is
+     * loaded, unless the current position is closer, and the remaining inputs are played back
+     * without frame limit. The keyframe is loaded on the next call to System::RunLoop.
+     * @returns false if the frame is past the end of the movie, or before the current position
+     * without a keyframe in between.
+     */
+    bool SeekToFrame(u64 frame);
+
+    /// Whether the movie is still running towards the frame requested by SeekToFrame
+    bool IsSeeking() const;
+
+    /**
+     * Takes the keyframe requested while recording and loads the one requested by SeekToFrame.
+     * Called by the emulation thread between slices, where a savestate can be taken.
+     * @returns true if the emulated state was replaced by a keyframe.
+     */
+    bool ProcessKeyframes(System& system);
+
+    /**
+     * Same as ProcessKeyframes(System&), with the functions that take and load savestates given
+     * separately.
+     */
+    bool ProcessKeyframes(const std::function<std::vector<u8>()>& save_state,
+                          const std::function<void(std::span<const u8>)>& load_state);
+
     /// Prepare to override the clock before playing back movies
     void PrepareForPlayback(const std::string& movie_file);
 
@@ -159,6 +197,18 @@ private:
     ValidationResult ValidateHeader(const CTMHeader& header) const;
     ValidationResult ValidateInput(std::span<const u8> input, u64 expected_count) const;
 
+    struct Keyframe {
+        u64 input_count;       ///< Number of pad inputs before the keyframe was taken
+        u64 offset;            ///< Location of the savestate in the movie file
+        u64 size;              ///< Size of the compressed savestate
+        std::vector<u8> state; ///< Savestate of keyframes that are not in the movie file yet
+    };
+
+    /// Returns the compressed savestate of a keyframe
+    std::vector<u8> ReadKeyframe(const Keyframe& keyframe) const;
+
+    void FinishSeek();
+
     PlayMode play_mode;
 
     std::string record_movie_file;
@@ -172,6 +222,14 @@ private:
     // Total input count of the current movie being played. Not used for recording.
     u64 total_input = 0;
 
+    std::vector<Keyframe> keyframes;
+    u64 keyframe_interval = 0; // Number of pad inputs between keyframes
+    bool keyframe_pending = false;
+
+    std::optional<u64> seek_request;          // Input index passed to SeekToFrame
+    std::optional<u64> seek_target;           // Input index the movie is running towards
+    std::optional<std::size_t> seek_keyframe; // Keyframe to load for seek_request
+
     u64 id = 0; // ID of the current movie loaded
     u64 program_id = 0;
     u32 rerecord_count = 1;
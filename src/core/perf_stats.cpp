@@ -27,6 +27,81 @@ constexpr std::size_t IgnoreFrames = 5;
 
 namespace Core {
 
+namespace {
+
+/// Host time accumulated by each component since the stats were last reset, in nanoseconds
+std::array<std::atomic<u64>, PerfStats::NumComponents> component_time_ns{};
+
+/// Component the calling thread currently spends its time in, Count if none
+thread_local PerfStats::Component current_component = PerfStats::Component::Count;
+/// Point when the calling thread entered or resumed its current component
+thread_local PerfStats::Clock::time_point component_begin;
+
+/// Adds the time since the current component was entered or resumed to it
+void AccumulateCurrentComponent(PerfStats::Clock::time_point now) {
+    if (current_component == PerfStats::Component::Count) {
+        return;
+    }
+    const auto elapsed = duration_cast<std::chrono::nanoseconds>(now - component_begin);
+    component_time_ns[static_cast<std::size_t>(current_component)].fetch_add(
+        static_cast<u64>(elapsed.count()), std::memory_order_relaxed);
+}
+
+} // Anonymous namespace
+
+PerfStats::ScopedComponent::ScopedComponent(Component component) : previous{current_component} {
+    const auto now = Clock::now();
+    AccumulateCurrentComponent(now);
+    current_component = component;
+    component_begin = now;
+}
+
+PerfStats::ScopedComponent::~ScopedComponent() {
+    const auto now = Clock::now();
+    AccumulateCurrentComponent(now);
+    current_component = previous;
+    component_begin = now;
+}
+
+const char* PerfStats::GetComponentName(Component component) {
+    switch (component) {
+    case Component::CpuJit:
+        return "cpu_jit";
+    case Component::Hle:
+        return "hle";
+    case Component::Gpu:
+        return "gpu";
+    case Component::RasterizerCache:
+        return "rasterizer_cache";
+    case Component::ShaderCompilation:
+        return "shader_compilation";
+    case Component::Audio:
+        return "audio";
+    case Component::FrameLimiter:
+        return "frame_limiter";
+    default:
+        return "unknown";
+    }
+}
+
+std::string PerfStats::GetCsvHeader() {
+    std::string header = "system_fps,game_fps,frametime_ms,emulation_speed";
+    for (std::size_t i = 0; i < NumComponents; ++i) {
+        header += fmt::format(",{}_ms", GetComponentName(static_cast<Component>(i)));
+    }
+    return header;
+}
+
+std::string PerfStats::FormatCsvRow(const Results& results) {
+    std::string row = fmt::format("{:.2f},{:.2f},{:.3f},{:.3f}", results.system_fps,
+                                  results.game_fps, results.frametime * 1000.0,
+                                  results.emulation_speed);
+    for (const double time : results.component_times) {
+        row += fmt::format(",{:.3f}", time * 1000.0);
+    }
+    return row;
+}
+
 PerfStats::PerfStats(u64 title_id) : title_id(title_id) {}
 
 PerfStats::~PerfStats() {
@@ -101,6 +176,12 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     results.frametime = duration_cast<DoubleSecs>(accumulated_frametime).count() /
                         static_cast<double>(system_frames);
     results.emulation_speed = system_us_per_second.count() / 1'000'000.0;
+    for (std::size_t i = 0; i < NumComponents; ++i) {
+        const u64 time_ns = component_time_ns[i].exchange(0, std::memory_order_relaxed);
+        results.component_times[i] =
+            static_cast<double>(time_ns) / 1'000'000'000.0 / static_cast<double>(system_frames);
+    }
+    last_results = results;
 
     // Reset counters
     reset_point = now;
@@ -112,6 +193,12 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     return results;
 }
 
+PerfStats::Results PerfStats::GetLastStats() const {
+    std::lock_guard lock{object_mutex};
+
+    return last_results;
+}
+
 double PerfStats::GetLastFrameTimeScale() const {
     std::lock_guard lock{object_mutex};
 
@@ -128,6 +215,7 @@ void FrameLimiter::WaitOnce() {
 }
 
 void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
+    PerfStats::ScopedComponent component{PerfStats::Component::FrameLimiter};
     if (frame_advancing_enabled) {
         // Frame advancing is enabled: wait on event instead of doing framelimiting
         frame_advance_event.Wait();
@@ -138,7 +226,7 @@ void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
     auto now = Clock::now();
     double sleep_scale = Settings::values.frame_limit.GetValue() / 100.0;
 
-    if (Settings::values.frame_limit.GetValue() == 0) {
+    if (unlimited || Settings::values.frame_limit.GetValue() == 0) {
         return;
     }
 
@@ -181,4 +269,12 @@ void FrameLimiter::AdvanceFrame() {
     frame_advance_event.Set();
 }
 
+void FrameLimiter::SetUnlimited(bool value) {
+    unlimited = value;
+}
+
+bool FrameLimiter::IsUnlimited() const {
+    return unlimited;
+}
+
 } // namespace Core
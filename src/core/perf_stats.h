@@ -9,6 +9,7 @@
 #include <chrono>
 #include <cstddef>
 #include <mutex>
+#include <string>
 #include "common/common_types.h"
 #include "common/thread.h"
 
@@ -25,6 +26,35 @@ public:
 
     using Clock = std::chrono::high_resolution_clock;
 
+    /// Parts of emulation whose host time is accounted separately in the frame breakdown
+    enum class Component : u32 {
+        CpuJit,
+        Hle,
+        Gpu,
+        RasterizerCache,
+        ShaderCompilation,
+        Audio,
+        FrameLimiter,
+        Count,
+    };
+    static constexpr std::size_t NumComponents = static_cast<std::size_t>(Component::Count);
+
+    /**
+     * Attributes the time spent on the calling thread to a component for the lifetime of the
+     * object. A nested scope pauses the enclosing one, so time is never counted twice.
+     */
+    class ScopedComponent {
+    public:
+        explicit ScopedComponent(Component component);
+        ~ScopedComponent();
+
+        ScopedComponent(const ScopedComponent&) = delete;
+        ScopedComponent& operator=(const ScopedComponent&) = delete;
+
+    private:
+        Component previous;
+    };
+
     struct Results {
         /// System FPS (LCD VBlanks) in Hz
         double system_fps;
@@ -34,14 +64,29 @@ public:
         double frametime;
         /// Ratio of walltime / emulated time elapsed
         double emulation_speed;
+        /// Host time per system frame spent in each component, in seconds. This includes time
+        /// spent on other threads, such as the GPU thread, so the sum can exceed the frametime.
+        std::array<double, NumComponents> component_times;
     };
 
+    /// Returns the name of a component, as used in the CSV columns
+    static const char* GetComponentName(Component component);
+
+    /// Returns the CSV header line for the rows written by FormatCsvRow
+    static std::string GetCsvHeader();
+
+    /// Formats results as a CSV line, with times in milliseconds
+    static std::string FormatCsvRow(const Results& results);
+
     void BeginSystemFrame();
     void EndSystemFrame();
     void EndGameFrame();
 
     Results GetAndResetStats(std::chrono::microseconds current_system_time_us);
 
+    /// Returns the results of the last call to GetAndResetStats
+    Results GetLastStats() const;
+
     /**
      * Returns the arithmetic mean of all frametime values stored in the performance history.
      */
@@ -82,6 +127,9 @@ private:
     Clock::time_point frame_begin = reset_point;
     /// Total visible duration (including frame-limiting, etc.) of the previous system frame
     Clock::duration previous_frame_length = Clock::duration::zero();
+
+    /// Results of the last call to GetAndResetStats
+    Results last_results{};
 };
 
 class FrameLimiter {
@@ -100,6 +148,13 @@ public:
     void AdvanceFrame();
     void WaitOnce();
 
+    /**
+     * Disables frame limiting regardless of the frame limit setting, which is left untouched.
+     * Used while a movie runs towards the frame it is seeking to.
+     */
+    void SetUnlimited(bool value);
+    bool IsUnlimited() const;
+
 private:
     /// Emulated system time (in microseconds) at the last limiter invocation
     std::chrono::microseconds previous_system_time_us{0};
@@ -112,6 +167,9 @@ private:
     /// Whether to use frame advancing (i.e. frame by frame)
     std::atomic_bool frame_advancing_enabled;
 
+    /// Whether frame limiting is overridden by SetUnlimited
+    std::atomic_bool unlimited{false};
+
     /// Event to advance the frame when frame advancing is enabled
     Common::Event frame_advance_event;
 };
@@ -15,6 +15,20 @@ enum class PacketType {
     Undefined = 0,
     ReadMemory,
     WriteMemory,
+    ReadHLEStats,
+    ReadPerfStats,
+    /// u32 count, then count times u32 address and u32 size. The reply holds all the data.
+    ReadMemoryBatch,
+    /// u32 count, then count times u32 address, u32 size and the data to write
+    WriteMemoryBatch,
+    /// u32 address and u32 size. The reply holds the u32 id of the watch, which sends a
+    /// WatchNotification at the end of every frame in which the watched memory changed. The
+    /// reply is empty if the range is not mapped in the current process.
+    AddWatch,
+    /// u32 id of the watch
+    RemoveWatch,
+    /// Sent with the watch id as packet id, holding the u32 frame number and the memory contents
+    WatchNotification,
 };
 
 struct PacketHeader {
@@ -24,11 +38,14 @@ struct PacketHeader {
     u32 packet_size;
 };
 
-constexpr u32 CURRENT_VERSION = 1;
+constexpr u32 CURRENT_VERSION = 2;
 constexpr u32 MIN_PACKET_SIZE = sizeof(PacketHeader);
-constexpr u32 MAX_PACKET_DATA_SIZE = 32;
+constexpr u32 MAX_PACKET_DATA_SIZE = 4096;
 constexpr u32 MAX_PACKET_SIZE = MIN_PACKET_SIZE + MAX_PACKET_DATA_SIZE;
 constexpr u32 MAX_READ_SIZE = MAX_PACKET_DATA_SIZE;
+/// Watch notifications start with the number of the frame in which the change was seen
+constexpr u32 MAX_WATCH_SIZE = MAX_PACKET_DATA_SIZE - sizeof(u32);
+constexpr u32 MAX_WATCH_COUNT = 256;
 
 class Packet {
 public:
@@ -66,6 +83,11 @@ public:
         send_reply_callback(*this);
     }
 
+    /// Returns the callback that sends a packet to the client this request came from
+    const std::function<void(Packet&)>& GetReplyCallback() const {
+        return send_reply_callback;
+    }
+
 private:
     void HandleReadMemory(u32 address, u32 data_size);
     void HandleWriteMemory(u32 address, std::span<const u8> data);
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstring>
+#include <fmt/format.h>
 #include "common/logging/log.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
@@ -37,7 +40,7 @@ void RPCServer::HandleReadMemory(Packet& packet, u32 address, u32 data_size) {
     packet.SendReply();
 }
 
-void RPCServer::HandleWriteMemory(Packet& packet, u32 address, std::span<const u8> data) {
+void RPCServer::WriteMemory(u32 address, std::span<const u8> data) {
     // Only allow writing to certain memory regions
     if ((address >= Memory::PROCESS_IMAGE_VADDR && address <= Memory::PROCESS_IMAGE_VADDR_END) ||
         (address >= Memory::HEAP_VADDR && address <= Memory::HEAP_VADDR_END) ||
@@ -51,19 +54,215 @@ void RPCServer::HandleWriteMemory(Packet& packet, u32 address, std::span<const u
         // Is current core correct here?
         Core::System::GetInstance().InvalidateCacheRange(address, data.size());
     }
+}
+
+void RPCServer::HandleWriteMemory(Packet& packet, u32 address, std::span<const u8> data) {
+    WriteMemory(address, data);
     packet.SetPacketDataSize(0);
     packet.SendReply();
 }
 
+bool RPCServer::HandleReadMemoryBatch(Packet& packet) {
+    struct Range {
+        u32 address;
+        u32 size;
+    };
+
+    u32 count = 0;
+    std::memcpy(&count, packet.GetPacketData().data(), sizeof(count));
+    if (packet.GetPacketDataSize() != sizeof(count) + u64{count} * sizeof(Range)) {
+        return false;
+    }
+
+    // The reply overwrites the request, so the ranges are copied first
+    std::vector<Range> ranges(count);
+    std::memcpy(ranges.data(), packet.GetPacketData().data() + sizeof(count),
+                ranges.size() * sizeof(Range));
+    u64 total_size = 0;
+    for (const auto& range : ranges) {
+        total_size += range.size;
+    }
+    if (total_size > MAX_READ_SIZE) {
+        return false;
+    }
+
+    // Note: Memory read occurs asynchronously from the state of the emulator
+    auto& system = Core::System::GetInstance();
+    const auto& process = *system.Kernel().GetCurrentProcess();
+    u32 offset = 0;
+    for (const auto& range : ranges) {
+        system.Memory().ReadBlock(process, range.address, packet.GetPacketData().data() + offset,
+                                  range.size);
+        offset += range.size;
+    }
+    packet.SetPacketDataSize(offset);
+    packet.SendReply();
+    return true;
+}
+
+bool RPCServer::HandleWriteMemoryBatch(Packet& packet) {
+    const auto request = std::span{packet.GetPacketData()}.first(packet.GetPacketDataSize());
+
+    // Check the whole request before writing anything
+    const auto for_each_write = [request](auto&& func) {
+        u32 count = 0;
+        std::memcpy(&count, request.data(), sizeof(count));
+        std::size_t offset = sizeof(count);
+        for (u32 i = 0; i < count; ++i) {
+            u32 address = 0;
+            u32 size = 0;
+            if (request.size() - offset < sizeof(address) + sizeof(size)) {
+                return false;
+            }
+            std::memcpy(&address, request.data() + offset, sizeof(address));
+            std::memcpy(&size, request.data() + offset + sizeof(address), sizeof(size));
+            offset += sizeof(address) + sizeof(size);
+            if (request.size() - offset < size) {
+                return false;
+            }
+            func(address, request.subspan(offset, size));
+            offset += size;
+        }
+        return offset == request.size();
+    };
+    if (!for_each_write([](u32, std::span<const u8>) {})) {
+        return false;
+    }
+    for_each_write([this](u32 address, std::span<const u8> data) {
+        if (!data.empty()) {
+            WriteMemory(address, data);
+        }
+    });
+
+    packet.SetPacketDataSize(0);
+    packet.SendReply();
+    return true;
+}
+
+bool RPCServer::HandleAddWatch(Packet& packet, u32 address, u32 size) {
+    // EndFrame reads watches without checking them, every page of the range must be mapped
+    const u64 end = u64{address} + size;
+    if (end > u64{1} << 32) {
+        return false;
+    }
+    auto& system = Core::System::GetInstance();
+    const auto process = system.Kernel().GetCurrentProcess();
+    if (!process) {
+        return false;
+    }
+    for (u64 page = address & ~Memory::CITRA_PAGE_MASK; page < end;
+         page += Memory::CITRA_PAGE_SIZE) {
+        if (!system.Memory().IsValidVirtualAddress(*process, static_cast<VAddr>(page))) {
+            return false;
+        }
+    }
+
+    u32 id;
+    {
+        std::scoped_lock lock{watch_mutex};
+        if (!accept_watches || watches.size() >= MAX_WATCH_COUNT) {
+            return false;
+        }
+        id = next_watch_id++;
+        watches.push_back({id, address, size, {}, packet.GetReplyCallback()});
+    }
+
+    std::memcpy(packet.GetPacketData().data(), &id, sizeof(id));
+    packet.SetPacketDataSize(sizeof(id));
+    packet.SendReply();
+    return true;
+}
+
+void RPCServer::HandleRemoveWatch(Packet& packet, u32 id) {
+    {
+        std::scoped_lock lock{watch_mutex};
+        std::erase_if(watches, [id](const Watch& watch) { return watch.id == id; });
+    }
+    packet.SetPacketDataSize(0);
+    packet.SendReply();
+}
+
+void RPCServer::EndFrame(u32 frame) {
+    std::scoped_lock lock{watch_mutex};
+    if (watches.empty()) {
+        return;
+    }
+
+    auto& system = Core::System::GetInstance();
+    const auto process = system.Kernel().GetCurrentProcess();
+    if (!process) {
+        return;
+    }
+
+    std::memcpy(watch_buffer.data(), &frame, sizeof(frame));
+    u8* const contents = watch_buffer.data() + sizeof(frame);
+    for (auto& watch : watches) {
+        system.Memory().ReadBlock(*process, watch.address, contents, watch.size);
+        if (!watch.contents.empty() &&
+            std::equal(watch.contents.begin(), watch.contents.end(), contents)) {
+            continue;
+        }
+        watch.contents.assign(contents, contents + watch.size);
+
+        const PacketHeader header{CURRENT_VERSION, watch.id, PacketType::WatchNotification,
+                                  static_cast<u32>(sizeof(frame) + watch.size)};
+        Packet notification{header, watch_buffer.data(), watch.send_notification};
+        notification.SendReply();
+    }
+}
+
+void RPCServer::HandleReadReport(Packet& packet, const std::string& report, u32 offset,
+                                 u32 data_size) {
+    // A reply shorter than requested marks the end of the report
+    const u32 size = offset < report.size()
+                         ? std::min<u32>(data_size, static_cast<u32>(report.size() - offset))
+                         : 0;
+    if (size > 0) {
+        std::memcpy(packet.GetPacketData().data(), report.data() + offset, size);
+    }
+    packet.SetPacketDataSize(size);
+    packet.SendReply();
+}
+
+void RPCServer::HandleReadHLEStats(Packet& packet, u32 offset, u32 data_size) {
+    if (offset == 0) {
+        // Recording starts with the first request, later reports cover the time since then
+        auto& hle_stats = Core::System::GetInstance().hle_stats;
+        hle_stats.SetEnabled(true);
+        hle_stats_report = hle_stats.GetReport();
+    }
+    HandleReadReport(packet, hle_stats_report, offset, data_size);
+}
+
+void RPCServer::HandleReadPerfStats(Packet& packet, u32 offset, u32 data_size) {
+    if (offset == 0) {
+        const auto& perf_stats = Core::System::GetInstance().perf_stats;
+        const auto results = perf_stats ? perf_stats->GetLastStats() : Core::PerfStats::Results{};
+        perf_stats_report = fmt::format("{}\n{}\n", Core::PerfStats::GetCsvHeader(),
+                                        Core::PerfStats::FormatCsvRow(results));
+    }
+    HandleReadReport(packet, perf_stats_report, offset, data_size);
+}
+
 bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
     if (packet_header.version <= CURRENT_VERSION) {
         switch (packet_header.packet_type) {
         case PacketType::ReadMemory:
         case PacketType::WriteMemory:
+        case PacketType::ReadHLEStats:
+        case PacketType::ReadPerfStats:
+        case PacketType::AddWatch:
             if (packet_header.packet_size >= (sizeof(u32) * 2)) {
                 return true;
             }
             break;
+        case PacketType::ReadMemoryBatch:
+        case PacketType::WriteMemoryBatch:
+        case PacketType::RemoveWatch:
+            if (packet_header.packet_size >= sizeof(u32)) {
+                return true;
+            }
+            break;
         default:
             break;
         }
@@ -76,7 +275,7 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
     const auto& packet_data = request_packet->GetPacketData();
 
     if (ValidatePacket(request_packet->GetHeader())) {
-        // Currently, all request types use the address/data_size wire format
+        // Apart from the batches, all request types start with the address/data_size wire format
         u32 address = 0;
         u32 data_size = 0;
         std::memcpy(&address, packet_data.data(), sizeof(address));
@@ -96,6 +295,33 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
                 success = true;
             }
             break;
+        case PacketType::ReadHLEStats:
+            if (data_size > 0 && data_size <= MAX_READ_SIZE) {
+                HandleReadHLEStats(*request_packet, address, data_size);
+                success = true;
+            }
+            break;
+        case PacketType::ReadPerfStats:
+            if (data_size > 0 && data_size <= MAX_READ_SIZE) {
+                HandleReadPerfStats(*request_packet, address, data_size);
+                success = true;
+            }
+            break;
+        case PacketType::ReadMemoryBatch:
+            success = HandleReadMemoryBatch(*request_packet);
+            break;
+        case PacketType::WriteMemoryBatch:
+            success = HandleWriteMemoryBatch(*request_packet);
+            break;
+        case PacketType::AddWatch:
+            if (data_size > 0 && data_size <= MAX_WATCH_SIZE) {
+                success = HandleAddWatch(*request_packet, address, data_size);
+            }
+            break;
+        case PacketType::RemoveWatch:
+            HandleRemoveWatch(*request_packet, address);
+            success = true;
+            break;
         default:
             break;
         }
@@ -123,12 +349,23 @@ void RPCServer::QueueRequest(std::unique_ptr<RPC::Packet> request) {
 }
 
 void RPCServer::Start() {
+    {
+        std::scoped_lock lock{watch_mutex};
+        accept_watches = true;
+    }
     const auto threadFunction = [this]() { HandleRequestsLoop(); };
     request_handler_thread = std::thread(threadFunction);
     server.Start();
 }
 
 void RPCServer::Stop() {
+    {
+        // Notifications are sent through the transports, which are destroyed by server.Stop.
+        // Requests still queued must not add watches after this either.
+        std::scoped_lock lock{watch_mutex};
+        accept_watches = false;
+        watches.clear();
+    }
     server.Stop();
     request_handler_thread.join();
 }
@@ -4,19 +4,21 @@
 
 #pragma once
 
+#include <array>
 #include <condition_variable>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <span>
+#include <string>
 #include <thread>
+#include <vector>
 #include "common/threadsafe_queue.h"
+#include "core/rpc/packet.h"
 #include "core/rpc/server.h"
 
 namespace RPC {
 
-class Packet;
-struct PacketHeader;
-
 class RPCServer {
 public:
     RPCServer();
@@ -24,18 +26,49 @@ public:
 
     void QueueRequest(std::unique_ptr<RPC::Packet> request);
 
+    /// Sends the watched memory that changed during the frame. Called by the emulation thread.
+    void EndFrame(u32 frame);
+
 private:
+    struct Watch {
+        u32 id;
+        u32 address;
+        u32 size;
+        std::vector<u8> contents; ///< Last sent contents, empty until the first notification
+        std::function<void(Packet&)> send_notification;
+    };
+
     void Start();
     void Stop();
     void HandleReadMemory(Packet& packet, u32 address, u32 data_size);
     void HandleWriteMemory(Packet& packet, u32 address, std::span<const u8> data);
+    bool HandleReadMemoryBatch(Packet& packet);
+    bool HandleWriteMemoryBatch(Packet& packet);
+    bool HandleAddWatch(Packet& packet, u32 address, u32 size);
+    void HandleRemoveWatch(Packet& packet, u32 id);
+    void WriteMemory(u32 address, std::span<const u8> data);
+    void HandleReadReport(Packet& packet, const std::string& report, u32 offset, u32 data_size);
+    void HandleReadHLEStats(Packet& packet, u32 offset, u32 data_size);
+    void HandleReadPerfStats(Packet& packet, u32 offset, u32 data_size);
     bool ValidatePacket(const PacketHeader& packet_header);
     void HandleSingleRequest(std::unique_ptr<Packet> request);
     void HandleRequestsLoop();
 
     Server server;
-    Common::SPSCQueue<std::unique_ptr<Packet>> request_queue;
+    Common::MPSCQueue<std::unique_ptr<Packet>> request_queue;
     std::thread request_handler_thread;
+    /// Reports read in chunks by ReadHLEStats and ReadPerfStats requests, which are taken when
+    /// reading from offset 0
+    std::string hle_stats_report;
+    std::string perf_stats_report;
+
+    std::mutex watch_mutex;
+    std::vector<Watch> watches;
+    u32 next_watch_id = 1;
+    /// Cleared with the watches when the transports are stopped
+    bool accept_watches = false;
+    /// Frame number followed by the contents of the watch being checked
+    std::array<u8, MAX_PACKET_DATA_SIZE> watch_buffer;
 };
 
 } // namespace RPC
@@ -0,0 +1,181 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/polyfill_thread.h"
+#include "common/thread.h"
+#include "core/rpc/packet.h"
+#include "core/rpc/shared_memory_server.h"
+
+namespace RPC {
+
+namespace {
+
+constexpr u32 SHARED_MEMORY_MAGIC = 0x43505243; // "CRPC"
+constexpr u32 SHARED_MEMORY_VERSION = 1;
+/// Size of each ring, a power of two so that the free running positions can wrap around
+constexpr u32 RING_SIZE = 1 << 16;
+/// Empty polls after a message during which the thread yields instead of sleeping
+constexpr u32 SPIN_POLLS = 1000;
+constexpr auto IDLE_SLEEP = std::chrono::microseconds(100);
+
+struct SharedMemoryHeader {
+    u32 magic;
+    u32 version;
+    u32 ring_size;
+    u32 reserved;
+    // Each position is written by one process only, keep them on separate cache lines
+    alignas(64) std::atomic<u32> request_head; ///< Written by the client
+    alignas(64) std::atomic<u32> request_tail; ///< Written by the server
+    alignas(64) std::atomic<u32> reply_head;   ///< Written by the server
+    alignas(64) std::atomic<u32> reply_tail;   ///< Written by the client
+};
+static_assert(sizeof(SharedMemoryHeader) == 320, "SharedMemoryHeader has the wrong size");
+static_assert(std::atomic<u32>::is_always_lock_free,
+              "Positions must be lock free to be shared with another process");
+
+constexpr std::size_t REQUEST_RING_OFFSET = sizeof(SharedMemoryHeader);
+constexpr std::size_t REPLY_RING_OFFSET = REQUEST_RING_OFFSET + RING_SIZE;
+constexpr std::size_t SHARED_MEMORY_SIZE = REPLY_RING_OFFSET + RING_SIZE;
+
+void CopyFromRing(const u8* ring, u32 position, void* dest, u32 size) {
+    const u32 offset = position % RING_SIZE;
+    const u32 first = std::min(size, RING_SIZE - offset);
+    std::memcpy(dest, ring + offset, first);
+    std::memcpy(static_cast<u8*>(dest) + first, ring, size - first);
+}
+
+void CopyToRing(u8* ring, u32 position, const void* src, u32 size) {
+    const u32 offset = position % RING_SIZE;
+    const u32 first = std::min(size, RING_SIZE - offset);
+    std::memcpy(ring + offset, src, first);
+    std::memcpy(ring, static_cast<const u8*>(src) + first, size - first);
+}
+
+} // Anonymous namespace
+
+class SharedMemoryServer::Impl {
+public:
+    explicit Impl(std::function<void(std::unique_ptr<Packet>)> new_request_callback)
+        : new_request_callback(std::move(new_request_callback)) {
+        const std::string path =
+            FileUtil::GetUserPath(FileUtil::UserPath::UserDir) + "rpc_shared_memory";
+        FileUtil::IOFile file(path, "w+b");
+        if (!file.IsOpen() || !file.Resize(SHARED_MEMORY_SIZE) || !mapping.Map(file, true)) {
+            throw std::runtime_error("Failed to map the RPC shared memory file");
+        }
+
+        u8* data = mapping.WritableData();
+        header = new (data) SharedMemoryHeader{};
+        header->version = SHARED_MEMORY_VERSION;
+        header->ring_size = RING_SIZE;
+        request_ring = data + REQUEST_RING_OFFSET;
+        reply_ring = data + REPLY_RING_OFFSET;
+        // Written last, clients wait for the magic before using the rings
+        std::atomic_ref{header->magic}.store(SHARED_MEMORY_MAGIC, std::memory_order_release);
+
+        worker_thread = std::jthread([this](std::stop_token stop_token) { Run(stop_token); });
+        LOG_INFO(RPC_Server, "Serving RPC requests through {}", path);
+    }
+
+    ~Impl() = default;
+
+private:
+    void Run(std::stop_token stop_token) {
+        Common::SetCurrentThreadName("RPC:SharedMemory");
+        const auto send_reply_callback = [this](Packet& reply) { SendReply(reply); };
+
+        u32 idle_polls = SPIN_POLLS;
+        while (!stop_token.stop_requested()) {
+            const u32 head = header->request_head.load(std::memory_order_acquire);
+            u32 tail = header->request_tail.load(std::memory_order_relaxed);
+            if (head == tail) {
+                if (idle_polls < SPIN_POLLS) {
+                    ++idle_polls;
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(IDLE_SLEEP);
+                }
+                continue;
+            }
+            idle_polls = 0;
+
+            // The client only advances the head past complete messages
+            const u32 available = head - tail;
+            PacketHeader packet_header{};
+            if (available >= MIN_PACKET_SIZE && available <= RING_SIZE) {
+                CopyFromRing(request_ring, tail, &packet_header, sizeof(packet_header));
+            }
+            if (available < MIN_PACKET_SIZE || available > RING_SIZE ||
+                packet_header.packet_size > MAX_PACKET_DATA_SIZE ||
+                packet_header.packet_size > available - MIN_PACKET_SIZE) {
+                LOG_WARNING(RPC_Server, "Dropping {} bytes of malformed shared memory requests",
+                            available);
+                header->request_tail.store(head, std::memory_order_release);
+                continue;
+            }
+
+            CopyFromRing(request_ring, tail + MIN_PACKET_SIZE, request_buffer.data(),
+                         packet_header.packet_size);
+            tail += MIN_PACKET_SIZE + packet_header.packet_size;
+            header->request_tail.store(tail, std::memory_order_release);
+
+            new_request_callback(std::make_unique<Packet>(packet_header, request_buffer.data(),
+                                                          send_reply_callback));
+        }
+    }
+
+    void SendReply(Packet& reply_packet) {
+        // Replies come from the request handler and watch notifications from the emulation thread
+        std::scoped_lock lock{reply_mutex};
+        const auto reply_header = reply_packet.GetHeader();
+        const u32 size = MIN_PACKET_SIZE + reply_packet.GetPacketDataSize();
+        const u32 head = header->reply_head.load(std::memory_order_relaxed);
+        const u32 tail = header->reply_tail.load(std::memory_order_acquire);
+        if (RING_SIZE - (head - tail) < size) {
+            LOG_WARNING(RPC_Server, "Shared memory reply ring is full, dropping reply id={}",
+                        reply_packet.GetId());
+            return;
+        }
+
+        CopyToRing(reply_ring, head, &reply_header, sizeof(reply_header));
+        CopyToRing(reply_ring, head + MIN_PACKET_SIZE, reply_packet.GetPacketData().data(),
+                   reply_packet.GetPacketDataSize());
+        header->reply_head.store(head + size, std::memory_order_release);
+
+        LOG_TRACE(RPC_Server, "Sent reply version({}) id=({}) type=({}) size=({})",
+                  reply_packet.GetVersion(), reply_packet.GetId(), reply_packet.GetPacketType(),
+                  reply_packet.GetPacketDataSize());
+    }
+
+    FileUtil::MappedFile mapping;
+    SharedMemoryHeader* header = nullptr;
+    u8* request_ring = nullptr;
+    u8* reply_ring = nullptr;
+    std::array<u8, MAX_PACKET_DATA_SIZE> request_buffer;
+    std::mutex reply_mutex;
+
+    std::function<void(std::unique_ptr<Packet>)> new_request_callback;
+
+    // Declared last, so that it is stopped before the mapping is released
+    std::jthread worker_thread;
+};
+
+SharedMemoryServer::SharedMemoryServer(
+    std::function<void(std::unique_ptr<Packet>)> new_request_callback)
+    : impl(std::make_unique<Impl>(std::move(new_request_callback))) {}
+
+SharedMemoryServer::~SharedMemoryServer() = default;
+
+} // namespace RPC
@@ -0,0 +1,32 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+
+namespace RPC {
+
+class Packet;
+
+/**
+ * Exchanges packets with a client through two ring buffers in a file mapped by both processes,
+ * rpc_shared_memory in the user directory, which avoids a system call per request. The file
+ * starts with a SharedMemoryHeader, followed by the request ring and the reply ring of ring_size
+ * bytes each. A message is a PacketHeader followed by its data, and may wrap around the end of
+ * its ring. The head and tail are free running byte counts: the producer writes a message and
+ * then advances the head, the consumer reads it and then advances the tail.
+ */
+class SharedMemoryServer {
+public:
+    explicit SharedMemoryServer(std::function<void(std::unique_ptr<Packet>)> new_request_callback);
+    ~SharedMemoryServer();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace RPC
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <mutex>
 #include <thread>
 #include <boost/asio.hpp>
 #include "common/common_types.h"
@@ -66,15 +67,17 @@ private:
         std::memcpy(reply_buffer.data() + (4 * sizeof(u32)), reply_packet.GetPacketData().data(),
                     reply_packet.GetPacketDataSize());
 
+        // Watch notifications are sent from the emulation thread
+        std::scoped_lock lock{send_mutex};
         boost::system::error_code error;
         socket.send_to(boost::asio::buffer(reply_buffer), endpoint, 0, error);
 
         if (error) {
             LOG_WARNING(RPC_Server, "Failed to send reply: {}", error.message());
         } else {
-            LOG_INFO(RPC_Server, "Sent reply version({}) id=({}) type=({}) size=({})",
-                     reply_packet.GetVersion(), reply_packet.GetId(), reply_packet.GetPacketType(),
-                     reply_packet.GetPacketDataSize());
+            LOG_TRACE(RPC_Server, "Sent reply version({}) id=({}) type=({}) size=({})",
+                      reply_packet.GetVersion(), reply_packet.GetId(), reply_packet.GetPacketType(),
+                      reply_packet.GetPacketDataSize());
         }
     }
 
@@ -82,6 +85,7 @@ private:
 
     boost::asio::io_context io_context;
     boost::asio::ip::udp::socket socket;
+    std::mutex send_mutex;
     std::array<u8, MAX_PACKET_SIZE> request_buffer;
     boost::asio::ip::udp::endpoint remote_endpoint;
 
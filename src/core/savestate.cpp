@@ -101,7 +101,7 @@ std::vector<SaveStateInfo> ListSaveStates(u64 program_id) {
     return result;
 }
 
-void System::SaveState(u32 slot) const {
+std::vector<u8> System::SaveStateBuffer() const {
     std::ostringstream sstream{std::ios_base::binary};
     // Serialize
     oarchive oa{sstream};
@@ -109,7 +109,23 @@ void System::SaveState(u32 slot) const {
 
     const std::string& str{sstream.str()};
     const auto data = std::span<const u8>{reinterpret_cast<const u8*>(str.data()), str.size()};
-    auto buffer = Common::Compression::CompressDataZSTDDefault(data);
+    return Common::Compression::CompressDataZSTDDefault(data);
+}
+
+void System::LoadStateBuffer(std::span<const u8> buffer) {
+    std::vector<u8> decompressed = Common::Compression::DecompressDataZSTD(buffer);
+    std::istringstream sstream{
+        std::string{reinterpret_cast<char*>(decompressed.data()), decompressed.size()},
+        std::ios_base::binary};
+    decompressed.clear();
+
+    // Deserialize
+    iarchive ia{sstream};
+    ia&* this;
+}
+
+void System::SaveState(u32 slot) const {
+    const auto buffer = SaveStateBuffer();
 
     const auto path = GetSaveStatePath(title_id, slot);
     if (!FileUtil::CreateFullPath(path)) {
@@ -145,10 +161,8 @@ void System::LoadState(u32 slot) {
 
     const auto path = GetSaveStatePath(title_id, slot);
 
-    std::vector<u8> decompressed;
+    std::vector<u8> buffer(FileUtil::GetSize(path) - sizeof(CSTHeader));
     {
-        std::vector<u8> buffer(FileUtil::GetSize(path) - sizeof(CSTHeader));
-
         FileUtil::IOFile file(path, "rb");
 
         // load header
@@ -166,16 +180,8 @@ void System::LoadState(u32 slot) {
         if (file.ReadBytes(buffer.data(), buffer.size()) != buffer.size()) {
             throw std::runtime_error("Could not read from file at " + path);
         }
-        decompressed = Common::Compression::DecompressDataZSTD(buffer);
     }
-    std::istringstream sstream{
-        std::string{reinterpret_cast<char*>(decompressed.data()), decompressed.size()},
-        std::ios_base::binary};
-    decompressed.clear();
-
-    // Deserialize
-    iarchive ia{sstream};
-    ia&* this;
+    LoadStateBuffer(buffer);
 }
 
 } // namespace Core
@@ -0,0 +1,232 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "common/assert.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "core/hw/gpu.h"
+#include "core/hw/hw.h"
+#include "core/hw/lcd.h"
+#include "core/memory.h"
+#include "core/tracer/player.h"
+#include "video_core/pica_state.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace CiTrace {
+
+namespace {
+
+/// Copies a register file, which may be shorter or longer in traces of other versions
+template <typename Regs>
+void CopyRegisters(Regs& regs, const u32* values, u32 size) {
+    const std::size_t count = std::min<std::size_t>(size, sizeof(Regs) / sizeof(u32));
+    std::memcpy(&regs, values, count * sizeof(u32));
+}
+
+/// Copies a shader program or swizzle data table
+template <std::size_t N>
+void CopyShaderData(std::array<u32, N>& dest, const u32* values, u32 size) {
+    std::copy_n(values, std::min<std::size_t>(size, N), dest.begin());
+}
+
+/// Loads vectors of float24 values, stored with one u32 per component
+template <typename Vector>
+void LoadFloat24Vectors(Vector* dest, std::size_t count, const u32* values, u32 size) {
+    count = std::min<std::size_t>(count, size / 4);
+    for (std::size_t i = 0; i < count; ++i) {
+        for (std::size_t comp = 0; comp < 4; ++comp) {
+            dest[i][comp] = Pica::f24::FromRaw(values[4 * i + comp] & 0xFFFFFF);
+        }
+    }
+}
+
+} // Anonymous namespace
+
+Player::Player(Memory::MemorySystem& memory_) : memory{memory_} {}
+
+bool Player::Load(const std::string& filename) {
+    std::string file_data;
+    if (FileUtil::ReadFileToString(false, filename, file_data) < sizeof(CTHeader)) {
+        LOG_ERROR(HW_GPU, "Failed to read CiTrace file {}", filename);
+        return false;
+    }
+    data.assign(file_data.begin(), file_data.end());
+
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, CTHeader::ExpectedMagicWord(), 4) != 0 ||
+        header.version != CTHeader::ExpectedVersion()) {
+        LOG_ERROR(HW_GPU, "{} is not a CiTrace file of version {}", filename,
+                  CTHeader::ExpectedVersion());
+        return false;
+    }
+
+    const u64 stream_end =
+        header.stream_offset + static_cast<u64>(header.stream_size) * sizeof(CTStreamElement);
+    if (stream_end > data.size()) {
+        LOG_ERROR(HW_GPU, "CiTrace file {} is truncated", filename);
+        return false;
+    }
+    stream.resize(header.stream_size);
+    std::memcpy(stream.data(), data.data() + header.stream_offset,
+                stream.size() * sizeof(CTStreamElement));
+
+    // A frame ends with its frame marker. Elements after the last marker, from a recording that
+    // was stopped in the middle of a frame, form a frame of their own.
+    frame_starts.clear();
+    bool frame_started = false;
+    for (std::size_t i = 0; i < stream.size(); ++i) {
+        if (!frame_started) {
+            frame_starts.push_back(i);
+            frame_started = true;
+        }
+        if (stream[i].type == FrameMarker) {
+            frame_started = false;
+        }
+    }
+
+    LOG_INFO(HW_GPU, "Loaded CiTrace file {} with {} stream elements in {} frames", filename,
+             stream.size(), frame_starts.size());
+    return true;
+}
+
+const u32* Player::GetSection(u32 offset, u32 size, std::size_t expected_size) const {
+    if (size == 0) {
+        return nullptr;
+    }
+    if (offset + static_cast<u64>(size) * sizeof(u32) > data.size()) {
+        LOG_ERROR(HW_GPU, "CiTrace initial state section at {:#x} is out of bounds", offset);
+        return nullptr;
+    }
+    if (size != expected_size) {
+        LOG_WARNING(HW_GPU, "CiTrace initial state section at {:#x} has {} entries, expected {}",
+                    offset, size, expected_size);
+    }
+    return reinterpret_cast<const u32*>(data.data() + offset);
+}
+
+void Player::ApplyInitialState() {
+    const auto& initial = header.initial_state_offsets;
+    auto& state = Pica::g_state;
+
+    if (const u32* values = GetSection(initial.gpu_registers, initial.gpu_registers_size,
+                                       sizeof(GPU::Regs) / sizeof(u32))) {
+        CopyRegisters(GPU::g_regs, values, initial.gpu_registers_size);
+    }
+    if (const u32* values = GetSection(initial.lcd_registers, initial.lcd_registers_size,
+                                       sizeof(LCD::Regs) / sizeof(u32))) {
+        CopyRegisters(LCD::g_regs, values, initial.lcd_registers_size);
+    }
+    if (const u32* values = GetSection(initial.pica_registers, initial.pica_registers_size,
+                                       Pica::Regs::NUM_REGS)) {
+        CopyRegisters(state.regs, values, initial.pica_registers_size);
+    }
+    if (const u32* values = GetSection(initial.default_attributes,
+                                       initial.default_attributes_size, 4 * 16)) {
+        LoadFloat24Vectors(state.input_default_attributes.attr, 16, values,
+                           initial.default_attributes_size);
+    }
+
+    const auto load_shader = [this](Pica::Shader::ShaderSetup& setup, u32 program_offset,
+                                    u32 program_size, u32 swizzle_offset, u32 swizzle_size,
+                                    u32 uniforms_offset, u32 uniforms_size) {
+        if (const u32* values =
+                GetSection(program_offset, program_size, Pica::Shader::MAX_PROGRAM_CODE_LENGTH)) {
+            CopyShaderData(setup.program_code, values, program_size);
+            setup.MarkProgramCodeDirty();
+        }
+        if (const u32* values =
+                GetSection(swizzle_offset, swizzle_size, Pica::Shader::MAX_SWIZZLE_DATA_LENGTH)) {
+            CopyShaderData(setup.swizzle_data, values, swizzle_size);
+            setup.MarkSwizzleDataDirty();
+        }
+        if (const u32* values =
+                GetSection(uniforms_offset, uniforms_size, 4 * setup.uniforms.f.size())) {
+            LoadFloat24Vectors(setup.uniforms.f.data(), setup.uniforms.f.size(), values,
+                               uniforms_size);
+        }
+    };
+    load_shader(state.vs, initial.vs_program_binary, initial.vs_program_binary_size,
+                initial.vs_swizzle_data, initial.vs_swizzle_data_size, initial.vs_float_uniforms,
+                initial.vs_float_uniforms_size);
+    load_shader(state.gs, initial.gs_program_binary, initial.gs_program_binary_size,
+                initial.gs_swizzle_data, initial.gs_swizzle_data_size, initial.gs_float_uniforms,
+                initial.gs_float_uniforms_size);
+
+    // The registers were replaced behind the rasterizer's back
+    VideoCore::g_renderer->Rasterizer()->SyncEntireState();
+}
+
+void Player::ReplayFrame(std::size_t frame) {
+    ASSERT(frame < frame_starts.size());
+    for (std::size_t i = frame_starts[frame]; i < stream.size(); ++i) {
+        ApplyElement(stream[i]);
+        if (stream[i].type == FrameMarker) {
+            break;
+        }
+    }
+}
+
+void Player::ApplyElement(const CTStreamElement& element) {
+    switch (element.type) {
+    case FrameMarker:
+        break;
+
+    case MemoryLoad: {
+        const auto& load = element.memory_load;
+        u8* dest = memory.GetPhysicalPointer(load.physical_address);
+        // The whole load has to be within the same physical memory region as its start
+        const u64 last_address = u64{load.physical_address} + load.size - 1;
+        const bool in_bounds = load.size == 0 ||
+                               (last_address <= std::numeric_limits<PAddr>::max() &&
+                                memory.GetPhysicalPointer(static_cast<PAddr>(last_address)) ==
+                                    dest + load.size - 1);
+        if (!dest || !in_bounds || load.file_offset + static_cast<u64>(load.size) > data.size()) {
+            LOG_ERROR(HW_GPU, "Invalid memory load of {:#x} bytes to {:#010x}", load.size,
+                      load.physical_address);
+            break;
+        }
+        // Invalidate first, like the GPU does, so that pending render target writes do not
+        // overwrite the loaded data
+        VideoCore::g_renderer->Rasterizer()->InvalidateRegion(load.physical_address, load.size);
+        std::memcpy(dest, data.data() + load.file_offset, load.size);
+        break;
+    }
+
+    case RegisterWrite: {
+        const auto& write = element.register_write;
+        // The recorder stores the physical address of the IO register
+        const u32 addr = write.physical_address - Memory::IO_AREA_PADDR + Memory::IO_AREA_VADDR;
+        switch (write.size) {
+        case CTRegisterWrite::SIZE_8:
+            HW::Write<u8>(addr, static_cast<u8>(write.value));
+            break;
+        case CTRegisterWrite::SIZE_16:
+            HW::Write<u16>(addr, static_cast<u16>(write.value));
+            break;
+        case CTRegisterWrite::SIZE_32:
+            HW::Write<u32>(addr, static_cast<u32>(write.value));
+            break;
+        case CTRegisterWrite::SIZE_64:
+            HW::Write<u64>(addr, write.value);
+            break;
+        default:
+            LOG_ERROR(HW_GPU, "Invalid register write size {:#x}", static_cast<u32>(write.size));
+            break;
+        }
+        break;
+    }
+
+    default:
+        LOG_ERROR(HW_GPU, "Unknown CiTrace stream element type {:#x}",
+                  static_cast<u32>(element.type));
+        break;
+    }
+}
+
+} // namespace CiTrace
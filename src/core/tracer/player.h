@@ -0,0 +1,59 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "core/tracer/citrace.h"
+
+namespace Memory {
+class MemorySystem;
+}
+
+namespace CiTrace {
+
+/**
+ * Replays a CiTrace file recorded by the Recorder. The memory loads and GPU register writes of the
+ * trace are applied to the emulated hardware, so the command lists of the trace go through the
+ * regular command processor and rasterizer, without any guest code running.
+ */
+class Player {
+public:
+    explicit Player(Memory::MemorySystem& memory);
+
+    /**
+     * Reads a CiTrace file.
+     * @returns true if the file is a valid CiTrace
+     */
+    bool Load(const std::string& filename);
+
+    /// Returns the number of frames in the trace
+    std::size_t GetFrameCount() const {
+        return frame_starts.size();
+    }
+
+    /// Restores the GPU state at the start of the trace
+    void ApplyInitialState();
+
+    /// Replays the stream elements of a frame, up to and including its frame marker
+    void ReplayFrame(std::size_t frame);
+
+private:
+    /// Returns the initial state section with the given offset and size in u32 units
+    const u32* GetSection(u32 offset, u32 size, std::size_t expected_size) const;
+
+    void ApplyElement(const CTStreamElement& element);
+
+    Memory::MemorySystem& memory;
+    std::vector<u8> data;
+    CTHeader header{};
+    std::vector<CTStreamElement> stream;
+
+    /// Index of the first stream element of each frame
+    std::vector<std::size_t> frame_starts;
+};
+
+} // namespace CiTrace
@@ -0,0 +1,69 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/logging/binary_log.h"
+#include "common/logging/log_entry.h"
+#include "common/logging/text_formatter.h"
+
+namespace Common::Log {
+
+namespace {
+
+enum class TestEnum : u16 { Value = 7 };
+
+Entry MakeEntry(u32 line_num) {
+    return {
+        .timestamp = std::chrono::microseconds{1234567 + line_num},
+        .log_class = Class::Log,
+        .log_level = Level::Warning,
+        .filename = "binary_log.cpp",
+        .line_num = line_num,
+        .function = "MakeEntry",
+    };
+}
+
+} // Anonymous namespace
+
+TEST_CASE("BinaryLog round trip", "[common]") {
+    std::vector<Entry> entries;
+
+    Entry deferred = MakeEntry(1);
+    deferred.format = "{} {:#x} {:.2f} {} {} {}";
+    deferred.args.Capture(-5, 0xABCDu, 1.5f, true, 'c', TestEnum::Value);
+    entries.push_back(deferred);
+
+    Entry eager = MakeEntry(2);
+    eager.message = "already formatted {}";
+    entries.push_back(eager);
+
+    // A format string used a second time is referred to by id
+    Entry repeated = MakeEntry(3);
+    repeated.format = deferred.format;
+    repeated.args.Capture(1, 2u, 3.0f, false, 'd', TestEnum::Value);
+    entries.push_back(repeated);
+
+    BinaryLogEncoder encoder;
+    std::vector<u8> data;
+    encoder.EncodeHeader(data);
+    std::string expected;
+    for (Entry& entry : entries) {
+        encoder.Encode(entry, data);
+        if (entry.args.IsCaptured()) {
+            entry.message = entry.args.Format(entry.format);
+        }
+        expected.append(FormatLogMessage(entry)).append(1, '\n');
+    }
+    REQUIRE(ExpandBinaryLog(data) == expected);
+    REQUIRE(entries[0].message == "-5 0xabcd 1.50 true c 7");
+
+    // A record cut off by a crash is dropped
+    data.pop_back();
+    const std::string truncated = ExpandBinaryLog(data);
+    REQUIRE(truncated == expected.substr(0, truncated.size()));
+    REQUIRE(truncated.size() < expected.size());
+}
+
+} // namespace Common::Log
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <filesystem>
 #include <string>
 
 #include <catch2/catch_test_macros.hpp>
@@ -24,3 +25,33 @@ TEST_CASE("SplitFilename83 Sanity", "[common]") {
     REQUIRE(std::memcmp(short_name.data(), expected_short_name.data(), short_name.size()) == 0);
     REQUIRE(std::memcmp(extension.data(), expected_extension.data(), extension.size()) == 0);
 }
+
+TEST_CASE("MappedFile reads file contents", "[common]") {
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "citra_mapped_file_test.bin").string();
+    std::array<u8, 0x1234> data;
+    for (std::size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<u8>(i * 7);
+    }
+    {
+        FileUtil::IOFile file(path, "wb");
+        REQUIRE(file.WriteBytes(data.data(), data.size()) == data.size());
+    }
+
+    FileUtil::MappedFile mapping;
+    {
+        FileUtil::IOFile file(path, "rb");
+        REQUIRE(mapping.Map(file));
+    }
+    REQUIRE(mapping.Size() == data.size());
+    REQUIRE(std::memcmp(mapping.Data(), data.data(), data.size()) == 0);
+
+    const auto tail = mapping.GetSpan(0x1200, 0x100);
+    REQUIRE(tail.size() == 0x34);
+    REQUIRE(std::memcmp(tail.data(), data.data() + 0x1200, tail.size()) == 0);
+    REQUIRE(mapping.GetSpan(data.size(), 1).empty());
+
+    mapping.Unmap();
+    REQUIRE(!mapping.IsMapped());
+    FileUtil::Delete(path);
+}
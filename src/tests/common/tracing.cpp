@@ -0,0 +1,133 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/tracing.h"
+
+namespace {
+
+namespace Tracing = Common::Tracing;
+
+// Events kept per thread, see RingSize in tracing.cpp
+constexpr u64 RingSize = 1 << 16;
+
+/// Records events on a new thread with the given name, and returns the exported events of it
+template <typename Func>
+std::vector<std::string> TraceOnThread(const char* thread_name, Func&& func) {
+    const std::string path = (std::filesystem::temp_directory_path() /
+                              fmt::format("citra_tracing_test_{}.json", std::random_device{}()))
+                                 .string();
+
+    Tracing::SetEnabled(true);
+    std::thread thread([&] {
+        Tracing::SetThreadName(thread_name);
+        func();
+    });
+    thread.join();
+    Tracing::SetEnabled(false);
+    REQUIRE(Tracing::ExportChromeTrace(path));
+
+    std::string json;
+    REQUIRE(FileUtil::ReadFileToString(true, path, json) > 0);
+    FileUtil::Delete(path);
+
+    // Events are written one per line, find the id of the thread from its name first
+    std::vector<std::string> lines;
+    for (std::size_t begin = 0, end; begin < json.size(); begin = end + 1) {
+        end = json.find('\n', begin);
+        if (end == std::string::npos) {
+            end = json.size();
+        }
+        lines.emplace_back(json.substr(begin, end - begin));
+    }
+    REQUIRE(lines.front() == R"({"displayTimeUnit":"ns","traceEvents":[)");
+    REQUIRE(lines.back() == "]}");
+
+    const std::string name_arg = fmt::format(R"("args":{{"name":"{}"}}}})", thread_name);
+    std::string tid;
+    for (const auto& line : lines) {
+        if (line.find(R"("name":"thread_name")") != std::string::npos &&
+            line.find(name_arg) != std::string::npos) {
+            const std::size_t begin = line.find(R"("tid":)") + 6;
+            tid = line.substr(begin, line.find(',', begin) - begin);
+        }
+    }
+    REQUIRE(!tid.empty());
+
+    std::vector<std::string> events;
+    const std::string tid_field = fmt::format(R"("pid":1,"tid":{})", tid);
+    for (const auto& line : lines) {
+        const std::size_t pos = line.find(tid_field);
+        if (pos == std::string::npos || line.find(R"("name":"thread_name")") != std::string::npos) {
+            continue;
+        }
+        const char next = line[pos + tid_field.size()];
+        if (next == '}' || next == ',') {
+            events.push_back(line);
+        }
+    }
+    return events;
+}
+
+bool Contains(const std::string& str, const std::string& part) {
+    return str.find(part) != std::string::npos;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Tracing exports Chrome trace events", "[common]") {
+    const auto events = TraceOnThread("Tracing export", [] {
+        {
+            CITRA_TRACE_SCOPE("Test", "\"Outer\"");
+            CITRA_TRACE_COUNTER("Test", "Queue", 3);
+            CITRA_TRACE_FLOW_BEGIN("Test", "Flow", 7);
+            CITRA_TRACE_FLOW_STEP("Test", "Flow", 7);
+            CITRA_TRACE_FLOW_END("Test", "Flow", 7);
+        }
+        // Never closed, the export ends it at the last event
+        Tracing::RecordEvent(Tracing::EventType::Begin, "Test", "Open");
+    });
+
+    REQUIRE(events.size() == 8);
+    REQUIRE(Contains(events[0], R"("name":"\"Outer\"","cat":"Test","ph":"B")"));
+    REQUIRE(Contains(events[1], R"("name":"Queue","cat":"Test","ph":"C")"));
+    REQUIRE(Contains(events[1], R"("args":{"value":3})"));
+    REQUIRE(Contains(events[2], R"("ph":"s")"));
+    REQUIRE(Contains(events[2], R"("id":7)"));
+    REQUIRE(Contains(events[3], R"("ph":"t")"));
+    REQUIRE(Contains(events[4], R"("ph":"f")"));
+    REQUIRE(Contains(events[4], R"("id":7,"bp":"e")"));
+    REQUIRE(Contains(events[5], R"("name":"\"Outer\"","cat":"Test","ph":"E")"));
+    REQUIRE(Contains(events[6], R"("name":"Open","cat":"Test","ph":"B")"));
+    REQUIRE(Contains(events[7], R"("name":"Open","cat":"Test","ph":"E")"));
+}
+
+TEST_CASE("Tracing keeps the newest events when the ring wraps around", "[common]") {
+    constexpr u64 NumEvents = RingSize + 100;
+    const auto events = TraceOnThread("Tracing wraparound", [] {
+        Tracing::RecordEvent(Tracing::EventType::Begin, "Test", "Overwritten");
+        for (u64 i = 1; i < NumEvents - 1; ++i) {
+            CITRA_TRACE_COUNTER("Test", "Index", i);
+        }
+        Tracing::RecordEvent(Tracing::EventType::End, "Test", "Overwritten");
+    });
+
+    // The begin of the scope was overwritten, so its end is dropped. The oldest event left in the
+    // ring is dropped too, as it is the one the thread would overwrite next.
+    REQUIRE(events.size() == RingSize - 2);
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const u64 index = NumEvents - RingSize + 1 + i;
+        REQUIRE(Contains(events[i], fmt::format(R"("args":{{"value":{}}})", index)));
+    }
+}
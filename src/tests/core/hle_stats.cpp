@@ -0,0 +1,90 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <limits>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "core/hle_stats.h"
+
+using Histogram = Core::HLEStats::Histogram;
+
+TEST_CASE("HLEStats histogram counts small values exactly", "[core]") {
+    for (u64 value = 0; value < Histogram::LinearBuckets; ++value) {
+        REQUIRE(Histogram::GetBucket(value) == value);
+        REQUIRE(Histogram::GetBucketLowerBound(value) == value);
+    }
+}
+
+TEST_CASE("HLEStats histogram splits powers of two into 8 buckets", "[core]") {
+    // 16 and 17 share a bucket, as do 32 to 35
+    REQUIRE(Histogram::GetBucket(16) == 16);
+    REQUIRE(Histogram::GetBucket(17) == 16);
+    REQUIRE(Histogram::GetBucket(18) == 17);
+    REQUIRE(Histogram::GetBucket(31) == 23);
+    REQUIRE(Histogram::GetBucket(32) == 24);
+    REQUIRE(Histogram::GetBucket(35) == 24);
+    REQUIRE(Histogram::GetBucket(36) == 25);
+    REQUIRE(Histogram::GetBucketLowerBound(17) == 18);
+    REQUIRE(Histogram::GetBucketLowerBound(24) == 32);
+    REQUIRE(Histogram::GetBucketLowerBound(25) == 36);
+
+    // 1000 is in [960, 1024)
+    REQUIRE(Histogram::GetBucket(1000) == 63);
+    REQUIRE(Histogram::GetBucketLowerBound(63) == 960);
+
+    REQUIRE(Histogram::GetBucket(std::numeric_limits<u64>::max()) == Histogram::NumBuckets - 1);
+}
+
+TEST_CASE("HLEStats histogram buckets are contiguous", "[core]") {
+    for (std::size_t bucket = 0; bucket < Histogram::NumBuckets; ++bucket) {
+        const u64 lower_bound = Histogram::GetBucketLowerBound(bucket);
+        REQUIRE(Histogram::GetBucket(lower_bound) == bucket);
+        if (bucket + 1 < Histogram::NumBuckets) {
+            const u64 upper_bound = Histogram::GetBucketLowerBound(bucket + 1) - 1;
+            REQUIRE(Histogram::GetBucket(upper_bound) == bucket);
+            // Every value is within 12.5% of the lower bound of its bucket
+            REQUIRE(upper_bound - lower_bound <= lower_bound / 8);
+        }
+    }
+}
+
+TEST_CASE("HLEStats histogram percentiles", "[core]") {
+    Histogram histogram;
+    REQUIRE(histogram.GetPercentile(0.5) == 0);
+
+    for (u64 value = 0; value < 100; ++value) {
+        histogram.Record(value);
+    }
+    REQUIRE(histogram.count == 100);
+    REQUIRE(histogram.total_ns == 4950);
+    REQUIRE(histogram.max_ns == 99);
+
+    // The 51st value, 50, is in [48, 52)
+    REQUIRE(histogram.GetPercentile(0.5) == 48);
+    // The 91st value, 90, is in [88, 96)
+    REQUIRE(histogram.GetPercentile(0.9) == 88);
+    // The 100th value, 99, is in [96, 104)
+    REQUIRE(histogram.GetPercentile(0.99) == 96);
+    REQUIRE(histogram.GetPercentile(0.0) == 0);
+    // There is no 101st value
+    REQUIRE(histogram.GetPercentile(1.0) == 99);
+}
+
+TEST_CASE("HLEStats only counts frames while enabled", "[core]") {
+    Core::HLEStats stats;
+    REQUIRE(!stats.IsEnabled());
+    stats.EndFrame();
+    REQUIRE(stats.GetReport().starts_with("# frames=0\n"));
+
+    stats.SetEnabled(true);
+    stats.EndFrame();
+    stats.RecordSVC(0x32, "SendSyncRequest", std::chrono::microseconds{3});
+    const std::string report = stats.GetReport();
+    REQUIRE(report.starts_with("# frames=1\n"));
+    REQUIRE(report.find("svc,0x32,SendSyncRequest,1,1.00,3.0,3.00,3.00,") != std::string::npos);
+}
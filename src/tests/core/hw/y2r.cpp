@@ -0,0 +1,395 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/memory_ref.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/service/y2r_u.h"
+#include "core/hw/y2r.h"
+#include "core/memory.h"
+
+using namespace Service::Y2R;
+
+namespace {
+
+constexpr VAddr BufferVAddr = 0x10000000;
+constexpr u32 BufferSize = 0x800000;
+
+/// Coefficients giving R = Y + V, G = Y and B = Y + U, so that the inputs can be read back
+constexpr CoefficientSet PassThrough{0x100, 0x100, 0, 0, 0x100, -0x18, -0x18, -0x18};
+
+/// Maps a zeroed buffer for the conversion.
+class Y2RFixture {
+public:
+    Y2RFixture()
+        : timing(1, 100), kernel(memory, timing, [] {}, 0, 1, 0),
+          process(kernel.CreateProcess(kernel.CreateCodeSet("", 0))),
+          backing(std::make_shared<BufferMem>(BufferSize)) {
+        REQUIRE(process->vm_manager
+                    .MapBackingMemory(BufferVAddr, MemoryRef{backing}, BufferSize,
+                                      Kernel::MemoryState::Private)
+                    .Code() == RESULT_SUCCESS);
+        memory.SetCurrentPageTable(process->vm_manager.page_table);
+        std::fill_n(backing->GetPtr(), BufferSize, u8{0});
+    }
+
+    /// Writes data to a buffer in transfer_unit sized pieces separated by gap bytes
+    void Write(const ConversionBuffer& buf, std::span<const u8> data) {
+        u8* dest = backing->GetPtr() + (buf.address - BufferVAddr);
+        for (std::size_t offset = 0; offset < data.size(); offset += buf.transfer_unit) {
+            const std::size_t size = std::min<std::size_t>(buf.transfer_unit, data.size() - offset);
+            std::memcpy(dest, data.data() + offset, size);
+            dest += buf.transfer_unit + buf.gap;
+        }
+    }
+
+    /// Reads size bytes written to a buffer in transfer_unit sized pieces separated by gap bytes
+    std::vector<u8> Read(const ConversionBuffer& buf, std::size_t size) const {
+        std::vector<u8> data(size);
+        const u8* src = backing->GetPtr() + (buf.address - BufferVAddr);
+        for (std::size_t offset = 0; offset < size; offset += buf.transfer_unit) {
+            std::memcpy(data.data() + offset, src,
+                        std::min<std::size_t>(buf.transfer_unit, size - offset));
+            src += buf.transfer_unit + buf.gap;
+        }
+        return data;
+    }
+
+    /// Converts the image and returns the output, read from the initial destination buffer
+    std::vector<u8> Convert(ConversionConfiguration cvt, std::size_t bytes_per_pixel) {
+        const ConversionBuffer dst = cvt.dst;
+        HW::Y2R::PerformConversion(memory, cvt);
+        return Read(dst, std::size_t{cvt.input_line_width} * cvt.input_lines * bytes_per_pixel);
+    }
+
+    Memory::MemorySystem memory;
+
+private:
+    Core::Timing timing;
+    Kernel::KernelSystem kernel;
+    std::shared_ptr<Kernel::Process> process;
+    std::shared_ptr<BufferMem> backing;
+};
+
+bool IsIndiv16(InputFormat input_format) {
+    return input_format == InputFormat::YUV422_Indiv16 ||
+           input_format == InputFormat::YUV420_Indiv16;
+}
+
+bool Is420(InputFormat input_format) {
+    return input_format == InputFormat::YUV420_Indiv8 ||
+           input_format == InputFormat::YUV420_Indiv16;
+}
+
+/// Sets up a conversion of a width x height image with line sized transfers.
+ConversionConfiguration MakeConfiguration(InputFormat input_format, OutputFormat output_format,
+                                          u16 width, u16 height) {
+    ConversionConfiguration cvt{};
+    cvt.input_format = input_format;
+    cvt.output_format = output_format;
+    cvt.rotation = Rotation::None;
+    cvt.block_alignment = BlockAlignment::Linear;
+    cvt.input_line_width = width;
+    cvt.input_lines = height;
+    cvt.SetStandardCoefficient(StandardCoefficient::ITU_Rec601);
+    cvt.alpha = 0xFF;
+
+    const u16 sample_size = IsIndiv16(input_format) ? 2 : 1;
+    const u16 chroma_unit = (Is420(input_format) ? width / 4 : width / 2) * sample_size;
+    const u16 gap = 0x10;
+
+    VAddr address = BufferVAddr;
+    const auto allocate = [&](ConversionBuffer& buf, u16 transfer_unit) {
+        buf.address = address;
+        buf.transfer_unit = transfer_unit;
+        buf.gap = gap;
+        buf.image_size = transfer_unit * height * 2;
+        address += (transfer_unit + gap) * height * 2;
+    };
+
+    if (input_format == InputFormat::YUYV422_Interleaved) {
+        allocate(cvt.src_YUYV, width * 2);
+    } else {
+        allocate(cvt.src_Y, width * sample_size);
+        allocate(cvt.src_U, chroma_unit);
+        allocate(cvt.src_V, chroma_unit);
+    }
+
+    constexpr std::array<u16, 4> bytes_per_pixel{4, 3, 2, 2};
+    allocate(cvt.dst, width * bytes_per_pixel[static_cast<std::size_t>(output_format)]);
+    return cvt;
+}
+
+/**
+ * Writes the planes of an image to the input buffers of the conversion. U and V hold the samples
+ * of a 4:2:2 or 4:2:0 image, depending on the input format.
+ */
+void WriteImage(Y2RFixture& fixture, const ConversionConfiguration& cvt, std::span<const u8> y,
+                std::span<const u8> u, std::span<const u8> v) {
+    if (cvt.input_format == InputFormat::YUYV422_Interleaved) {
+        std::vector<u8> yuyv;
+        for (std::size_t i = 0; i < y.size(); i += 2) {
+            yuyv.insert(yuyv.end(), {y[i], u[i / 2], y[i + 1], v[i / 2]});
+        }
+        fixture.Write(cvt.src_YUYV, yuyv);
+        return;
+    }
+
+    // Only the low byte of 16-bit samples is used
+    const auto widen = [&](std::span<const u8> plane) {
+        if (!IsIndiv16(cvt.input_format)) {
+            return std::vector<u8>(plane.begin(), plane.end());
+        }
+        std::vector<u8> samples;
+        for (const u8 sample : plane) {
+            samples.insert(samples.end(), {sample, 0xEE});
+        }
+        return samples;
+    };
+    fixture.Write(cvt.src_Y, widen(y));
+    fixture.Write(cvt.src_U, widen(u));
+    fixture.Write(cvt.src_V, widen(v));
+}
+
+/// Converts an image where every pixel has the same color and returns the first output pixel
+std::vector<u8> ConvertUniform(Y2RFixture& fixture, const ConversionConfiguration& cvt, u8 y,
+                               u8 u, u8 v) {
+    constexpr std::array<std::size_t, 4> bytes_per_pixel{4, 3, 2, 2};
+    const std::size_t pixel_size = bytes_per_pixel[static_cast<std::size_t>(cvt.output_format)];
+    const std::size_t pixels = std::size_t{cvt.input_line_width} * cvt.input_lines;
+    const std::size_t chroma_samples = Is420(cvt.input_format) ? pixels / 4 : pixels / 2;
+    WriteImage(fixture, cvt, std::vector<u8>(pixels, y), std::vector<u8>(chroma_samples, u),
+               std::vector<u8>(chroma_samples, v));
+
+    const std::vector<u8> output = fixture.Convert(cvt, pixel_size);
+    const std::vector<u8> first(output.begin(), output.begin() + pixel_size);
+    for (std::size_t i = 0; i < output.size(); i += pixel_size) {
+        REQUIRE(std::equal(first.begin(), first.end(), output.begin() + i));
+    }
+    return first;
+}
+
+/// Returns the R component of each pixel of an RGBA8 output
+std::vector<u8> RedComponents(const std::vector<u8>& output) {
+    std::vector<u8> red;
+    for (std::size_t i = 0; i < output.size(); i += 4) {
+        red.push_back(output[i + 3]);
+    }
+    return red;
+}
+
+constexpr u16 LargeWidth = 400;
+
+/// Returns a 400 pixel wide luma plane that differs between neighbouring lines and columns
+std::vector<u8> MakeLargeLuma(u16 height) {
+    std::vector<u8> y(std::size_t{LargeWidth} * height);
+    for (std::size_t line = 0; line < height; ++line) {
+        for (std::size_t x = 0; x < LargeWidth; ++x) {
+            y[line * LargeWidth + x] = static_cast<u8>(x * 3 + line * 5);
+        }
+    }
+    return y;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Y2R converts colors to each output format", "[core][y2r]") {
+    struct Color {
+        u8 y, u, v;
+        u8 alpha;
+        std::array<u8, 4> rgba8;
+        std::array<u8, 3> rgb8;
+        u16 rgb5a1;
+        u16 rgb565;
+    };
+    // Computed from the coefficient formula of CoefficientSet with ITU_Rec601
+    constexpr std::array<Color, 4> colors{{
+        {0x80, 0x80, 0x80, 0xFF, {0xFF, 0x80, 0x81, 0x80}, {0x80, 0x81, 0x80}, 0x8421, 0x8410},
+        {0xEB, 0x5A, 0xF0, 0xFF, {0xFF, 0xA8, 0xA9, 0xFF}, {0xA8, 0xA9, 0xFF}, 0xFD6B, 0xFD55},
+        {0x10, 0xF0, 0x10, 0xFF, {0xFF, 0xD6, 0x3A, 0x00}, {0xD6, 0x3A, 0x00}, 0x01F5, 0x01DA},
+        {0x80, 0x80, 0x80, 0x40, {0x40, 0x80, 0x81, 0x80}, {0x80, 0x81, 0x80}, 0x8420, 0x8410},
+    }};
+
+    Y2RFixture fixture;
+    for (const Color& color : colors) {
+        INFO("YUV " << +color.y << " " << +color.u << " " << +color.v << " alpha "
+                    << +color.alpha);
+        const auto convert = [&](OutputFormat output_format) {
+            ConversionConfiguration cvt =
+                MakeConfiguration(InputFormat::YUV422_Indiv8, output_format, 32, 16);
+            cvt.alpha = color.alpha;
+            return ConvertUniform(fixture, cvt, color.y, color.u, color.v);
+        };
+        const auto to_bytes = [](u16 value) {
+            return std::vector<u8>{static_cast<u8>(value), static_cast<u8>(value >> 8)};
+        };
+
+        CHECK(convert(OutputFormat::RGBA8) ==
+              std::vector<u8>(color.rgba8.begin(), color.rgba8.end()));
+        CHECK(convert(OutputFormat::RGB8) ==
+              std::vector<u8>(color.rgb8.begin(), color.rgb8.end()));
+        CHECK(convert(OutputFormat::RGB5A1) == to_bytes(color.rgb5a1));
+        CHECK(convert(OutputFormat::RGB565) == to_bytes(color.rgb565));
+    }
+}
+
+TEST_CASE("Y2R clamps coefficients that overflow the output range", "[core][y2r]") {
+    Y2RFixture fixture;
+    ConversionConfiguration cvt =
+        MakeConfiguration(InputFormat::YUV422_Indiv8, OutputFormat::RGBA8, 64, 8);
+    cvt.coefficients = {0x7FFF, -0x8000, 0x7FFF, -0x8000, 0x7FFF, -0x8000, 0x7FFF, -0x8000};
+
+    // R and G are far below 0, B far above 255
+    CHECK(ConvertUniform(fixture, cvt, 0x80, 0x10, 0xF0) == std::vector<u8>{0xFF, 0xFF, 0, 0});
+    // All components are far above 255
+    CHECK(ConvertUniform(fixture, cvt, 0x80, 0xF0, 0x10) ==
+          std::vector<u8>{0xFF, 0xFF, 0xFF, 0xFF});
+}
+
+TEST_CASE("Y2R reads each input format", "[core][y2r]") {
+    // A 16x2 image with Y = 0..31 and chroma samples 0x40.. for U and 0x80.. for V
+    std::array<u8, 32> y;
+    std::array<u8, 16> u;
+    std::array<u8, 16> v;
+    for (u8 i = 0; i < y.size(); ++i) {
+        y[i] = i;
+    }
+    for (u8 i = 0; i < u.size(); ++i) {
+        u[i] = 0x40 + i;
+        v[i] = 0x80 + i;
+    }
+
+    struct Pixel {
+        std::size_t index;
+        u8 r, g, b;
+    };
+    // 4:2:2 formats share the samples between horizontal pairs of pixels. With 4:2:0 they are
+    // also shared between both lines, so the second line uses the samples of the first.
+    constexpr std::array<Pixel, 4> pixels_422{{
+        {0, 0x80, 0x00, 0x40},
+        {5, 0x87, 0x05, 0x47},
+        {21, 0x9F, 0x15, 0x5F},
+        {31, 0xAE, 0x1F, 0x6E},
+    }};
+    constexpr std::array<Pixel, 4> pixels_420{{
+        {0, 0x80, 0x00, 0x40},
+        {5, 0x87, 0x05, 0x47},
+        {21, 0x97, 0x15, 0x57},
+        {31, 0xA6, 0x1F, 0x66},
+    }};
+
+    Y2RFixture fixture;
+    for (u8 input = 0; input <= static_cast<u8>(InputFormat::YUYV422_Interleaved); ++input) {
+        const auto input_format = static_cast<InputFormat>(input);
+        INFO("input " << +input);
+        ConversionConfiguration cvt = MakeConfiguration(input_format, OutputFormat::RGBA8, 16, 2);
+        cvt.coefficients = PassThrough;
+        const std::size_t chroma_samples = Is420(input_format) ? 8 : 16;
+        WriteImage(fixture, cvt, y, std::span{u}.first(chroma_samples),
+                   std::span{v}.first(chroma_samples));
+
+        const std::vector<u8> output = fixture.Convert(cvt, 4);
+        for (const Pixel& pixel : Is420(input_format) ? pixels_420 : pixels_422) {
+            INFO("pixel " << pixel.index);
+            CHECK(std::vector<u8>(output.begin() + pixel.index * 4,
+                                  output.begin() + pixel.index * 4 + 4) ==
+                  std::vector<u8>{0xFF, pixel.b, pixel.g, pixel.r});
+        }
+    }
+}
+
+TEST_CASE("Y2R rotates and tiles each strip", "[core][y2r]") {
+    struct Layout {
+        Rotation rotation;
+        BlockAlignment block_alignment;
+        /// Luma of the first 8 output pixels, and of the 8 starting at the second tile or strip
+        std::array<u8, 8> first;
+        std::array<u8, 8> second_tile;
+    };
+    // For a 16x8 image with the luma of each pixel set to y * 16 + x
+    constexpr std::array<Layout, 8> layouts{{
+        {Rotation::None, BlockAlignment::Linear, {0, 1, 2, 3, 4, 5, 6, 7},
+         {64, 65, 66, 67, 68, 69, 70, 71}},
+        {Rotation::Clockwise_90, BlockAlignment::Linear, {112, 96, 80, 64, 48, 32, 16, 0},
+         {120, 104, 88, 72, 56, 40, 24, 8}},
+        {Rotation::Clockwise_180, BlockAlignment::Linear, {127, 126, 125, 124, 123, 122, 121, 120},
+         {63, 62, 61, 60, 59, 58, 57, 56}},
+        {Rotation::Clockwise_270, BlockAlignment::Linear, {15, 31, 47, 63, 79, 95, 111, 127},
+         {7, 23, 39, 55, 71, 87, 103, 119}},
+        {Rotation::None, BlockAlignment::Block8x8, {0, 1, 16, 17, 2, 3, 18, 19},
+         {8, 9, 24, 25, 10, 11, 26, 27}},
+        {Rotation::Clockwise_90, BlockAlignment::Block8x8, {112, 96, 113, 97, 80, 64, 81, 65},
+         {120, 104, 121, 105, 88, 72, 89, 73}},
+        {Rotation::Clockwise_180, BlockAlignment::Block8x8,
+         {127, 126, 111, 110, 125, 124, 109, 108},
+         {119, 118, 103, 102, 117, 116, 101, 100}},
+        {Rotation::Clockwise_270, BlockAlignment::Block8x8, {15, 31, 14, 30, 47, 63, 46, 62},
+         {7, 23, 6, 22, 39, 55, 38, 54}},
+    }};
+
+    std::array<u8, 16 * 8> y;
+    for (u8 i = 0; i < y.size(); ++i) {
+        y[i] = i;
+    }
+    const std::array<u8, 16 * 8 / 2> chroma{};
+
+    Y2RFixture fixture;
+    for (const Layout& layout : layouts) {
+        INFO("rotation " << static_cast<int>(layout.rotation) << " alignment "
+                         << static_cast<int>(layout.block_alignment));
+        ConversionConfiguration cvt =
+            MakeConfiguration(InputFormat::YUV422_Indiv8, OutputFormat::RGBA8, 16, 8);
+        cvt.coefficients = PassThrough;
+        cvt.rotation = layout.rotation;
+        cvt.block_alignment = layout.block_alignment;
+        WriteImage(fixture, cvt, y, chroma, chroma);
+
+        const std::vector<u8> red = RedComponents(fixture.Convert(cvt, 4));
+        CHECK(std::equal(layout.first.begin(), layout.first.end(), red.begin()));
+        CHECK(std::equal(layout.second_tile.begin(), layout.second_tile.end(), red.begin() + 64));
+    }
+}
+
+TEST_CASE("Y2R converts large images in order", "[core][y2r]") {
+    Y2RFixture fixture;
+    // Images of more than a few strips are converted on worker threads. The last strip of the
+    // second image is shorter than the others.
+    for (const u16 height : {240, 236}) {
+        INFO("height " << height);
+        const std::vector<u8> y = MakeLargeLuma(height);
+        const std::vector<u8> chroma(y.size() / 2);
+
+        ConversionConfiguration cvt = MakeConfiguration(InputFormat::YUV422_Indiv8,
+                                                        OutputFormat::RGBA8, LargeWidth, height);
+        cvt.coefficients = PassThrough;
+        WriteImage(fixture, cvt, y, chroma, chroma);
+        CHECK(RedComponents(fixture.Convert(cvt, 4)) == y);
+    }
+}
+
+TEST_CASE("Y2R converts output overlapping the input strip by strip", "[core][y2r]") {
+    constexpr u16 Height = 240;
+    ConversionConfiguration cvt =
+        MakeConfiguration(InputFormat::YUV422_Indiv8, OutputFormat::RGBA8, LargeWidth, Height);
+    cvt.coefficients = PassThrough;
+    // Each luma line is followed by a gap so that it starts where its output line starts. The
+    // output of a strip only replaces luma lines that were already read, so converting strip by
+    // strip gives the same image as converting into a separate buffer.
+    cvt.src_Y.address = cvt.dst.address;
+    cvt.src_Y.gap = cvt.dst.transfer_unit - cvt.src_Y.transfer_unit;
+    cvt.dst.gap = 0;
+
+    Y2RFixture fixture;
+    const std::vector<u8> y = MakeLargeLuma(Height);
+    const std::vector<u8> chroma(y.size() / 2);
+    WriteImage(fixture, cvt, y, chroma, chroma);
+    CHECK(RedComponents(fixture.Convert(cvt, 4)) == y);
+}
@@ -0,0 +1,315 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/settings.h"
+#include "core/core.h"
+#include "core/hle/service/hid/hid.h"
+#include "core/movie.h"
+
+namespace {
+
+using Core::Movie;
+
+// Layout of the movie header
+constexpr std::size_t HeaderSize = 256;
+constexpr std::size_t InputCountOffset = 84;
+constexpr std::size_t VersionOffset = 92;
+constexpr std::size_t InputSizeOffset = 96;
+constexpr std::size_t KeyframeOffsetOffset = 104;
+constexpr std::size_t KeyframeCountOffset = 112;
+constexpr std::size_t ControllerStateSize = 7;
+constexpr std::size_t KeyframeEntrySize = 24;
+
+// Inputs of one frame, see FramesToInputs in movie.cpp
+constexpr u64 InputsPerFrame = 4;
+constexpr u64 MovieFrames = 4;
+constexpr u64 MovieInputs = MovieFrames * InputsPerFrame;
+
+struct TestKeyframe {
+    u64 input_count;
+    std::vector<u8> state;
+};
+
+template <typename T>
+void Put(std::vector<u8>& data, std::size_t offset, T value) {
+    std::memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T Get(const std::vector<u8>& data, std::size_t offset) {
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+/// Builds a movie of MovieInputs pad inputs, the circle pad x of input i is i * 10
+std::vector<u8> BuildMovie(u32 version, const std::vector<TestKeyframe>& keyframes) {
+    std::vector<u8> movie(HeaderSize + MovieInputs * ControllerStateSize);
+    const u8 magic[] = {'C', 'T', 'M', 0x1B};
+    std::memcpy(movie.data(), magic, sizeof(magic));
+    Put<u64>(movie, InputCountOffset, MovieInputs);
+    Put<u32>(movie, VersionOffset, version);
+
+    for (u64 i = 0; i < MovieInputs; ++i) {
+        const std::size_t offset = HeaderSize + i * ControllerStateSize;
+        movie[offset] = 0; // ControllerStateType::PadAndCircle
+        Put<s16>(movie, offset + 3, static_cast<s16>(i * 10));
+    }
+    if (version < 2) {
+        return movie;
+    }
+
+    Put<u64>(movie, InputSizeOffset, MovieInputs * ControllerStateSize);
+    std::vector<u8> index;
+    for (const auto& keyframe : keyframes) {
+        const u64 entry[] = {keyframe.input_count, movie.size(), keyframe.state.size()};
+        index.insert(index.end(), reinterpret_cast<const u8*>(entry),
+                     reinterpret_cast<const u8*>(entry) + sizeof(entry));
+        movie.insert(movie.end(), keyframe.state.begin(), keyframe.state.end());
+    }
+    Put<u64>(movie, KeyframeOffsetOffset, movie.size());
+    Put<u32>(movie, KeyframeCountOffset, static_cast<u32>(keyframes.size()));
+    movie.insert(movie.end(), index.begin(), index.end());
+    return movie;
+}
+
+std::string WriteMovie(const std::vector<u8>& movie) {
+    const std::string path = (std::filesystem::temp_directory_path() /
+                              fmt::format("citra_movie_test_{}.ctm", std::random_device{}()))
+                                 .string();
+    FileUtil::IOFile file(path, "wb");
+    REQUIRE(file.WriteBytes(movie.data(), movie.size()) == movie.size());
+    return path;
+}
+
+std::vector<u8> ReadMovie(const std::string& path) {
+    std::vector<u8> movie;
+    FileUtil::IOFile file(path, "rb");
+    movie.resize(file.GetSize());
+    REQUIRE(file.ReadBytes(movie.data(), movie.size()) == movie.size());
+    return movie;
+}
+
+/// Plays one input of the movie, checking that it is the one of BuildMovie
+void PlayInput(Movie& movie, u64 input) {
+    REQUIRE(movie.GetPlayMode() == Movie::PlayMode::Playing);
+    Service::HID::PadState pad_state{};
+    s16 circle_pad_x = 0;
+    s16 circle_pad_y = 0;
+    movie.HandlePadAndCircleStatus(pad_state, circle_pad_x, circle_pad_y);
+    REQUIRE(circle_pad_x == static_cast<s16>(input * 10));
+}
+
+/// Plays the remaining inputs of the movie
+void PlayInputs(Movie& movie, u64 first_input) {
+    for (u64 i = first_input; i < MovieInputs; ++i) {
+        PlayInput(movie, i);
+    }
+    REQUIRE(movie.GetPlayMode() == Movie::PlayMode::MovieFinished);
+}
+
+bool IsFrameLimiterOverridden() {
+    return Core::System::GetInstance().frame_limiter.IsUnlimited();
+}
+
+std::vector<u8> NoSaveState() {
+    FAIL("No keyframe should be taken during playback");
+    return {};
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Movie plays back and seeks in version 2 movies", "[core][movie]") {
+    Movie& movie = Movie::GetInstance();
+    const std::string path = WriteMovie(BuildMovie(2, {{8, {1, 2, 3}}, {16, {4, 5, 6}}}));
+
+    REQUIRE(movie.ValidateMovie(path) != Movie::ValidationResult::Invalid);
+    movie.StartPlayback(path);
+    REQUIRE(movie.GetTotalInputCount() == MovieFrames);
+    PlayInputs(movie, 0);
+
+    // Past the end of the movie
+    REQUIRE(!movie.SeekToFrame(5));
+    // Before the first keyframe, from the end of the movie
+    REQUIRE(!movie.SeekToFrame(1));
+    // From the keyframe at input 8, the one at the last input can't be loaded
+    REQUIRE(movie.SeekToFrame(3));
+    REQUIRE(movie.IsSeeking());
+    REQUIRE(movie.SeekToFrame(4));
+
+    movie.Shutdown();
+    REQUIRE(!movie.IsSeeking());
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Movie skips keyframes taken at the last input", "[core][movie]") {
+    Movie& movie = Movie::GetInstance();
+    const std::string path = WriteMovie(BuildMovie(2, {{MovieInputs, {1, 2, 3}}}));
+
+    movie.StartPlayback(path);
+    PlayInputs(movie, 0);
+    REQUIRE(!movie.SeekToFrame(4));
+
+    movie.Shutdown();
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Movie keeps its keyframes when saved again", "[core][movie]") {
+    Movie& movie = Movie::GetInstance();
+    const std::vector<u8> first_state{1, 2, 3};
+    const std::vector<u8> second_state{4, 5, 6, 7};
+    const std::string path = WriteMovie(BuildMovie(2, {{8, first_state}, {12, second_state}}));
+
+    movie.StartPlayback(path);
+    movie.SaveMovie();
+    movie.Shutdown();
+
+    const std::vector<u8> saved = ReadMovie(path);
+    REQUIRE(Get<u32>(saved, VersionOffset) == 2);
+    REQUIRE(Get<u64>(saved, InputCountOffset) == MovieInputs);
+    REQUIRE(Get<u64>(saved, InputSizeOffset) == MovieInputs * ControllerStateSize);
+    REQUIRE(Get<u32>(saved, KeyframeCountOffset) == 2);
+
+    const u64 index_offset = Get<u64>(saved, KeyframeOffsetOffset);
+    REQUIRE(index_offset + 2 * KeyframeEntrySize == saved.size());
+    for (const auto& [number, state] : {std::pair{0, first_state}, std::pair{1, second_state}}) {
+        const std::size_t entry = index_offset + number * KeyframeEntrySize;
+        const u64 offset = Get<u64>(saved, entry + 8);
+        REQUIRE(Get<u64>(saved, entry) == (number == 0 ? 8u : 12u));
+        REQUIRE(Get<u64>(saved, entry + 16) == state.size());
+        REQUIRE(std::vector<u8>(saved.begin() + offset, saved.begin() + offset + state.size()) ==
+                state);
+    }
+
+    REQUIRE(movie.ValidateMovie(path) != Movie::ValidationResult::Invalid);
+    movie.StartPlayback(path);
+    PlayInputs(movie, 0);
+    REQUIRE(movie.SeekToFrame(3));
+
+    movie.Shutdown();
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Movie rejects invalid keyframe indexes", "[core][movie]") {
+    Movie& movie = Movie::GetInstance();
+    std::vector<u8> data;
+
+    SECTION("unsorted index") {
+        data = BuildMovie(2, {{12, {1, 2, 3}}, {8, {4, 5, 6}}});
+    }
+    SECTION("index past the end of the file") {
+        data = BuildMovie(2, {{8, {1, 2, 3}}});
+        Put<u32>(data, KeyframeCountOffset, std::numeric_limits<u32>::max());
+    }
+    SECTION("keyframe wrapping around the end of the file") {
+        data = BuildMovie(2, {{8, {1, 2, 3}}});
+        const std::size_t entry = Get<u64>(data, KeyframeOffsetOffset);
+        // The end of the keyframe, offset + size, wraps around to 1
+        Put<u64>(data, entry + 16, std::numeric_limits<u64>::max() - Get<u64>(data, entry + 8) + 2);
+    }
+
+    const std::string path = WriteMovie(data);
+    REQUIRE(movie.ValidateMovie(path) == Movie::ValidationResult::Invalid);
+
+    // The movie is still played, without seeking back
+    movie.StartPlayback(path);
+    PlayInputs(movie, 0);
+    REQUIRE(!movie.SeekToFrame(3));
+
+    movie.Shutdown();
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Movie plays back version 1 movies", "[core][movie]") {
+    Movie& movie = Movie::GetInstance();
+    const std::string path = WriteMovie(BuildMovie(0, {}));
+
+    REQUIRE(movie.ValidateMovie(path) != Movie::ValidationResult::Invalid);
+    movie.StartPlayback(path);
+    REQUIRE(movie.GetTotalInputCount() == MovieFrames);
+    PlayInputs(movie, 0);
+    REQUIRE(!movie.SeekToFrame(1));
+
+    movie.Shutdown();
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Movie loads keyframes read-only while seeking", "[core][movie]") {
+    Movie& movie = Movie::GetInstance();
+    const std::vector<u8> state{1, 2, 3};
+    const std::string path = WriteMovie(BuildMovie(2, {{8, state}, {12, {4, 5, 6}}}));
+    const u16 frame_limit = Settings::values.frame_limit.GetValue();
+
+    movie.StartPlayback(path);
+    // Loading a state in R/W mode would start recording from it
+    movie.SetReadOnly(false);
+    PlayInput(movie, 0);
+
+    // Frame 2 is input 8, so the keyframe there is loaded
+    REQUIRE(movie.SeekToFrame(2));
+    REQUIRE(!IsFrameLimiterOverridden());
+    int loads = 0;
+    REQUIRE(movie.ProcessKeyframes(NoSaveState, [&](std::span<const u8> loaded_state) {
+        ++loads;
+        REQUIRE(std::vector<u8>(loaded_state.begin(), loaded_state.end()) == state);
+        REQUIRE(movie.IsReadOnly());
+        REQUIRE(IsFrameLimiterOverridden());
+    }));
+    REQUIRE(loads == 1);
+    REQUIRE(!movie.IsReadOnly());
+    REQUIRE(Settings::values.frame_limit.GetValue() == frame_limit);
+
+    // The states are not actually loaded here, so the movie plays on from input 1 to the target
+    REQUIRE(movie.IsSeeking());
+    REQUIRE(IsFrameLimiterOverridden());
+    for (u64 i = 1; i < 8; ++i) {
+        PlayInput(movie, i);
+        REQUIRE(movie.IsSeeking() == (i < 7));
+    }
+    REQUIRE(!IsFrameLimiterOverridden());
+    REQUIRE(!movie.ProcessKeyframes(NoSaveState, [](std::span<const u8>) {
+        FAIL("No keyframe was requested");
+    }));
+
+    movie.Shutdown();
+    movie.SetReadOnly(true);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Movie finishes the seek when a keyframe fails to load", "[core][movie]") {
+    Movie& movie = Movie::GetInstance();
+    const std::string path = WriteMovie(BuildMovie(2, {{8, {1, 2, 3}}}));
+
+    movie.StartPlayback(path);
+    movie.SetReadOnly(false);
+    PlayInputs(movie, 0);
+
+    REQUIRE(movie.SeekToFrame(3));
+    REQUIRE_THROWS_AS(movie.ProcessKeyframes(NoSaveState,
+                                             [](std::span<const u8>) {
+                                                 throw std::runtime_error("Invalid state");
+                                             }),
+                      std::runtime_error);
+    REQUIRE(!movie.IsReadOnly());
+    REQUIRE(!movie.IsSeeking());
+    REQUIRE(!IsFrameLimiterOverridden());
+
+    movie.Shutdown();
+    movie.SetReadOnly(true);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,95 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <catch2/catch_test_macros.hpp>
+#include "video_core/pica_types_simd.h"
+
+using Pica::f24;
+using Pica::F24x4;
+
+namespace {
+
+/// Generates values with a high share of the special cases the PICA handles differently
+f24 RandomValue(std::mt19937& rng) {
+    static constexpr std::array<float, 7> special_values = {
+        0.0f,
+        -0.0f,
+        1.0f,
+        std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::min(),
+    };
+
+    std::uniform_int_distribution<std::size_t> pick(0, special_values.size() * 2);
+    const std::size_t index = pick(rng);
+    if (index < special_values.size()) {
+        return f24::FromFloat32(special_values[index]);
+    }
+    return f24::FromRaw(std::uniform_int_distribution<u32>(0, 0xFFFFFF)(rng));
+}
+
+std::array<f24, 4> RandomVector(std::mt19937& rng) {
+    return {RandomValue(rng), RandomValue(rng), RandomValue(rng), RandomValue(rng)};
+}
+
+bool BitEqual(f24 a, f24 b) {
+    return std::bit_cast<u32>(a.ToFloat32()) == std::bit_cast<u32>(b.ToFloat32()) ||
+           (std::isnan(a.ToFloat32()) && std::isnan(b.ToFloat32()));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("F24x4 matches scalar f24 arithmetic", "[video_core][pica_types]") {
+    std::mt19937 rng(0x3D5);
+
+    for (int iteration = 0; iteration < 10000; ++iteration) {
+        const auto a = RandomVector(rng);
+        const auto b = RandomVector(rng);
+        const auto c = RandomVector(rng);
+
+        const auto va = F24x4::Load(a.data());
+        const auto vb = F24x4::Load(b.data());
+        const auto vc = F24x4::Load(c.data());
+
+        const auto sum = (va + vb).ToArray();
+        const auto difference = (va - vb).ToArray();
+        const auto product = (va * vb).ToArray();
+        const auto mad = (va * vb + vc).ToArray();
+        const auto negated = (-va).ToArray();
+        const auto max = F24x4::Max(va, vb).ToArray();
+        const auto min = F24x4::Min(va, vb).ToArray();
+
+        for (std::size_t i = 0; i < 4; ++i) {
+            REQUIRE(BitEqual(sum[i], a[i] + b[i]));
+            REQUIRE(BitEqual(difference[i], a[i] - b[i]));
+            REQUIRE(BitEqual(product[i], a[i] * b[i]));
+            REQUIRE(BitEqual(mad[i], a[i] * b[i] + c[i]));
+            REQUIRE(BitEqual(negated[i], -a[i]));
+            REQUIRE(BitEqual(max[i], (a[i] > b[i]) ? a[i] : b[i]));
+            REQUIRE(BitEqual(min[i], (a[i] < b[i]) ? a[i] : b[i]));
+        }
+    }
+}
+
+TEST_CASE("F24x4 masked store", "[video_core][pica_types]") {
+    const std::array<f24, 4> values = {f24::FromFloat32(1.0f), f24::FromFloat32(2.0f),
+                                       f24::FromFloat32(3.0f), f24::FromFloat32(4.0f)};
+
+    for (u32 lanes = 0; lanes < 16; ++lanes) {
+        std::array<f24, 4> dest;
+        dest.fill(f24::FromFloat32(-1.0f));
+        F24x4::Load(values.data()).StoreMasked(dest.data(), lanes);
+
+        for (std::size_t i = 0; i < 4; ++i) {
+            const float expected = ((lanes >> i) & 1) ? values[i].ToFloat32() : -1.0f;
+            REQUIRE(dest[i].ToFloat32() == expected);
+        }
+    }
+}
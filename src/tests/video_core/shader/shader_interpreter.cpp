@@ -0,0 +1,340 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <nihstro/shader_bytecode.h>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "video_core/shader/shader.h"
+#include "video_core/shader/shader_interpreter.h"
+
+using nihstro::OpCode;
+using ShaderInterpreter = Pica::Shader::InterpreterEngine;
+
+namespace {
+
+// The programs are encoded by hand, since the inline assembler doesn't support relative
+// addressing, MAD or flow control with conditions. Uniforms only fit in the 7 bit source fields:
+// the first source of arithmetic instructions, the second one of MAD and the last one of the
+// inverted forms.
+
+constexpr u32 Input(u32 index) {
+    return index;
+}
+
+constexpr u32 Temporary(u32 index) {
+    return 0x10 + index;
+}
+
+constexpr u32 Uniform(u32 index) {
+    return 0x20 + index;
+}
+
+constexpr u32 Output(u32 index) {
+    return index;
+}
+
+/// Address register added to the relatively addressed source
+enum Relative : u32 { None, A0X, A0Y, AL };
+
+/// Condition of JMPC, CALLC and IFC
+enum Condition : u32 { Or, And, JustX, JustY };
+
+/// Comparison of CMP
+enum Compare : u32 { EQ, NE, LT, LE, GT, GE };
+
+constexpr u32 Opcode(OpCode::Id id) {
+    return static_cast<u32>(id) << 26;
+}
+
+u32 Arithmetic(OpCode::Id id, u32 dest, u32 src1, u32 src2, u32 desc, Relative relative = None) {
+    return Opcode(id) | dest << 21 | relative << 19 | src1 << 12 | src2 << 7 | desc;
+}
+
+/// Arithmetic instruction with inverted sources, the second one may be a uniform
+u32 ArithmeticI(OpCode::Id id, u32 dest, u32 src1, u32 src2, u32 desc, Relative relative = None) {
+    return Opcode(id) | dest << 21 | relative << 19 | src1 << 14 | src2 << 7 | desc;
+}
+
+u32 Cmp(u32 src1, u32 src2, u32 desc, Compare x, Compare y, Relative relative = None) {
+    return Opcode(OpCode::Id::CMP) | x << 24 | y << 21 | relative << 19 | src1 << 12 | src2 << 7 |
+           desc;
+}
+
+u32 Mad(u32 dest, u32 src1, u32 src2, u32 src3, u32 desc, Relative relative = None) {
+    return Opcode(OpCode::Id::MAD) | dest << 24 | relative << 22 | src1 << 17 | src2 << 10 |
+           src3 << 5 | desc;
+}
+
+/// MAD with inverted sources, the third one may be a uniform
+u32 MadI(u32 dest, u32 src1, u32 src2, u32 src3, u32 desc, Relative relative = None) {
+    return Opcode(OpCode::Id::MADI) | dest << 24 | relative << 22 | src1 << 17 | src2 << 12 |
+           src3 << 5 | desc;
+}
+
+u32 FlowControl(OpCode::Id id, u32 dest_offset, u32 num_instructions) {
+    return Opcode(id) | dest_offset << 10 | num_instructions;
+}
+
+u32 FlowControlConditional(OpCode::Id id, u32 dest_offset, u32 num_instructions,
+                           Condition condition, bool refx, bool refy) {
+    return FlowControl(id, dest_offset, num_instructions) | u32{refx} << 25 | u32{refy} << 24 |
+           condition << 22;
+}
+
+u32 FlowControlUniform(OpCode::Id id, u32 uniform, u32 dest_offset, u32 num_instructions) {
+    return FlowControl(id, dest_offset, num_instructions) | uniform << 22;
+}
+
+/// Encodes a selector string like "-wzyx", with an optional leading minus for negation
+u32 Selector(std::string_view selector) {
+    const bool negate = !selector.empty() && selector.front() == '-';
+    if (negate) {
+        selector.remove_prefix(1);
+    }
+    u32 value = 0;
+    for (const char component : selector) {
+        value = value << 2 | static_cast<u32>(std::string_view{"xyzw"}.find(component));
+    }
+    return value << 1 | u32{negate};
+}
+
+/// Encodes an operand descriptor
+u32 Swizzle(std::string_view dest_mask, std::string_view src1, std::string_view src2 = "xyzw",
+            std::string_view src3 = "xyzw") {
+    u32 mask = 0;
+    for (const char component : dest_mask) {
+        mask |= 8 >> std::string_view{"xyzw"}.find(component);
+    }
+    return mask | Selector(src1) << 4 | Selector(src2) << 13 | Selector(src3) << 22;
+}
+
+bool SameFloat(Pica::f24 a, Pica::f24 b) {
+    const float x = a.ToFloat32();
+    const float y = b.ToFloat32();
+    return (std::isnan(x) && std::isnan(y)) || std::bit_cast<u32>(x) == std::bit_cast<u32>(y);
+}
+
+bool SameRegisters(const std::array<Common::Vec4<Pica::f24>, 16>& a,
+                   const std::array<Common::Vec4<Pica::f24>, 16>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), [](const auto& x, const auto& y) {
+        return SameFloat(x.x, y.x) && SameFloat(x.y, y.y) && SameFloat(x.z, y.z) &&
+               SameFloat(x.w, y.w);
+    });
+}
+
+class ShaderTest {
+public:
+    ShaderTest(std::span<const u32> code, std::span<const u32> operand_descs)
+        : shader_setup(std::make_unique<Pica::Shader::ShaderSetup>()) {
+        shader_setup->program_code.fill(Opcode(OpCode::Id::END));
+        std::copy(code.begin(), code.end(), shader_setup->program_code.begin());
+        shader_setup->swizzle_data.fill(0);
+        std::copy(operand_descs.begin(), operand_descs.end(),
+                  shader_setup->swizzle_data.begin());
+
+        auto& uniforms = shader_setup->uniforms;
+        for (u32 i = 0; i < uniforms.f.size(); ++i) {
+            const float value = static_cast<float>(i) * 0.25f - 3.0f;
+            uniforms.f[i] = {Pica::f24::FromFloat32(value), Pica::f24::FromFloat32(-value),
+                             Pica::f24::FromFloat32(value * 2.0f), Pica::f24::FromFloat32(1.0f)};
+        }
+        uniforms.b.fill(false);
+        uniforms.i.fill(Common::Vec4<u8>{0, 0, 0, 0});
+
+        shader_interpreter.SetupBatch(*shader_setup, 0);
+    }
+
+    /// Runs the program with the pre-decoded and the decoding interpreter, and compares the state
+    void CheckSameResult(std::span<const Common::Vec4f> inputs) {
+        Pica::Shader::UnitState decoded_unit;
+        Pica::Shader::UnitState undecoded_unit;
+        Setup(decoded_unit, inputs);
+        Setup(undecoded_unit, inputs);
+
+        shader_interpreter.Run(*shader_setup, decoded_unit);
+        shader_interpreter.RunUndecoded(*shader_setup, undecoded_unit);
+
+        REQUIRE(SameRegisters(decoded_unit.registers.output, undecoded_unit.registers.output));
+        REQUIRE(
+            SameRegisters(decoded_unit.registers.temporary, undecoded_unit.registers.temporary));
+        for (u32 i = 0; i < 3; ++i) {
+            REQUIRE(decoded_unit.address_registers[i] == undecoded_unit.address_registers[i]);
+        }
+        for (u32 i = 0; i < 2; ++i) {
+            REQUIRE(decoded_unit.conditional_code[i] == undecoded_unit.conditional_code[i]);
+        }
+    }
+
+    std::unique_ptr<Pica::Shader::ShaderSetup> shader_setup;
+
+private:
+    static void Setup(Pica::Shader::UnitState& shader_unit, std::span<const Common::Vec4f> inputs) {
+        const auto zero = Common::Vec4<Pica::f24>::AssignToAll(Pica::f24::Zero());
+        shader_unit.registers.input.fill(zero);
+        shader_unit.registers.temporary.fill(zero);
+        shader_unit.registers.output.fill(zero);
+        std::fill(std::begin(shader_unit.address_registers),
+                  std::end(shader_unit.address_registers), 0);
+        std::fill(std::begin(shader_unit.conditional_code), std::end(shader_unit.conditional_code),
+                  false);
+
+        u32 i = 0;
+        for (const Common::Vec4f& input : inputs) {
+            shader_unit.registers.input[i++] = {
+                Pica::f24::FromFloat32(input.x), Pica::f24::FromFloat32(input.y),
+                Pica::f24::FromFloat32(input.z), Pica::f24::FromFloat32(input.w)};
+        }
+    }
+
+    ShaderInterpreter shader_interpreter;
+};
+
+const std::vector<std::vector<Common::Vec4f>> test_inputs = {
+    {{1.0f, 2.0f, 3.0f, 4.0f}, {-0.5f, 0.25f, 8.0f, -3.0f}, {0.0f, -0.0f, 1.5f, 2.5f}},
+    {{-2.0f, 0.5f, -1.0f, 7.0f}, {-2.0f, 0.5f, 3.0f, 0.0f}, {4.0f, 4.0f, -4.0f, 0.125f}},
+    {{INFINITY, -INFINITY, NAN, 1.0f}, {0.0f, 1.0f, -1.0f, INFINITY}, {3.0f, 2.0f, 1.0f, 0.0f}},
+};
+
+} // Anonymous namespace
+
+TEST_CASE("Interpreter arithmetic", "[video_core][shader][shader_interpreter]") {
+    // clang-format off
+    ShaderTest shader_test(std::vector<u32>{
+        Arithmetic(OpCode::Id::ADD, Output(0), Input(0), Input(1), 0),
+        Arithmetic(OpCode::Id::ADD, Output(0), Uniform(0), Input(2), 1),
+        Arithmetic(OpCode::Id::MUL, Output(1), Input(0), Input(2), 4),
+        Arithmetic(OpCode::Id::DP3, Temporary(0), Input(0), Input(1), 3),
+        Arithmetic(OpCode::Id::DP4, Output(2), Input(1), Input(2), 2),
+        Arithmetic(OpCode::Id::DPH, Output(3), Uniform(1), Input(0), 0),
+        ArithmeticI(OpCode::Id::DPHI, Output(4), Input(2), Uniform(2), 1),
+        Arithmetic(OpCode::Id::FLR, Output(5), Input(1), 0, 1),
+        Arithmetic(OpCode::Id::MAX, Output(6), Input(0), Input(2), 4),
+        Arithmetic(OpCode::Id::MIN, Output(7), Uniform(3), Input(1), 2),
+        Arithmetic(OpCode::Id::RCP, Temporary(1), Input(2), 0, 0),
+        Arithmetic(OpCode::Id::RSQ, Temporary(2), Input(1), 0, 4),
+        Arithmetic(OpCode::Id::SGE, Output(8), Input(0), Input(1), 1),
+        ArithmeticI(OpCode::Id::SGEI, Output(9), Input(1), Uniform(4), 0),
+        Arithmetic(OpCode::Id::SLT, Output(10), Input(2), Input(0), 4),
+        ArithmeticI(OpCode::Id::SLTI, Output(11), Input(0), Uniform(12), 2),
+        Arithmetic(OpCode::Id::EX2, Temporary(3), Input(0), 0, 2),
+        Arithmetic(OpCode::Id::LG2, Temporary(4), Input(1), 0, 0),
+        Mad(Output(12), Input(0), Uniform(5), Input(1), 0),
+        Mad(Output(12), Input(1), Input(2), Temporary(0), 4),
+        MadI(Output(13), Input(1), Input(2), Uniform(6), 1),
+        Arithmetic(OpCode::Id::MOV, Output(14), Temporary(0), 0, 4),
+        Cmp(Input(0), Input(1), 0, LT, GE),
+        Arithmetic(OpCode::Id::MOV, Output(15), Temporary(1), 0, 1),
+        Arithmetic(OpCode::Id::ADD, Temporary(5), Temporary(2), Temporary(3), 2),
+        Arithmetic(OpCode::Id::MUL, Temporary(6), Uniform(95), Temporary(4), 0),
+        FlowControl(OpCode::Id::END, 0, 0),
+    }, std::vector<u32>{
+        Swizzle("xyzw", "xyzw", "xyzw"),
+        Swizzle("xz", "-yxwz", "wzyx"),
+        Swizzle("yw", "zzxy", "-xyzw", "-yyzz"),
+        Swizzle("x", "xyzw", "xyzw"),
+        Swizzle("xyzw", "-wzyx", "-xxyy", "zwxy"),
+    });
+    // clang-format on
+
+    for (const auto& inputs : test_inputs) {
+        shader_test.CheckSameResult(inputs);
+    }
+}
+
+TEST_CASE("Interpreter flow control", "[video_core][shader][shader_interpreter]") {
+    // clang-format off
+    ShaderTest shader_test(std::vector<u32>{
+        /*  0 */ Cmp(Input(0), Input(1), 0, LT, GE),
+        /*  1 */ FlowControlUniform(OpCode::Id::IFU, 0, 4, 2),
+        /*  2 */     Arithmetic(OpCode::Id::ADD, Temporary(0), Input(0), Input(1), 0),
+        /*  3 */     FlowControl(OpCode::Id::NOP, 0, 0),
+        /*  4 */     Arithmetic(OpCode::Id::MUL, Temporary(0), Input(0), Input(1), 0),
+        /*  5 */     FlowControl(OpCode::Id::NOP, 0, 0),
+        /*  6 */ FlowControlConditional(OpCode::Id::IFC, 8, 1, JustX, true, false),
+        /*  7 */     Arithmetic(OpCode::Id::MOV, Output(0), Input(0), 0, 1),
+        /*  8 */     Arithmetic(OpCode::Id::MOV, Output(0), Input(1), 0, 0),
+        /*  9 */ FlowControlConditional(OpCode::Id::CALLC, 20, 2, And, true, false),
+        /* 10 */ FlowControlUniform(OpCode::Id::CALLU, 1, 22, 1),
+        /* 11 */ FlowControl(OpCode::Id::CALL, 23, 1),
+        /* 12 */ FlowControlUniform(OpCode::Id::JMPU, 2, 14, 0),
+        /* 13 */ Arithmetic(OpCode::Id::ADD, Output(1), Temporary(0), Input(2), 0),
+        /* 14 */ FlowControlConditional(OpCode::Id::JMPC, 16, 0, Or, false, true),
+        /* 15 */ Arithmetic(OpCode::Id::ADD, Output(2), Temporary(0), Input(2), 1),
+        /* 16 */ Arithmetic(OpCode::Id::MOV, Output(3), Temporary(0), 0, 1),
+        /* 17 */ FlowControlUniform(OpCode::Id::JMPU, 3, 19, 1),
+        /* 18 */ Arithmetic(OpCode::Id::ADD, Output(4), Input(0), Input(0), 0),
+        /* 19 */ FlowControl(OpCode::Id::END, 0, 0),
+        /* 20 */ Arithmetic(OpCode::Id::ADD, Temporary(7), Input(0), Input(2), 0),
+        /* 21 */ Arithmetic(OpCode::Id::MUL, Output(5), Temporary(7), Input(1), 1),
+        /* 22 */ Arithmetic(OpCode::Id::ADD, Output(6), Input(1), Input(2), 0),
+        /* 23 */ Arithmetic(OpCode::Id::MAX, Output(7), Temporary(0), Input(2), 1),
+    }, std::vector<u32>{
+        Swizzle("xyzw", "xyzw", "xyzw"),
+        Swizzle("xyzw", "-wzyx", "yxwz"),
+    });
+    // clang-format on
+
+    for (u32 bools = 0; bools < 16; ++bools) {
+        for (u32 i = 0; i < 4; ++i) {
+            shader_test.shader_setup->uniforms.b[i] = (bools >> i) & 1;
+        }
+        for (const auto& inputs : test_inputs) {
+            shader_test.CheckSameResult(inputs);
+        }
+    }
+}
+
+TEST_CASE("Interpreter loops and address registers", "[video_core][shader][shader_interpreter]") {
+    // clang-format off
+    ShaderTest shader_test(std::vector<u32>{
+        /*  0 */ Arithmetic(OpCode::Id::MOVA, 0, Input(2), 0, 1),
+        /*  1 */ Arithmetic(OpCode::Id::MOV, Output(0), Uniform(10), 0, 0, A0X),
+        /*  2 */ Arithmetic(OpCode::Id::MOV, Output(1), Uniform(20), 0, 0, A0Y),
+        /*  3 */ FlowControlUniform(OpCode::Id::LOOP, 0, 5, 0),
+        /*  4 */     Arithmetic(OpCode::Id::ADD, Temporary(0), Uniform(0), Temporary(0), 0, AL),
+        /*  5 */     Mad(Temporary(1), Input(0), Uniform(1), Temporary(1), 0, A0X),
+        /*  6 */ FlowControlUniform(OpCode::Id::LOOP, 1, 9, 0),
+        /*  7 */     FlowControlUniform(OpCode::Id::LOOP, 2, 8, 0),
+        /*  8 */         Arithmetic(OpCode::Id::ADD, Temporary(2), Uniform(0), Temporary(2), 2, AL),
+        /*  9 */     ArithmeticI(OpCode::Id::DPHI, Temporary(3), Input(0), Uniform(2), 0, AL),
+        /* 10 */ MadI(Temporary(4), Input(0), Temporary(1), Uniform(4), 2, A0Y),
+        /* 11 */ Arithmetic(OpCode::Id::SLT, Temporary(5), Uniform(30), Input(1), 0, AL),
+        /* 12 */ Arithmetic(OpCode::Id::MOVA, 0, Input(1), 0, 1),
+        /* 13 */ Arithmetic(OpCode::Id::MOV, Output(2), Uniform(1), 0, 0, A0Y),
+        /* 14 */ FlowControl(OpCode::Id::END, 0, 0),
+    }, std::vector<u32>{
+        Swizzle("xyzw", "xyzw", "xyzw"),
+        Swizzle("xy", "xyzw", "xyzw"),
+        Swizzle("yw", "wxzy", "-xyzw", "yyww"),
+    });
+    // clang-format on
+
+    auto& uniforms = shader_test.shader_setup->uniforms;
+    const std::vector<std::vector<Common::Vec4<u8>>> loop_params = {
+        {{3, 1, 2, 0}, {2, 0, 1, 0}, {2, 4, 3, 0}},
+        {{0, 0, 0, 0}, {0, 5, 0, 0}, {1, 2, 1, 0}},
+        {{5, 10, 1, 0}, {1, 3, 2, 0}, {3, 0, 1, 0}},
+    };
+    // MOVA truncates towards zero, a negative offset reaches the temporary registers
+    const std::vector<std::vector<Common::Vec4f>> inputs = {
+        {{1.0f, 2.0f, 3.0f, 4.0f}, {0.0f, 3.5f, 0.0f, 0.0f}, {2.5f, 5.9f, 0.0f, 0.0f}},
+        {{-1.5f, 0.5f, 2.0f, 1.0f}, {0.0f, -2.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f, 0.0f}},
+        {{0.25f, -4.0f, 8.0f, 0.0f}, {0.0f, 6.0f, 0.0f, 0.0f}, {7.0f, 1.0f, 0.0f, 0.0f}},
+    };
+    for (const auto& params : loop_params) {
+        std::copy(params.begin(), params.end(), uniforms.i.begin());
+        for (const auto& input : inputs) {
+            shader_test.CheckSameResult(input);
+        }
+    }
+}
@@ -47,6 +47,7 @@ public:
     explicit ShaderTest(std::initializer_list<nihstro::InlineAsm> code)
         : shader_setup(CompileShaderSetup(code)) {
         shader_jit.Compile(&shader_setup->program_code, &shader_setup->swizzle_data);
+        shader_interpreter.SetupBatch(*shader_setup, 0);
     }
 
     Common::Vec4f Run(std::span<const Common::Vec4f> inputs) {
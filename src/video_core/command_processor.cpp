@@ -2,21 +2,28 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstring>
 #include <memory>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include "common/assert.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/tracing.h"
 #include "common/vector_math.h"
 #include "core/hle/service/gsp/gsp.h"
 #include "core/hw/gpu.h"
 #include "core/memory.h"
+#include "core/perf_stats.h"
 #include "core/tracer/recorder.h"
 #include "video_core/command_processor.h"
 #include "video_core/debug_utils/debug_utils.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/pica_state.h"
 #include "video_core/pica_types.h"
 #include "video_core/primitive_assembly.h"
@@ -39,6 +46,36 @@ constexpr std::array<u32, 16> expand_bits_to_bytes{
 
 MICROPROFILE_DEFINE(GPU_Drawing, "GPU", "Drawing", MP_RGB(50, 50, 240));
 
+static DrawObserver draw_observer;
+
+/// Measures a draw and reports it to the draw observer, if one is set
+class DrawTimer {
+public:
+    DrawTimer(u32 num_vertices, bool is_indexed, bool is_immediate) {
+        if (draw_observer) [[unlikely]] {
+            info = {num_vertices, is_indexed, is_immediate, false, {}};
+            start_time = std::chrono::steady_clock::now();
+            active = true;
+        }
+    }
+
+    ~DrawTimer() {
+        if (active) [[unlikely]] {
+            info.time = std::chrono::steady_clock::now() - start_time;
+            draw_observer(info);
+        }
+    }
+
+    void SetAccelerated() {
+        info.is_accelerated = true;
+    }
+
+private:
+    DrawInfo info{};
+    std::chrono::steady_clock::time_point start_time;
+    bool active = false;
+};
+
 static const char* GetShaderSetupTypeName(Shader::ShaderSetup& setup) {
     if (&setup == &g_state.vs) {
         return "vertex shader";
@@ -143,7 +180,10 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     switch (id) {
     // Trigger IRQ
     case PICA_REG_INDEX(trigger_irq):
-        Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
+        if (!VideoCore::g_gpu_thread ||
+            !VideoCore::g_gpu_thread->DeferInterrupt(Service::GSP::InterruptId::P3D)) {
+            Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
+        }
         break;
 
     case PICA_REG_INDEX(pipeline.triangle_topology):
@@ -213,7 +253,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                 if (immediate_attribute_id < regs.pipeline.max_input_attrib_index) {
                     immediate_attribute_id += 1;
                 } else {
-                    MICROPROFILE_SCOPE(GPU_Drawing);
+                    CITRA_PROFILE_SCOPE(GPU_Drawing, "GPU", "Drawing");
+                    DrawTimer draw_timer{1, false, true};
                     immediate_attribute_id = 0;
 
                     Shader::OutputVertex::ValidateSemantics(regs.rasterizer);
@@ -273,7 +314,9 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     // It seems like these trigger vertex rendering
     case PICA_REG_INDEX(pipeline.trigger_draw):
     case PICA_REG_INDEX(pipeline.trigger_draw_indexed): {
-        MICROPROFILE_SCOPE(GPU_Drawing);
+        CITRA_PROFILE_SCOPE(GPU_Drawing, "GPU", "Drawing");
+        const bool is_indexed = (id == PICA_REG_INDEX(pipeline.trigger_draw_indexed));
+        DrawTimer draw_timer{regs.pipeline.num_vertices, is_indexed, false};
 
 #if PICA_LOG_TEV
         DebugUtils::DumpTevStageConfig(regs.GetTevStages());
@@ -301,10 +344,9 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
             accelerate_draw = false;
         }
 
-        bool is_indexed = (id == PICA_REG_INDEX(pipeline.trigger_draw_indexed));
-
         if (accelerate_draw &&
             VideoCore::g_renderer->Rasterizer()->AccelerateDrawBatch(is_indexed)) {
+            draw_timer.SetAccelerated();
             if (g_debug_context) {
                 g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch, nullptr);
             }
@@ -586,6 +628,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         ASSERT_MSG(lut_config.index < 256, "lut_config.index exceeded maximum value of 255!");
 
         g_state.lighting.luts[lut_config.type][lut_config.index].raw = value;
+        g_state.lighting.luts_dirty |= 1u << lut_config.type;
         lut_config.index.Assign(lut_config.index + 1);
         break;
     }
@@ -599,6 +642,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX(texturing.fog_lut_data[6]):
     case PICA_REG_INDEX(texturing.fog_lut_data[7]): {
         g_state.fog.lut[regs.texturing.fog_lut_offset % 128].raw = value;
+        g_state.fog.lut_dirty = true;
         regs.texturing.fog_lut_offset.Assign(regs.texturing.fog_lut_offset + 1);
         break;
     }
@@ -613,8 +657,9 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX(texturing.proctex_lut_data[7]): {
         auto& index = regs.texturing.proctex_lut_config.index;
         auto& pt = g_state.proctex;
+        const auto ref_table = regs.texturing.proctex_lut_config.ref_table.Value();
 
-        switch (regs.texturing.proctex_lut_config.ref_table.Value()) {
+        switch (ref_table) {
         case TexturingRegs::ProcTexLutTable::Noise:
             pt.noise_table[index % pt.noise_table.size()].raw = value;
             break;
@@ -631,6 +676,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
             pt.color_diff_table[index % pt.color_diff_table.size()].raw = value;
             break;
         }
+        pt.tables_dirty |= 1u << static_cast<u32>(ref_table);
         index.Assign(index + 1);
         break;
     }
@@ -638,25 +684,331 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         break;
     }
 
-    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(id);
+    g_state.dirty_regs.Set(id);
 
     if (g_debug_context)
         g_debug_context->OnEvent(DebugContext::Event::PicaCommandProcessed,
                                  reinterpret_cast<void*>(&id));
 }
 
-void ProcessCommandList(PAddr list, u32 size) {
+/// Registers which stream data into internal memory. Consecutive writes to the registers of one
+/// port have the same effect, so a run of them can be applied without going through WritePicaReg.
+enum class DataPort : u8 {
+    None,
+    VSUniform,
+    GSUniform,
+    VSProgram,
+    GSProgram,
+    VSSwizzle,
+    GSSwizzle,
+    LightingLut,
+    FogLut,
+    ProcTexLut,
+};
 
-    u32* buffer = (u32*)VideoCore::g_memory->GetPhysicalPointer(list);
+static DataPort GetDataPort(u32 id) {
+    const auto in_port = [id](u32 first) { return id >= first && id < first + 8; };
 
-    if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
-        Pica::g_debug_context->recorder->MemoryAccessed((u8*)buffer, size, list);
+    if (in_port(PICA_REG_INDEX(vs.uniform_setup.set_value[0]))) {
+        return DataPort::VSUniform;
+    }
+    if (in_port(PICA_REG_INDEX(gs.uniform_setup.set_value[0]))) {
+        return DataPort::GSUniform;
+    }
+    if (in_port(PICA_REG_INDEX(vs.program.set_word[0]))) {
+        return DataPort::VSProgram;
     }
+    if (in_port(PICA_REG_INDEX(gs.program.set_word[0]))) {
+        return DataPort::GSProgram;
+    }
+    if (in_port(PICA_REG_INDEX(vs.swizzle_patterns.set_word[0]))) {
+        return DataPort::VSSwizzle;
+    }
+    if (in_port(PICA_REG_INDEX(gs.swizzle_patterns.set_word[0]))) {
+        return DataPort::GSSwizzle;
+    }
+    if (in_port(PICA_REG_INDEX(lighting.lut_data[0]))) {
+        return DataPort::LightingLut;
+    }
+    if (in_port(PICA_REG_INDEX(texturing.fog_lut_data[0]))) {
+        return DataPort::FogLut;
+    }
+    if (in_port(PICA_REG_INDEX(texturing.proctex_lut_data[0]))) {
+        return DataPort::ProcTexLut;
+    }
+    return DataPort::None;
+}
 
-    g_state.cmd_list.addr = list;
-    g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = buffer;
-    g_state.cmd_list.length = size / sizeof(u32);
+/// A command header together with its parameters, as decoded from a command list.
+struct CommandRun {
+    u16 id;          ///< First register written
+    u8 mask;         ///< Byte enable mask, see CommandHeader::parameter_mask
+    bool group;      ///< Whether consecutive registers are written instead of the same one
+    DataPort port;   ///< Data port all writes go to, if any
+    u32 first_value; ///< Index of the first parameter in DecodedCommandList::values
+    u32 count;       ///< Number of parameters
+};
+
+struct DecodedCommandList {
+    u64 hash;
+    u32 length;
+    /// Word offset at which the remaining commands have to be interpreted one by one. This is
+    /// where the list jumps to another command buffer, or the end of the list.
+    u32 resume_offset;
+    std::vector<CommandRun> runs;
+    std::vector<u32> values;
+};
+
+/// Games submit mostly identical command lists every frame, from a handful of addresses.
+static std::unordered_map<PAddr, DecodedCommandList> decoded_list_cache;
+constexpr std::size_t MaxDecodedLists = 256;
+
+static bool WritesCommandBufferTrigger(u32 first_id, u32 last_id) {
+    return first_id <= PICA_REG_INDEX(pipeline.command_buffer.trigger[1]) &&
+           last_id >= PICA_REG_INDEX(pipeline.command_buffer.trigger[0]);
+}
+
+static void DecodeCommandList(DecodedCommandList& decoded, const u32* buffer, u32 length) {
+    decoded.runs.clear();
+    decoded.values.clear();
+
+    u32 offset = 0;
+    while (offset < length) {
+        // Align read pointer to 8 bytes
+        offset += offset % 2;
+        if (offset + 2 > length) {
+            break;
+        }
+
+        const CommandHeader header = {buffer[offset + 1]};
+        const u32 count = header.extra_data_length + 1;
+        const u32 first_id = header.cmd_id;
+        const u32 last_id = first_id + (header.group_commands ? count - 1 : 0);
+
+        // Jumps and lists running past their end are left to the interpreter, which handles
+        // them exactly as before.
+        if (offset + 1 + count > length || WritesCommandBufferTrigger(first_id, last_id)) {
+            break;
+        }
+
+        const DataPort port = GetDataPort(first_id);
+        CommandRun& run = decoded.runs.emplace_back();
+        run.id = static_cast<u16>(first_id);
+        run.mask = static_cast<u8>(header.parameter_mask.Value());
+        run.group = header.group_commands != 0;
+        run.port = (run.mask == 0xF && GetDataPort(last_id) == port) ? port : DataPort::None;
+        run.first_value = static_cast<u32>(decoded.values.size());
+        run.count = count;
+
+        decoded.values.push_back(buffer[offset]);
+        decoded.values.insert(decoded.values.end(), buffer + offset + 2,
+                              buffer + offset + 1 + count);
+        offset += 1 + count;
+    }
+    decoded.resume_offset = std::min(offset, length);
+}
+
+static const DecodedCommandList& GetDecodedCommandList(PAddr list, const u32* buffer, u32 length) {
+    const u64 hash = Common::ComputeHash64(buffer, length * sizeof(u32));
+
+    auto it = decoded_list_cache.find(list);
+    if (it != decoded_list_cache.end() && it->second.hash == hash &&
+        it->second.length == length) {
+        return it->second;
+    }
+
+    if (it == decoded_list_cache.end()) {
+        if (decoded_list_cache.size() >= MaxDecodedLists) {
+            decoded_list_cache.clear();
+        }
+        it = decoded_list_cache.emplace(list, DecodedCommandList{}).first;
+    }
+
+    DecodedCommandList& decoded = it->second;
+    decoded.hash = hash;
+    decoded.length = length;
+    DecodeCommandList(decoded, buffer, length);
+    return decoded;
+}
+
+/// Applies a run of full writes to a data port, with the same effect as calling WritePicaReg for
+/// each of them.
+static void WriteDataPort(const CommandRun& run, const u32* values) {
+    auto& regs = g_state.regs;
+
+    if (run.group) {
+        std::memcpy(&regs.reg_array[run.id], values, run.count * sizeof(u32));
+    } else {
+        regs.reg_array[run.id] = values[run.count - 1];
+    }
+
+    switch (run.port) {
+    case DataPort::VSUniform:
+        for (u32 i = 0; i < run.count; ++i) {
+            WriteUniformFloatReg(regs.vs, g_state.vs, g_state.vs_float_regs_counter,
+                                 g_state.vs_uniform_write_buffer, values[i]);
+        }
+        break;
+
+    case DataPort::GSUniform:
+        for (u32 i = 0; i < run.count; ++i) {
+            WriteUniformFloatReg(regs.gs, g_state.gs, g_state.gs_float_regs_counter,
+                                 g_state.gs_uniform_write_buffer, values[i]);
+        }
+        break;
+
+    case DataPort::VSProgram: {
+        u32& offset = regs.vs.program.offset;
+        const bool shared = !regs.pipeline.gs_unit_exclusive_configuration;
+        for (u32 i = 0; i < run.count; ++i) {
+            if (offset >= 512) {
+                LOG_ERROR(HW_GPU, "Invalid VS program offset {}", offset);
+                break;
+            }
+            g_state.vs.program_code[offset] = values[i];
+            if (shared) {
+                g_state.gs.program_code[offset] = values[i];
+            }
+            offset++;
+        }
+        g_state.vs.MarkProgramCodeDirty();
+        if (shared) {
+            g_state.gs.MarkProgramCodeDirty();
+        }
+        break;
+    }
+
+    case DataPort::GSProgram: {
+        u32& offset = regs.gs.program.offset;
+        for (u32 i = 0; i < run.count; ++i) {
+            if (offset >= 4096) {
+                LOG_ERROR(HW_GPU, "Invalid GS program offset {}", offset);
+                break;
+            }
+            g_state.gs.program_code[offset++] = values[i];
+        }
+        g_state.gs.MarkProgramCodeDirty();
+        break;
+    }
+
+    case DataPort::VSSwizzle: {
+        u32& offset = regs.vs.swizzle_patterns.offset;
+        const bool shared = !regs.pipeline.gs_unit_exclusive_configuration;
+        for (u32 i = 0; i < run.count; ++i) {
+            if (offset >= g_state.vs.swizzle_data.size()) {
+                LOG_ERROR(HW_GPU, "Invalid VS swizzle pattern offset {}", offset);
+                break;
+            }
+            g_state.vs.swizzle_data[offset] = values[i];
+            if (shared) {
+                g_state.gs.swizzle_data[offset] = values[i];
+            }
+            offset++;
+        }
+        g_state.vs.MarkSwizzleDataDirty();
+        if (shared) {
+            g_state.gs.MarkSwizzleDataDirty();
+        }
+        break;
+    }
+
+    case DataPort::GSSwizzle: {
+        u32& offset = regs.gs.swizzle_patterns.offset;
+        for (u32 i = 0; i < run.count; ++i) {
+            if (offset >= g_state.gs.swizzle_data.size()) {
+                LOG_ERROR(HW_GPU, "Invalid GS swizzle pattern offset {}", offset);
+                break;
+            }
+            g_state.gs.swizzle_data[offset++] = values[i];
+        }
+        g_state.gs.MarkSwizzleDataDirty();
+        break;
+    }
+
+    case DataPort::LightingLut: {
+        auto& lut_config = regs.lighting.lut_config;
+        auto& lut = g_state.lighting.luts[lut_config.type];
+        g_state.lighting.luts_dirty |= 1u << lut_config.type;
+        for (u32 i = 0; i < run.count; ++i) {
+            ASSERT_MSG(lut_config.index < 256, "lut_config.index exceeded maximum value of 255!");
+            lut[lut_config.index].raw = values[i];
+            lut_config.index.Assign(lut_config.index + 1);
+        }
+        break;
+    }
+
+    case DataPort::FogLut: {
+        auto& offset = regs.texturing.fog_lut_offset;
+        g_state.fog.lut_dirty = true;
+        for (u32 i = 0; i < run.count; ++i) {
+            g_state.fog.lut[offset % 128].raw = values[i];
+            offset.Assign(offset + 1);
+        }
+        break;
+    }
+
+    case DataPort::ProcTexLut: {
+        auto& index = regs.texturing.proctex_lut_config.index;
+        auto& pt = g_state.proctex;
+        const auto write_table = [&](auto& table) {
+            for (u32 i = 0; i < run.count; ++i) {
+                table[index % table.size()].raw = values[i];
+                index.Assign(index + 1);
+            }
+        };
+
+        const auto ref_table = regs.texturing.proctex_lut_config.ref_table.Value();
+        pt.tables_dirty |= 1u << static_cast<u32>(ref_table);
+
+        switch (ref_table) {
+        case TexturingRegs::ProcTexLutTable::Noise:
+            write_table(pt.noise_table);
+            break;
+        case TexturingRegs::ProcTexLutTable::ColorMap:
+            write_table(pt.color_map_table);
+            break;
+        case TexturingRegs::ProcTexLutTable::AlphaMap:
+            write_table(pt.alpha_map_table);
+            break;
+        case TexturingRegs::ProcTexLutTable::Color:
+            write_table(pt.color_table);
+            break;
+        case TexturingRegs::ProcTexLutTable::ColorDiff:
+            write_table(pt.color_diff_table);
+            break;
+        default:
+            index.Assign(index + run.count);
+            break;
+        }
+        break;
+    }
 
+    case DataPort::None:
+        UNREACHABLE();
+    }
+
+    // All registers of a port are handled the same way by the rasterizer, so marking the first
+    // one dirty covers the whole run.
+    g_state.dirty_regs.Set(run.id);
+}
+
+static void ExecuteDecodedCommandList(const DecodedCommandList& decoded) {
+    for (const CommandRun& run : decoded.runs) {
+        const u32* values = decoded.values.data() + run.first_value;
+
+        if (run.port != DataPort::None) {
+            WriteDataPort(run, values);
+            continue;
+        }
+
+        for (u32 i = 0; i < run.count; ++i) {
+            WritePicaReg(run.id + (run.group ? i : 0), values[i], run.mask);
+        }
+    }
+}
+
+/// Interprets the commands from the current position of the command list on.
+static void InterpretCommands() {
     while (g_state.cmd_list.current_ptr < g_state.cmd_list.head_ptr + g_state.cmd_list.length) {
 
         // Align read pointer to 8 bytes
@@ -675,4 +1027,33 @@ void ProcessCommandList(PAddr list, u32 size) {
     }
 }
 
+void SetDrawObserver(DrawObserver observer) {
+    draw_observer = std::move(observer);
+}
+
+void ProcessCommandList(PAddr list, u32 size) {
+    CITRA_TRACE_SCOPE("GPU", "ProcessCommandList");
+    Core::PerfStats::ScopedComponent component{Core::PerfStats::Component::Gpu};
+
+    u32* buffer = (u32*)VideoCore::g_memory->GetPhysicalPointer(list);
+
+    if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
+        Pica::g_debug_context->recorder->MemoryAccessed((u8*)buffer, size, list);
+    }
+
+    g_state.cmd_list.addr = list;
+    g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = buffer;
+    g_state.cmd_list.length = size / sizeof(u32);
+
+    // The debugger and the tracer observe every single register write, so they get the plain
+    // interpreter.
+    if (buffer && !g_debug_context && !DebugUtils::IsPicaTracing()) {
+        const auto& decoded = GetDecodedCommandList(list, buffer, g_state.cmd_list.length);
+        ExecuteDecodedCommandList(decoded);
+        g_state.cmd_list.current_ptr = buffer + decoded.resume_offset;
+    }
+
+    InterpretCommands();
+}
+
 } // namespace Pica::CommandProcessor
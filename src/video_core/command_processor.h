@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <type_traits>
 #include "common/bit_field.h"
 #include "common/common_types.h"
@@ -34,4 +36,22 @@ static_assert(sizeof(CommandHeader) == sizeof(u32), "CommandHeader has incorrect
 
 void ProcessCommandList(PAddr list, u32 size);
 
+/// Description of a draw, passed to the draw observer
+struct DrawInfo {
+    u32 num_vertices;
+    bool is_indexed;
+    bool is_immediate; ///< Triangles submitted through the immediate mode vertex attribute port
+    bool is_accelerated;
+    std::chrono::steady_clock::duration time; ///< Host time spent processing the draw
+};
+
+using DrawObserver = std::function<void(const DrawInfo&)>;
+
+/**
+ * Sets a function that is called after every draw, for tools that measure the cost of individual
+ * draws like the CiTrace player. An empty function removes the observer. Must not be changed while
+ * a command list is being processed.
+ */
+void SetDrawObserver(DrawObserver observer);
+
 } // namespace Pica::CommandProcessor
@@ -0,0 +1,111 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/microprofile.h"
+#include "common/tracing.h"
+#include "core/core_timing.h"
+#include "core/hle/service/gsp/gsp.h"
+#include "video_core/command_processor.h"
+#include "video_core/gpu_thread.h"
+
+MICROPROFILE_DEFINE(GPU_ThreadCmdlistProcessing, "GPU", "Cmdlist Processing (GPU thread)",
+                    MP_RGB(100, 255, 100));
+MICROPROFILE_DEFINE(GPU_ThreadSynchronize, "GPU", "Wait for GPU thread", MP_RGB(255, 100, 100));
+
+namespace VideoCore {
+
+namespace {
+thread_local bool is_gpu_thread = false;
+}
+
+GPUThread::GPUThread(Core::Timing& timing_) : timing{timing_}, worker{1, "GPU"} {
+    completion_event = timing.RegisterEvent("VideoCore::GPUThread::Completion",
+                                            [this](std::uintptr_t, s64) { Synchronize(); });
+}
+
+GPUThread::~GPUThread() {
+    worker.WaitForRequests();
+    timing.UnscheduleEvent(completion_event, 0);
+    RunDeferredTasks();
+}
+
+void GPUThread::SubmitCommandList(PAddr address, u32 size) {
+    const u64 list_id = submitted_lists.fetch_add(1, std::memory_order_relaxed) + 1;
+    CITRA_TRACE_FLOW_BEGIN("GPU", "Command list", list_id);
+    CITRA_TRACE_COUNTER("GPU", "Queued command lists",
+                        list_id - processed_lists.load(std::memory_order_relaxed));
+    worker.QueueWork([this, address, size, list_id] {
+        {
+            CITRA_PROFILE_SCOPE(GPU_ThreadCmdlistProcessing, "GPU",
+                                "Cmdlist Processing (GPU thread)");
+            CITRA_TRACE_FLOW_END("GPU", "Command list", list_id);
+            is_gpu_thread = true;
+            Pica::CommandProcessor::ProcessCommandList(address, size);
+        }
+        processed_lists.store(list_id, std::memory_order_relaxed);
+        CITRA_TRACE_COUNTER("GPU", "Queued command lists",
+                            submitted_lists.load(std::memory_order_relaxed) - list_id);
+    });
+
+    if (!is_busy) {
+        is_busy = true;
+        timing.ScheduleEvent(usToCycles(CompletionDelayUs), completion_event);
+    }
+}
+
+void GPUThread::Synchronize() {
+    if (is_gpu_thread || !is_busy) {
+        return;
+    }
+
+    {
+        CITRA_PROFILE_SCOPE(GPU_ThreadSynchronize, "GPU", "Wait for GPU thread");
+        worker.WaitForRequests();
+    }
+    is_busy = false;
+    timing.UnscheduleEvent(completion_event, 0);
+    RunDeferredTasks();
+
+    std::vector<Service::GSP::InterruptId> interrupts;
+    {
+        std::scoped_lock lock{deferred_mutex};
+        interrupts.swap(deferred_interrupts);
+    }
+    for (const auto interrupt_id : interrupts) {
+        Service::GSP::SignalInterrupt(interrupt_id);
+    }
+}
+
+bool GPUThread::DeferInterrupt(Service::GSP::InterruptId interrupt_id) {
+    if (!is_gpu_thread) {
+        return false;
+    }
+
+    std::scoped_lock lock{deferred_mutex};
+    deferred_interrupts.push_back(interrupt_id);
+    return true;
+}
+
+bool GPUThread::DeferTask(std::function<void()> task) {
+    if (!is_gpu_thread) {
+        return false;
+    }
+
+    std::scoped_lock lock{deferred_mutex};
+    deferred_tasks.push_back(std::move(task));
+    return true;
+}
+
+void GPUThread::RunDeferredTasks() {
+    std::vector<std::function<void()>> tasks;
+    {
+        std::scoped_lock lock{deferred_mutex};
+        tasks.swap(deferred_tasks);
+    }
+    for (const auto& task : tasks) {
+        task();
+    }
+}
+
+} // namespace VideoCore
@@ -0,0 +1,88 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "common/common_types.h"
+#include "common/thread_worker.h"
+
+namespace Core {
+class Timing;
+struct TimingEventType;
+} // namespace Core
+
+namespace Service::GSP {
+enum class InterruptId : u8;
+}
+
+namespace VideoCore {
+
+/**
+ * Processes PICA command lists on a dedicated host thread, so that CPU emulation keeps running
+ * while the software rasterizer draws.
+ *
+ * Interrupts raised by a command list are held back and signaled on the emulation thread once the
+ * GPU thread has caught up. This happens at a fixed emulated delay after submission, or earlier
+ * when the emulation thread needs the GPU to be idle (register accesses, rasterizer cache
+ * flushes, VBlank and savestates). Guest-visible timing therefore doesn't depend on host speed.
+ *
+ * Only the software renderer can use this, as the hardware renderers need their graphics context
+ * on the emulation thread.
+ */
+class GPUThread {
+public:
+    explicit GPUThread(Core::Timing& timing);
+    ~GPUThread();
+
+    /// Queues a command list for processing on the GPU thread.
+    void SubmitCommandList(PAddr address, u32 size);
+
+    /**
+     * Waits until all submitted command lists have been processed and signals the interrupts they
+     * raised. Does nothing when called from the GPU thread itself.
+     */
+    void Synchronize();
+
+    /**
+     * Defers an interrupt raised while processing a command list.
+     * @returns false if not called from the GPU thread, in which case the caller should signal the
+     * interrupt itself.
+     */
+    bool DeferInterrupt(Service::GSP::InterruptId interrupt_id);
+
+    /**
+     * Defers work that has to happen on the emulation thread, such as changes to the page tables
+     * used by the CPU. Deferred tasks run in order when synchronizing, before the interrupts are
+     * signaled.
+     * @returns false if not called from the GPU thread, in which case the caller should run the
+     * task itself.
+     */
+    bool DeferTask(std::function<void()> task);
+
+private:
+    /// Runs the deferred tasks on the calling thread.
+    void RunDeferredTasks();
+
+    /// Delay after a submission at which the GPU thread is waited for.
+    static constexpr int CompletionDelayUs = 500;
+
+    Core::Timing& timing;
+    Core::TimingEventType* completion_event;
+    Common::ThreadWorker worker;
+
+    bool is_busy = false; ///< Whether there is submitted work not waited for yet
+    /// Number of submitted command lists, identifies them in traces
+    std::atomic<u64> submitted_lists{0};
+    /// Number of command lists processed by the GPU thread
+    std::atomic<u64> processed_lists{0};
+    std::mutex deferred_mutex;
+    std::vector<Service::GSP::InterruptId> deferred_interrupts;
+    std::vector<std::function<void()>> deferred_tasks;
+};
+
+} // namespace VideoCore
@@ -40,6 +40,15 @@ struct State {
     /// Pica registers
     Regs regs;
 
+    /// Registers written since the rasterizer last synchronized its state with them
+    struct DirtyRegs {
+        std::array<u64, (Regs::NUM_REGS + 63) / 64> words{};
+
+        void Set(u32 id) {
+            words[id / 64] |= u64{1} << (id % 64);
+        }
+    } dirty_regs;
+
     Shader::ShaderSetup vs;
     Shader::ShaderSetup gs;
 
@@ -97,6 +106,10 @@ struct State {
         UnionArray<ColorEntry, 256> color_table;
         UnionArray<ColorDifferenceEntry, 256> color_diff_table;
 
+        /// Bitmask of the tables written since the rasterizer last synchronized them, indexed by
+        /// TexturingRegs::ProcTexLutTable
+        u32 tables_dirty = 0;
+
     private:
         friend class boost::serialization::access;
         template <class Archive>
@@ -137,6 +150,9 @@ struct State {
         };
 
         std::array<UnionArray<LutEntry, 256>, 24> luts;
+
+        /// Bitmask of the LUTs written since the rasterizer last synchronized them
+        u32 luts_dirty = 0;
     } lighting;
 
     struct {
@@ -157,6 +173,9 @@ struct State {
         };
 
         UnionArray<LutEntry, 128> lut;
+
+        /// Whether the LUT was written since the software rasterizer last converted it
+        bool lut_dirty = false;
     } fog;
 
     /// Current Pica command list
@@ -247,6 +266,11 @@ private:
         cmd_list.head_ptr =
             reinterpret_cast<u32*>(VideoCore::g_memory->GetPhysicalPointer(cmd_list.addr));
         cmd_list.current_ptr = cmd_list.head_ptr + offset;
+
+        // The LUTs were replaced, so the rasterizer has to pick them up again
+        lighting.luts_dirty = ~0u;
+        proctex.tables_dirty = ~0u;
+        fog.lut_dirty = true;
     }
 };
 
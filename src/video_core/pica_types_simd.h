@@ -0,0 +1,213 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstring>
+#include "common/arch.h"
+#include "video_core/pica_types.h"
+
+#if CITRA_ARCH(x86_64)
+#include <emmintrin.h>
+#elif CITRA_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
+namespace Pica {
+
+static_assert(sizeof(f24) == sizeof(float), "f24 must be stored as a single host float");
+
+/**
+ * Four f24 values processed together in one host SIMD register.
+ *
+ * The operations give bit-identical results to applying the f24 operators to each component,
+ * including the PICA specific rule that 0 * inf is 0 rather than NaN. On hosts without a SIMD
+ * implementation the components are processed one by one.
+ */
+class F24x4 {
+public:
+    /// Loads four consecutive values
+    static F24x4 Load(const f24* src) {
+        F24x4 ret;
+#if CITRA_ARCH(x86_64)
+        ret.value = _mm_loadu_ps(reinterpret_cast<const float*>(src));
+#elif CITRA_ARCH(arm64)
+        ret.value = vld1q_f32(reinterpret_cast<const float*>(src));
+#else
+        std::memcpy(ret.value.data(), src, sizeof(ret.value));
+#endif
+        return ret;
+    }
+
+    /// Returns a vector with all components set to the given value
+    static F24x4 Broadcast(f24 src) {
+        F24x4 ret;
+#if CITRA_ARCH(x86_64)
+        ret.value = _mm_set1_ps(src.ToFloat32());
+#elif CITRA_ARCH(arm64)
+        ret.value = vdupq_n_f32(src.ToFloat32());
+#else
+        ret.value.fill(src.ToFloat32());
+#endif
+        return ret;
+    }
+
+    /// Stores all four components
+    void Store(f24* dest) const {
+#if CITRA_ARCH(x86_64)
+        _mm_storeu_ps(reinterpret_cast<float*>(dest), value);
+#elif CITRA_ARCH(arm64)
+        vst1q_f32(reinterpret_cast<float*>(dest), value);
+#else
+        std::memcpy(dest, value.data(), sizeof(value));
+#endif
+    }
+
+    /**
+     * Stores the components selected by a mask and leaves the others untouched.
+     * @param lanes Bit i set stores component i
+     */
+    void StoreMasked(f24* dest, u32 lanes) const {
+        if (lanes == 0xF) {
+            Store(dest);
+            return;
+        }
+#if CITRA_ARCH(x86_64)
+        const __m128 mask = _mm_castsi128_ps(_mm_set_epi32(-static_cast<s32>((lanes >> 3) & 1),
+                                                           -static_cast<s32>((lanes >> 2) & 1),
+                                                           -static_cast<s32>((lanes >> 1) & 1),
+                                                           -static_cast<s32>(lanes & 1)));
+        const __m128 old = _mm_loadu_ps(reinterpret_cast<const float*>(dest));
+        _mm_storeu_ps(reinterpret_cast<float*>(dest),
+                      _mm_or_ps(_mm_and_ps(mask, value), _mm_andnot_ps(mask, old)));
+#elif CITRA_ARCH(arm64)
+        const u32 mask_bits[4] = {0u - (lanes & 1), 0u - ((lanes >> 1) & 1),
+                                  0u - ((lanes >> 2) & 1), 0u - ((lanes >> 3) & 1)};
+        const float32x4_t old = vld1q_f32(reinterpret_cast<const float*>(dest));
+        vst1q_f32(reinterpret_cast<float*>(dest), vbslq_f32(vld1q_u32(mask_bits), value, old));
+#else
+        for (std::size_t i = 0; i < 4; ++i) {
+            if ((lanes >> i) & 1) {
+                std::memcpy(&dest[i], &value[i], sizeof(float));
+            }
+        }
+#endif
+    }
+
+    /// Returns the components as f24 values
+    std::array<f24, 4> ToArray() const {
+        std::array<f24, 4> ret;
+        Store(ret.data());
+        return ret;
+    }
+
+    F24x4 operator+(const F24x4& other) const {
+        F24x4 ret;
+#if CITRA_ARCH(x86_64)
+        ret.value = _mm_add_ps(value, other.value);
+#elif CITRA_ARCH(arm64)
+        ret.value = vaddq_f32(value, other.value);
+#else
+        for (std::size_t i = 0; i < 4; ++i) {
+            ret.value[i] = value[i] + other.value[i];
+        }
+#endif
+        return ret;
+    }
+
+    F24x4 operator-(const F24x4& other) const {
+        F24x4 ret;
+#if CITRA_ARCH(x86_64)
+        ret.value = _mm_sub_ps(value, other.value);
+#elif CITRA_ARCH(arm64)
+        ret.value = vsubq_f32(value, other.value);
+#else
+        for (std::size_t i = 0; i < 4; ++i) {
+            ret.value[i] = value[i] - other.value[i];
+        }
+#endif
+        return ret;
+    }
+
+    F24x4 operator*(const F24x4& other) const {
+        F24x4 ret;
+#if CITRA_ARCH(x86_64)
+        // PICA gives 0 instead of NaN when multiplying by inf
+        const __m128 product = _mm_mul_ps(value, other.value);
+        const __m128 nan_product = _mm_cmpunord_ps(product, product);
+        const __m128 nan_input = _mm_cmpunord_ps(value, other.value);
+        ret.value = _mm_andnot_ps(_mm_andnot_ps(nan_input, nan_product), product);
+#elif CITRA_ARCH(arm64)
+        // PICA gives 0 instead of NaN when multiplying by inf
+        const float32x4_t product = vmulq_f32(value, other.value);
+        const uint32x4_t valid_product = vceqq_f32(product, product);
+        const uint32x4_t valid_input =
+            vandq_u32(vceqq_f32(value, value), vceqq_f32(other.value, other.value));
+        const uint32x4_t zero_mask = vbicq_u32(valid_input, valid_product);
+        ret.value = vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(product), zero_mask));
+#else
+        for (std::size_t i = 0; i < 4; ++i) {
+            ret.value[i] = (f24::FromFloat32(value[i]) * f24::FromFloat32(other.value[i]))
+                               .ToFloat32();
+        }
+#endif
+        return ret;
+    }
+
+    F24x4 operator-() const {
+        F24x4 ret;
+#if CITRA_ARCH(x86_64)
+        ret.value = _mm_xor_ps(value, _mm_set1_ps(-0.0f));
+#elif CITRA_ARCH(arm64)
+        ret.value = vnegq_f32(value);
+#else
+        for (std::size_t i = 0; i < 4; ++i) {
+            ret.value[i] = -value[i];
+        }
+#endif
+        return ret;
+    }
+
+    /// Component-wise (a > b) ? a : b, which is how the PICA handles NaN inputs
+    static F24x4 Max(const F24x4& a, const F24x4& b) {
+        F24x4 ret;
+#if CITRA_ARCH(x86_64)
+        ret.value = _mm_max_ps(a.value, b.value);
+#elif CITRA_ARCH(arm64)
+        ret.value = vbslq_f32(vcgtq_f32(a.value, b.value), a.value, b.value);
+#else
+        for (std::size_t i = 0; i < 4; ++i) {
+            ret.value[i] = (a.value[i] > b.value[i]) ? a.value[i] : b.value[i];
+        }
+#endif
+        return ret;
+    }
+
+    /// Component-wise (a < b) ? a : b, which is how the PICA handles NaN inputs
+    static F24x4 Min(const F24x4& a, const F24x4& b) {
+        F24x4 ret;
+#if CITRA_ARCH(x86_64)
+        ret.value = _mm_min_ps(a.value, b.value);
+#elif CITRA_ARCH(arm64)
+        ret.value = vbslq_f32(vcltq_f32(a.value, b.value), a.value, b.value);
+#else
+        for (std::size_t i = 0; i < 4; ++i) {
+            ret.value[i] = (a.value[i] < b.value[i]) ? a.value[i] : b.value[i];
+        }
+#endif
+        return ret;
+    }
+
+private:
+#if CITRA_ARCH(x86_64)
+    __m128 value;
+#elif CITRA_ARCH(arm64)
+    float32x4_t value;
+#else
+    std::array<float, 4> value;
+#endif
+};
+
+} // namespace Pica
@@ -2,7 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <bit>
 #include <limits>
+#include <utility>
 #include "common/alignment.h"
 #include "core/memory.h"
 #include "video_core/pica_state.h"
@@ -167,7 +169,51 @@ void RasterizerAccelerated::SyncEntireState() {
     }
 }
 
-void RasterizerAccelerated::NotifyPicaRegisterChanged(u32 id) {
+void RasterizerAccelerated::SyncDirtyRegisters() {
+    auto& state = Pica::g_state;
+
+    // LUT uploads depend on the table selected at the time of the write, so they are tracked
+    // separately from the registers.
+    if (state.lighting.luts_dirty != 0) {
+        for (std::size_t i = 0; i < uniform_block_data.lighting_lut_dirty.size(); ++i) {
+            if ((state.lighting.luts_dirty >> i) & 1) {
+                uniform_block_data.lighting_lut_dirty[i] = true;
+                uniform_block_data.lighting_lut_dirty_any = true;
+            }
+        }
+        state.lighting.luts_dirty = 0;
+    }
+
+    if (state.proctex.tables_dirty != 0) {
+        using Pica::TexturingRegs;
+        const auto is_dirty = [&](TexturingRegs::ProcTexLutTable table) {
+            return ((state.proctex.tables_dirty >> static_cast<u32>(table)) & 1) != 0;
+        };
+        uniform_block_data.proctex_noise_lut_dirty |=
+            is_dirty(TexturingRegs::ProcTexLutTable::Noise);
+        uniform_block_data.proctex_color_map_dirty |=
+            is_dirty(TexturingRegs::ProcTexLutTable::ColorMap);
+        uniform_block_data.proctex_alpha_map_dirty |=
+            is_dirty(TexturingRegs::ProcTexLutTable::AlphaMap);
+        uniform_block_data.proctex_lut_dirty |= is_dirty(TexturingRegs::ProcTexLutTable::Color);
+        uniform_block_data.proctex_diff_lut_dirty |=
+            is_dirty(TexturingRegs::ProcTexLutTable::ColorDiff);
+        state.proctex.tables_dirty = 0;
+    }
+
+    // Most draws only change a handful of registers, so skip over clean words quickly. Registers
+    // written several times since the last draw are only synced once.
+    for (std::size_t word = 0; word < state.dirty_regs.words.size(); ++word) {
+        u64 bits = std::exchange(state.dirty_regs.words[word], 0);
+        while (bits != 0) {
+            const u32 bit = static_cast<u32>(std::countr_zero(bits));
+            bits &= bits - 1;
+            SyncPicaRegister(static_cast<u32>(word * 64 + bit));
+        }
+    }
+}
+
+void RasterizerAccelerated::SyncPicaRegister(u32 id) {
     switch (id) {
     // Depth modifiers
     case PICA_REG_INDEX(rasterizer.viewport_depth_range):
@@ -224,24 +270,7 @@ void RasterizerAccelerated::NotifyPicaRegisterChanged(u32 id) {
     case PICA_REG_INDEX(texturing.proctex_lut_data[5]):
     case PICA_REG_INDEX(texturing.proctex_lut_data[6]):
     case PICA_REG_INDEX(texturing.proctex_lut_data[7]):
-        using Pica::TexturingRegs;
-        switch (regs.texturing.proctex_lut_config.ref_table.Value()) {
-        case TexturingRegs::ProcTexLutTable::Noise:
-            uniform_block_data.proctex_noise_lut_dirty = true;
-            break;
-        case TexturingRegs::ProcTexLutTable::ColorMap:
-            uniform_block_data.proctex_color_map_dirty = true;
-            break;
-        case TexturingRegs::ProcTexLutTable::AlphaMap:
-            uniform_block_data.proctex_alpha_map_dirty = true;
-            break;
-        case TexturingRegs::ProcTexLutTable::Color:
-            uniform_block_data.proctex_lut_dirty = true;
-            break;
-        case TexturingRegs::ProcTexLutTable::ColorDiff:
-            uniform_block_data.proctex_diff_lut_dirty = true;
-            break;
-        }
+        // Tracked through State::proctex.tables_dirty
         break;
 
     // Alpha test
@@ -581,12 +610,9 @@ void RasterizerAccelerated::NotifyPicaRegisterChanged(u32 id) {
     case PICA_REG_INDEX(lighting.lut_data[4]):
     case PICA_REG_INDEX(lighting.lut_data[5]):
     case PICA_REG_INDEX(lighting.lut_data[6]):
-    case PICA_REG_INDEX(lighting.lut_data[7]): {
-        const auto& lut_config = regs.lighting.lut_config;
-        uniform_block_data.lighting_lut_dirty[lut_config.type] = true;
-        uniform_block_data.lighting_lut_dirty_any = true;
+    case PICA_REG_INDEX(lighting.lut_data[7]):
+        // Tracked through State::lighting.luts_dirty
         break;
-    }
 
     // Texture LOD biases
     case PICA_REG_INDEX(texturing.texture0.lod.bias):
@@ -609,7 +635,7 @@ void RasterizerAccelerated::NotifyPicaRegisterChanged(u32 id) {
 
     default:
         // Forward registers that map to fixed function API features to the video backend
-        NotifyFixedFunctionPicaRegisterChanged(id);
+        SyncFixedFunctionPicaRegister(id);
     }
 }
 
@@ -26,15 +26,21 @@ public:
 
     void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
                      const Pica::Shader::OutputVertex& v2) override;
-    void NotifyPicaRegisterChanged(u32 id) override;
     void SyncEntireState() override;
 
 protected:
+    /// Syncs the state affected by the PICA registers written since the last call. Called
+    /// before drawing.
+    void SyncDirtyRegisters();
+
+    /// Syncs the state affected by the specified PICA register
+    void SyncPicaRegister(u32 id);
+
     /// Sync fixed-function pipeline state
     virtual void SyncFixedState() = 0;
 
-    /// Notifies that a fixed function PICA register changed to the video backend
-    virtual void NotifyFixedFunctionPicaRegisterChanged(u32 id) = 0;
+    /// Syncs the video backend state affected by the specified fixed function PICA register
+    virtual void SyncFixedFunctionPicaRegister(u32 id) = 0;
 
     /// Syncs the depth scale to match the PICA register
     void SyncDepthScale();
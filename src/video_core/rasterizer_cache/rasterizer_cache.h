@@ -11,7 +11,9 @@
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/settings.h"
+#include "common/tracing.h"
 #include "core/memory.h"
+#include "core/perf_stats.h"
 #include "video_core/custom_textures/custom_tex_manager.h"
 #include "video_core/rasterizer_cache/rasterizer_cache_base.h"
 #include "video_core/regs.h"
@@ -319,7 +321,7 @@ typename T::Sampler& RasterizerCache<T>::GetSampler(
 template <class T>
 void RasterizerCache<T>::CopySurface(Surface& src_surface, Surface& dst_surface,
                                      SurfaceInterval copy_interval) {
-    MICROPROFILE_SCOPE(RasterizerCache_CopySurface);
+    CITRA_PROFILE_SCOPE(RasterizerCache_CopySurface, "RasterizerCache", "CopySurface");
 
     const PAddr copy_addr = copy_interval.lower();
     const SurfaceParams subrect_params = dst_surface.FromInterval(copy_interval);
@@ -993,7 +995,8 @@ void RasterizerCache<T>::ValidateSurface(SurfaceId surface_id, PAddr addr, u32 s
 
 template <class T>
 void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interval) {
-    MICROPROFILE_SCOPE(RasterizerCache_UploadSurface);
+    CITRA_PROFILE_SCOPE(RasterizerCache_UploadSurface, "RasterizerCache", "UploadSurface");
+    Core::PerfStats::ScopedComponent component{Core::PerfStats::Component::RasterizerCache};
 
     const SurfaceParams load_info = surface.FromInterval(interval);
     ASSERT(load_info.addr >= surface.addr && load_info.end <= surface.end);
@@ -1007,6 +1010,8 @@ void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interva
     }
 
     const auto upload_data = source_ptr.GetWriteBytes(load_info.end - load_info.addr);
+    uploaded_bytes += upload_data.size();
+    CITRA_TRACE_COUNTER("RasterizerCache", "Uploaded bytes", uploaded_bytes);
     DecodeTexture(load_info, load_info.addr, load_info.end, upload_data, staging.mapped,
                   runtime.NeedsConversion(surface.pixel_format));
 
@@ -1027,7 +1032,8 @@ void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interva
 
 template <class T>
 bool RasterizerCache<T>::UploadCustomSurface(SurfaceId surface_id, SurfaceInterval interval) {
-    MICROPROFILE_SCOPE(RasterizerCache_UploadSurface);
+    CITRA_PROFILE_SCOPE(RasterizerCache_UploadSurface, "RasterizerCache", "UploadSurface");
+    Core::PerfStats::ScopedComponent component{Core::PerfStats::Component::RasterizerCache};
 
     Surface& surface = slot_surfaces[surface_id];
     const SurfaceParams load_info = surface.FromInterval(interval);
@@ -1086,7 +1092,8 @@ bool RasterizerCache<T>::UploadCustomSurface(SurfaceId surface_id, SurfaceInterv
 
 template <class T>
 void RasterizerCache<T>::DownloadSurface(Surface& surface, SurfaceInterval interval) {
-    MICROPROFILE_SCOPE(RasterizerCache_DownloadSurface);
+    CITRA_PROFILE_SCOPE(RasterizerCache_DownloadSurface, "RasterizerCache", "DownloadSurface");
+    Core::PerfStats::ScopedComponent component{Core::PerfStats::Component::RasterizerCache};
 
     const SurfaceParams flush_info = surface.FromInterval(interval);
     const u32 flush_start = boost::icl::first(interval);
@@ -1110,6 +1117,8 @@ void RasterizerCache<T>::DownloadSurface(Surface& surface, SurfaceInterval inter
     }
 
     const auto download_dest = dest_ptr.GetWriteBytes(flush_end - flush_start);
+    downloaded_bytes += download_dest.size();
+    CITRA_TRACE_COUNTER("RasterizerCache", "Downloaded bytes", downloaded_bytes);
     EncodeTexture(flush_info, flush_start, flush_end, staging.mapped, download_dest,
                   runtime.NeedsConversion(surface.pixel_format));
 }
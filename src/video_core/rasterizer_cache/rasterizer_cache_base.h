@@ -225,6 +225,8 @@ private:
     bool use_filter;
     bool dump_textures;
     bool use_custom_textures;
+    u64 uploaded_bytes = 0;   ///< Guest memory uploaded so far, sampled in traces
+    u64 downloaded_bytes = 0; ///< Guest memory written back so far, sampled in traces
 };
 
 } // namespace VideoCore
@@ -5,6 +5,7 @@
 #include "common/settings.h"
 #include "core/core.h"
 #include "core/frontend/emu_window.h"
+#include "core/rpc/rpc_server.h"
 #include "core/tracer/recorder.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/renderer_base.h"
@@ -44,6 +45,8 @@ void RendererBase::EndFrame() {
     current_frame++;
 
     system.perf_stats->EndSystemFrame();
+    system.hle_stats.EndFrame();
+    system.RPCServer().EndFrame(current_frame);
 
     render_window.PollEvents();
 
@@ -367,6 +367,8 @@ void RasterizerOpenGL::DrawTriangles() {
 bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     MICROPROFILE_SCOPE(OpenGL_Drawing);
 
+    SyncDirtyRegisters();
+
     const bool shadow_rendering = regs.framebuffer.IsShadowRendering();
     const bool has_stencil = regs.framebuffer.HasStencil();
 
@@ -638,7 +640,7 @@ void RasterizerOpenGL::UnbindSpecial() {
     state.image_shadow_buffer = 0;
 }
 
-void RasterizerOpenGL::NotifyFixedFunctionPicaRegisterChanged(u32 id) {
+void RasterizerOpenGL::SyncFixedFunctionPicaRegister(u32 id) {
     switch (id) {
     // Clipping plane
     case PICA_REG_INDEX(rasterizer.clip_enable):
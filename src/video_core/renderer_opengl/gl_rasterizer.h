@@ -53,7 +53,7 @@ public:
 
 private:
     void SyncFixedState() override;
-    void NotifyFixedFunctionPicaRegisterChanged(u32 id) override;
+    void SyncFixedFunctionPicaRegister(u32 id) override;
 
     /// Syncs the clip enabled status to match the PICA register
     void SyncClipEnabled();
@@ -8,12 +8,14 @@
 #include <glad/glad.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "core/perf_stats.h"
 #include "video_core/renderer_opengl/gl_shader_util.h"
 #include "video_core/renderer_opengl/gl_vars.h"
 
 namespace OpenGL {
 
 GLuint LoadShader(std::string_view source, GLenum type) {
+    Core::PerfStats::ScopedComponent component{Core::PerfStats::Component::ShaderCompilation};
     const std::string version = GLES ? R"(#version 320 es
 
 #define CITRA_GLES
@@ -71,6 +73,7 @@ GLuint LoadShader(std::string_view source, GLenum type) {
 }
 
 GLuint LoadProgram(bool separable_program, std::span<const GLuint> shaders) {
+    Core::PerfStats::ScopedComponent component{Core::PerfStats::Component::ShaderCompilation};
     // Link the program
     LOG_DEBUG(Render_OpenGL, "Linking program...");
 
@@ -46,9 +46,11 @@ void RendererSoftware::LoadFBToScreenInfo(int i) {
     const PAddr framebuffer_addr =
         framebuffer.active_fb == 0 ? framebuffer.address_left1 : framebuffer.address_left2;
     const s32 bpp = GPU::Regs::BytesPerPixel(framebuffer.color_format);
+    const s32 pixel_stride = framebuffer.stride / bpp;
+    // The screen may be drawn to directly, without a display transfer
+    rasterizer->FlushRegion(framebuffer_addr, framebuffer.stride * framebuffer.height);
     const u8* framebuffer_data = memory.GetPhysicalPointer(framebuffer_addr);
 
-    const s32 pixel_stride = framebuffer.stride / bpp;
     info.height = framebuffer.height;
     info.width = pixel_stride;
     info.pixels.resize(info.width * info.height * 4);
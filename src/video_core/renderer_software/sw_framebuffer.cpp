@@ -3,14 +3,19 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <span>
+#include "common/alignment.h"
 #include "common/color.h"
 #include "common/logging/log.h"
 #include "core/hw/gpu.h"
 #include "core/memory.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/pica_types.h"
 #include "video_core/regs_framebuffer.h"
 #include "video_core/renderer_software/sw_framebuffer.h"
 #include "video_core/utils.h"
+#include "video_core/video_core.h"
 
 namespace SwRenderer {
 
@@ -34,200 +39,386 @@ void EncodeD24X8Shadow(u32 depth, u8* bytes) {
 void EncodeX24S8Shadow(u8 stencil, u8* bytes) {
     bytes[3] = stencil;
 }
+
+/// Converts the pixels of a render target from guest memory
+template <typename T, typename Func>
+void DecodePixels(std::span<T> pixels, const u8* src, u32 bytes_per_pixel, Func&& decode) {
+    for (T& pixel : pixels) {
+        pixel = decode(src);
+        src += bytes_per_pixel;
+    }
+}
+
+/// Converts the pixels of a render target to guest memory
+template <typename T, typename Func>
+void EncodePixels(std::span<const T> pixels, u8* dst, u32 bytes_per_pixel, Func&& encode) {
+    for (const T& pixel : pixels) {
+        encode(pixel, dst);
+        dst += bytes_per_pixel;
+    }
+}
+
+/// Rounds a color to the precision of the color format
+template <auto Encode, auto Decode>
+Common::Vec4<u8> Quantize(const Common::Vec4<u8>& color) {
+    std::array<u8, 4> bytes;
+    Encode(color, bytes.data());
+    return Decode(bytes.data());
+}
+
 } // Anonymous namespace
 
 Framebuffer::Framebuffer(Memory::MemorySystem& memory_, const Pica::FramebufferRegs& regs_)
     : memory{memory_}, regs{regs_} {}
 
-Framebuffer::~Framebuffer() = default;
+Framebuffer::~Framebuffer() {
+    Clear(false);
+}
 
-void Framebuffer::DrawPixel(int x, int y, const Common::Vec4<u8>& color) const {
+void Framebuffer::Bind() {
     const auto& framebuffer = regs.framebuffer;
-    const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
+    if (framebuffer.GetWidth() != width || framebuffer.GetHeight() != height) {
+        Clear(true);
+        width = framebuffer.GetWidth();
+        height = framebuffer.GetHeight();
+        // Partial tiles at the top of the framebuffer are kept whole
+        num_pixels = width * Common::AlignUp(height, 8);
+        color_pixels.resize(num_pixels);
+        depth_pixels.resize(num_pixels);
+    }
 
+    // The shadow output is written to guest memory directly by DrawShadowMapPixel
+    const bool shadow = regs.output_merger.fragment_operation_mode ==
+                        FramebufferRegs::FragmentOperationMode::Shadow;
+    const PAddr color_addr = framebuffer.GetColorBufferPhysicalAddress();
+    const u32 color_format = static_cast<u32>(framebuffer.color_format.Value());
+    const bool rebind_color = shadow || !color_target.bound || color_target.addr != color_addr ||
+                              color_target.format != color_format;
+    const PAddr depth_addr = framebuffer.GetDepthBufferPhysicalAddress();
+    const u32 depth_format = static_cast<u32>(framebuffer.depth_format.Value());
+    const bool rebind_depth = !depth_target.bound || depth_target.addr != depth_addr ||
+                              depth_target.format != depth_format;
+
+    // Write back both targets before loading, in case the new ones alias the old ones
+    if (rebind_color && color_target.bound) {
+        StoreColor();
+        Release(color_target);
+    }
+    if (rebind_depth && depth_target.bound) {
+        StoreDepth();
+        Release(depth_target);
+    }
+    if (rebind_color && !shadow) {
+        Acquire(color_target, color_addr, color_format,
+                FramebufferRegs::BytesPerColorPixel(framebuffer.color_format));
+        LoadColor();
+    }
+    if (rebind_depth) {
+        Acquire(depth_target, depth_addr, depth_format,
+                FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format));
+        LoadDepth();
+    }
+}
+
+void Framebuffer::FlushRegion(PAddr addr, u32 size) {
+    if (color_target.Overlaps(addr, size)) {
+        StoreColor();
+    }
+    if (depth_target.Overlaps(addr, size)) {
+        StoreDepth();
+    }
+}
+
+void Framebuffer::InvalidateRegion(PAddr addr, u32 size) {
+    // Targets that are overwritten completely do not need to be written back
+    const auto covers = [addr, size](const RenderTarget& target) {
+        return addr <= target.addr && target.addr + target.size <= addr + size;
+    };
+    if (color_target.Overlaps(addr, size)) {
+        if (!covers(color_target)) {
+            StoreColor();
+        }
+        Release(color_target);
+    }
+    if (depth_target.Overlaps(addr, size)) {
+        if (!covers(depth_target)) {
+            StoreDepth();
+        }
+        Release(depth_target);
+    }
+}
+
+void Framebuffer::FlushAll() {
+    StoreColor();
+    StoreDepth();
+}
+
+void Framebuffer::Clear(bool flush) {
+    if (flush) {
+        FlushAll();
+    }
+    Release(color_target);
+    Release(depth_target);
+}
+
+std::size_t Framebuffer::GetPixelIndex(int x, int y) const {
     // Similarly to textures, the render framebuffer is laid out from bottom to top, too.
-    // NOTE: The framebuffer height register contains the actual FB height minus one.
-    y = framebuffer.height - y;
+    y = static_cast<int>(height) - 1 - y;
+    if (static_cast<u32>(x) >= width || static_cast<u32>(y) >= height) {
+        return InvalidIndex;
+    }
 
     const u32 coarse_y = y & ~7;
-    const u32 bytes_per_pixel =
-        GPU::Regs::BytesPerPixel(GPU::Regs::PixelFormat(framebuffer.color_format.Value()));
-    const u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                           coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* depth_buffer = memory.GetPhysicalPointer(addr);
-    u8* dst_pixel = depth_buffer + dst_offset;
-
-    switch (framebuffer.color_format) {
+    return VideoCore::GetMortonOffset(x, y, 1) + coarse_y * width;
+}
+
+void Framebuffer::DrawPixel(int x, int y, const Common::Vec4<u8>& color) {
+    const std::size_t index = GetPixelIndex(x, y);
+    if (index == InvalidIndex) {
+        return;
+    }
+
+    // Blending reads the color back, so it has to have the precision of the format
+    using namespace Common::Color;
+    Common::Vec4<u8>& pixel = color_pixels[index];
+    switch (static_cast<FramebufferRegs::ColorFormat>(color_target.format)) {
     case FramebufferRegs::ColorFormat::RGBA8:
-        Common::Color::EncodeRGBA8(color, dst_pixel);
+        pixel = color;
         break;
     case FramebufferRegs::ColorFormat::RGB8:
-        Common::Color::EncodeRGB8(color, dst_pixel);
+        pixel = Quantize<EncodeRGB8, DecodeRGB8>(color);
         break;
     case FramebufferRegs::ColorFormat::RGB5A1:
-        Common::Color::EncodeRGB5A1(color, dst_pixel);
+        pixel = Quantize<EncodeRGB5A1, DecodeRGB5A1>(color);
         break;
     case FramebufferRegs::ColorFormat::RGB565:
-        Common::Color::EncodeRGB565(color, dst_pixel);
+        pixel = Quantize<EncodeRGB565, DecodeRGB565>(color);
         break;
     case FramebufferRegs::ColorFormat::RGBA4:
-        Common::Color::EncodeRGBA4(color, dst_pixel);
+        pixel = Quantize<EncodeRGBA4, DecodeRGBA4>(color);
         break;
     default:
         LOG_CRITICAL(Render_Software, "Unknown framebuffer color format {:x}",
-                     static_cast<u32>(framebuffer.color_format.Value()));
+                     color_target.format);
         UNIMPLEMENTED();
     }
+    color_target.dirty = true;
 }
 
 const Common::Vec4<u8> Framebuffer::GetPixel(int x, int y) const {
-    const auto& framebuffer = regs.framebuffer;
-    const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
-
-    y = framebuffer.height - y;
+    const std::size_t index = GetPixelIndex(x, y);
+    return index != InvalidIndex ? color_pixels[index] : Common::Vec4<u8>{0, 0, 0, 0};
+}
 
-    const u32 coarse_y = y & ~7;
-    const u32 bytes_per_pixel =
-        GPU::Regs::BytesPerPixel(GPU::Regs::PixelFormat(framebuffer.color_format.Value()));
-    const u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                           coarse_y * framebuffer.width * bytes_per_pixel;
-    const u8* color_buffer = memory.GetPhysicalPointer(addr);
-    const u8* src_pixel = color_buffer + src_offset;
-
-    switch (framebuffer.color_format) {
-    case FramebufferRegs::ColorFormat::RGBA8:
-        return Common::Color::DecodeRGBA8(src_pixel);
-    case FramebufferRegs::ColorFormat::RGB8:
-        return Common::Color::DecodeRGB8(src_pixel);
-    case FramebufferRegs::ColorFormat::RGB5A1:
-        return Common::Color::DecodeRGB5A1(src_pixel);
-    case FramebufferRegs::ColorFormat::RGB565:
-        return Common::Color::DecodeRGB565(src_pixel);
-    case FramebufferRegs::ColorFormat::RGBA4:
-        return Common::Color::DecodeRGBA4(src_pixel);
-    default:
-        LOG_CRITICAL(Render_Software, "Unknown framebuffer color format {:x}",
-                     static_cast<u32>(framebuffer.color_format.Value()));
-        UNIMPLEMENTED();
-    }
+u32 Framebuffer::GetDepth(int x, int y) const {
+    const std::size_t index = GetPixelIndex(x, y);
+    return index != InvalidIndex ? depth_pixels[index] & 0xFFFFFF : 0;
+}
 
-    return {0, 0, 0, 0};
+u8 Framebuffer::GetStencil(int x, int y) const {
+    const std::size_t index = GetPixelIndex(x, y);
+    return index != InvalidIndex ? static_cast<u8>(depth_pixels[index] >> 24) : 0;
 }
 
-u32 Framebuffer::GetDepth(int x, int y) const {
-    const auto& framebuffer = regs.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
+void Framebuffer::SetDepth(int x, int y, u32 value) {
+    const std::size_t index = GetPixelIndex(x, y);
+    if (index == InvalidIndex) {
+        return;
+    }
 
-    y = framebuffer.height - y;
+    u32& pixel = depth_pixels[index];
+    pixel = (pixel & 0xFF000000) | (value & 0xFFFFFF);
+    depth_target.dirty = true;
+}
 
-    const u32 coarse_y = y & ~7;
-    const u32 bytes_per_pixel = FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    const u32 stride = framebuffer.width * bytes_per_pixel;
+void Framebuffer::SetStencil(int x, int y, u8 value) {
+    const std::size_t index = GetPixelIndex(x, y);
+    if (index == InvalidIndex) {
+        return;
+    }
 
-    const u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    const u8* depth_buffer = memory.GetPhysicalPointer(addr);
-    const u8* src_pixel = depth_buffer + src_offset;
+    // Only D24S8 has a stencil component, the other formats drop it when written back
+    u32& pixel = depth_pixels[index];
+    pixel = (pixel & 0xFFFFFF) | (static_cast<u32>(value) << 24);
+    depth_target.dirty = true;
+}
 
-    switch (framebuffer.depth_format) {
-    case FramebufferRegs::DepthFormat::D16:
-        return Common::Color::DecodeD16(src_pixel);
-    case FramebufferRegs::DepthFormat::D24:
-        return Common::Color::DecodeD24(src_pixel);
-    case FramebufferRegs::DepthFormat::D24S8:
-        return Common::Color::DecodeD24S8(src_pixel).x;
-    default:
-        LOG_CRITICAL(HW_GPU, "Unimplemented depth format {}",
-                     static_cast<u32>(framebuffer.depth_format.Value()));
-        UNIMPLEMENTED();
-        return 0;
+void Framebuffer::Acquire(RenderTarget& target, PAddr addr, u32 format, u32 bytes_per_pixel) {
+    target.addr = addr;
+    target.size = num_pixels * bytes_per_pixel;
+    target.format = format;
+    target.bound = true;
+    target.dirty = false;
+    target.data = memory.GetPhysicalPointer(addr);
+    if (target.size == 0 || !target.data ||
+        !memory.IsValidPhysicalAddress(addr + target.size - 1)) {
+        LOG_ERROR(Render_Software, "Render target at {:#010x} of size {:#x} is out of bounds",
+                  addr, target.size);
+        target.data = nullptr;
+        return;
     }
+    UpdatePagesCachedCount(target, 1);
 }
 
-u8 Framebuffer::GetStencil(int x, int y) const {
-    const auto& framebuffer = regs.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
+void Framebuffer::Release(RenderTarget& target) {
+    if (target.bound && target.data) {
+        UpdatePagesCachedCount(target, -1);
+    }
+    target.bound = false;
+    target.dirty = false;
+}
 
-    y = framebuffer.height - y;
+void Framebuffer::UpdatePagesCachedCount(const RenderTarget& target, int delta) {
+    std::vector<PAddr> changed_pages;
+    const u32 first_page = target.addr >> Memory::CITRA_PAGE_BITS;
+    const u32 last_page = (target.addr + target.size - 1) >> Memory::CITRA_PAGE_BITS;
+    for (u32 page = first_page; page <= last_page; ++page) {
+        if (delta > 0) {
+            if (cached_pages[page]++ == 0) {
+                changed_pages.push_back(page << Memory::CITRA_PAGE_BITS);
+            }
+        } else if (--cached_pages[page] == 0) {
+            changed_pages.push_back(page << Memory::CITRA_PAGE_BITS);
+            cached_pages.erase(page);
+        }
+    }
+    if (changed_pages.empty()) {
+        return;
+    }
 
-    const u32 coarse_y = y & ~7;
-    const u32 bytes_per_pixel = Pica::FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    const u32 stride = framebuffer.width * bytes_per_pixel;
+    // The page tables are used by the CPU while the GPU thread draws, so they are only changed
+    // on the emulation thread. The CPU waits for the GPU thread before it can see the results of
+    // a draw, which applies the deferred changes.
+    auto mark = [&memory = memory, changed_pages = std::move(changed_pages), cached = delta > 0] {
+        for (const PAddr page_addr : changed_pages) {
+            memory.RasterizerMarkRegionCached(page_addr, Memory::CITRA_PAGE_SIZE, cached);
+        }
+    };
+    if (!VideoCore::g_gpu_thread || !VideoCore::g_gpu_thread->DeferTask(mark)) {
+        mark();
+    }
+}
 
-    const u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    const u8* depth_buffer = memory.GetPhysicalPointer(addr);
-    const u8* src_pixel = depth_buffer + src_offset;
+void Framebuffer::LoadColor() {
+    if (!color_target.data) {
+        std::fill(color_pixels.begin(), color_pixels.end(), Common::Vec4<u8>{0, 0, 0, 0});
+        return;
+    }
 
-    switch (framebuffer.depth_format) {
-    case FramebufferRegs::DepthFormat::D24S8:
-        return Common::Color::DecodeD24S8(src_pixel).y;
+    using namespace Common::Color;
+    const std::span<Common::Vec4<u8>> pixels{color_pixels};
+    const u8* src = color_target.data;
+    switch (static_cast<FramebufferRegs::ColorFormat>(color_target.format)) {
+    case FramebufferRegs::ColorFormat::RGBA8:
+        DecodePixels(pixels, src, 4, DecodeRGBA8);
+        break;
+    case FramebufferRegs::ColorFormat::RGB8:
+        DecodePixels(pixels, src, 3, DecodeRGB8);
+        break;
+    case FramebufferRegs::ColorFormat::RGB5A1:
+        DecodePixels(pixels, src, 2, DecodeRGB5A1);
+        break;
+    case FramebufferRegs::ColorFormat::RGB565:
+        DecodePixels(pixels, src, 2, DecodeRGB565);
+        break;
+    case FramebufferRegs::ColorFormat::RGBA4:
+        DecodePixels(pixels, src, 2, DecodeRGBA4);
+        break;
     default:
-        LOG_WARNING(
-            HW_GPU,
-            "GetStencil called for function which doesn't have a stencil component (format {})",
-            static_cast<u32>(framebuffer.depth_format.Value()));
-        return 0;
+        LOG_CRITICAL(Render_Software, "Unknown framebuffer color format {:x}",
+                     color_target.format);
+        UNIMPLEMENTED();
     }
 }
 
-void Framebuffer::SetDepth(int x, int y, u32 value) const {
-    const auto& framebuffer = regs.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-
-    y = framebuffer.height - y;
+void Framebuffer::StoreColor() {
+    if (!color_target.dirty) {
+        return;
+    }
+    color_target.dirty = false;
+    if (!color_target.data) {
+        return;
+    }
 
-    const u32 coarse_y = y & ~7;
-    const u32 bytes_per_pixel = FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    const u32 stride = framebuffer.width * bytes_per_pixel;
+    using namespace Common::Color;
+    const std::span<const Common::Vec4<u8>> pixels{color_pixels};
+    u8* dst = color_target.data;
+    switch (static_cast<FramebufferRegs::ColorFormat>(color_target.format)) {
+    case FramebufferRegs::ColorFormat::RGBA8:
+        EncodePixels(pixels, dst, 4, EncodeRGBA8);
+        break;
+    case FramebufferRegs::ColorFormat::RGB8:
+        EncodePixels(pixels, dst, 3, EncodeRGB8);
+        break;
+    case FramebufferRegs::ColorFormat::RGB5A1:
+        EncodePixels(pixels, dst, 2, EncodeRGB5A1);
+        break;
+    case FramebufferRegs::ColorFormat::RGB565:
+        EncodePixels(pixels, dst, 2, EncodeRGB565);
+        break;
+    case FramebufferRegs::ColorFormat::RGBA4:
+        EncodePixels(pixels, dst, 2, EncodeRGBA4);
+        break;
+    default:
+        LOG_CRITICAL(Render_Software, "Unknown framebuffer color format {:x}",
+                     color_target.format);
+        UNIMPLEMENTED();
+    }
+}
 
-    const u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* depth_buffer = memory.GetPhysicalPointer(addr);
-    u8* dst_pixel = depth_buffer + dst_offset;
+void Framebuffer::LoadDepth() {
+    if (!depth_target.data) {
+        std::fill(depth_pixels.begin(), depth_pixels.end(), 0);
+        return;
+    }
 
-    switch (framebuffer.depth_format) {
+    const std::span<u32> pixels{depth_pixels};
+    const u8* src = depth_target.data;
+    switch (static_cast<FramebufferRegs::DepthFormat>(depth_target.format)) {
     case FramebufferRegs::DepthFormat::D16:
-        Common::Color::EncodeD16(value, dst_pixel);
+        DecodePixels(pixels, src, 2, Common::Color::DecodeD16);
         break;
     case FramebufferRegs::DepthFormat::D24:
-        Common::Color::EncodeD24(value, dst_pixel);
+        DecodePixels(pixels, src, 3, Common::Color::DecodeD24);
         break;
     case FramebufferRegs::DepthFormat::D24S8:
-        Common::Color::EncodeD24X8(value, dst_pixel);
+        DecodePixels(pixels, src, 4, [](const u8* bytes) {
+            const auto value = Common::Color::DecodeD24S8(bytes);
+            return value.x | (value.y << 24);
+        });
         break;
     default:
-        LOG_CRITICAL(HW_GPU, "Unimplemented depth format {}",
-                     static_cast<u32>(framebuffer.depth_format.Value()));
+        LOG_CRITICAL(HW_GPU, "Unimplemented depth format {}", depth_target.format);
         UNIMPLEMENTED();
-        break;
     }
 }
 
-void Framebuffer::SetStencil(int x, int y, u8 value) const {
-    const auto& framebuffer = regs.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    const u32 bytes_per_pixel = Pica::FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    const u32 stride = framebuffer.width * bytes_per_pixel;
-
-    const u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* depth_buffer = memory.GetPhysicalPointer(addr);
-    u8* dst_pixel = depth_buffer + dst_offset;
+void Framebuffer::StoreDepth() {
+    if (!depth_target.dirty) {
+        return;
+    }
+    depth_target.dirty = false;
+    if (!depth_target.data) {
+        return;
+    }
 
-    switch (framebuffer.depth_format) {
-    case Pica::FramebufferRegs::DepthFormat::D16:
-    case Pica::FramebufferRegs::DepthFormat::D24:
-        // Nothing to do
+    const std::span<const u32> pixels{depth_pixels};
+    u8* dst = depth_target.data;
+    switch (static_cast<FramebufferRegs::DepthFormat>(depth_target.format)) {
+    case FramebufferRegs::DepthFormat::D16:
+        EncodePixels(pixels, dst, 2, Common::Color::EncodeD16);
         break;
-    case Pica::FramebufferRegs::DepthFormat::D24S8:
-        Common::Color::EncodeX24S8(value, dst_pixel);
+    case FramebufferRegs::DepthFormat::D24:
+        EncodePixels(pixels, dst, 3, Common::Color::EncodeD24);
+        break;
+    case FramebufferRegs::DepthFormat::D24S8:
+        EncodePixels(pixels, dst, 4, [](u32 value, u8* bytes) {
+            Common::Color::EncodeD24S8(value & 0xFFFFFF, static_cast<u8>(value >> 24), bytes);
+        });
         break;
     default:
-        LOG_CRITICAL(HW_GPU, "Unimplemented depth format {}",
-                     static_cast<u32>(framebuffer.depth_format.Value()));
+        LOG_CRITICAL(HW_GPU, "Unimplemented depth format {}", depth_target.format);
         UNIMPLEMENTED();
-        break;
     }
 }
 
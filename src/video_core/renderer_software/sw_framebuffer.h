@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <unordered_map>
+#include <vector>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/regs_framebuffer.h"
@@ -12,19 +14,37 @@ namespace Memory {
 class MemorySystem;
 }
 
-namespace Pica {
-struct FramebufferRegs;
-}
-
 namespace SwRenderer {
 
+/**
+ * Keeps the color and depth-stencil buffers being rendered to in host memory, in a fixed format,
+ * and converts them to the PICA formats only when guest memory needs to see them. The pixels are
+ * stored in the order of the tiled layout in guest memory, so the conversion is a linear pass.
+ */
 class Framebuffer {
 public:
     explicit Framebuffer(Memory::MemorySystem& memory, const Pica::FramebufferRegs& framebuffer);
     ~Framebuffer();
 
+    /// Makes the buffers in the framebuffer registers the render targets, writing back the
+    /// previous ones if they changed.
+    void Bind();
+
+    /// Writes back the render targets overlapping the specified region.
+    void FlushRegion(PAddr addr, u32 size);
+
+    /// Writes back and releases the render targets overlapping the specified region, which is
+    /// about to be written to.
+    void InvalidateRegion(PAddr addr, u32 size);
+
+    /// Writes back all render targets.
+    void FlushAll();
+
+    /// Releases all render targets, writing them back first if flush is set.
+    void Clear(bool flush);
+
     /// Draws a pixel at the specified coordinates.
-    void DrawPixel(int x, int y, const Common::Vec4<u8>& color) const;
+    void DrawPixel(int x, int y, const Common::Vec4<u8>& color);
 
     /// Returns the current color at the specified coordinates.
     [[nodiscard]] const Common::Vec4<u8> GetPixel(int x, int y) const;
@@ -36,17 +56,54 @@ public:
     [[nodiscard]] u8 GetStencil(int x, int y) const;
 
     /// Stores the provided depth value at the specified coordinates.
-    void SetDepth(int x, int y, u32 value) const;
+    void SetDepth(int x, int y, u32 value);
 
     /// Stores the provided stencil value at the specified coordinates.
-    void SetStencil(int x, int y, u8 value) const;
+    void SetStencil(int x, int y, u8 value);
 
     /// Draws a pixel to the shadow buffer.
     void DrawShadowMapPixel(int x, int y, u32 depth, u8 stencil) const;
 
+private:
+    struct RenderTarget {
+        PAddr addr = 0;
+        u32 size = 0; ///< Size in guest memory
+        u32 format = 0;
+        u8* data = nullptr; ///< Guest memory, or nullptr if the address is invalid
+        bool bound = false;
+        bool dirty = false;
+
+        bool Overlaps(PAddr start, u32 length) const {
+            return bound && addr < start + length && start < addr + size;
+        }
+    };
+
+    static constexpr std::size_t InvalidIndex = ~std::size_t{0};
+
+    /// Returns the index of the pixel in the render targets, or InvalidIndex if out of bounds
+    std::size_t GetPixelIndex(int x, int y) const;
+
+    /// Sets up a render target and marks its pages as cached, so the CPU accesses are notified
+    void Acquire(RenderTarget& target, PAddr addr, u32 format, u32 bytes_per_pixel);
+    void Release(RenderTarget& target);
+    void UpdatePagesCachedCount(const RenderTarget& target, int delta);
+
+    void LoadColor();
+    void StoreColor();
+    void LoadDepth();
+    void StoreDepth();
+
 private:
     Memory::MemorySystem& memory;
     const Pica::FramebufferRegs& regs;
+    u32 width = 0;
+    u32 height = 0;
+    u32 num_pixels = 0;
+    RenderTarget color_target;
+    RenderTarget depth_target;
+    std::vector<Common::Vec4<u8>> color_pixels;
+    std::vector<u32> depth_pixels; ///< Depth in the low 24 bits, stencil in the high 8 bits
+    std::unordered_map<u32, u32> cached_pages;
 };
 
 u8 PerformStencilAction(Pica::FramebufferRegs::StencilAction action, u8 old_stencil, u8 ref);
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cmath>
 #include "video_core/renderer_software/sw_lighting.h"
 
 namespace SwRenderer {
@@ -10,21 +11,66 @@ namespace SwRenderer {
 using Pica::f16;
 using Pica::LightingRegs;
 
-static float LookupLightingLut(const Pica::State::Lighting& lighting, std::size_t lut_index,
-                               u8 index, float delta) {
-    ASSERT_MSG(lut_index < lighting.luts.size(), "Out of range lut");
-    ASSERT_MSG(index < lighting.luts[lut_index].size(), "Out of range index");
-
-    const auto& lut = lighting.luts[lut_index][index];
+void UpdateLightingLuts(LightingLuts& luts, const Pica::State::Lighting& lighting_state,
+                        u32 dirty_mask) {
+    for (std::size_t i = 0; i < luts.size(); ++i) {
+        if ((dirty_mask >> i) & 1) {
+            luts[i].Load(lighting_state.luts[i]);
+        }
+    }
+}
 
-    const float lut_value = lut.ToFloat();
-    const float lut_diff = lut.DiffToFloat();
+void LightSetup::Update(const Pica::LightingRegs& lighting) {
+    const auto is_supported = [&](LightingRegs::LightingSampler sampler) {
+        return LightingRegs::IsLightingSamplerSupported(lighting.config0.config, sampler);
+    };
+    d0_enable = lighting.config1.disable_lut_d0 == 0 &&
+                is_supported(LightingRegs::LightingSampler::Distribution0);
+    d1_enable = lighting.config1.disable_lut_d1 == 0 &&
+                is_supported(LightingRegs::LightingSampler::Distribution1);
+    rr_enable = lighting.config1.disable_lut_rr == 0 &&
+                is_supported(LightingRegs::LightingSampler::ReflectRed);
+    rg_enable = lighting.config1.disable_lut_rg == 0 &&
+                is_supported(LightingRegs::LightingSampler::ReflectGreen);
+    rb_enable = lighting.config1.disable_lut_rb == 0 &&
+                is_supported(LightingRegs::LightingSampler::ReflectBlue);
+    fr_enable = lighting.config1.disable_lut_fr == 0 &&
+                is_supported(LightingRegs::LightingSampler::Fresnel);
+    const bool spot_supported = is_supported(LightingRegs::LightingSampler::SpotlightAttenuation);
+
+    num_lights = lighting.max_light_index + 1;
+    for (u32 light_index = 0; light_index < num_lights; ++light_index) {
+        const u32 num = lighting.light_enable.GetNum(light_index);
+        const auto& light_config = lighting.light[num];
 
-    return lut_value + lut_diff * delta;
+        light_num[light_index] = num;
+        position_x[light_index] = f16::FromRaw(light_config.x).ToFloat32();
+        position_y[light_index] = f16::FromRaw(light_config.y).ToFloat32();
+        position_z[light_index] = f16::FromRaw(light_config.z).ToFloat32();
+        directional[light_index] = light_config.config.directional != 0;
+
+        const Common::Vec3<s32> spot_dir{light_config.spot_x.Value(), light_config.spot_y.Value(),
+                                         light_config.spot_z.Value()};
+        spot_direction[light_index] = spot_dir.Cast<float>() / 2047.0f;
+        specular_0[light_index] = light_config.specular_0.ToVec3f();
+        specular_1[light_index] = light_config.specular_1.ToVec3f();
+        diffuse[light_index] = light_config.diffuse.ToVec3f();
+        ambient[light_index] = light_config.ambient.ToVec3f();
+        dist_atten_scale[light_index] =
+            Pica::f20::FromRaw(light_config.dist_atten_scale).ToFloat32();
+        dist_atten_bias[light_index] = Pica::f20::FromRaw(light_config.dist_atten_bias).ToFloat32();
+
+        dist_atten_enable[light_index] = !lighting.IsDistAttenDisabled(num);
+        spot_atten_enable[light_index] = !lighting.IsSpotAttenDisabled(num) && spot_supported;
+        shadow_enable[light_index] = !lighting.IsShadowDisabled(num);
+        two_sided_diffuse[light_index] = light_config.config.two_sided_diffuse != 0;
+        geometric_factor_0[light_index] = light_config.config.geometric_factor_0 != 0;
+        geometric_factor_1[light_index] = light_config.config.geometric_factor_1 != 0;
+    }
 }
 
 std::pair<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
-    const Pica::LightingRegs& lighting, const Pica::State::Lighting& lighting_state,
+    const Pica::LightingRegs& lighting, const LightingLuts& luts, const LightSetup& lights,
     const Common::Quaternion<f32>& normquat, const Common::Vec3f& view,
     std::span<const Common::Vec4<u8>, 4> texture_color) {
 
@@ -71,41 +117,61 @@ std::pair<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
     Common::Vec4f diffuse_sum = {0.0f, 0.0f, 0.0f, 1.0f};
     Common::Vec4f specular_sum = {0.0f, 0.0f, 0.0f, 1.0f};
 
-    for (u32 light_index = 0; light_index <= lighting.max_light_index; ++light_index) {
-        u32 num = lighting.light_enable.GetNum(light_index);
-        const auto& light_config = lighting.light[num];
+    const Common::Vec3f norm_view = view.Normalized();
+
+    // Vectors of all lights, computed in fixed size loops that the compiler can vectorize. The
+    // slots past the enabled lights are computed too, but never read.
+    using PerLightFloat = LightSetup::PerLight<f32>;
+    PerLightFloat light_x, light_y, light_z, light_length;
+    PerLightFloat half_x, half_y, half_z, half_length2;
+    PerLightFloat light_dot_normal;
+    for (std::size_t i = 0; i < LightSetup::MaxLights; ++i) {
+        f32 x = lights.directional[i] ? lights.position_x[i] : lights.position_x[i] + view.x;
+        f32 y = lights.directional[i] ? lights.position_y[i] : lights.position_y[i] + view.y;
+        f32 z = lights.directional[i] ? lights.position_z[i] : lights.position_z[i] + view.z;
+        const f32 length = std::sqrt(x * x + y * y + z * z);
+        x /= length;
+        y /= length;
+        z /= length;
+        light_x[i] = x;
+        light_y[i] = y;
+        light_z[i] = z;
+        light_length[i] = length;
+        light_dot_normal[i] = x * normal.x + y * normal.y + z * normal.z;
+
+        const f32 hx = norm_view.x + x;
+        const f32 hy = norm_view.y + y;
+        const f32 hz = norm_view.z + z;
+        const f32 length2 = hx * hx + hy * hy + hz * hz;
+        const f32 half_length = std::sqrt(length2);
+        half_x[i] = hx / half_length;
+        half_y[i] = hy / half_length;
+        half_z[i] = hz / half_length;
+        half_length2[i] = length2;
+    }
 
-        const Common::Vec3f position = {f16::FromRaw(light_config.x).ToFloat32(),
-                                        f16::FromRaw(light_config.y).ToFloat32(),
-                                        f16::FromRaw(light_config.z).ToFloat32()};
+    for (u32 light_index = 0; light_index < lights.num_lights; ++light_index) {
+        const Common::Vec3f light_vector{light_x[light_index], light_y[light_index],
+                                         light_z[light_index]};
+        const Common::Vec3f norm_half_vector{half_x[light_index], half_y[light_index],
+                                             half_z[light_index]};
         Common::Vec3f refl_value{};
-        Common::Vec3f light_vector{};
-
-        if (light_config.config.directional) {
-            light_vector = position;
-        } else {
-            light_vector = position + view;
-        }
-
-        [[maybe_unused]] const f32 length = light_vector.Normalize();
-
-        Common::Vec3f norm_view = view.Normalized();
-        Common::Vec3f half_vector = norm_view + light_vector;
 
         f32 dist_atten = 1.0f;
-        if (!lighting.IsDistAttenDisabled(num)) {
-            const f32 scale = Pica::f20::FromRaw(light_config.dist_atten_scale).ToFloat32();
-            const f32 bias = Pica::f20::FromRaw(light_config.dist_atten_bias).ToFloat32();
+        if (lights.dist_atten_enable[light_index]) {
+            const f32 scale = lights.dist_atten_scale[light_index];
+            const f32 bias = lights.dist_atten_bias[light_index];
             const std::size_t lut =
-                static_cast<std::size_t>(LightingRegs::LightingSampler::DistanceAttenuation) + num;
+                static_cast<std::size_t>(LightingRegs::LightingSampler::DistanceAttenuation) +
+                lights.light_num[light_index];
 
-            const f32 sample_loc = std::clamp(scale * length + bias, 0.0f, 1.0f);
+            const f32 sample_loc = std::clamp(scale * light_length[light_index] + bias, 0.0f, 1.0f);
 
             const u8 lutindex =
                 static_cast<u8>(std::clamp(std::floor(sample_loc * 256.0f), 0.0f, 255.0f));
             const f32 delta = sample_loc * 256 - lutindex;
 
-            dist_atten = LookupLightingLut(lighting_state, lut, lutindex, delta);
+            dist_atten = luts[lut].Lookup(lutindex, delta);
         }
 
         auto get_lut_value = [&](LightingRegs::LightingLutInput input, bool abs,
@@ -115,26 +181,22 @@ std::pair<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
 
             switch (input) {
             case LightingRegs::LightingLutInput::NH:
-                result = Common::Dot(normal, half_vector.Normalized());
+                result = Common::Dot(normal, norm_half_vector);
                 break;
             case LightingRegs::LightingLutInput::VH:
-                result = Common::Dot(norm_view, half_vector.Normalized());
+                result = Common::Dot(norm_view, norm_half_vector);
                 break;
             case LightingRegs::LightingLutInput::NV:
                 result = Common::Dot(normal, norm_view);
                 break;
             case LightingRegs::LightingLutInput::LN:
-                result = Common::Dot(light_vector, normal);
+                result = light_dot_normal[light_index];
                 break;
-            case LightingRegs::LightingLutInput::SP: {
-                Common::Vec3<s32> spot_dir{light_config.spot_x.Value(), light_config.spot_y.Value(),
-                                           light_config.spot_z.Value()};
-                result = Common::Dot(light_vector, spot_dir.Cast<float>() / 2047.0f);
+            case LightingRegs::LightingLutInput::SP:
+                result = Common::Dot(light_vector, lights.spot_direction[light_index]);
                 break;
-            }
             case LightingRegs::LightingLutInput::CP:
                 if (lighting.config0.config == LightingRegs::LightingConfig::Config7) {
-                    const Common::Vec3f norm_half_vector = half_vector.Normalized();
                     const Common::Vec3f half_vector_proj =
                         norm_half_vector - normal * Common::Dot(normal, norm_half_vector);
                     result = Common::Dot(half_vector_proj, tangent);
@@ -152,7 +214,7 @@ std::pair<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
             f32 delta;
 
             if (abs) {
-                if (light_config.config.two_sided_diffuse) {
+                if (lights.two_sided_diffuse[light_index]) {
                     result = std::abs(result);
                 } else {
                     result = std::max(result, 0.0f);
@@ -169,16 +231,13 @@ std::pair<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
             }
 
             const f32 scale = lighting.lut_scale.GetScale(scale_enum);
-            return scale * LookupLightingLut(lighting_state, static_cast<std::size_t>(sampler),
-                                             index, delta);
+            return scale * luts[static_cast<std::size_t>(sampler)].Lookup(index, delta);
         };
 
         // If enabled, compute spot light attenuation value
         f32 spot_atten = 1.0f;
-        if (!lighting.IsSpotAttenDisabled(num) &&
-            LightingRegs::IsLightingSamplerSupported(
-                lighting.config0.config, LightingRegs::LightingSampler::SpotlightAttenuation)) {
-            auto lut = LightingRegs::SpotlightAttenuationSampler(num);
+        if (lights.spot_atten_enable[light_index]) {
+            auto lut = LightingRegs::SpotlightAttenuationSampler(lights.light_num[light_index]);
             spot_atten =
                 get_lut_value(lighting.lut_input.sp, lighting.abs_lut_input.disable_sp == 0,
                               lighting.lut_scale.sp, lut);
@@ -186,20 +245,16 @@ std::pair<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
 
         // Specular 0 component
         f32 d0_lut_value = 1.0f;
-        if (lighting.config1.disable_lut_d0 == 0 &&
-            LightingRegs::IsLightingSamplerSupported(
-                lighting.config0.config, LightingRegs::LightingSampler::Distribution0)) {
+        if (lights.d0_enable) {
             d0_lut_value =
                 get_lut_value(lighting.lut_input.d0, lighting.abs_lut_input.disable_d0 == 0,
                               lighting.lut_scale.d0, LightingRegs::LightingSampler::Distribution0);
         }
 
-        Common::Vec3f specular_0 = d0_lut_value * light_config.specular_0.ToVec3f();
+        Common::Vec3f specular_0 = d0_lut_value * lights.specular_0[light_index];
 
         // If enabled, lookup ReflectRed value, otherwise, 1.0 is used
-        if (lighting.config1.disable_lut_rr == 0 &&
-            LightingRegs::IsLightingSamplerSupported(lighting.config0.config,
-                                                     LightingRegs::LightingSampler::ReflectRed)) {
+        if (lights.rr_enable) {
             refl_value.x =
                 get_lut_value(lighting.lut_input.rr, lighting.abs_lut_input.disable_rr == 0,
                               lighting.lut_scale.rr, LightingRegs::LightingSampler::ReflectRed);
@@ -208,9 +263,7 @@ std::pair<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
         }
 
         // If enabled, lookup ReflectGreen value, otherwise, ReflectRed value is used
-        if (lighting.config1.disable_lut_rg == 0 &&
-            LightingRegs::IsLightingSamplerSupported(lighting.config0.config,
-                                                     LightingRegs::LightingSampler::ReflectGreen)) {
+        if (lights.rg_enable) {
             refl_value.y =
                 get_lut_value(lighting.lut_input.rg, lighting.abs_lut_input.disable_rg == 0,
                               lighting.lut_scale.rg, LightingRegs::LightingSampler::ReflectGreen);
@@ -219,9 +272,7 @@ std::pair<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
         }
 
         // If enabled, lookup ReflectBlue value, otherwise, ReflectRed value is used
-        if (lighting.config1.disable_lut_rb == 0 &&
-            LightingRegs::IsLightingSamplerSupported(lighting.config0.config,
-                                                     LightingRegs::LightingSampler::ReflectBlue)) {
+        if (lights.rb_enable) {
             refl_value.z =
                 get_lut_value(lighting.lut_input.rb, lighting.abs_lut_input.disable_rb == 0,
                               lighting.lut_scale.rb, LightingRegs::LightingSampler::ReflectBlue);
@@ -231,22 +282,17 @@ std::pair<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
 
         // Specular 1 component
         f32 d1_lut_value = 1.0f;
-        if (lighting.config1.disable_lut_d1 == 0 &&
-            LightingRegs::IsLightingSamplerSupported(
-                lighting.config0.config, LightingRegs::LightingSampler::Distribution1)) {
+        if (lights.d1_enable) {
             d1_lut_value =
                 get_lut_value(lighting.lut_input.d1, lighting.abs_lut_input.disable_d1 == 0,
                               lighting.lut_scale.d1, LightingRegs::LightingSampler::Distribution1);
         }
 
-        Common::Vec3f specular_1 = d1_lut_value * refl_value * light_config.specular_1.ToVec3f();
+        Common::Vec3f specular_1 = d1_lut_value * refl_value * lights.specular_1[light_index];
 
         // Fresnel
         // Note: only the last entry in the light slots applies the Fresnel factor
-        if (light_index == lighting.max_light_index && lighting.config1.disable_lut_fr == 0 &&
-            LightingRegs::IsLightingSamplerSupported(lighting.config0.config,
-                                                     LightingRegs::LightingSampler::Fresnel)) {
-
+        if (light_index == lighting.max_light_index && lights.fr_enable) {
             const f32 lut_value =
                 get_lut_value(lighting.lut_input.fr, lighting.abs_lut_input.disable_fr == 0,
                               lighting.lut_scale.fr, LightingRegs::LightingSampler::Fresnel);
@@ -262,8 +308,8 @@ std::pair<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
             }
         }
 
-        auto dot_product = Common::Dot(light_vector, normal);
-        if (light_config.config.two_sided_diffuse) {
+        auto dot_product = light_dot_normal[light_index];
+        if (lights.two_sided_diffuse[light_index]) {
             dot_product = std::abs(dot_product);
         } else {
             dot_product = std::max(dot_product, 0.0f);
@@ -274,23 +320,23 @@ std::pair<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
             clamp_highlights = dot_product == 0.0f ? 0.0f : 1.0f;
         }
 
-        if (light_config.config.geometric_factor_0 || light_config.config.geometric_factor_1) {
-            f32 geo_factor = half_vector.Length2();
+        if (lights.geometric_factor_0[light_index] || lights.geometric_factor_1[light_index]) {
+            f32 geo_factor = half_length2[light_index];
             geo_factor = geo_factor == 0.0f ? 0.0f : std::min(dot_product / geo_factor, 1.0f);
-            if (light_config.config.geometric_factor_0) {
+            if (lights.geometric_factor_0[light_index]) {
                 specular_0 *= geo_factor;
             }
-            if (light_config.config.geometric_factor_1) {
+            if (lights.geometric_factor_1[light_index]) {
                 specular_1 *= geo_factor;
             }
         }
 
         auto diffuse =
-            (light_config.diffuse.ToVec3f() * dot_product + light_config.ambient.ToVec3f()) *
+            (lights.diffuse[light_index] * dot_product + lights.ambient[light_index]) *
             dist_atten * spot_atten;
         auto specular = (specular_0 + specular_1) * clamp_highlights * dist_atten * spot_atten;
 
-        if (!lighting.IsShadowDisabled(num)) {
+        if (lights.shadow_enable[light_index]) {
             if (lighting.config0.shadow_primary) {
                 diffuse = diffuse * shadow.xyz();
             }
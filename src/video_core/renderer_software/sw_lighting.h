@@ -4,17 +4,69 @@
 
 #pragma once
 
+#include <array>
 #include <span>
 #include <utility>
 
 #include "common/quaternion.h"
 #include "common/vector_math.h"
 #include "video_core/pica_state.h"
+#include "video_core/renderer_software/sw_lut.h"
 
 namespace SwRenderer {
 
+/// Lighting LUTs converted to floats
+using LightingLuts = std::array<FloatLut<256>, 24>;
+
+/// Converts the lighting LUTs whose bit is set in dirty_mask
+void UpdateLightingLuts(LightingLuts& luts, const Pica::State::Lighting& lighting_state,
+                        u32 dirty_mask);
+
+/**
+ * Parameters of the enabled lights, decoded from the registers once per primitive. The vectors
+ * used for every light are stored by component, so the vector math of a fragment is done for all
+ * lights in one loop.
+ */
+struct LightSetup {
+    static constexpr std::size_t MaxLights = 8;
+
+    template <typename T>
+    using PerLight = std::array<T, MaxLights>;
+
+    void Update(const Pica::LightingRegs& lighting);
+
+    u32 num_lights = 0;
+    PerLight<float> position_x{};
+    PerLight<float> position_y{};
+    PerLight<float> position_z{};
+    PerLight<bool> directional{};
+
+    PerLight<u32> light_num{}; ///< Light source used by each slot
+    PerLight<Common::Vec3f> spot_direction{};
+    PerLight<Common::Vec3f> specular_0{};
+    PerLight<Common::Vec3f> specular_1{};
+    PerLight<Common::Vec3f> diffuse{};
+    PerLight<Common::Vec3f> ambient{};
+    PerLight<float> dist_atten_scale{};
+    PerLight<float> dist_atten_bias{};
+    PerLight<bool> dist_atten_enable{};
+    PerLight<bool> spot_atten_enable{};
+    PerLight<bool> shadow_enable{};
+    PerLight<bool> two_sided_diffuse{};
+    PerLight<bool> geometric_factor_0{};
+    PerLight<bool> geometric_factor_1{};
+
+    /// Whether each LUT is enabled and supported by the lighting configuration
+    bool d0_enable = false;
+    bool d1_enable = false;
+    bool rr_enable = false;
+    bool rg_enable = false;
+    bool rb_enable = false;
+    bool fr_enable = false;
+};
+
 std::pair<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
-    const Pica::LightingRegs& lighting, const Pica::State::Lighting& lighting_state,
+    const Pica::LightingRegs& lighting, const LightingLuts& luts, const LightSetup& lights,
     const Common::Quaternion<f32>& normquat, const Common::Vec3f& view,
     std::span<const Common::Vec4<u8>, 4> texture_color);
 
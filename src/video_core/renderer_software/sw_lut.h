@@ -0,0 +1,37 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace SwRenderer {
+
+/**
+ * PICA lookup table with its fixed point entries converted to floats, keeping the values and the
+ * differences between neighbouring entries in separate arrays. The conversion is done when the
+ * table is written instead of on every lookup.
+ */
+template <std::size_t Size>
+struct FloatLut {
+    std::array<float, Size> value{};
+    std::array<float, Size> diff{};
+
+    /// Converts a table whose entries provide ToFloat and DiffToFloat
+    template <typename Table>
+    void Load(const Table& table) {
+        for (std::size_t i = 0; i < Size; ++i) {
+            value[i] = table[i].ToFloat();
+            diff[i] = table[i].DiffToFloat();
+        }
+    }
+
+    /// Interpolates between the entry at index and the next one
+    float Lookup(std::size_t index, float delta) const {
+        return value[index] + diff[index] * delta;
+    }
+};
+
+} // namespace SwRenderer
@@ -15,29 +15,27 @@ using ProcTexCombiner = Pica::TexturingRegs::ProcTexCombiner;
 using ProcTexFilter = Pica::TexturingRegs::ProcTexFilter;
 using Pica::f16;
 
-float LookupLUT(const std::array<Pica::State::ProcTex::ValueEntry, 128>& lut, float coord) {
+float LookupLUT(const FloatLut<128>& lut, float coord) {
     // For NoiseLUT/ColorMap/AlphaMap, coord=0.0 is lut[0], coord=127.0/128.0 is lut[127] and
     // coord=1.0 is lut[127]+lut_diff[127]. For other indices, the result is interpolated using
     // value entries and difference entries.
     coord *= 128;
     const int index_int = std::min(static_cast<int>(coord), 127);
     const float frac = coord - index_int;
-    return lut[index_int].ToFloat() + frac * lut[index_int].DiffToFloat();
+    return lut.Lookup(index_int, frac);
 }
 
 // These function are used to generate random noise for procedural texture. Their results are
 // verified against real hardware, but it's not known if the algorithm is the same as hardware.
-unsigned int NoiseRand1D(unsigned int v) {
-    static constexpr std::array<unsigned int, 16> table{
+constexpr unsigned int NoiseRand1D(unsigned int v) {
+    constexpr std::array<unsigned int, 16> table{
         {0, 4, 10, 8, 4, 9, 7, 12, 5, 15, 13, 14, 11, 15, 2, 11}};
     return ((v % 9 + 2) * 3 & 0xF) ^ table[(v / 9) & 0xF];
 }
 
-float NoiseRand2D(unsigned int x, unsigned int y) {
-    static constexpr std::array<unsigned int, 16> table{
+constexpr float NoiseRand2D(unsigned int u2, unsigned int v2) {
+    constexpr std::array<unsigned int, 16> table{
         {10, 2, 15, 8, 0, 7, 4, 5, 5, 13, 2, 6, 13, 9, 3, 14}};
-    unsigned int u2 = NoiseRand1D(x);
-    unsigned int v2 = NoiseRand1D(y);
     v2 += ((u2 & 3) == 1) ? 4 : 0;
     v2 ^= (u2 & 1) * 6;
     v2 += 10 + u2;
@@ -46,8 +44,33 @@ float NoiseRand2D(unsigned int x, unsigned int y) {
     return -1.0f + v2 * 2.0f / 15.0f;
 }
 
-float NoiseCoef(float u, float v, const Pica::TexturingRegs& regs,
-                const Pica::State::ProcTex& state) {
+// NoiseRand1D repeats every 144 values and returns 4 bits, so the noise of any coordinates can be
+// looked up in two small tables.
+constexpr std::size_t NoisePeriod = 144;
+
+constexpr auto NoiseRand1DTable = [] {
+    std::array<u8, NoisePeriod> table{};
+    for (unsigned int v = 0; v < NoisePeriod; ++v) {
+        table[v] = static_cast<u8>(NoiseRand1D(v));
+    }
+    return table;
+}();
+
+constexpr auto NoiseRand2DTable = [] {
+    std::array<std::array<float, 16>, 16> table{};
+    for (unsigned int u2 = 0; u2 < 16; ++u2) {
+        for (unsigned int v2 = 0; v2 < 16; ++v2) {
+            table[u2][v2] = NoiseRand2D(u2, v2);
+        }
+    }
+    return table;
+}();
+
+float LookupNoise(unsigned int x, unsigned int y) {
+    return NoiseRand2DTable[NoiseRand1DTable[x % NoisePeriod]][NoiseRand1DTable[y % NoisePeriod]];
+}
+
+float NoiseCoef(float u, float v, const Pica::TexturingRegs& regs, const ProcTexLuts& luts) {
     const float freq_u = f16::FromRaw(regs.proctex_noise_frequency.u).ToFloat32();
     const float freq_v = f16::FromRaw(regs.proctex_noise_frequency.v).ToFloat32();
     const float phase_u = f16::FromRaw(regs.proctex_noise_u.phase).ToFloat32();
@@ -59,12 +82,12 @@ float NoiseCoef(float u, float v, const Pica::TexturingRegs& regs,
     const float x_frac = x - x_int;
     const float y_frac = y - y_int;
 
-    const float g0 = NoiseRand2D(x_int, y_int) * (x_frac + y_frac);
-    const float g1 = NoiseRand2D(x_int + 1, y_int) * (x_frac + y_frac - 1);
-    const float g2 = NoiseRand2D(x_int, y_int + 1) * (x_frac + y_frac - 1);
-    const float g3 = NoiseRand2D(x_int + 1, y_int + 1) * (x_frac + y_frac - 2);
-    const float x_noise = LookupLUT(state.noise_table, x_frac);
-    const float y_noise = LookupLUT(state.noise_table, y_frac);
+    const float g0 = LookupNoise(x_int, y_int) * (x_frac + y_frac);
+    const float g1 = LookupNoise(x_int + 1, y_int) * (x_frac + y_frac - 1);
+    const float g2 = LookupNoise(x_int, y_int + 1) * (x_frac + y_frac - 1);
+    const float g3 = LookupNoise(x_int + 1, y_int + 1) * (x_frac + y_frac - 2);
+    const float x_noise = LookupLUT(luts.noise, x_frac);
+    const float y_noise = LookupLUT(luts.noise, y_frac);
     return Common::BilinearInterp(g0, g1, g2, g3, x_noise, y_noise);
 }
 
@@ -114,8 +137,7 @@ void ClampCoord(float& coord, ProcTexClamp mode) {
     }
 }
 
-float CombineAndMap(float u, float v, ProcTexCombiner combiner,
-                    const std::array<Pica::State::ProcTex::ValueEntry, 128>& map_table) {
+float CombineAndMap(float u, float v, ProcTexCombiner combiner, const FloatLut<128>& map_table) {
     float f;
     switch (combiner) {
     case ProcTexCombiner::U:
@@ -157,8 +179,34 @@ float CombineAndMap(float u, float v, ProcTexCombiner combiner,
 }
 } // Anonymous namespace
 
+void ProcTexLuts::Update(const Pica::State::ProcTex& state, u32 dirty_mask) {
+    using Pica::TexturingRegs;
+    const auto is_dirty = [dirty_mask](TexturingRegs::ProcTexLutTable table) {
+        return ((dirty_mask >> static_cast<u32>(table)) & 1) != 0;
+    };
+    if (is_dirty(TexturingRegs::ProcTexLutTable::Noise)) {
+        noise.Load(state.noise_table);
+    }
+    if (is_dirty(TexturingRegs::ProcTexLutTable::ColorMap)) {
+        color_map.Load(state.color_map_table);
+    }
+    if (is_dirty(TexturingRegs::ProcTexLutTable::AlphaMap)) {
+        alpha_map.Load(state.alpha_map_table);
+    }
+    if (is_dirty(TexturingRegs::ProcTexLutTable::Color)) {
+        for (std::size_t i = 0; i < color.size(); ++i) {
+            color[i] = state.color_table[i].ToVector().Cast<float>();
+        }
+    }
+    if (is_dirty(TexturingRegs::ProcTexLutTable::ColorDiff)) {
+        for (std::size_t i = 0; i < color_diff.size(); ++i) {
+            color_diff[i] = state.color_diff_table[i].ToVector().Cast<float>();
+        }
+    }
+}
+
 Common::Vec4<u8> ProcTex(float u, float v, const Pica::TexturingRegs& regs,
-                         const Pica::State::ProcTex& state) {
+                         const ProcTexLuts& luts) {
     u = std::abs(u);
     v = std::abs(v);
 
@@ -168,7 +216,7 @@ Common::Vec4<u8> ProcTex(float u, float v, const Pica::TexturingRegs& regs,
 
     // Generate noise
     if (regs.proctex.noise_enable) {
-        float noise = NoiseCoef(u, v, regs, state);
+        float noise = NoiseCoef(u, v, regs, luts);
         u += noise * regs.proctex_noise_u.amplitude / 4095.0f;
         v += noise * regs.proctex_noise_v.amplitude / 4095.0f;
         u = std::abs(u);
@@ -184,7 +232,7 @@ Common::Vec4<u8> ProcTex(float u, float v, const Pica::TexturingRegs& regs,
     ClampCoord(v, regs.proctex.v_clamp);
 
     // Combine and map
-    const float lut_coord = CombineAndMap(u, v, regs.proctex.color_combiner, state.color_map_table);
+    const float lut_coord = CombineAndMap(u, v, regs.proctex.color_combiner, luts.color_map);
 
     // Look up the color
     // For the color lut, coord=0.0 is lut[offset] and coord=1.0 is lut[offset+width-1]
@@ -199,15 +247,13 @@ Common::Vec4<u8> ProcTex(float u, float v, const Pica::TexturingRegs& regs,
     case ProcTexFilter::LinearMipmapNearest: {
         const int index_int = static_cast<int>(index);
         const float frac = index - index_int;
-        const auto color_value = state.color_table[index_int].ToVector().Cast<float>();
-        const auto color_diff = state.color_diff_table[index_int].ToVector().Cast<float>();
-        final_color = (color_value + frac * color_diff).Cast<u8>();
+        final_color = (luts.color[index_int] + frac * luts.color_diff[index_int]).Cast<u8>();
         break;
     }
     case ProcTexFilter::Nearest:
     case ProcTexFilter::NearestMipmapLinear:
     case ProcTexFilter::NearestMipmapNearest:
-        final_color = state.color_table[static_cast<int>(std::round(index))].ToVector();
+        final_color = luts.color[static_cast<int>(std::round(index))].Cast<u8>();
         break;
     }
 
@@ -215,7 +261,7 @@ Common::Vec4<u8> ProcTex(float u, float v, const Pica::TexturingRegs& regs,
         // Note: in separate alpha mode, the alpha channel skips the color LUT look up stage. It
         // uses the output of CombineAndMap directly instead.
         const float final_alpha =
-            CombineAndMap(u, v, regs.proctex.alpha_combiner, state.alpha_map_table);
+            CombineAndMap(u, v, regs.proctex.alpha_combiner, luts.alpha_map);
         return Common::MakeVec<u8>(final_color.rgb(), static_cast<u8>(final_alpha * 255));
     } else {
         return final_color;
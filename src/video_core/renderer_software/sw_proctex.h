@@ -4,14 +4,28 @@
 
 #pragma once
 
+#include <array>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/pica_state.h"
+#include "video_core/renderer_software/sw_lut.h"
 
 namespace SwRenderer {
 
+/// Procedural texture LUTs converted to floats
+struct ProcTexLuts {
+    /// Converts the tables whose bit, indexed by TexturingRegs::ProcTexLutTable, is set
+    void Update(const Pica::State::ProcTex& state, u32 dirty_mask);
+
+    FloatLut<128> noise;
+    FloatLut<128> color_map;
+    FloatLut<128> alpha_map;
+    std::array<Common::Vec4f, 256> color{};
+    std::array<Common::Vec4f, 256> color_diff{};
+};
+
 /// Generates procedural texture color for the given coordinates
 Common::Vec4<u8> ProcTex(float u, float v, const Pica::TexturingRegs& regs,
-                         const Pica::State::ProcTex& state);
+                         const ProcTexLuts& luts);
 
 } // namespace SwRenderer
@@ -2,6 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <utility>
 #include <boost/container/static_vector.hpp>
 #include "common/logging/log.h"
 #include "common/microprofile.h"
@@ -10,6 +14,7 @@
 #include "core/memory.h"
 #include "video_core/pica_state.h"
 #include "video_core/pica_types.h"
+#include "video_core/pica_types_simd.h"
 #include "video_core/renderer_software/sw_framebuffer.h"
 #include "video_core/renderer_software/sw_lighting.h"
 #include "video_core/renderer_software/sw_proctex.h"
@@ -21,10 +26,10 @@
 namespace SwRenderer {
 
 using Pica::f24;
+using Pica::F24x4;
 using Pica::FramebufferRegs;
 using Pica::RasterizerRegs;
 using Pica::TexturingRegs;
-using Pica::Texture::LookupTexture;
 using Pica::Texture::TextureInfo;
 
 struct Vertex : Pica::Shader::OutputVertex {
@@ -36,17 +41,24 @@ struct Vertex : Pica::Shader::OutputVertex {
     /**
      * Linear interpolation
      * factor: 0=this, 1=vtx
+     * lanes: Components to interpolate in each of the six attribute vectors, see AttributeLanes
      * Note: This function cannot be called after perspective divide.
      **/
-    void Lerp(f24 factor, const Vertex& vtx) {
-        pos = pos * factor + vtx.pos * (f24::One() - factor);
-        quat = quat * factor + vtx.quat * (f24::One() - factor);
-        color = color * factor + vtx.color * (f24::One() - factor);
-        tc0 = tc0 * factor + vtx.tc0 * (f24::One() - factor);
-        tc1 = tc1 * factor + vtx.tc1 * (f24::One() - factor);
-        tc0_w = tc0_w * factor + vtx.tc0_w * (f24::One() - factor);
-        view = view * factor + vtx.view * (f24::One() - factor);
-        tc2 = tc2 * factor + vtx.tc2 * (f24::One() - factor);
+    void Lerp(f24 factor, const Vertex& vtx, const AttributeLanes& lanes) {
+        // The attributes from pos to tc2 are laid out as six vectors of four values
+        static_assert(offsetof(OutputVertex, tc2) + sizeof(tc2) == 24 * sizeof(f24));
+
+        const auto this_factor = F24x4::Broadcast(factor);
+        const auto vtx_factor = F24x4::Broadcast(f24::One() - factor);
+        f24* const dest = &pos.x;
+        const f24* const src = &vtx.pos.x;
+        for (std::size_t i = 0; i < lanes.size(); ++i) {
+            if (lanes[i] == 0) {
+                continue;
+            }
+            (F24x4::Load(dest + i * 4) * this_factor + F24x4::Load(src + i * 4) * vtx_factor)
+                .StoreMasked(dest + i * 4, lanes[i]);
+        }
     }
 
     /**
@@ -54,9 +66,10 @@ struct Vertex : Pica::Shader::OutputVertex {
      * factor: 0=v0, 1=v1
      * Note: This function cannot be called after perspective divide.
      **/
-    static Vertex Lerp(f24 factor, const Vertex& v0, const Vertex& v1) {
+    static Vertex Lerp(f24 factor, const Vertex& v0, const Vertex& v1,
+                       const AttributeLanes& lanes) {
         Vertex ret = v0;
-        ret.Lerp(factor, v1);
+        ret.Lerp(factor, v1, lanes);
         return ret;
     }
 };
@@ -65,6 +78,37 @@ namespace {
 
 MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 240));
 
+/**
+ * Screen coordinates up to which triangles are rasterized without clipping them against the x and
+ * y planes. Keeps the 12.4 fixed point coordinates and the products of the edge functions in range.
+ */
+constexpr f24 GuardBandSize = f24::FromFloat32(1024.0f);
+
+/// Parts of the fragment pipeline that the rasterization routines are specialized on
+namespace FragmentFeature {
+enum : u32 {
+    Lighting = 1 << 0,
+    AlphaTest = 1 << 1,
+    DepthStencil = 1 << 2,
+    ShadowOutput = 1 << 3,
+    ColorWrite = 1 << 4,
+    ColorMerge = 1 << 5, ///< The written color depends on the current framebuffer color
+    NumCombinations = 1 << 6,
+};
+} // namespace FragmentFeature
+
+/// Detects if a TEV stage leaves the output of the previous stage unchanged
+bool IsPassThroughTevStage(const TexturingRegs::TevStageConfig& stage) {
+    using TevStageConfig = TexturingRegs::TevStageConfig;
+    return (stage.color_op == TevStageConfig::Operation::Replace &&
+            stage.alpha_op == TevStageConfig::Operation::Replace &&
+            stage.color_source1 == TevStageConfig::Source::Previous &&
+            stage.alpha_source1 == TevStageConfig::Source::Previous &&
+            stage.color_modifier1 == TevStageConfig::ColorModifier::SourceColor &&
+            stage.alpha_modifier1 == TevStageConfig::AlphaModifier::SourceAlpha &&
+            stage.GetColorMultiplier() == 1 && stage.GetAlphaMultiplier() == 1);
+}
+
 struct ClippingEdge {
 public:
     constexpr ClippingEdge(Common::Vec4<f24> coeffs,
@@ -73,21 +117,29 @@ public:
         : pos(f24::Zero()), coeffs(coeffs), bias(bias) {}
 
     bool IsInside(const Vertex& vertex) const {
-        return Common::Dot(vertex.pos + bias, coeffs) >= f24::Zero();
+        return Distance(vertex) >= f24::Zero();
     }
 
     bool IsOutSide(const Vertex& vertex) const {
         return !IsInside(vertex);
     }
 
-    Vertex GetIntersection(const Vertex& v0, const Vertex& v1) const {
-        const f24 dp = Common::Dot(v0.pos + bias, coeffs);
-        const f24 dp_prev = Common::Dot(v1.pos + bias, coeffs);
+    Vertex GetIntersection(const Vertex& v0, const Vertex& v1, const AttributeLanes& lanes) const {
+        const f24 dp = Distance(v0);
+        const f24 dp_prev = Distance(v1);
         const f24 factor = dp_prev / (dp_prev - dp);
-        return Vertex::Lerp(factor, v0, v1);
+        return Vertex::Lerp(factor, v0, v1, lanes);
     }
 
 private:
+    /// Equivalent to Common::Dot(vertex.pos + bias, coeffs)
+    f24 Distance(const Vertex& vertex) const {
+        const auto products =
+            ((F24x4::Load(&vertex.pos.x) + F24x4::Load(&bias.x)) * F24x4::Load(&coeffs.x))
+                .ToArray();
+        return products[0] + products[1] + products[2] + products[3];
+    }
+
     [[maybe_unused]] f24 pos;
     Common::Vec4<f24> coeffs;
     Common::Vec4<f24> bias;
@@ -96,7 +148,57 @@ private:
 } // Anonymous namespace
 
 RasterizerSoftware::RasterizerSoftware(Memory::MemorySystem& memory_)
-    : memory{memory_}, state{Pica::g_state}, regs{state.regs}, fb{memory, regs.framebuffer} {}
+    : memory{memory_}, state{Pica::g_state}, regs{state.regs}, fb{memory, regs.framebuffer},
+      texture_cache{memory, fb} {
+    SyncEntireState();
+}
+
+void RasterizerSoftware::DrawTriangles() {
+    texture_cache.EndDraw();
+}
+
+void RasterizerSoftware::FlushAll() {
+    fb.FlushAll();
+}
+
+void RasterizerSoftware::FlushRegion(PAddr addr, u32 size) {
+    fb.FlushRegion(addr, size);
+}
+
+void RasterizerSoftware::InvalidateRegion(PAddr addr, u32 size) {
+    fb.InvalidateRegion(addr, size);
+}
+
+void RasterizerSoftware::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    // Invalidation writes back the parts of the render targets outside the region
+    fb.InvalidateRegion(addr, size);
+}
+
+void RasterizerSoftware::ClearAll(bool flush) {
+    fb.Clear(flush);
+    texture_cache.Clear();
+}
+
+void RasterizerSoftware::SyncEntireState() {
+    // The LUTs may have been replaced without going through the command processor
+    state.lighting.luts_dirty = ~0u;
+    state.proctex.tables_dirty = ~0u;
+    state.fog.lut_dirty = true;
+}
+
+void RasterizerSoftware::SyncLuts() {
+    if (state.lighting.luts_dirty != 0) {
+        UpdateLightingLuts(lighting_luts, state.lighting,
+                           std::exchange(state.lighting.luts_dirty, 0));
+    }
+    if (state.proctex.tables_dirty != 0) {
+        proctex_luts.Update(state.proctex, std::exchange(state.proctex.tables_dirty, 0));
+    }
+    if (state.fog.lut_dirty) {
+        fog_lut.Load(state.fog.lut);
+        state.fog.lut_dirty = false;
+    }
+}
 
 void RasterizerSoftware::AddTriangle(const Pica::Shader::OutputVertex& v0,
                                      const Pica::Shader::OutputVertex& v1,
@@ -104,16 +206,20 @@ void RasterizerSoftware::AddTriangle(const Pica::Shader::OutputVertex& v0,
     /**
      * Clipping a planar n-gon against a plane will remove at least 1 vertex and introduces 2 at
      * the new edge (or less in degenerate cases). As such, we can say that each clipping plane
-     * introduces at most 1 new vertex to the polygon. Since we start with a triangle and have a
-     * fixed 6 clipping planes, the maximum number of vertices of the clipped polygon is 3 + 6 = 9.
+     * introduces at most 1 new vertex to the polygon. Since we start with a triangle and have
+     * 7 fixed clipping planes and the custom one, the clipped polygon has at most 3 + 8 = 11
+     * vertices. The intersections are kept in a pool that the polygons refer to by index, each
+     * plane adds at most 2 of them.
      **/
-    static constexpr std::size_t MAX_VERTICES = 9;
+    static constexpr std::size_t MAX_VERTICES = 11;
+    static constexpr std::size_t MAX_POOL_VERTICES = 3 + 2 * 8;
 
-    boost::container::static_vector<Vertex, MAX_VERTICES> buffer_a = {v0, v1, v2};
-    boost::container::static_vector<Vertex, MAX_VERTICES> buffer_b;
+    boost::container::static_vector<Vertex, MAX_POOL_VERTICES> pool = {v0, v1, v2};
+    boost::container::static_vector<u8, MAX_VERTICES> buffer_a = {0, 1, 2};
+    boost::container::static_vector<u8, MAX_VERTICES> buffer_b;
 
-    FlipQuaternionIfOpposite(buffer_a[1].quat, buffer_a[0].quat);
-    FlipQuaternionIfOpposite(buffer_a[2].quat, buffer_a[0].quat);
+    FlipQuaternionIfOpposite(pool[1].quat, pool[0].quat);
+    FlipQuaternionIfOpposite(pool[2].quat, pool[0].quat);
 
     auto* output_list = &buffer_a;
     auto* input_list = &buffer_b;
@@ -133,50 +239,108 @@ void RasterizerSoftware::AddTriangle(const Pica::Shader::OutputVertex& v0,
         {Common::MakeVec(f0, f0, f1, f1)},                                         // z = -w
         {Common::MakeVec(f0, f0, f0, f1), Common::Vec4<f24>(f0, f0, f0, EPSILON)}, // w = EPSILON
     }};
+    static constexpr u32 XY_PLANES = 0xF;
+    static constexpr u32 W_PLANE = 1 << 6;
+    static constexpr u32 CUSTOM_PLANE = 1 << 7;
+
+    const bool custom_clip = state.regs.rasterizer.clip_enable != 0;
+    const ClippingEdge custom_edge{state.regs.rasterizer.GetClipCoef()};
+
+    // Outcodes with one bit per plane a vertex is outside of
+    u32 outside_any = 0;
+    u32 outside_all = ~0u;
+    for (const Vertex& vertex : pool) {
+        u32 outcode = 0;
+        for (std::size_t i = 0; i < clipping_edges.size(); ++i) {
+            if (clipping_edges[i].IsOutSide(vertex)) {
+                outcode |= 1u << i;
+            }
+        }
+        if (custom_clip && custom_edge.IsOutSide(vertex)) {
+            outcode |= CUSTOM_PLANE;
+        }
+        outside_any |= outcode;
+        outside_all &= outcode;
+    }
+
+    // All vertices are outside of the same plane, so nothing of the triangle is visible
+    if (outside_all != 0) {
+        return;
+    }
+
+    const ProcessTriangleFunc process_triangle = SetupFragmentPipeline();
+    const auto& config = fragment_config;
+
+    // Triangles crossing the x and y planes don't need clipping as long as their screen
+    // coordinates fit the rasterizer, the rasterization loop is limited to the viewport. This
+    // needs all vertices in front of the w=epsilon plane. The depth planes cut the triangle along
+    // its edges, which never moves a projected vertex out of the guard band.
+    u32 clip_planes = outside_any;
+    if ((outside_any & XY_PLANES) != 0 && (outside_any & W_PLANE) == 0) {
+        const auto in_guard_band = [&viewport = config.viewport](const Vertex& vertex) {
+            const f24 inv_w = f24::One() / vertex.pos.w;
+            const f24 x =
+                (vertex.pos.x * inv_w + f24::One()) * viewport.halfsize_x + viewport.offset_x;
+            const f24 y =
+                (vertex.pos.y * inv_w + f24::One()) * viewport.halfsize_y + viewport.offset_y;
+            return x >= f24::Zero() && x <= GuardBandSize && y >= f24::Zero() &&
+                   y <= GuardBandSize;
+        };
+        if (std::all_of(pool.begin(), pool.end(), in_guard_band)) {
+            clip_planes &= ~XY_PLANES;
+        }
+    }
 
     // Simple implementation of the Sutherland-Hodgman clipping algorithm.
-    // TODO: Make this less inefficient (currently lots of useless buffering overhead happens here)
     const auto clip = [&](const ClippingEdge& edge) {
         std::swap(input_list, output_list);
         output_list->clear();
 
-        const Vertex* reference_vertex = &input_list->back();
-        for (const auto& vertex : *input_list) {
+        u8 reference = input_list->back();
+        for (const u8 index : *input_list) {
+            const Vertex& vertex = pool[index];
+            const Vertex& reference_vertex = pool[reference];
             // NOTE: This algorithm changes vertex order in some cases!
             if (edge.IsInside(vertex)) {
-                if (edge.IsOutSide(*reference_vertex)) {
-                    output_list->push_back(edge.GetIntersection(vertex, *reference_vertex));
+                if (edge.IsOutSide(reference_vertex)) {
+                    output_list->push_back(static_cast<u8>(pool.size()));
+                    pool.push_back(
+                        edge.GetIntersection(vertex, reference_vertex, config.lerp_lanes));
                 }
-                output_list->push_back(vertex);
-            } else if (edge.IsInside(*reference_vertex)) {
-                output_list->push_back(edge.GetIntersection(vertex, *reference_vertex));
+                output_list->push_back(index);
+            } else if (edge.IsInside(reference_vertex)) {
+                output_list->push_back(static_cast<u8>(pool.size()));
+                pool.push_back(edge.GetIntersection(vertex, reference_vertex, config.lerp_lanes));
             }
-            reference_vertex = &vertex;
+            reference = index;
         }
     };
 
-    for (const ClippingEdge& edge : clipping_edges) {
-        clip(edge);
+    for (std::size_t i = 0; i < clipping_edges.size(); ++i) {
+        if ((clip_planes & (1u << i)) == 0) {
+            continue;
+        }
+        clip(clipping_edges[i]);
         if (output_list->size() < 3) {
             return;
         }
     }
 
-    if (state.regs.rasterizer.clip_enable) {
-        const ClippingEdge custom_edge{state.regs.rasterizer.GetClipCoef()};
+    if ((clip_planes & CUSTOM_PLANE) != 0) {
         clip(custom_edge);
         if (output_list->size() < 3) {
             return;
         }
     }
 
-    MakeScreenCoords((*output_list)[0]);
-    MakeScreenCoords((*output_list)[1]);
+    const auto& polygon = *output_list;
+    MakeScreenCoords(pool[polygon[0]]);
+    MakeScreenCoords(pool[polygon[1]]);
 
-    for (std::size_t i = 0; i < output_list->size() - 2; i++) {
-        Vertex& vtx0 = (*output_list)[0];
-        Vertex& vtx1 = (*output_list)[i + 1];
-        Vertex& vtx2 = (*output_list)[i + 2];
+    for (std::size_t i = 0; i < polygon.size() - 2; i++) {
+        Vertex& vtx0 = pool[polygon[0]];
+        Vertex& vtx1 = pool[polygon[i + 1]];
+        Vertex& vtx2 = pool[polygon[i + 2]];
 
         MakeScreenCoords(vtx2);
 
@@ -185,7 +349,7 @@ void RasterizerSoftware::AddTriangle(const Pica::Shader::OutputVertex& v0,
             "Triangle {}/{} at position ({:.3}, {:.3}, {:.3}, {:.3f}), "
             "({:.3}, {:.3}, {:.3}, {:.3}), ({:.3}, {:.3}, {:.3}, {:.3}) and "
             "screen position ({:.2}, {:.2}, {:.2}), ({:.2}, {:.2}, {:.2}), ({:.2}, {:.2}, {:.2})",
-            i + 1, output_list->size() - 2, vtx0.pos.x.ToFloat32(), vtx0.pos.y.ToFloat32(),
+            i + 1, polygon.size() - 2, vtx0.pos.x.ToFloat32(), vtx0.pos.y.ToFloat32(),
             vtx0.pos.z.ToFloat32(), vtx0.pos.w.ToFloat32(), vtx1.pos.x.ToFloat32(),
             vtx1.pos.y.ToFloat32(), vtx1.pos.z.ToFloat32(), vtx1.pos.w.ToFloat32(),
             vtx2.pos.x.ToFloat32(), vtx2.pos.y.ToFloat32(), vtx2.pos.z.ToFloat32(),
@@ -195,17 +359,128 @@ void RasterizerSoftware::AddTriangle(const Pica::Shader::OutputVertex& v0,
             vtx2.screenpos.x.ToFloat32(), vtx2.screenpos.y.ToFloat32(),
             vtx2.screenpos.z.ToFloat32());
 
-        ProcessTriangle(vtx0, vtx1, vtx2);
+        (this->*process_triangle)(vtx0, vtx1, vtx2, false);
     }
 }
 
-void RasterizerSoftware::MakeScreenCoords(Vertex& vtx) {
-    Viewport viewport{};
+RasterizerSoftware::ProcessTriangleFunc RasterizerSoftware::SetupFragmentPipeline() {
+    auto& config = fragment_config;
+    fb.Bind();
+    SyncLuts();
+
+    const auto tev_stages = regs.texturing.GetTevStages();
+    const auto& buffer_input = regs.texturing.tev_combiner_buffer_input;
+    for (u32 i = 0; i < tev_stages.size(); ++i) {
+        const auto& tev_stage = tev_stages[i];
+        auto& stage = config.tev_stages[i];
+        stage.config = tev_stage;
+        stage.const_color = Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
+                                            tev_stage.const_b.Value(), tev_stage.const_a.Value())
+                                .Cast<u8>();
+        stage.color_multiplier = tev_stage.GetColorMultiplier();
+        stage.alpha_multiplier = tev_stage.GetAlphaMultiplier();
+        stage.updates_buffer_color = buffer_input.TevStageUpdatesCombinerBufferColor(i);
+        stage.updates_buffer_alpha = buffer_input.TevStageUpdatesCombinerBufferAlpha(i);
+        stage.pass_through = IsPassThroughTevStage(tev_stage);
+    }
+    config.tev_buffer_color = Common::MakeVec(regs.texturing.tev_combiner_buffer_color.r.Value(),
+                                              regs.texturing.tev_combiner_buffer_color.g.Value(),
+                                              regs.texturing.tev_combiner_buffer_color.b.Value(),
+                                              regs.texturing.tev_combiner_buffer_color.a.Value())
+                                  .Cast<u8>();
+
+    const auto& output_merger = regs.framebuffer.output_merger;
+    config.blend_const =
+        Common::MakeVec(output_merger.blend_const.r.Value(), output_merger.blend_const.g.Value(),
+                        output_merger.blend_const.b.Value(), output_merger.blend_const.a.Value())
+            .Cast<u8>();
+
+    config.depth_scale = f24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
+    config.depth_offset = f24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
+    config.w_buffering =
+        regs.rasterizer.depthmap_enable == RasterizerRegs::DepthBuffering::WBuffering;
+    config.scissor_exclude =
+        regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude;
+    config.fog = regs.texturing.fog_mode == TexturingRegs::FogMode::Fog;
+
+    auto& viewport = config.viewport;
     viewport.halfsize_x = f24::FromRaw(regs.rasterizer.viewport_size_x);
     viewport.halfsize_y = f24::FromRaw(regs.rasterizer.viewport_size_y);
     viewport.offset_x = f24::FromFloat32(static_cast<f32>(regs.rasterizer.viewport_corner.x));
     viewport.offset_y = f24::FromFloat32(static_cast<f32>(regs.rasterizer.viewport_corner.y));
 
+    // Triangles within the guard band are not clipped to the viewport, limit the bounding box
+    const auto to_rasterizer_coord = [](f24 value) {
+        static constexpr f24 max_coord = f24::FromFloat32(4095.0f);
+        return Fix12P4::FromFloat24(std::clamp(value, f24::Zero(), max_coord));
+    };
+    config.viewport_x1 = to_rasterizer_coord(viewport.offset_x);
+    config.viewport_y1 = to_rasterizer_coord(viewport.offset_y);
+    const f24 two = f24::FromFloat32(2.0f);
+    config.viewport_x2 = to_rasterizer_coord(viewport.halfsize_x * two + viewport.offset_x);
+    config.viewport_y2 = to_rasterizer_coord(viewport.halfsize_y * two + viewport.offset_y);
+
+    // Only the attributes read by the enabled stages are interpolated when clipping
+    const auto& main_config = regs.texturing.main_config;
+    const bool lighting = !regs.lighting.disable;
+    const bool texturing = main_config.texture0_enable || main_config.texture1_enable ||
+                           main_config.texture2_enable || main_config.texture3_enable;
+    config.lerp_lanes = {
+        0xF,                                                 // pos
+        lighting ? 0xFu : 0u,                                // quat
+        0xF,                                                 // color
+        texturing ? 0xFu : 0u,                               // tc0, tc1
+        (texturing ? 0x1u : 0u) | (lighting ? 0xCu : 0u),    // tc0_w, pad, view.xy
+        (lighting ? 0x1u : 0u) | (texturing ? 0xCu : 0u),    // view.z, pad, tc2
+    };
+
+    u32 features = 0;
+    if (lighting) {
+        features |= FragmentFeature::Lighting;
+        light_setup.Update(regs.lighting);
+    }
+    if (output_merger.fragment_operation_mode == FramebufferRegs::FragmentOperationMode::Shadow) {
+        // The shadow output skips the rest of the output merger
+        features |= FragmentFeature::ShadowOutput;
+    } else {
+        const auto& framebuffer = regs.framebuffer.framebuffer;
+        if (output_merger.alpha_test.enable) {
+            features |= FragmentFeature::AlphaTest;
+        }
+
+        // Without any of these, DoDepthStencilTest always passes without side effects
+        const bool stencil_action_enable =
+            output_merger.stencil_test.enable &&
+            framebuffer.depth_format == FramebufferRegs::DepthFormat::D24S8;
+        const bool depth_write_enable =
+            framebuffer.allow_depth_stencil_write != 0 && output_merger.depth_write_enable;
+        if (stencil_action_enable || output_merger.depth_test_enable || depth_write_enable) {
+            features |= FragmentFeature::DepthStencil;
+        }
+
+        if (framebuffer.allow_color_write != 0) {
+            features |= FragmentFeature::ColorWrite;
+            const bool color_copy = !output_merger.alphablend_enable &&
+                                    output_merger.logic_op == FramebufferRegs::LogicOp::Copy &&
+                                    output_merger.red_enable && output_merger.green_enable &&
+                                    output_merger.blue_enable && output_merger.alpha_enable;
+            if (!color_copy) {
+                features |= FragmentFeature::ColorMerge;
+            }
+        }
+    }
+
+    static constexpr auto routines = []<std::size_t... Features>(
+                                         std::index_sequence<Features...>) {
+        return std::array<ProcessTriangleFunc, sizeof...(Features)>{
+            &RasterizerSoftware::ProcessTriangle<static_cast<u32>(Features)>...};
+    }(std::make_index_sequence<FragmentFeature::NumCombinations>{});
+    return routines[features];
+}
+
+void RasterizerSoftware::MakeScreenCoords(Vertex& vtx) {
+    const Viewport& viewport = fragment_config.viewport;
+
     f24 inv_w = f24::One() / vtx.pos.w;
     vtx.pos.w = inv_w;
     vtx.quat *= inv_w;
@@ -221,6 +496,7 @@ void RasterizerSoftware::MakeScreenCoords(Vertex& vtx) {
     vtx.screenpos[2] = vtx.pos.z * inv_w;
 }
 
+template <u32 Features>
 void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
                                          bool reversed) {
     MICROPROFILE_SCOPE(GPU_Rasterization);
@@ -240,13 +516,13 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
     if (regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepAll) {
         // Make sure we always end up with a triangle wound counter-clockwise
         if (!reversed && SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) <= 0) {
-            ProcessTriangle(v0, v2, v1, true);
+            ProcessTriangle<Features>(v0, v2, v1, true);
             return;
         }
     } else {
         if (!reversed && regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepClockWise) {
             // Reverse vertex order and use the CCW code path.
-            ProcessTriangle(v0, v2, v1, true);
+            ProcessTriangle<Features>(v0, v2, v1, true);
             return;
         }
         // Cull away triangles which are wound clockwise.
@@ -275,6 +551,12 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
         max_y = std::min(max_y, scissor_y2);
     }
 
+    const auto& config = fragment_config;
+    min_x = std::max(min_x, config.viewport_x1);
+    min_y = std::max(min_y, config.viewport_y1);
+    max_x = std::min(max_x, config.viewport_x2);
+    max_y = std::min(max_y, config.viewport_y2);
+
     min_x &= Fix12P4::IntMask();
     min_y &= Fix12P4::IntMask();
     max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
@@ -288,9 +570,7 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
         IsRightSideOrFlatBottomEdge(vtxpos[2].xy(), vtxpos[0].xy(), vtxpos[1].xy()) ? -1 : 0;
 
     const auto w_inverse = Common::MakeVec(v0.pos.w, v1.pos.w, v2.pos.w);
-
-    auto textures = regs.texturing.GetTextures();
-    const auto tev_stages = regs.texturing.GetTevStages();
+    const auto textures = regs.texturing.GetTextures();
 
     // Enter rasterization loop, starting at the center of the topleft bounding box corner.
     // TODO: Not sure if looping through x first might be faster
@@ -298,7 +578,7 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
         for (u16 x = min_x + 8; x < max_x; x += 0x10) {
             // Do not process the pixel if it's inside the scissor box and the scissor mode is set
             // to Exclude.
-            if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude) {
+            if (config.scissor_exclude) {
                 if (x >= scissor_x1 && x < scissor_x2 && y >= scissor_y1 && y < scissor_y2) {
                     continue;
                 }
@@ -329,15 +609,10 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
 
             // Not fully accurate. About 3 bits in precision are missing.
             // Z-Buffer (z / w * scale + offset)
-            const float depth_scale =
-                f24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
-            const float depth_offset =
-                f24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
-            float depth = interpolated_z_over_w * depth_scale + depth_offset;
+            float depth = interpolated_z_over_w * config.depth_scale + config.depth_offset;
 
             // Potentially switch to W-Buffer
-            if (regs.rasterizer.depthmap_enable ==
-                Pica::RasterizerRegs::DepthBuffering::WBuffering) {
+            if (config.w_buffering) {
                 // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
                 depth *= interpolated_w_inverse.ToFloat32() * wsum;
             }
@@ -402,7 +677,7 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
             Common::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
             Common::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
 
-            if (!regs.lighting.disable) {
+            if constexpr ((Features & FragmentFeature::Lighting) != 0) {
                 const auto normquat =
                     Common::Quaternion<f32>{
                         {get_interpolated_attribute(v0.quat.x, v1.quat.x, v2.quat.x).ToFloat32(),
@@ -417,17 +692,16 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
                     get_interpolated_attribute(v0.view.y, v1.view.y, v2.view.y).ToFloat32(),
                     get_interpolated_attribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
                 };
-                std::tie(primary_fragment_color, secondary_fragment_color) = ComputeFragmentsColors(
-                    regs.lighting, state.lighting, normquat, view, texture_color);
+                std::tie(primary_fragment_color, secondary_fragment_color) =
+                    ComputeFragmentsColors(regs.lighting, lighting_luts, light_setup, normquat,
+                                           view, texture_color);
             }
 
             // Write the TEV stages.
-            WriteTevConfig(texture_color, tev_stages, primary_color, primary_fragment_color,
+            WriteTevConfig(texture_color, primary_color, primary_fragment_color,
                            secondary_fragment_color);
 
-            const auto& output_merger = regs.framebuffer.output_merger;
-            if (output_merger.fragment_operation_mode ==
-                FramebufferRegs::FragmentOperationMode::Shadow) {
+            if constexpr ((Features & FragmentFeature::ShadowOutput) != 0) {
                 u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
                 // Use green color as the shadow intensity
                 u8 stencil = combiner_output.y;
@@ -437,16 +711,24 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
             }
 
             // Does alpha testing happen before or after stencil?
-            if (!DoAlphaTest(combiner_output.a())) {
-                continue;
+            if constexpr ((Features & FragmentFeature::AlphaTest) != 0) {
+                if (!DoAlphaTest(combiner_output.a())) {
+                    continue;
+                }
             }
-            WriteFog(combiner_output, depth);
-            if (!DoDepthStencilTest(x, y, depth)) {
-                continue;
+            if (config.fog) {
+                WriteFog(combiner_output, depth);
+            }
+            if constexpr ((Features & FragmentFeature::DepthStencil) != 0) {
+                if (!DoDepthStencilTest(x, y, depth)) {
+                    continue;
+                }
             }
-            const auto result = PixelColor(x, y, combiner_output);
-            if (regs.framebuffer.framebuffer.allow_color_write != 0) {
-                fb.DrawPixel(x >> 4, y >> 4, result);
+            if constexpr ((Features & FragmentFeature::ColorMerge) != 0) {
+                fb.DrawPixel(x >> 4, y >> 4, PixelColor(x, y, combiner_output));
+            } else if constexpr ((Features & FragmentFeature::ColorWrite) != 0) {
+                // Neither blending nor the logic op read the framebuffer color
+                fb.DrawPixel(x >> 4, y >> 4, combiner_output);
             }
         }
     }
@@ -454,7 +736,7 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
 
 std::array<Common::Vec4<u8>, 4> RasterizerSoftware::TextureColor(
     std::span<const Common::Vec2<f24>, 3> uv,
-    std::span<const Pica::TexturingRegs::FullTextureConfig, 3> textures, f24 tc0_w) const {
+    std::span<const Pica::TexturingRegs::FullTextureConfig, 3> textures, f24 tc0_w) {
     std::array<Common::Vec4<u8>, 4> texture_color{};
     for (u32 i = 0; i < 3; ++i) {
         const auto& texture = textures[i];
@@ -538,11 +820,13 @@ std::array<Common::Vec4<u8>, 4> RasterizerSoftware::TextureColor(
             t = texture.config.height - 1 -
                 GetWrappedTexCoord(texture.config.wrap_t, t, texture.config.height);
 
-            const u8* texture_data = memory.GetPhysicalPointer(texture_address);
-            const auto info = TextureInfo::FromPicaRegister(texture.config, texture.format);
+            auto info = TextureInfo::FromPicaRegister(texture.config, texture.format);
+            info.physical_address = texture_address;
 
             // TODO: Apply the min and mag filters to the texture
-            texture_color[i] = LookupTexture(texture_data, s, t, info);
+            if (const auto* decoded = texture_cache.GetTexture(info)) {
+                texture_color[i] = decoded->Lookup(s, t);
+            }
         }
 
         if (i == 0 && (texture.config.type == TexturingRegs::TextureConfig::Shadow2D ||
@@ -566,7 +850,7 @@ std::array<Common::Vec4<u8>, 4> RasterizerSoftware::TextureColor(
     if (regs.texturing.main_config.texture3_enable) {
         const auto& proctex_uv = uv[regs.texturing.main_config.texture3_coordinates];
         texture_color[3] = ProcTex(proctex_uv.u().ToFloat32(), proctex_uv.v().ToFloat32(),
-                                   regs.texturing, state.proctex);
+                                   regs.texturing, proctex_luts);
     }
 
     return texture_color;
@@ -583,11 +867,7 @@ Common::Vec4<u8> RasterizerSoftware::PixelColor(u16 x, u16 y,
         const auto lookup_factor = [&](u32 channel, FramebufferRegs::BlendFactor factor) -> u8 {
             DEBUG_ASSERT(channel < 4);
 
-            const Common::Vec4<u8> blend_const =
-                Common::MakeVec(
-                    output_merger.blend_const.r.Value(), output_merger.blend_const.g.Value(),
-                    output_merger.blend_const.b.Value(), output_merger.blend_const.a.Value())
-                    .Cast<u8>();
+            const Common::Vec4<u8>& blend_const = fragment_config.blend_const;
 
             switch (factor) {
             case FramebufferRegs::BlendFactor::Zero:
@@ -663,11 +943,10 @@ Common::Vec4<u8> RasterizerSoftware::PixelColor(u16 x, u16 y,
     return result;
 }
 
-void RasterizerSoftware::WriteTevConfig(
-    std::span<const Common::Vec4<u8>, 4> texture_color,
-    std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages,
-    Common::Vec4<u8> primary_color, Common::Vec4<u8> primary_fragment_color,
-    Common::Vec4<u8> secondary_fragment_color) {
+void RasterizerSoftware::WriteTevConfig(std::span<const Common::Vec4<u8>, 4> texture_color,
+                                        Common::Vec4<u8> primary_color,
+                                        Common::Vec4<u8> primary_fragment_color,
+                                        Common::Vec4<u8> secondary_fragment_color) {
     /**
      * Texture environment - consists of 6 stages of color and alpha combining.
      * Color combiners take three input color values from some source (e.g. interpolated
@@ -677,92 +956,89 @@ void RasterizerSoftware::WriteTevConfig(
      * analogously.
      **/
     Common::Vec4<u8> combiner_buffer = {0, 0, 0, 0};
-    Common::Vec4<u8> next_combiner_buffer =
-        Common::MakeVec(regs.texturing.tev_combiner_buffer_color.r.Value(),
-                        regs.texturing.tev_combiner_buffer_color.g.Value(),
-                        regs.texturing.tev_combiner_buffer_color.b.Value(),
-                        regs.texturing.tev_combiner_buffer_color.a.Value())
-            .Cast<u8>();
+    Common::Vec4<u8> next_combiner_buffer = fragment_config.tev_buffer_color;
 
-    for (u32 tev_stage_index = 0; tev_stage_index < tev_stages.size(); ++tev_stage_index) {
-        const auto& tev_stage = tev_stages[tev_stage_index];
+    for (const auto& stage : fragment_config.tev_stages) {
+        const auto& tev_stage = stage.config;
         using Source = TexturingRegs::TevStageConfig::Source;
 
-        auto get_source = [&](Source source) -> Common::Vec4<u8> {
-            switch (source) {
-            case Source::PrimaryColor:
-                return primary_color;
-            case Source::PrimaryFragmentColor:
-                return primary_fragment_color;
-            case Source::SecondaryFragmentColor:
-                return secondary_fragment_color;
-            case Source::Texture0:
-                return texture_color[0];
-            case Source::Texture1:
-                return texture_color[1];
-            case Source::Texture2:
-                return texture_color[2];
-            case Source::Texture3:
-                return texture_color[3];
-            case Source::PreviousBuffer:
-                return combiner_buffer;
-            case Source::Constant:
-                return Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
-                                       tev_stage.const_b.Value(), tev_stage.const_a.Value())
-                    .Cast<u8>();
-            case Source::Previous:
-                return combiner_output;
-            default:
-                LOG_ERROR(HW_GPU, "Unknown color combiner source {}", (int)source);
-                UNIMPLEMENTED();
-                return {0, 0, 0, 0};
-            }
-        };
+        // Pass-through stages only advance the combiner buffer
+        if (!stage.pass_through) {
+            auto get_source = [&](Source source) -> Common::Vec4<u8> {
+                switch (source) {
+                case Source::PrimaryColor:
+                    return primary_color;
+                case Source::PrimaryFragmentColor:
+                    return primary_fragment_color;
+                case Source::SecondaryFragmentColor:
+                    return secondary_fragment_color;
+                case Source::Texture0:
+                    return texture_color[0];
+                case Source::Texture1:
+                    return texture_color[1];
+                case Source::Texture2:
+                    return texture_color[2];
+                case Source::Texture3:
+                    return texture_color[3];
+                case Source::PreviousBuffer:
+                    return combiner_buffer;
+                case Source::Constant:
+                    return stage.const_color;
+                case Source::Previous:
+                    return combiner_output;
+                default:
+                    LOG_ERROR(HW_GPU, "Unknown color combiner source {}", (int)source);
+                    UNIMPLEMENTED();
+                    return {0, 0, 0, 0};
+                }
+            };
 
-        /**
-         * Color combiner
-         * NOTE: Not sure if the alpha combiner might use the color output of the previous
-         *       stage as input. Hence, we currently don't directly write the result to
-         *       combiner_output.rgb(), but instead store it in a temporary variable until
-         *       alpha combining has been done.
-         **/
-        const std::array<Common::Vec3<u8>, 3> color_result = {
-            GetColorModifier(tev_stage.color_modifier1, get_source(tev_stage.color_source1)),
-            GetColorModifier(tev_stage.color_modifier2, get_source(tev_stage.color_source2)),
-            GetColorModifier(tev_stage.color_modifier3, get_source(tev_stage.color_source3)),
-        };
-        const Common::Vec3<u8> color_output = ColorCombine(tev_stage.color_op, color_result);
+            /**
+             * Color combiner
+             * NOTE: Not sure if the alpha combiner might use the color output of the previous
+             *       stage as input. Hence, we currently don't directly write the result to
+             *       combiner_output.rgb(), but instead store it in a temporary variable until
+             *       alpha combining has been done.
+             **/
+            const std::array<Common::Vec3<u8>, 3> color_result = {
+                GetColorModifier(tev_stage.color_modifier1, get_source(tev_stage.color_source1)),
+                GetColorModifier(tev_stage.color_modifier2, get_source(tev_stage.color_source2)),
+                GetColorModifier(tev_stage.color_modifier3, get_source(tev_stage.color_source3)),
+            };
+            const Common::Vec3<u8> color_output = ColorCombine(tev_stage.color_op, color_result);
 
-        u8 alpha_output;
-        if (tev_stage.color_op == TexturingRegs::TevStageConfig::Operation::Dot3_RGBA) {
-            // result of Dot3_RGBA operation is also placed to the alpha component
-            alpha_output = color_output.x;
-        } else {
-            // alpha combiner
-            const std::array<u8, 3> alpha_result = {{
-                GetAlphaModifier(tev_stage.alpha_modifier1, get_source(tev_stage.alpha_source1)),
-                GetAlphaModifier(tev_stage.alpha_modifier2, get_source(tev_stage.alpha_source2)),
-                GetAlphaModifier(tev_stage.alpha_modifier3, get_source(tev_stage.alpha_source3)),
-            }};
-            alpha_output = AlphaCombine(tev_stage.alpha_op, alpha_result);
-        }
+            u8 alpha_output;
+            if (tev_stage.color_op == TexturingRegs::TevStageConfig::Operation::Dot3_RGBA) {
+                // result of Dot3_RGBA operation is also placed to the alpha component
+                alpha_output = color_output.x;
+            } else {
+                // alpha combiner
+                const std::array<u8, 3> alpha_result = {{
+                    GetAlphaModifier(tev_stage.alpha_modifier1,
+                                     get_source(tev_stage.alpha_source1)),
+                    GetAlphaModifier(tev_stage.alpha_modifier2,
+                                     get_source(tev_stage.alpha_source2)),
+                    GetAlphaModifier(tev_stage.alpha_modifier3,
+                                     get_source(tev_stage.alpha_source3)),
+                }};
+                alpha_output = AlphaCombine(tev_stage.alpha_op, alpha_result);
+            }
 
-        combiner_output[0] = std::min(255U, color_output.r() * tev_stage.GetColorMultiplier());
-        combiner_output[1] = std::min(255U, color_output.g() * tev_stage.GetColorMultiplier());
-        combiner_output[2] = std::min(255U, color_output.b() * tev_stage.GetColorMultiplier());
-        combiner_output[3] = std::min(255U, alpha_output * tev_stage.GetAlphaMultiplier());
+            combiner_output[0] = std::min(255U, color_output.r() * stage.color_multiplier);
+            combiner_output[1] = std::min(255U, color_output.g() * stage.color_multiplier);
+            combiner_output[2] = std::min(255U, color_output.b() * stage.color_multiplier);
+            combiner_output[3] = std::min(255U, alpha_output * stage.alpha_multiplier);
+        }
 
         combiner_buffer = next_combiner_buffer;
 
-        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(
-                tev_stage_index)) {
+        if (stage.updates_buffer_color) {
             next_combiner_buffer.r() = combiner_output.r();
             next_combiner_buffer.g() = combiner_output.g();
             next_combiner_buffer.b() = combiner_output.b();
         }
 
-        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(
-                tev_stage_index)) {
+        if (stage.updates_buffer_alpha) {
             next_combiner_buffer.a() = combiner_output.a();
         }
     }
@@ -789,8 +1065,7 @@ void RasterizerSoftware::WriteFog(Common::Vec4<u8>& combiner_output, float depth
         // Generate clamped fog factor from LUT for given fog index
         const f32 fog_i = std::clamp(floorf(fog_index), 0.0f, 127.0f);
         const f32 fog_f = fog_index - fog_i;
-        const auto& fog_lut_entry = state.fog.lut[static_cast<u32>(fog_i)];
-        f32 fog_factor = fog_lut_entry.ToFloat() + fog_lut_entry.DiffToFloat() * fog_f;
+        f32 fog_factor = fog_lut.Lookup(static_cast<u32>(fog_i), fog_f);
         fog_factor = std::clamp(fog_factor, 0.0f, 1.0f);
         for (u32 i = 0; i < 3; i++) {
             combiner_output[i] = static_cast<u8>(fog_factor * combiner_output[i] +
@@ -828,7 +1103,7 @@ bool RasterizerSoftware::DoAlphaTest(u8 alpha) const {
     }
 }
 
-bool RasterizerSoftware::DoDepthStencilTest(u16 x, u16 y, float depth) const {
+bool RasterizerSoftware::DoDepthStencilTest(u16 x, u16 y, float depth) {
     const auto& framebuffer = regs.framebuffer.framebuffer;
     const auto stencil_test = regs.framebuffer.output_merger.stencil_test;
     u8 old_stencil = 0;
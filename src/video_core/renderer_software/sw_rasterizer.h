@@ -4,12 +4,17 @@
 
 #pragma once
 
+#include <array>
 #include <span>
 
 #include "video_core/rasterizer_interface.h"
 #include "video_core/regs_texturing.h"
 #include "video_core/renderer_software/sw_clipper.h"
 #include "video_core/renderer_software/sw_framebuffer.h"
+#include "video_core/renderer_software/sw_lighting.h"
+#include "video_core/renderer_software/sw_lut.h"
+#include "video_core/renderer_software/sw_proctex.h"
+#include "video_core/renderer_software/sw_texture_cache.h"
 
 namespace Pica::Shader {
 struct OutputVertex;
@@ -24,39 +29,84 @@ namespace SwRenderer {
 
 struct Vertex;
 
+/**
+ * Components to interpolate in each of the six vectors of four vertex attributes: pos, quat,
+ * color, tc0 and tc1, tc0_w and view.xy, view.z and tc2. Components are bits 0 to 3.
+ */
+using AttributeLanes = std::array<u32, 6>;
+
 class RasterizerSoftware : public VideoCore::RasterizerInterface {
 public:
     explicit RasterizerSoftware(Memory::MemorySystem& memory);
 
     void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
                      const Pica::Shader::OutputVertex& v2) override;
-    void DrawTriangles() override {}
-    void NotifyPicaRegisterChanged(u32 id) override {}
-    void FlushAll() override {}
-    void FlushRegion(PAddr addr, u32 size) override {}
-    void InvalidateRegion(PAddr addr, u32 size) override {}
-    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {}
-    void ClearAll(bool flush) override {}
+    void DrawTriangles() override;
+    void FlushAll() override;
+    void FlushRegion(PAddr addr, u32 size) override;
+    void InvalidateRegion(PAddr addr, u32 size) override;
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override;
+    void ClearAll(bool flush) override;
+    void SyncEntireState() override;
 
 private:
+    /// Fragment pipeline state that is constant within a primitive, resolved from the registers.
+    struct FragmentConfig {
+        struct TevStage {
+            Pica::TexturingRegs::TevStageConfig config;
+            Common::Vec4<u8> const_color;
+            u32 color_multiplier;
+            u32 alpha_multiplier;
+            bool updates_buffer_color;
+            bool updates_buffer_alpha;
+            bool pass_through; ///< The stage leaves the previous combiner output unchanged
+        };
+
+        std::array<TevStage, 6> tev_stages;
+        Common::Vec4<u8> tev_buffer_color;
+        Common::Vec4<u8> blend_const;
+        float depth_scale;
+        float depth_offset;
+        bool w_buffering;
+        bool scissor_exclude;
+        bool fog;
+        Viewport viewport;
+        u16 viewport_x1; ///< Viewport bounds in rasterizer coordinates
+        u16 viewport_y1;
+        u16 viewport_x2;
+        u16 viewport_y2;
+        AttributeLanes lerp_lanes; ///< Attributes interpolated when clipping
+    };
+
+    using ProcessTriangleFunc = void (RasterizerSoftware::*)(const Vertex&, const Vertex&,
+                                                             const Vertex&, bool);
+
+    /**
+     * Resolves the fragment pipeline state of the current registers into fragment_config.
+     * @return The rasterization routine specialized for the enabled pipeline features.
+     */
+    ProcessTriangleFunc SetupFragmentPipeline();
+
+    /// Converts the LUTs written since the last draw to floats
+    void SyncLuts();
+
     /// Computes the screen coordinates of the provided vertex.
     void MakeScreenCoords(Vertex& vtx);
 
     /// Processes the triangle defined by the provided vertices.
-    void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
-                         bool reversed = false);
+    template <u32 Features>
+    void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2, bool reversed);
 
     /// Returns the texture color of the currently processed pixel.
     std::array<Common::Vec4<u8>, 4> TextureColor(
         std::span<const Common::Vec2<f24>, 3> uv,
-        std::span<const Pica::TexturingRegs::FullTextureConfig, 3> textures, f24 tc0_w) const;
+        std::span<const Pica::TexturingRegs::FullTextureConfig, 3> textures, f24 tc0_w);
 
     /// Returns the final pixel color with blending or logic ops applied.
     Common::Vec4<u8> PixelColor(u16 x, u16 y, Common::Vec4<u8>& combiner_output) const;
 
     /// Emulates the TEV configuration and returns the combiner output.
     void WriteTevConfig(std::span<const Common::Vec4<u8>, 4> texture_color,
-                        std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages,
                         Common::Vec4<u8> primary_color, Common::Vec4<u8> primary_fragment_color,
                         Common::Vec4<u8> secondary_fragment_color);
 
@@ -67,13 +117,19 @@ private:
     bool DoAlphaTest(u8 alpha) const;
 
     /// Performs the depth stencil test. Returns false if the test failed.
-    bool DoDepthStencilTest(u16 x, u16 y, float depth) const;
+    bool DoDepthStencilTest(u16 x, u16 y, float depth);
 
 private:
     Memory::MemorySystem& memory;
     Pica::State& state;
     const Pica::Regs& regs;
     Framebuffer fb;
+    TextureCache texture_cache;
+    FragmentConfig fragment_config{};
+    LightSetup light_setup{};
+    LightingLuts lighting_luts{};
+    ProcTexLuts proctex_luts{};
+    FloatLut<128> fog_lut{};
     // Kirby Blowout Blast relies on the combiner output of a previous draw
     // in order to render the sky correctly.
     Common::Vec4<u8> combiner_output{};
@@ -0,0 +1,125 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "core/memory.h"
+#include "video_core/renderer_software/sw_framebuffer.h"
+#include "video_core/renderer_software/sw_texture_cache.h"
+#include "video_core/texture/texture_decode.h"
+
+namespace SwRenderer {
+
+namespace {
+
+u64 MakeKey(const Pica::Texture::TextureInfo& info) {
+    return static_cast<u64>(info.physical_address) |
+           (static_cast<u64>(info.format) & 0xF) << 32 |
+           (static_cast<u64>(info.width) & 0xFFF) << 36 |
+           (static_cast<u64>(info.height) & 0xFFF) << 48;
+}
+
+/// Size of the encoded texture in guest memory
+std::size_t GetDataSize(const Pica::Texture::TextureInfo& info) {
+    return static_cast<std::size_t>(info.stride) * (info.height / 8);
+}
+
+std::size_t GetDecodedSize(u32 width, u32 height) {
+    return std::size_t{width} * height * sizeof(Common::Vec4<u8>);
+}
+
+} // Anonymous namespace
+
+TextureCache::TextureCache(Memory::MemorySystem& memory_, Framebuffer& fb_)
+    : memory{memory_}, fb{fb_} {}
+
+TextureCache::~TextureCache() = default;
+
+const TextureCache::Texture* TextureCache::GetTexture(const Pica::Texture::TextureInfo& info) {
+    const u64 key = MakeKey(info);
+    for (std::size_t i = 0; i < num_recent_entries; ++i) {
+        if (recent_entries[i].key == key) {
+            return recent_entries[i].texture;
+        }
+    }
+
+    const u8* data = memory.GetPhysicalPointer(info.physical_address);
+    const std::size_t data_size = GetDataSize(info);
+    if (!data || data_size == 0 ||
+        !memory.IsValidPhysicalAddress(info.physical_address + static_cast<u32>(data_size) - 1)) {
+        LOG_ERROR(Render_Software, "Texture at {:#010x} of size {}x{} is out of bounds",
+                  info.physical_address, info.width, info.height);
+        return nullptr;
+    }
+
+    auto [it, inserted] = entries.try_emplace(key);
+    Entry& entry = it->second;
+    if (!inserted && entry.checked_draw == current_draw) {
+        PushRecent(key, entry.texture);
+        return &entry.texture;
+    }
+
+    // Textures rendered to are only in guest memory once the render target is written back
+    fb.FlushRegion(info.physical_address, static_cast<u32>(data_size));
+    const u64 hash = Common::ComputeHash64(data, data_size);
+    if (inserted || entry.hash != hash) {
+        if (inserted) {
+            const std::size_t size = GetDecodedSize(info.width, info.height);
+            if (cached_bytes + size > MaxCachedBytes) {
+                // Keep only the textures of the current draw, which may still be referenced
+                std::erase_if(entries, [&](const auto& pair) {
+                    const Entry& other = pair.second;
+                    if (&other == &entry || other.checked_draw == current_draw) {
+                        return false;
+                    }
+                    cached_bytes -= GetDecodedSize(other.texture.width, other.texture.height);
+                    return true;
+                });
+                num_recent_entries = 0;
+            }
+            cached_bytes += size;
+        }
+        Decode(entry.texture, data, info);
+        entry.hash = hash;
+    }
+    entry.checked_draw = current_draw;
+
+    PushRecent(key, entry.texture);
+    return &entry.texture;
+}
+
+void TextureCache::PushRecent(u64 key, const Texture& texture) {
+    if (num_recent_entries < recent_entries.size()) {
+        recent_entries[num_recent_entries++] = {key, &texture};
+    } else {
+        std::shift_right(recent_entries.begin(), recent_entries.end(), 1);
+        recent_entries[0] = {key, &texture};
+    }
+}
+
+void TextureCache::EndDraw() {
+    ++current_draw;
+    num_recent_entries = 0;
+}
+
+void TextureCache::Clear() {
+    entries.clear();
+    num_recent_entries = 0;
+    cached_bytes = 0;
+}
+
+void TextureCache::Decode(Texture& texture, const u8* data,
+                          const Pica::Texture::TextureInfo& info) {
+    texture.width = info.width;
+    texture.height = info.height;
+    texture.texels.resize(std::size_t{info.width} * info.height);
+    for (u32 y = 0; y < info.height; ++y) {
+        for (u32 x = 0; x < info.width; ++x) {
+            texture.texels[y * info.width + x] = Pica::Texture::LookupTexture(data, x, y, info);
+        }
+    }
+}
+
+} // namespace SwRenderer
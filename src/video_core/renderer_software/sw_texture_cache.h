@@ -0,0 +1,88 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+
+namespace Memory {
+class MemorySystem;
+}
+
+namespace Pica::Texture {
+struct TextureInfo;
+}
+
+namespace SwRenderer {
+
+class Framebuffer;
+
+/**
+ * Keeps decoded copies of the textures sampled by the software rasterizer, so that sampling a
+ * texel is an array access instead of a tile, Morton and format decode. The contents of a texture
+ * are hashed the first time it is used in a draw and it is decoded again if they changed. Hashing
+ * is needed because CPU writes only reach the rasterizer for pages marked as cached, which the
+ * software renderer does for its render targets only.
+ */
+class TextureCache {
+public:
+    struct Texture {
+        u32 width;
+        u32 height;
+        /// Texels in the coordinates of Pica::Texture::LookupTexture, row by row
+        std::vector<Common::Vec4<u8>> texels;
+
+        Common::Vec4<u8> Lookup(u32 x, u32 y) const {
+            return texels[y * width + x];
+        }
+    };
+
+    explicit TextureCache(Memory::MemorySystem& memory, Framebuffer& fb);
+    ~TextureCache();
+
+    /// Returns the decoded texture, or nullptr if the texture is not in accessible memory
+    const Texture* GetTexture(const Pica::Texture::TextureInfo& info);
+
+    /// Marks the end of a draw, after which the used textures are checked for changes again
+    void EndDraw();
+
+    /// Drops all decoded textures
+    void Clear();
+
+private:
+    struct Entry {
+        Texture texture;
+        u64 hash;
+        u64 checked_draw; ///< Draw in which the hash was last compared
+    };
+
+    /// Recently used textures, checked before the map because a draw samples only a few
+    struct RecentEntry {
+        u64 key;
+        const Texture* texture;
+    };
+
+    static constexpr std::size_t NumRecentEntries = 8;
+
+    /// Decoded texels kept before textures not used in the current draw are dropped
+    static constexpr std::size_t MaxCachedBytes = 64 * 1024 * 1024;
+
+    void PushRecent(u64 key, const Texture& texture);
+
+    void Decode(Texture& texture, const u8* data, const Pica::Texture::TextureInfo& info);
+
+    Memory::MemorySystem& memory;
+    Framebuffer& fb;
+    std::unordered_map<u64, Entry> entries;
+    std::array<RecentEntry, NumRecentEntries> recent_entries{};
+    std::size_t num_recent_entries = 0;
+    std::size_t cached_bytes = 0;
+    u64 current_draw = 1;
+};
+
+} // namespace SwRenderer
@@ -158,6 +158,7 @@ void Shutdown() {
 #if CITRA_ARCH(x86_64)
     jit_engine = nullptr;
 #endif // CITRA_ARCH(x86_64)
+    interpreter_engine.ClearCache();
 }
 
 } // namespace Pica::Shader
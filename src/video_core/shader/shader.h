@@ -252,7 +252,7 @@ struct ShaderSetup {
     /// Data private to ShaderEngines
     struct EngineData {
         unsigned int entry_point;
-        /// Used by the JIT, points to a compiled shader object.
+        /// Points to the JIT compiled or interpreter pre-decoded shader object.
         const void* cached_shader = nullptr;
     } engine_data;
 
@@ -5,7 +5,6 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
-#include <numeric>
 #include <boost/container/static_vector.hpp>
 #include <nihstro/shader_bytecode.h>
 #include "common/assert.h"
@@ -13,8 +12,10 @@
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/vector_math.h"
+#include "core/perf_stats.h"
 #include "video_core/pica_state.h"
 #include "video_core/pica_types.h"
+#include "video_core/pica_types_simd.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_interpreter.h"
 
@@ -35,6 +36,58 @@ struct CallStackElement {
     u32 loop_address;   // The address where we'll return to after each loop iteration
 };
 
+/// Returns the destination components written by an instruction as a lane mask for F24x4
+static u32 GetDestLanes(const SwizzlePattern& swizzle) {
+    u32 lanes = 0;
+    for (u32 i = 0; i < 4; ++i) {
+        if (swizzle.DestComponentEnabled(i)) {
+            lanes |= 1u << i;
+        }
+    }
+    return lanes;
+}
+
+/// Placeholder for invalid inputs and outputs
+static Common::Vec4<f24> dummy_register;
+
+static const f24* LookupSourceRegister(const UnitState& state, const Uniforms& uniforms,
+                                       const SourceRegister& source_reg) {
+    switch (source_reg.GetRegisterType()) {
+    case RegisterType::Input:
+        return &state.registers.input[source_reg.GetIndex()].x;
+
+    case RegisterType::Temporary:
+        return &state.registers.temporary[source_reg.GetIndex()].x;
+
+    case RegisterType::FloatUniform:
+        return &uniforms.f[source_reg.GetIndex()].x;
+
+    default:
+        return &dummy_register.x;
+    }
+}
+
+static bool EvaluateCondition(const UnitState& state, Instruction::FlowControlType flow_control) {
+    using Op = Instruction::FlowControlType::Op;
+
+    bool result_x = flow_control.refx.Value() == state.conditional_code[0];
+    bool result_y = flow_control.refy.Value() == state.conditional_code[1];
+
+    switch (flow_control.op) {
+    case Op::Or:
+        return result_x || result_y;
+    case Op::And:
+        return result_x && result_y;
+    case Op::JustX:
+        return result_x;
+    case Op::JustY:
+        return result_y;
+    default:
+        UNREACHABLE();
+        return false;
+    }
+}
+
 template <bool Debug>
 static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData<Debug>& debug_data,
                            unsigned offset) {
@@ -54,34 +107,10 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
             {offset + num_instructions, return_offset, repeat_count, loop_increment, offset});
     };
 
-    auto evaluate_condition = [&state](Instruction::FlowControlType flow_control) {
-        using Op = Instruction::FlowControlType::Op;
-
-        bool result_x = flow_control.refx.Value() == state.conditional_code[0];
-        bool result_y = flow_control.refy.Value() == state.conditional_code[1];
-
-        switch (flow_control.op) {
-        case Op::Or:
-            return result_x || result_y;
-        case Op::And:
-            return result_x && result_y;
-        case Op::JustX:
-            return result_x;
-        case Op::JustY:
-            return result_y;
-        default:
-            UNREACHABLE();
-            return false;
-        }
-    };
-
     const auto& uniforms = setup.uniforms;
     const auto& swizzle_data = setup.swizzle_data;
     const auto& program_code = setup.program_code;
 
-    // Placeholder for invalid inputs
-    static f24 dummy_vec4_float24[4];
-
     unsigned iteration = 0;
     bool exit_loop = false;
     while (!exit_loop) {
@@ -111,22 +140,6 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
 
         debug_data.max_offset = std::max<u32>(debug_data.max_offset, 1 + program_counter);
 
-        auto LookupSourceRegister = [&](const SourceRegister& source_reg) -> const f24* {
-            switch (source_reg.GetRegisterType()) {
-            case RegisterType::Input:
-                return &state.registers.input[source_reg.GetIndex()].x;
-
-            case RegisterType::Temporary:
-                return &state.registers.temporary[source_reg.GetIndex()].x;
-
-            case RegisterType::FloatUniform:
-                return &uniforms.f[source_reg.GetIndex()].x;
-
-            default:
-                return dummy_vec4_float24;
-            }
-        };
-
         switch (instr.opcode.Value().GetInfo().type) {
         case OpCode::Type::Arithmetic: {
             const bool is_inverted =
@@ -137,10 +150,14 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                     ? 0
                     : state.address_registers[instr.common.address_register_index - 1];
 
-            const f24* src1_ = LookupSourceRegister(instr.common.GetSrc1(is_inverted) +
-                                                    (is_inverted ? 0 : address_offset));
-            const f24* src2_ = LookupSourceRegister(instr.common.GetSrc2(is_inverted) +
-                                                    (is_inverted ? address_offset : 0));
+            const f24* src1_ =
+                LookupSourceRegister(state, uniforms,
+                                     instr.common.GetSrc1(is_inverted) +
+                                         (is_inverted ? 0 : address_offset));
+            const f24* src2_ =
+                LookupSourceRegister(state, uniforms,
+                                     instr.common.GetSrc2(is_inverted) +
+                                         (is_inverted ? address_offset : 0));
 
             const bool negate_src1 = ((bool)swizzle.negate_src1 != false);
             const bool negate_src2 = ((bool)swizzle.negate_src2 != false);
@@ -174,7 +191,7 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                             ? &state.registers.output[instr.common.dest.Value().GetIndex()][0]
                         : (instr.common.dest.Value() < 0x20)
                             ? &state.registers.temporary[instr.common.dest.Value().GetIndex()][0]
-                            : dummy_vec4_float24;
+                            : &dummy_register.x;
 
             debug_data.max_opdesc_id =
                 std::max<u32>(debug_data.max_opdesc_id, 1 + instr.common.operand_desc_id);
@@ -184,12 +201,7 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = src1[i] + src2[i];
-                }
+                (F24x4::Load(src1) + F24x4::Load(src2)).StoreMasked(dest, GetDestLanes(swizzle));
                 Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
                 break;
             }
@@ -198,12 +210,7 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = src1[i] * src2[i];
-                }
+                (F24x4::Load(src1) * F24x4::Load(src2)).StoreMasked(dest, GetDestLanes(swizzle));
                 Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
                 break;
             }
@@ -224,15 +231,11 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    // NOTE: Exact form required to match NaN semantics to hardware:
-                    //   max(0, NaN) -> NaN
-                    //   max(NaN, 0) -> 0
-                    dest[i] = (src1[i] > src2[i]) ? src1[i] : src2[i];
-                }
+                // NOTE: Exact form required to match NaN semantics to hardware:
+                //   max(0, NaN) -> NaN
+                //   max(NaN, 0) -> 0
+                F24x4::Max(F24x4::Load(src1), F24x4::Load(src2))
+                    .StoreMasked(dest, GetDestLanes(swizzle));
                 Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
                 break;
 
@@ -240,15 +243,11 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    // NOTE: Exact form required to match NaN semantics to hardware:
-                    //   min(0, NaN) -> NaN
-                    //   min(NaN, 0) -> 0
-                    dest[i] = (src1[i] < src2[i]) ? src1[i] : src2[i];
-                }
+                // NOTE: Exact form required to match NaN semantics to hardware:
+                //   min(0, NaN) -> NaN
+                //   min(NaN, 0) -> 0
+                F24x4::Min(F24x4::Load(src1), F24x4::Load(src2))
+                    .StoreMasked(dest, GetDestLanes(swizzle));
                 Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
                 break;
 
@@ -264,8 +263,12 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 if (opcode == OpCode::Id::DPH || opcode == OpCode::Id::DPHI)
                     src1[3] = f24::One();
 
-                int num_components = (opcode == OpCode::Id::DP3) ? 3 : 4;
-                f24 dot = std::inner_product(src1, src1 + num_components, src2, f24::Zero());
+                // The products are summed in order, to round the same way as the scalar code
+                const auto products = (F24x4::Load(src1) * F24x4::Load(src2)).ToArray();
+                f24 dot = f24::Zero() + products[0] + products[1] + products[2];
+                if (opcode != OpCode::Id::DP3) {
+                    dot = dot + products[3];
+                }
 
                 for (int i = 0; i < 4; ++i) {
                     if (!swizzle.DestComponentEnabled(i))
@@ -462,11 +465,16 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                         ? 0
                         : state.address_registers[instr.mad.address_register_index - 1];
 
-                const f24* src1_ = LookupSourceRegister(instr.mad.GetSrc1(is_inverted));
-                const f24* src2_ = LookupSourceRegister(instr.mad.GetSrc2(is_inverted) +
-                                                        (!is_inverted * address_offset));
-                const f24* src3_ = LookupSourceRegister(instr.mad.GetSrc3(is_inverted) +
-                                                        (is_inverted * address_offset));
+                const f24* src1_ =
+                    LookupSourceRegister(state, uniforms, instr.mad.GetSrc1(is_inverted));
+                const f24* src2_ =
+                    LookupSourceRegister(state, uniforms,
+                                         instr.mad.GetSrc2(is_inverted) +
+                                             (!is_inverted * address_offset));
+                const f24* src3_ =
+                    LookupSourceRegister(state, uniforms,
+                                         instr.mad.GetSrc3(is_inverted) +
+                                             (is_inverted * address_offset));
 
                 const bool negate_src1 = ((bool)mad_swizzle.negate_src1 != false);
                 const bool negate_src2 = ((bool)mad_swizzle.negate_src2 != false);
@@ -513,18 +521,14 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                                 ? &state.registers.output[instr.mad.dest.Value().GetIndex()][0]
                             : (instr.mad.dest.Value() < 0x20)
                                 ? &state.registers.temporary[instr.mad.dest.Value().GetIndex()][0]
-                                : dummy_vec4_float24;
+                                : &dummy_register.x;
 
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
                 Record<DebugDataRecord::SRC3>(debug_data, iteration, src3);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!mad_swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = src1[i] * src2[i] + src3[i];
-                }
+                (F24x4::Load(src1) * F24x4::Load(src2) + F24x4::Load(src3))
+                    .StoreMasked(dest, GetDestLanes(mad_swizzle));
                 Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
             } else {
                 LOG_ERROR(HW_GPU, "Unhandled multiply-add instruction: 0x{:02x} ({}): 0x{:08x}",
@@ -543,7 +547,7 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
 
             case OpCode::Id::JMPC:
                 Record<DebugDataRecord::COND_CMP_IN>(debug_data, iteration, state.conditional_code);
-                if (evaluate_condition(instr.flow_control)) {
+                if (EvaluateCondition(state, instr.flow_control)) {
                     program_counter = instr.flow_control.dest_offset - 1;
                 }
                 break;
@@ -574,7 +578,7 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
 
             case OpCode::Id::CALLC:
                 Record<DebugDataRecord::COND_CMP_IN>(debug_data, iteration, state.conditional_code);
-                if (evaluate_condition(instr.flow_control)) {
+                if (EvaluateCondition(state, instr.flow_control)) {
                     call(instr.flow_control.dest_offset, instr.flow_control.num_instructions,
                          program_counter + 1, 0, 0);
                 }
@@ -602,7 +606,7 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 // TODO: Do we need to consider swizzlers here?
 
                 Record<DebugDataRecord::COND_CMP_IN>(debug_data, iteration, state.conditional_code);
-                if (evaluate_condition(instr.flow_control)) {
+                if (EvaluateCondition(state, instr.flow_control)) {
                     call(program_counter + 1, instr.flow_control.dest_offset - program_counter - 1,
                          instr.flow_control.dest_offset + instr.flow_control.num_instructions, 0,
                          0);
@@ -660,17 +664,670 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
     }
 }
 
+/**
+ * Shader program translated once per program and swizzle table, so that running it does not decode
+ * the instruction and operand descriptor bitfields of every instruction for every vertex.
+ */
+struct DecodedProgram {
+    enum class Op : u8 {
+        Add,
+        Mul,
+        Flr,
+        Max,
+        Min,
+        Dp3,
+        Dp4,
+        Dph,
+        Rcp,
+        Rsq,
+        Mova,
+        Mov,
+        Sge,
+        Slt,
+        Cmp,
+        Ex2,
+        Lg2,
+        Mad,
+        End,
+        Jmpc,
+        Jmpu,
+        Call,
+        Callu,
+        Callc,
+        Nop,
+        Ifu,
+        Ifc,
+        Loop,
+        Emit,
+        SetEmit,
+        Unhandled,
+    };
+
+    /// Register file of an operand, used as an index into the register file tables of RunDecoded
+    enum class RegisterFile : u8 {
+        Input,
+        Temporary,
+        Output,
+        FloatUniform,
+        Dummy,
+    };
+
+    struct Source {
+        SourceRegister reg; ///< Encoded register, resolved at run time if relative is set
+        RegisterFile file;
+        u8 index;
+        bool negate;
+        bool relative; ///< Whether the address register is added to the register index
+        std::array<u8, 4> selectors;
+    };
+
+    struct Operation {
+        Op op;
+        RegisterFile dest_file;
+        u8 dest_index;
+        u8 dest_lanes;
+        u8 address_register_index; ///< 0 for none, otherwise 1 + index of the address register
+        std::array<Source, 3> src;
+        Instruction instr; ///< Encoded instruction, for flow control, CMP and SETEMIT
+    };
+
+    std::array<Operation, MAX_PROGRAM_CODE_LENGTH> code;
+};
+
+using DecodedOp = DecodedProgram::Op;
+using DecodedRegisterFile = DecodedProgram::RegisterFile;
+
+static DecodedProgram::Source DecodeSource(SourceRegister reg, bool negate,
+                                           std::array<u8, 4> selectors, bool relative) {
+    DecodedProgram::Source source{};
+    source.reg = reg;
+    switch (reg.GetRegisterType()) {
+    case RegisterType::Input:
+        source.file = DecodedRegisterFile::Input;
+        break;
+    case RegisterType::Temporary:
+        source.file = DecodedRegisterFile::Temporary;
+        break;
+    case RegisterType::FloatUniform:
+        source.file = DecodedRegisterFile::FloatUniform;
+        break;
+    default:
+        source.file = DecodedRegisterFile::Dummy;
+        break;
+    }
+    source.index =
+        source.file == DecodedRegisterFile::Dummy ? 0 : static_cast<u8>(reg.GetIndex());
+    source.negate = negate;
+    source.relative = relative;
+    source.selectors = selectors;
+    return source;
+}
+
+template <typename Dest>
+static void DecodeDest(DecodedProgram::Operation& operation, Dest dest) {
+    if (dest < 0x10) {
+        operation.dest_file = DecodedRegisterFile::Output;
+        operation.dest_index = static_cast<u8>(dest.GetIndex());
+    } else if (dest < 0x20) {
+        operation.dest_file = DecodedRegisterFile::Temporary;
+        operation.dest_index = static_cast<u8>(dest.GetIndex());
+    } else {
+        operation.dest_file = DecodedRegisterFile::Dummy;
+        operation.dest_index = 0;
+    }
+}
+
+static DecodedProgram::Operation DecodeInstruction(const Instruction instr,
+                                                   const SwizzleData& swizzle_data) {
+    DecodedProgram::Operation operation{};
+    operation.instr = instr;
+
+    switch (instr.opcode.Value().GetInfo().type) {
+    case OpCode::Type::Arithmetic: {
+        const SwizzlePattern swizzle = {swizzle_data[instr.common.operand_desc_id]};
+        const bool is_inverted =
+            (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+        const bool is_relative = instr.common.address_register_index != 0;
+
+        operation.address_register_index = static_cast<u8>(instr.common.address_register_index);
+        operation.dest_lanes = static_cast<u8>(GetDestLanes(swizzle));
+        DecodeDest(operation, instr.common.dest.Value());
+        operation.src[0] = DecodeSource(instr.common.GetSrc1(is_inverted), swizzle.negate_src1,
+                                        {static_cast<u8>(swizzle.src1_selector_0.Value()),
+                                         static_cast<u8>(swizzle.src1_selector_1.Value()),
+                                         static_cast<u8>(swizzle.src1_selector_2.Value()),
+                                         static_cast<u8>(swizzle.src1_selector_3.Value())},
+                                        is_relative && !is_inverted);
+        operation.src[1] = DecodeSource(instr.common.GetSrc2(is_inverted), swizzle.negate_src2,
+                                        {static_cast<u8>(swizzle.src2_selector_0.Value()),
+                                         static_cast<u8>(swizzle.src2_selector_1.Value()),
+                                         static_cast<u8>(swizzle.src2_selector_2.Value()),
+                                         static_cast<u8>(swizzle.src2_selector_3.Value())},
+                                        is_relative && is_inverted);
+
+        switch (instr.opcode.Value().EffectiveOpCode()) {
+        case OpCode::Id::ADD:
+            operation.op = DecodedOp::Add;
+            break;
+        case OpCode::Id::MUL:
+            operation.op = DecodedOp::Mul;
+            break;
+        case OpCode::Id::FLR:
+            operation.op = DecodedOp::Flr;
+            break;
+        case OpCode::Id::MAX:
+            operation.op = DecodedOp::Max;
+            break;
+        case OpCode::Id::MIN:
+            operation.op = DecodedOp::Min;
+            break;
+        case OpCode::Id::DP3:
+            operation.op = DecodedOp::Dp3;
+            break;
+        case OpCode::Id::DP4:
+            operation.op = DecodedOp::Dp4;
+            break;
+        case OpCode::Id::DPH:
+        case OpCode::Id::DPHI:
+            operation.op = DecodedOp::Dph;
+            break;
+        case OpCode::Id::RCP:
+            operation.op = DecodedOp::Rcp;
+            break;
+        case OpCode::Id::RSQ:
+            operation.op = DecodedOp::Rsq;
+            break;
+        case OpCode::Id::MOVA:
+            operation.op = DecodedOp::Mova;
+            break;
+        case OpCode::Id::MOV:
+            operation.op = DecodedOp::Mov;
+            break;
+        case OpCode::Id::SGE:
+        case OpCode::Id::SGEI:
+            operation.op = DecodedOp::Sge;
+            break;
+        case OpCode::Id::SLT:
+        case OpCode::Id::SLTI:
+            operation.op = DecodedOp::Slt;
+            break;
+        case OpCode::Id::CMP:
+            operation.op = DecodedOp::Cmp;
+            break;
+        case OpCode::Id::EX2:
+            operation.op = DecodedOp::Ex2;
+            break;
+        case OpCode::Id::LG2:
+            operation.op = DecodedOp::Lg2;
+            break;
+        default:
+            operation.op = DecodedOp::Unhandled;
+            break;
+        }
+        break;
+    }
+
+    case OpCode::Type::MultiplyAdd: {
+        if ((instr.opcode.Value().EffectiveOpCode() != OpCode::Id::MAD) &&
+            (instr.opcode.Value().EffectiveOpCode() != OpCode::Id::MADI)) {
+            operation.op = DecodedOp::Unhandled;
+            break;
+        }
+
+        const SwizzlePattern swizzle = {swizzle_data[instr.mad.operand_desc_id]};
+        const bool is_inverted = (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI);
+        const bool is_relative = instr.mad.address_register_index != 0;
+
+        operation.op = DecodedOp::Mad;
+        operation.address_register_index = static_cast<u8>(instr.mad.address_register_index);
+        operation.dest_lanes = static_cast<u8>(GetDestLanes(swizzle));
+        DecodeDest(operation, instr.mad.dest.Value());
+        operation.src[0] = DecodeSource(instr.mad.GetSrc1(is_inverted), swizzle.negate_src1,
+                                        {static_cast<u8>(swizzle.src1_selector_0.Value()),
+                                         static_cast<u8>(swizzle.src1_selector_1.Value()),
+                                         static_cast<u8>(swizzle.src1_selector_2.Value()),
+                                         static_cast<u8>(swizzle.src1_selector_3.Value())},
+                                        false);
+        operation.src[1] = DecodeSource(instr.mad.GetSrc2(is_inverted), swizzle.negate_src2,
+                                        {static_cast<u8>(swizzle.src2_selector_0.Value()),
+                                         static_cast<u8>(swizzle.src2_selector_1.Value()),
+                                         static_cast<u8>(swizzle.src2_selector_2.Value()),
+                                         static_cast<u8>(swizzle.src2_selector_3.Value())},
+                                        is_relative && !is_inverted);
+        operation.src[2] = DecodeSource(instr.mad.GetSrc3(is_inverted), swizzle.negate_src3,
+                                        {static_cast<u8>(swizzle.src3_selector_0.Value()),
+                                         static_cast<u8>(swizzle.src3_selector_1.Value()),
+                                         static_cast<u8>(swizzle.src3_selector_2.Value()),
+                                         static_cast<u8>(swizzle.src3_selector_3.Value())},
+                                        is_relative && is_inverted);
+        break;
+    }
+
+    default:
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::END:
+            operation.op = DecodedOp::End;
+            break;
+        case OpCode::Id::JMPC:
+            operation.op = DecodedOp::Jmpc;
+            break;
+        case OpCode::Id::JMPU:
+            operation.op = DecodedOp::Jmpu;
+            break;
+        case OpCode::Id::CALL:
+            operation.op = DecodedOp::Call;
+            break;
+        case OpCode::Id::CALLU:
+            operation.op = DecodedOp::Callu;
+            break;
+        case OpCode::Id::CALLC:
+            operation.op = DecodedOp::Callc;
+            break;
+        case OpCode::Id::NOP:
+            operation.op = DecodedOp::Nop;
+            break;
+        case OpCode::Id::IFU:
+            operation.op = DecodedOp::Ifu;
+            break;
+        case OpCode::Id::IFC:
+            operation.op = DecodedOp::Ifc;
+            break;
+        case OpCode::Id::LOOP:
+            operation.op = DecodedOp::Loop;
+            break;
+        case OpCode::Id::EMIT:
+            operation.op = DecodedOp::Emit;
+            break;
+        case OpCode::Id::SETEMIT:
+            operation.op = DecodedOp::SetEmit;
+            break;
+        default:
+            operation.op = DecodedOp::Unhandled;
+            break;
+        }
+        break;
+    }
+
+    return operation;
+}
+
+/**
+ * Runs a pre-decoded program. This must behave exactly like RunInterpreter, which is kept for
+ * producing debug information.
+ */
+static void RunDecoded(const DecodedProgram& program, const ShaderSetup& setup, UnitState& state,
+                       unsigned offset) {
+    boost::container::static_vector<CallStackElement, 16> call_stack;
+    u32 program_counter = offset;
+
+    state.conditional_code[0] = false;
+    state.conditional_code[1] = false;
+
+    auto call = [&program_counter, &call_stack](u32 offset, u32 num_instructions, u32 return_offset,
+                                                u8 repeat_count, u8 loop_increment) {
+        // -1 to make sure when incrementing the PC we end up at the correct offset
+        program_counter = offset - 1;
+        ASSERT(call_stack.size() < call_stack.capacity());
+        call_stack.push_back(
+            {offset + num_instructions, return_offset, repeat_count, loop_increment, offset});
+    };
+
+    const auto& uniforms = setup.uniforms;
+
+    // Indexed by DecodedProgram::RegisterFile
+    const std::array<const Common::Vec4<f24>*, 5> source_files = {
+        state.registers.input.data(), state.registers.temporary.data(),
+        state.registers.output.data(), uniforms.f.data(), &dummy_register};
+    const std::array<Common::Vec4<f24>*, 5> dest_files = {
+        nullptr, state.registers.temporary.data(), state.registers.output.data(), nullptr,
+        &dummy_register};
+
+    const auto load_source = [&](const DecodedProgram::Operation& operation, std::size_t n) {
+        const DecodedProgram::Source& source = operation.src[n];
+        const f24* reg =
+            source.relative
+                ? LookupSourceRegister(
+                      state, uniforms,
+                      source.reg + state.address_registers[operation.address_register_index - 1])
+                : &source_files[static_cast<std::size_t>(source.file)][source.index].x;
+        std::array<f24, 4> value = {reg[source.selectors[0]], reg[source.selectors[1]],
+                                    reg[source.selectors[2]], reg[source.selectors[3]]};
+        if (source.negate) {
+            for (f24& component : value) {
+                component = -component;
+            }
+        }
+        return value;
+    };
+
+    const auto get_dest = [&](const DecodedProgram::Operation& operation) {
+        return &dest_files[static_cast<std::size_t>(operation.dest_file)][operation.dest_index].x;
+    };
+
+    const auto store_scalar = [](f24* dest, u32 lanes, f24 value) {
+        for (u32 i = 0; i < 4; ++i) {
+            if (lanes & (1u << i)) {
+                dest[i] = value;
+            }
+        }
+    };
+
+    while (true) {
+        if (!call_stack.empty()) {
+            auto& top = call_stack.back();
+            if (program_counter == top.final_address) {
+                state.address_registers[2] += top.loop_increment;
+
+                if (top.repeat_counter-- == 0) {
+                    program_counter = top.return_address;
+                    call_stack.pop_back();
+                } else {
+                    program_counter = top.loop_address;
+                }
+
+                continue;
+            }
+        }
+
+        const DecodedProgram::Operation& operation = program.code[program_counter];
+        const u32 lanes = operation.dest_lanes;
+        const Instruction instr = operation.instr;
+
+        switch (operation.op) {
+        case DecodedOp::Add: {
+            const auto src1 = load_source(operation, 0);
+            const auto src2 = load_source(operation, 1);
+            (F24x4::Load(src1.data()) + F24x4::Load(src2.data()))
+                .StoreMasked(get_dest(operation), lanes);
+            break;
+        }
+
+        case DecodedOp::Mul: {
+            const auto src1 = load_source(operation, 0);
+            const auto src2 = load_source(operation, 1);
+            (F24x4::Load(src1.data()) * F24x4::Load(src2.data()))
+                .StoreMasked(get_dest(operation), lanes);
+            break;
+        }
+
+        case DecodedOp::Flr: {
+            const auto src1 = load_source(operation, 0);
+            f24* dest = get_dest(operation);
+            for (u32 i = 0; i < 4; ++i) {
+                if (lanes & (1u << i)) {
+                    dest[i] = f24::FromFloat32(std::floor(src1[i].ToFloat32()));
+                }
+            }
+            break;
+        }
+
+        case DecodedOp::Max: {
+            const auto src1 = load_source(operation, 0);
+            const auto src2 = load_source(operation, 1);
+            F24x4::Max(F24x4::Load(src1.data()), F24x4::Load(src2.data()))
+                .StoreMasked(get_dest(operation), lanes);
+            break;
+        }
+
+        case DecodedOp::Min: {
+            const auto src1 = load_source(operation, 0);
+            const auto src2 = load_source(operation, 1);
+            F24x4::Min(F24x4::Load(src1.data()), F24x4::Load(src2.data()))
+                .StoreMasked(get_dest(operation), lanes);
+            break;
+        }
+
+        case DecodedOp::Dp3:
+        case DecodedOp::Dp4:
+        case DecodedOp::Dph: {
+            auto src1 = load_source(operation, 0);
+            const auto src2 = load_source(operation, 1);
+            if (operation.op == DecodedOp::Dph) {
+                src1[3] = f24::One();
+            }
+
+            const auto products = (F24x4::Load(src1.data()) * F24x4::Load(src2.data())).ToArray();
+            f24 dot = f24::Zero() + products[0] + products[1] + products[2];
+            if (operation.op != DecodedOp::Dp3) {
+                dot = dot + products[3];
+            }
+            store_scalar(get_dest(operation), lanes, dot);
+            break;
+        }
+
+        case DecodedOp::Rcp: {
+            const auto src1 = load_source(operation, 0);
+            store_scalar(get_dest(operation), lanes, f24::FromFloat32(1.0f / src1[0].ToFloat32()));
+            break;
+        }
+
+        case DecodedOp::Rsq: {
+            const auto src1 = load_source(operation, 0);
+            store_scalar(get_dest(operation), lanes,
+                         f24::FromFloat32(1.0f / std::sqrt(src1[0].ToFloat32())));
+            break;
+        }
+
+        case DecodedOp::Mova: {
+            const auto src1 = load_source(operation, 0);
+            for (u32 i = 0; i < 2; ++i) {
+                if (lanes & (1u << i)) {
+                    state.address_registers[i] = static_cast<s32>(src1[i].ToFloat32());
+                }
+            }
+            break;
+        }
+
+        case DecodedOp::Mov: {
+            const auto src1 = load_source(operation, 0);
+            F24x4::Load(src1.data()).StoreMasked(get_dest(operation), lanes);
+            break;
+        }
+
+        case DecodedOp::Sge:
+        case DecodedOp::Slt: {
+            const auto src1 = load_source(operation, 0);
+            const auto src2 = load_source(operation, 1);
+            f24* dest = get_dest(operation);
+            const bool is_sge = operation.op == DecodedOp::Sge;
+            for (u32 i = 0; i < 4; ++i) {
+                if (lanes & (1u << i)) {
+                    const bool result = is_sge ? (src1[i] >= src2[i]) : (src1[i] < src2[i]);
+                    dest[i] = result ? f24::One() : f24::Zero();
+                }
+            }
+            break;
+        }
+
+        case DecodedOp::Cmp: {
+            const auto src1 = load_source(operation, 0);
+            const auto src2 = load_source(operation, 1);
+            for (int i = 0; i < 2; ++i) {
+                auto compare_op = instr.common.compare_op;
+                auto op = (i == 0) ? compare_op.x.Value() : compare_op.y.Value();
+
+                switch (op) {
+                case Instruction::Common::CompareOpType::Equal:
+                    state.conditional_code[i] = (src1[i] == src2[i]);
+                    break;
+
+                case Instruction::Common::CompareOpType::NotEqual:
+                    state.conditional_code[i] = (src1[i] != src2[i]);
+                    break;
+
+                case Instruction::Common::CompareOpType::LessThan:
+                    state.conditional_code[i] = (src1[i] < src2[i]);
+                    break;
+
+                case Instruction::Common::CompareOpType::LessEqual:
+                    state.conditional_code[i] = (src1[i] <= src2[i]);
+                    break;
+
+                case Instruction::Common::CompareOpType::GreaterThan:
+                    state.conditional_code[i] = (src1[i] > src2[i]);
+                    break;
+
+                case Instruction::Common::CompareOpType::GreaterEqual:
+                    state.conditional_code[i] = (src1[i] >= src2[i]);
+                    break;
+
+                default:
+                    LOG_ERROR(HW_GPU, "Unknown compare mode {:x}", static_cast<int>(op));
+                    break;
+                }
+            }
+            break;
+        }
+
+        case DecodedOp::Ex2: {
+            const auto src1 = load_source(operation, 0);
+            store_scalar(get_dest(operation), lanes,
+                         f24::FromFloat32(std::exp2(src1[0].ToFloat32())));
+            break;
+        }
+
+        case DecodedOp::Lg2: {
+            const auto src1 = load_source(operation, 0);
+            store_scalar(get_dest(operation), lanes,
+                         f24::FromFloat32(std::log2(src1[0].ToFloat32())));
+            break;
+        }
+
+        case DecodedOp::Mad: {
+            const auto src1 = load_source(operation, 0);
+            const auto src2 = load_source(operation, 1);
+            const auto src3 = load_source(operation, 2);
+            (F24x4::Load(src1.data()) * F24x4::Load(src2.data()) + F24x4::Load(src3.data()))
+                .StoreMasked(get_dest(operation), lanes);
+            break;
+        }
+
+        case DecodedOp::End:
+            return;
+
+        case DecodedOp::Jmpc:
+            if (EvaluateCondition(state, instr.flow_control)) {
+                program_counter = instr.flow_control.dest_offset - 1;
+            }
+            break;
+
+        case DecodedOp::Jmpu:
+            if (uniforms.b[instr.flow_control.bool_uniform_id] ==
+                !(instr.flow_control.num_instructions & 1)) {
+                program_counter = instr.flow_control.dest_offset - 1;
+            }
+            break;
+
+        case DecodedOp::Call:
+            call(instr.flow_control.dest_offset, instr.flow_control.num_instructions,
+                 program_counter + 1, 0, 0);
+            break;
+
+        case DecodedOp::Callu:
+            if (uniforms.b[instr.flow_control.bool_uniform_id]) {
+                call(instr.flow_control.dest_offset, instr.flow_control.num_instructions,
+                     program_counter + 1, 0, 0);
+            }
+            break;
+
+        case DecodedOp::Callc:
+            if (EvaluateCondition(state, instr.flow_control)) {
+                call(instr.flow_control.dest_offset, instr.flow_control.num_instructions,
+                     program_counter + 1, 0, 0);
+            }
+            break;
+
+        case DecodedOp::Nop:
+            break;
+
+        case DecodedOp::Ifu:
+        case DecodedOp::Ifc: {
+            const bool condition = operation.op == DecodedOp::Ifu
+                                       ? uniforms.b[instr.flow_control.bool_uniform_id]
+                                       : EvaluateCondition(state, instr.flow_control);
+            if (condition) {
+                call(program_counter + 1, instr.flow_control.dest_offset - program_counter - 1,
+                     instr.flow_control.dest_offset + instr.flow_control.num_instructions, 0, 0);
+            } else {
+                call(instr.flow_control.dest_offset, instr.flow_control.num_instructions,
+                     instr.flow_control.dest_offset + instr.flow_control.num_instructions, 0, 0);
+            }
+            break;
+        }
+
+        case DecodedOp::Loop: {
+            const auto& loop_param = uniforms.i[instr.flow_control.int_uniform_id];
+            state.address_registers[2] = loop_param.y;
+            call(program_counter + 1, instr.flow_control.dest_offset - program_counter,
+                 instr.flow_control.dest_offset + 1, loop_param.x, loop_param.z);
+            break;
+        }
+
+        case DecodedOp::Emit: {
+            GSEmitter* emitter = state.emitter_ptr;
+            ASSERT_MSG(emitter, "Execute EMIT on VS");
+            emitter->Emit(state.registers.output);
+            break;
+        }
+
+        case DecodedOp::SetEmit: {
+            GSEmitter* emitter = state.emitter_ptr;
+            ASSERT_MSG(emitter, "Execute SETEMIT on VS");
+            emitter->vertex_id = instr.setemit.vertex_id;
+            emitter->prim_emit = instr.setemit.prim_emit != 0;
+            emitter->winding = instr.setemit.winding != 0;
+            break;
+        }
+
+        case DecodedOp::Unhandled:
+            LOG_ERROR(HW_GPU, "Unhandled instruction: 0x{:02x} ({}): 0x{:08x}",
+                      (int)instr.opcode.Value().EffectiveOpCode(),
+                      instr.opcode.Value().GetInfo().name, instr.hex);
+            break;
+        }
+
+        ++program_counter;
+    }
+}
+
+InterpreterEngine::InterpreterEngine() = default;
+InterpreterEngine::~InterpreterEngine() = default;
+
 void InterpreterEngine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
     setup.engine_data.entry_point = entry_point;
+
+    const u64 cache_key = setup.GetProgramCodeHash() ^ setup.GetSwizzleDataHash();
+    auto iter = cache.find(cache_key);
+    if (iter != cache.end()) {
+        setup.engine_data.cached_shader = iter->second.get();
+    } else {
+        Core::PerfStats::ScopedComponent component{Core::PerfStats::Component::ShaderCompilation};
+        auto program = std::make_unique<DecodedProgram>();
+        for (std::size_t i = 0; i < program->code.size(); ++i) {
+            program->code[i] = DecodeInstruction({setup.program_code[i]}, setup.swizzle_data);
+        }
+        setup.engine_data.cached_shader = program.get();
+        cache.emplace_hint(iter, cache_key, std::move(program));
+    }
+}
+
+void InterpreterEngine::ClearCache() {
+    cache.clear();
 }
 
 MICROPROFILE_DECLARE(GPU_Shader);
 
 void InterpreterEngine::Run(const ShaderSetup& setup, UnitState& state) const {
+    ASSERT(setup.engine_data.cached_shader != nullptr);
 
     MICROPROFILE_SCOPE(GPU_Shader);
 
+    const auto* program = static_cast<const DecodedProgram*>(setup.engine_data.cached_shader);
+    RunDecoded(*program, setup, state, setup.engine_data.entry_point);
+}
+
+void InterpreterEngine::RunUndecoded(const ShaderSetup& setup, UnitState& state) const {
     DebugData<false> dummy_debug_data;
     RunInterpreter(setup, state, dummy_debug_data, setup.engine_data.entry_point);
 }
@@ -4,16 +4,30 @@
 
 #pragma once
 
+#include <memory>
+#include <unordered_map>
+#include "common/common_types.h"
 #include "video_core/shader/debug_data.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica::Shader {
 
+struct DecodedProgram;
+
 class InterpreterEngine final : public ShaderEngine {
 public:
+    InterpreterEngine();
+    ~InterpreterEngine() override;
+
     void SetupBatch(ShaderSetup& setup, unsigned int entry_point) override;
     void Run(const ShaderSetup& setup, UnitState& state) const override;
 
+    /**
+     * Runs the shader without the pre-decoded program of SetupBatch, decoding every instruction
+     * like ProduceDebugInfo does. Slower than Run, used to check it.
+     */
+    void RunUndecoded(const ShaderSetup& setup, UnitState& state) const;
+
     /**
      * Produce debug information based on the given shader and input vertex
      * @param setup  Shader engine state
@@ -23,6 +37,12 @@ public:
      */
     DebugData<true> ProduceDebugInfo(const ShaderSetup& setup, const AttributeBuffer& input,
                                      const ShaderRegs& config) const;
+
+    /// Frees the pre-decoded programs
+    void ClearCache();
+
+private:
+    std::unordered_map<u64, std::unique_ptr<DecodedProgram>> cache;
 };
 
 } // namespace Pica::Shader
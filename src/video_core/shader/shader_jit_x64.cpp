@@ -7,6 +7,7 @@
 
 #include "common/assert.h"
 #include "common/microprofile.h"
+#include "core/perf_stats.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit_x64.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
@@ -28,6 +29,7 @@ void JitX64Engine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     if (iter != cache.end()) {
         setup.engine_data.cached_shader = iter->second.get();
     } else {
+        Core::PerfStats::ScopedComponent component{Core::PerfStats::Component::ShaderCompilation};
         auto shader = std::make_unique<JitShader>();
         shader->Compile(&setup.program_code, &setup.swizzle_data);
         setup.engine_data.cached_shader = shader.get();
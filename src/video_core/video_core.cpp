@@ -8,6 +8,7 @@
 #include "common/settings.h"
 #include "core/core.h"
 #include "core/frontend/emu_window.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
 #include "video_core/renderer_base.h"
@@ -19,6 +20,7 @@
 namespace VideoCore {
 
 std::unique_ptr<RendererBase> g_renderer{}; ///< Renderer plugin
+std::unique_ptr<GPUThread> g_gpu_thread{};  ///< Command list thread, if enabled
 
 std::atomic<bool> g_shader_jit_enabled;
 std::atomic<bool> g_hw_shader_enabled;
@@ -46,10 +48,19 @@ void Init(Frontend::EmuWindow& emu_window, Frontend::EmuWindow* secondary_window
         LOG_CRITICAL(Render, "Unknown graphics API {}, using OpenGL", graphics_api);
         g_renderer = std::make_unique<OpenGL::RendererOpenGL>(system, emu_window, secondary_window);
     }
+
+    if (Settings::values.use_async_gpu.GetValue()) {
+        if (graphics_api == Settings::GraphicsAPI::Software) {
+            g_gpu_thread = std::make_unique<GPUThread>(system.CoreTiming());
+        } else {
+            LOG_WARNING(Render, "Asynchronous GPU emulation requires the software renderer");
+        }
+    }
 }
 
 /// Shutdown the video core
 void Shutdown() {
+    g_gpu_thread.reset();
     Pica::Shutdown();
     g_renderer.reset();
 
@@ -58,6 +69,9 @@ void Shutdown() {
 
 template <class Archive>
 void serialize(Archive& ar, const unsigned int) {
+    if (g_gpu_thread) {
+        g_gpu_thread->Synchronize();
+    }
     ar& Pica::g_state;
 }
 